@@ -0,0 +1,123 @@
+/*
+ * bench_escape_json.cpp
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json_escape.h"
+
+namespace {
+
+namespace Internal = Onedatashare::Internal;
+
+/**
+ * The Util::escape_json implementation that wrote every character through an ostringstream, kept for comparison.
+ */
+std::string escape_json_stream(const std::string& json)
+{
+    std::ostringstream stream {};
+    for (auto c : json) {
+        switch (c) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\b':
+            stream << "\\b";
+            break;
+        case '\f':
+            stream << "\\f";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\r':
+            stream << "\\r";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            if ('\x00' <= c && c <= '\x1f') {
+                stream << "\\u" << std::setfill('0') << (int) c;
+            } else {
+                stream << c;
+            }
+        }
+    }
+    return stream.str();
+}
+
+/**
+ * Times escaping every string of the specified set with the specified function.
+ *
+ * @return throughput in megabytes per second
+ */
+template <typename Escape>
+double measure(const std::vector<std::string>& strings, int rounds, Escape escape)
+{
+    std::size_t bytes {0}, checksum {0};
+    const auto start {std::chrono::steady_clock::now()};
+    for (auto round {0}; round < rounds; ++round) {
+        for (const auto& str : strings) {
+            checksum += escape(str).size();
+            bytes += str.size();
+        }
+    }
+    const std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+
+    // use the checksum so the calls are not optimized away
+    if (checksum == 0) {
+        std::cerr << "no output" << std::endl;
+    }
+    return bytes / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+/**
+ * Compares the throughput of append_escaped_json, writing into a reused buffer the way Json_writer does, against the
+ * ostringstream implementation it replaced, on short ids, typical paths, and long paths, each without escapes and
+ * with an escape every 64 characters.
+ *
+ * Usage: bench_escape_json [rounds]
+ */
+int main(int argc, char* argv[])
+{
+    const auto rounds {argc > 1 ? std::atoi(argv[1]) : 20};
+
+    for (std::size_t length : {12, 64, 1024}) {
+        for (auto dirty : {false, true}) {
+            std::vector<std::string> strings {};
+            for (auto i {0}; i < 20000; ++i) {
+                std::string str(length, 'a' + i % 26);
+                for (std::size_t j {63}; dirty && j < length; j += 64) {
+                    str[j] = '"';
+                }
+                strings.push_back(std::move(str));
+            }
+
+            const auto stream {measure(strings, rounds, escape_json_stream)};
+            std::string buffer {};
+            const auto vector {measure(strings, rounds, [&buffer](const std::string& str) -> const std::string& {
+                buffer.clear();
+                Internal::append_escaped_json(buffer, str);
+                return buffer;
+            })};
+
+            std::cout << "length " << length << (dirty ? " with escapes" : " clean") << ": ostringstream " << stream
+                      << " MB/s, append_escaped_json " << vector << " MB/s" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
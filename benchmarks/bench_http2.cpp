@@ -0,0 +1,128 @@
+/*
+ * bench_http2.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "curl_multi_rest.h"
+
+namespace {
+
+namespace Internal = Onedatashare::Internal;
+
+/**
+ * Keeps a fixed number of GET requests in flight until a total number of requests have completed.
+ */
+class Closed_loop {
+public:
+    Closed_loop(const Internal::Rest& rest, const std::string& url, int total)
+        : rest_ {rest},
+          url_ {url},
+          total_ {total},
+          started_ {0},
+          failed_ {0},
+          mutex_ {},
+          done_ {},
+          completed_ {0}
+    {}
+
+    /**
+     * Runs the loop with the specified number of requests in flight.
+     *
+     * @return the number of requests that failed
+     */
+    int run(int concurrency)
+    {
+        for (auto i {0}; i < concurrency; ++i) {
+            start();
+        }
+
+        std::unique_lock<std::mutex> lock {mutex_};
+        done_.wait(lock, [this] { return completed_ == total_; });
+
+        return failed_;
+    }
+
+private:
+    void start()
+    {
+        if (started_.fetch_add(1) >= total_) {
+            return;
+        }
+        rest_.get_async(url_, {}, [this](std::future<Internal::Response> response) {
+            try {
+                if (response.get().status() != 200) {
+                    ++failed_;
+                }
+            } catch (...) {
+                ++failed_;
+            }
+            // issue the next request before counting this one so the loop never drops below its concurrency
+            start();
+
+            std::lock_guard<std::mutex> lock {mutex_};
+            if (++completed_ == total_) {
+                done_.notify_one();
+            }
+        });
+    }
+
+    const Internal::Rest& rest_;
+    const std::string url_;
+    const int total_;
+    std::atomic<int> started_;
+    std::atomic<int> failed_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    int completed_;
+};
+
+} // namespace
+
+/**
+ * Measures requests per second made through Curl_multi_rest at 1, 16, and 128 concurrent streams.
+ *
+ * The benchmark needs a local HTTP/2 server standing in for the OneDataShare API, for example nghttpd serving a small
+ * file with a self-signed certificate:
+ *
+ *     mkdir -p /tmp/www && echo '{"files":[]}' > /tmp/www/ls
+ *     openssl req -x509 -newkey rsa:2048 -nodes -keyout key.pem -out cert.pem -days 1 -subj /CN=localhost \
+ *         -addext subjectAltName=DNS:localhost
+ *     nghttpd -d /tmp/www 8443 key.pem cert.pem
+ *     bench_http2 https://localhost:8443/ls cert.pem
+ *
+ * Passing "http1" as the mode disables HTTP/2, to compare against a server that also speaks HTTP/1.1.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <url> [ca bundle] [h2|http1] [requests]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string url {argv[1]};
+    Internal::Curl_multi_options options {};
+    options.ca_info = argc > 2 ? argv[2] : "";
+    options.http2 = argc <= 3 || std::string {argv[3]} != "http1";
+    const auto total {argc > 4 ? std::atoi(argv[4]) : 5000};
+
+    for (auto concurrency : {1, 16, 128}) {
+        // a fresh caller per run so each run starts without open connections
+        Internal::Curl_multi_rest rest {options};
+
+        const auto start {std::chrono::steady_clock::now()};
+        const auto failed {Closed_loop {rest, url, total}.run(concurrency)};
+        const std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+
+        std::cout << "streams " << concurrency << ": " << static_cast<long>(total / elapsed.count()) << " req/s ("
+                  << failed << " failed)" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
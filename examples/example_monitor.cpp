@@ -4,14 +4,18 @@
  * 8/6/20
  */
 
+#include <condition_variable>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <onedatashare/onedatashare.h>
 
 /**
- * Example of monitoring endpoint and performing transfers.
+ * Example of watching a directory on an endpoint and transferring a file once it is added.
  */
 int main()
 {
@@ -62,20 +66,41 @@ int main()
 
     const auto target_file_name {""};
 
-    try {
-        while (true) {
-            for (auto& r : *src_endpoint->list(src_dir).contained_resources) {
-                if (r.name == target_file_name) {
-                    const Ods::Source src {src_type, src_cred, src_dir, std::vector {r.name}};
-                    std::cout << "Starting transfer with id:" << transfer->transfer(src, dest, Ods::Transfer_options {})
-                              << std::endl;
-                }
+    // reaching the end of the watch is signaled from the watching thread
+    std::mutex mutex {};
+    std::condition_variable done_cv {};
+    auto done {false};
+    std::exception_ptr error {};
+
+    const auto watcher {Ods::Directory_watcher::create()};
+    watcher->watch(
+        *src_endpoint,
+        src_dir,
+        [&](const Ods::Watch_event& event) {
+            if (event.type == Ods::Watch_event_type::removed || event.resource.name != target_file_name) {
+                return;
             }
-        }
+            const Ods::Source src {src_type, src_cred, src_dir, std::vector {event.resource.name}};
+            std::cout << "Starting transfer with id:" << transfer->transfer(src, dest, Ods::Transfer_options {})
+                      << std::endl;
+        },
+        [&](const std::string&, std::exception_ptr e) {
+            const std::lock_guard<std::mutex> lock {mutex};
+            error = e;
+            done = true;
+            done_cv.notify_all();
+        });
+
+    // wait without polling until listing the directory or starting a transfer fails
+    std::unique_lock<std::mutex> lock {mutex};
+    done_cv.wait(lock, [&] { return done; });
+
+    try {
+        std::rethrow_exception(error);
     } catch (Ods::Unexpected_response_error e) {
         std::cout << "\nUnexpected response received from OneDataShare.\n\nwhat(): " << e.what()
                   << "\n\nstatus: " << e.status << std::endl;
     } catch (Ods::Connection_error e) {
         std::cout << "\nError connecting to OneDataShare.\n\nwhat(): " << e.what() << std::endl;
     }
-}
\ No newline at end of file
+}
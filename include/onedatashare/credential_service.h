@@ -9,6 +9,7 @@
 #ifndef ONEDATASHARE_CREDENTIAL_SERVICE_H
 #define ONEDATASHARE_CREDENTIAL_SERVICE_H
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -138,6 +139,56 @@ public:
      */
     virtual std::vector<std::string> credential_id_list(Endpoint_type type) const = 0;
 
+    /**
+     * Starts getting the url used to register an endpoint of the specified type via OAuth without waiting for
+     * OneDataShare to respond. Behaves like oauth_url otherwise.
+     *
+     * @param type the endpoint type to get the OAuth url for
+     *
+     * @return future holding the OAuth url, or the Connection_error or Unexpected_response_error that oauth_url would
+     * throw
+     *
+     * @see oauth_url
+     */
+    virtual std::future<std::string> oauth_url_async(Oauth_endpoint_type type) const = 0;
+
+    /**
+     * Starts registering the specified endpoint with OneDataShare without waiting for OneDataShare to respond.
+     * Behaves like register_credential otherwise. The credentials are copied, so the pointers need not outlive the
+     * call.
+     *
+     * @param type the endpoint type to register
+     * @param cred_id borrowed reference to the credential identifier to associate with the registered endpoint
+     * @param uri borrowed reference to the uri of the endpoint to register
+     * @param username borrowed pointer to the username needed to log in to the endpoint or nullptr to register an
+     * endpoint without a username
+     * @param secret borrowed pointer to the password needed to log in to the endpoint or nullptr to register an
+     * endpoint without a password
+     *
+     * @return future that becomes ready once the endpoint is registered, or holds the Connection_error or
+     * Unexpected_response_error that register_credential would throw
+     *
+     * @see register_credential
+     */
+    virtual std::future<void> register_credential_async(Credential_endpoint_type type,
+                                                        const std::string& cred_id,
+                                                        const std::string& uri,
+                                                        const std::string* username,
+                                                        const std::string* secret) const = 0;
+
+    /**
+     * Starts creating the list of registered credential identifiers of the specified endpoint type without waiting
+     * for OneDataShare to respond. Behaves like credential_id_list otherwise.
+     *
+     * @param type the endpoint type to list the registered credential identifiers of
+     *
+     * @return future holding the registered credential identifiers, or the Connection_error or
+     * Unexpected_response_error that credential_id_list would throw
+     *
+     * @see credential_id_list
+     */
+    virtual std::future<std::vector<std::string>> credential_id_list_async(Endpoint_type type) const = 0;
+
 protected:
     /// @private
     Credential_service();
@@ -0,0 +1,138 @@
+/**
+ * @file directory_watcher.h
+ * Defines structs and classes needed to observe changes to directories on endpoints' file systems.
+ */
+
+#ifndef ONEDATASHARE_DIRECTORY_WATCHER_H
+#define ONEDATASHARE_DIRECTORY_WATCHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "endpoint.h"
+
+namespace Onedatashare {
+
+/**
+ * Contains the kinds of changes a Directory_watcher reports.
+ */
+enum class Watch_event_type {
+    /** Indicates a resource that was not in the previous listing of the directory. */
+    added,
+    /** Indicates a resource from the previous listing of the directory that is no longer listed. */
+    removed,
+    /** Indicates a resource whose size or time differs from the previous listing of the directory. */
+    modified
+};
+
+/**
+ * Describes a change to a watched directory.
+ */
+struct Watch_event {
+    /** Kind of change. */
+    Watch_event_type type;
+
+    /** Path or id of the watched directory the resource is contained by. */
+    std::string directory;
+
+    /** The resource as it was last listed for removed resources, and as it is now listed otherwise. */
+    Resource resource;
+};
+
+/**
+ * Options controlling how often a Directory_watcher lists each directory.
+ */
+struct Directory_watcher_options {
+    /** Time between listings of a directory that recently changed. */
+    std::chrono::milliseconds min_interval {1000};
+
+    /** Greatest time between listings of a directory that has not changed for a while. */
+    std::chrono::milliseconds max_interval {30000};
+
+    /** Factor the time between listings of a directory grows by each time a listing finds no change. */
+    double backoff_factor {2.0};
+
+    /** Maximum number of directories listed at once. */
+    int max_concurrency {64};
+};
+
+/**
+ * Identifies a directory being watched by a Directory_watcher.
+ */
+using Watch_id = std::uint64_t;
+
+/**
+ * Service observing changes to directories on any number of endpoints by listing each directory periodically and
+ * comparing consecutive listings. A directory that keeps changing is listed every minimum interval, while the time
+ * between listings of an unchanging directory backs off up to the maximum interval, so thousands of mostly idle
+ * directories can be watched without overwhelming OneDataShare. Every directory is watched by a single thread owned
+ * by the Directory_watcher, which starts listings asynchronously and invokes the callbacks. Callbacks should not
+ * block for long since no listing is compared while a callback runs.
+ */
+class Directory_watcher {
+public:
+    /**
+     * Creates a new Directory_watcher with the specified options, passing ownership of the Directory_watcher object
+     * to the caller. The watching thread is started immediately and stopped when the Directory_watcher is destroyed.
+     *
+     * @param options borrowed reference to the options controlling how often directories are listed
+     *
+     * @return a unique pointer to a new Directory_watcher object
+     */
+    static std::unique_ptr<Directory_watcher> create(const Directory_watcher_options& options = {});
+
+    /// @private
+    virtual ~Directory_watcher() = 0;
+
+    /// @private
+    Directory_watcher(const Directory_watcher&) = delete;
+
+    /// @private
+    Directory_watcher& operator=(const Directory_watcher&) = delete;
+
+    /// @private
+    Directory_watcher(Directory_watcher&&) = delete;
+
+    /// @private
+    Directory_watcher& operator=(Directory_watcher&&) = delete;
+
+    /**
+     * Starts watching the specified directory. The first listing of the directory is taken as the starting point and
+     * reports no events; each later listing reports every resource added, removed, or modified since the listing
+     * before it. Resources are matched between listings by id if they have one and by name otherwise.
+     *
+     * @param endpoint borrowed reference to the endpoint the directory is on, which must outlive the watch
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint needs
+     * in order to locate the directory
+     * @param on_event moved callback invoked with each change to the directory
+     * @param on_error moved callback invoked with the directory and the exception when listing the directory or
+     * invoking on_event fails, or nullptr to ignore failures. The directory keeps being watched after a failure.
+     *
+     * @return the id identifying the watch
+     */
+    virtual Watch_id watch(const Endpoint& endpoint,
+                           const std::string& identifier,
+                           std::function<void(const Watch_event& event)> on_event,
+                           std::function<void(const std::string& identifier, std::exception_ptr error)> on_error =
+                               nullptr) = 0;
+
+    /**
+     * Stops watching the directory identified by the specified id. Callbacks already being invoked on the watching
+     * thread may still complete after this returns. Does nothing if the id does not identify a watched directory.
+     *
+     * @param id the id returned when the directory started being watched
+     */
+    virtual void unwatch(Watch_id id) = 0;
+
+protected:
+    /// @private
+    Directory_watcher();
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_DIRECTORY_WATCHER_H
@@ -9,12 +9,19 @@
 #ifndef ONEDATASHARE_ENDPOINT_H
 #define ONEDATASHARE_ENDPOINT_H
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "endpoint_type.h"
+#include "listing_cache.h"
+#include "resource_table.h"
 
 namespace Onedatashare {
 
@@ -52,6 +59,77 @@ struct Resource {
     std::optional<std::vector<Resource>> contained_resources;
 };
 
+/**
+ * Options controlling how Endpoint::list_recursive walks a tree of directories.
+ */
+struct List_recursive_options {
+    /** Maximum number of directories listed at once. */
+    int max_concurrency {16};
+
+    /** Maximum depth of directories listed, where the root is at depth 0 and its directories are at depth 1. */
+    int max_depth {std::numeric_limits<int>::max()};
+};
+
+/**
+ * Checksums that Endpoint::download_file can compute over a file as it is received.
+ */
+enum class Checksum_algorithm {
+    /** No checksum is computed. */
+    none,
+
+    /** CRC32C (Castagnoli), accelerated with SSE4.2 when available. */
+    crc32c,
+
+    /** 64-bit xxHash with a seed of 0. */
+    xxh64
+};
+
+/**
+ * Options controlling how Endpoint::download_file fetches a file.
+ */
+struct Download_options {
+    /** Number of bytes fetched by each ranged request. */
+    std::size_t chunk_size {8 * 1024 * 1024};
+
+    /** Maximum number of ranged requests in flight at once. */
+    int max_concurrency {8};
+
+    /** Checksum computed over the file as each chunk is received. */
+    Checksum_algorithm checksum {Checksum_algorithm::none};
+
+    /** Hexadecimal digest the checksum must match, or empty to use the digest supplied by the server, if any. */
+    std::string expected_digest {};
+};
+
+/**
+ * Outcome of Endpoint::download_file.
+ */
+struct Download_result {
+    /** Size of the downloaded file in bytes. */
+    std::uint64_t size;
+
+    /** Lower case hexadecimal checksum of the file, or no value if no checksum was requested. */
+    std::optional<std::string> digest;
+
+    /** If the checksum was compared against, and matched, a digest supplied by the caller or the server. */
+    bool verified;
+};
+
+/**
+ * Options controlling how Endpoint::upload sends a file.
+ */
+struct Upload_options {
+    /** Number of bytes sent by each part. */
+    std::size_t part_size {8 * 1024 * 1024};
+
+    /** Maximum number of parts in flight at once, which together with the part size bounds the memory used. */
+    int max_concurrency {4};
+
+    /** Callback invoked on the calling thread with the number of bytes sent so far and the size of the file each time
+     * a part is sent, or nullptr to report no progress. */
+    std::function<void(std::uint64_t sent, std::uint64_t total)> on_progress {};
+};
+
 /**
  * Service providing access to an endpoint of a specific type and credential id. Different endpoint types may differ
  * slightly in behavior and functionality as described in {@link Endpoint_type}.
@@ -91,6 +169,27 @@ public:
                                             const std::string& ods_auth_token,
                                             const std::string& url);
 
+    /**
+     * Creates a new Endpoint object like create does, except that the Endpoint object answers list and list_async
+     * from the specified cache when it can and adds the listings it receives to the cache. The cache may be shared by
+     * many Endpoint objects.
+     *
+     * @param type the type of endpoint to return
+     * @param cred_id borrowed reference to the credential id of the endpoint to use
+     * @param ods_auth_token borrowed reference to the OneDataShare authentication token to use
+     * @param url borrowed reference to the url that OneDataShare is running on
+     * @param cache shared pointer to the cache to use, which must have been created by Listing_cache::create
+     *
+     * @return a unique pointer to a new Endpoint object
+     *
+     * @exception invalid_argument if the cache was not created by Listing_cache::create
+     */
+    static std::unique_ptr<Endpoint> create(Endpoint_type type,
+                                            const std::string& cred_id,
+                                            const std::string& ods_auth_token,
+                                            const std::string& url,
+                                            std::shared_ptr<Listing_cache> cache);
+
     /// @private
     virtual ~Endpoint() = 0;
 
@@ -106,6 +205,20 @@ public:
     /// @private
     Endpoint& operator=(Endpoint&&) = delete;
 
+    /**
+     * Gets the type of the endpoint.
+     *
+     * @return the type of the endpoint
+     */
+    virtual Endpoint_type type() const = 0;
+
+    /**
+     * Gets the credential id used to access the endpoint.
+     *
+     * @return borrowed reference to the credential id
+     */
+    virtual const std::string& cred_id() const = 0;
+
     /**
      * Creates a Resource object corresponding to the resource found at the specified location. The Resource is
      * guaranteed to have an id defined if and only if created by an endpoint that supports ids. If the Resource is a
@@ -127,6 +240,73 @@ public:
      */
     virtual Resource list(const std::string& identifier) const = 0;
 
+    /**
+     * Lists the resource found at the specified location like list does, except that each contained resource is
+     * passed to the specified callback as soon as it is received instead of being collected into the returned
+     * Resource. Only a bounded part of the listing is held in memory at a time, so directories with millions of
+     * resources can be listed in bounded memory. The callback is invoked on the calling thread in the order the
+     * resources are received, and receiving the listing is paused while the callback falls behind. An exception thrown
+     * by the callback stops the listing and is rethrown.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param on_resource borrowed reference to the callback invoked with each contained resource
+     *
+     * @return the created Resource, whose list of contained resources is empty if the Resource is a directory
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     *
+     * @see list
+     */
+    virtual Resource list_stream(const std::string& identifier,
+                                 const std::function<void(Resource)>& on_resource) const = 0;
+
+    /**
+     * Lists the resource found at the specified location like list_stream does, except that each contained resource
+     * is added to the end of the specified table instead of being passed to a callback. Storing contained resources in
+     * a table rather than in Resource objects avoids allocating memory for each of them, so directories with millions
+     * of resources can be listed and scanned quickly.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param contained borrowed reference to the table the contained resources are added to
+     *
+     * @return the created Resource, whose list of contained resources is empty if the Resource is a directory
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     *
+     * @see list_stream
+     */
+    virtual Resource list_table(const std::string& identifier, Resource_table& contained) const = 0;
+
+    /**
+     * Lists the resource found at the specified location along with every directory beneath it, listing many
+     * directories at once rather than waiting for each listing before starting the next. Each listed resource is
+     * passed to the specified callback together with its path or id and its depth below the root, in the order the
+     * listings complete. Directories that are symbolic links are not followed. The callback is invoked on the calling
+     * thread, one listing at a time, and should not block for long since no new listings are started while it runs.
+     * If a listing fails or the callback throws, no new listings are started and the exception is rethrown once the
+     * listings already started complete.
+     *
+     * @param root borrowed reference to the path or id, dependending on the endpoint type, that the endpoint needs in
+     * order to locate the resource to start from
+     * @param options borrowed reference to the options controlling the walk
+     * @param on_directory borrowed reference to the callback invoked with the path or id, depth, and Resource of
+     * each listed resource
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     *
+     * @see list
+     */
+    virtual void list_recursive(
+        const std::string& root,
+        const List_recursive_options& options,
+        const std::function<void(const std::string& identifier, int depth, const Resource& directory)>& on_directory)
+        const = 0;
+
     /**
      * Removes the specified resource from the endpoint. It is expected that the authentication token used to create
      * this Endpoint object is valid, that a connection can be made to OneDataShare, that a connection can be made
@@ -184,6 +364,143 @@ public:
      */
     virtual void download(const std::string& identifier, const std::string& file_to_download) const = 0;
 
+    /**
+     * Downloads the contents of the specified file to the specified local path. The first chunk of the file is
+     * requested on its own to learn the size of the file, after which the local file is preallocated and the
+     * remaining chunks are requested at once over HTTP range requests, each written in place as it is received. If
+     * OneDataShare does not honor range requests, the whole file is written as it is received instead.
+     *
+     * While the download is in progress, the chunks received so far are recorded in a state file next to the local
+     * file, named by appending ".odsdownload" to the local path. If the download is interrupted, downloading the same
+     * file to the same local path again fetches only the missing chunks, unless the file changed in the meantime, in
+     * which case it is downloaded again from the start. The state file is removed once the download completes.
+     *
+     * If a checksum is requested, it is computed over each chunk as the chunk is received, before it is written, so
+     * the local file is not read back afterwards except for chunks received before an interruption. The checksum is
+     * compared against the expected digest in the options or, failing that, the digest OneDataShare sends in an
+     * X-Checksum-CRC32C or X-Checksum-XXH64 header.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to download
+     * @param file_to_download borrowed reference to the name or id depending on the endpoint type, that the
+     * endpoint needs in order to locate the file to download from within the specified directory
+     * @param local_path borrowed reference to the path of the local file to write, which is replaced if it exists and
+     * no interrupted download of it is recorded
+     * @param options borrowed reference to the options controlling how the file is fetched
+     *
+     * @return the size of the file and its checksum, if requested
+     *
+     * @exception Connection_error if unable to connect to OneDataShare or unable to write the local file
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare or the checksum
+     * does not match the expected digest
+     *
+     * @see Endpoint_type
+     */
+    virtual Download_result download_file(const std::string& identifier,
+                                          const std::string& file_to_download,
+                                          const std::string& local_path,
+                                          const Download_options& options = {}) const = 0;
+
+    /**
+     * Uploads the local file at the specified path into the specified directory, naming the uploaded file after the
+     * last component of the local path. The file is split into parts that are read from disk and sent concurrently,
+     * each part naming the range of the file it holds in a Content-Range header, so that no more than the maximum
+     * number of parts is held in memory at once.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory to upload the file into
+     * @param local_path borrowed reference to the path of the local file to upload
+     * @param options borrowed reference to the options controlling how the file is sent
+     *
+     * @exception Connection_error if unable to connect to OneDataShare or unable to read the local file
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     *
+     * @see Endpoint_type
+     */
+    virtual void upload(const std::string& identifier,
+                        const std::string& local_path,
+                        const Upload_options& options = {}) const = 0;
+
+    /**
+     * Starts creating the Resource object corresponding to the resource found at the specified location without
+     * waiting for OneDataShare to respond. Behaves like list otherwise, so many listings can be in flight at once
+     * without a thread per listing.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     *
+     * @return future holding the created Resource, or the Connection_error or Unexpected_response_error that list
+     * would throw
+     *
+     * @see list
+     */
+    virtual std::future<Resource> list_async(const std::string& identifier) const = 0;
+
+    /**
+     * Starts creating the Resource object corresponding to the resource found at the specified location like
+     * list_async does, except that the specified callback is invoked with the result once OneDataShare responds, so
+     * that the caller is told when the listing completes instead of having to wait on it. The callback may be invoked
+     * on a thread owned by the library, or on the calling thread before returning, and should not block.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param on_listed moved callback invoked with a ready future holding the created Resource, or the
+     * Connection_error or Unexpected_response_error that list would throw
+     *
+     * @see list_async
+     */
+    virtual void list_async(const std::string& identifier,
+                            std::function<void(std::future<Resource> listing)> on_listed) const = 0;
+
+    /**
+     * Starts removing the specified resource from the endpoint without waiting for OneDataShare to respond. Behaves
+     * like remove otherwise.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to remove
+     * @param to_delete borrowed reference to the name or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the resource to remove from within the specified directory
+     *
+     * @return future that becomes ready once the resource is removed, or holds the Connection_error or
+     * Unexpected_response_error that remove would throw
+     *
+     * @see remove
+     */
+    virtual std::future<void> remove_async(const std::string& identifier, const std::string& to_delete) const = 0;
+
+    /**
+     * Starts creating a new directory with the specified name under the specified directory without waiting for
+     * OneDataShare to respond. Behaves like mkdir otherwise.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory to create the new directory under
+     * @param folder_to_create borrowed reference to the name of the directory to create
+     *
+     * @return future that becomes ready once the directory is created, or holds the Connection_error or
+     * Unexpected_response_error that mkdir would throw
+     *
+     * @see mkdir
+     */
+    virtual std::future<void> mkdir_async(const std::string& identifier,
+                                          const std::string& folder_to_create) const = 0;
+
+    /**
+     * Starts downloading the specified file without waiting for OneDataShare to respond. Behaves like download
+     * otherwise.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to download
+     * @param file_to_download borrowed reference to the name or id depending on the endpoint type, that the
+     * endpoint needs in order to locate the file to download from within the specified directory
+     *
+     * @return future that becomes ready once the download request is accepted, or holds the Connection_error or
+     * Unexpected_response_error that download would throw
+     *
+     * @see download
+     */
+    virtual std::future<void> download_async(const std::string& identifier,
+                                             const std::string& file_to_download) const = 0;
+
 protected:
     /// @private
     Endpoint();
@@ -0,0 +1,106 @@
+/**
+ * @file listing_cache.h
+ * Defines classes used to cache the listings of resources from endpoints' file systems.
+ */
+
+#ifndef ONEDATASHARE_LISTING_CACHE_H
+#define ONEDATASHARE_LISTING_CACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Onedatashare {
+
+/**
+ * Options controlling how long a Listing_cache keeps listings and how much memory it uses.
+ */
+struct Listing_cache_options {
+    /** How long a listing is used without asking OneDataShare if it changed. */
+    std::chrono::seconds ttl {30};
+
+    /** Approximate number of bytes of listings kept before the least recently used listings are evicted. */
+    std::size_t max_bytes {64 * 1024 * 1024};
+};
+
+/**
+ * Counters describing how a Listing_cache has been used.
+ */
+struct Listing_cache_stats {
+    /** Number of listings answered from the cache without a request. */
+    std::uint64_t hits;
+
+    /** Number of listings received in full from OneDataShare. */
+    std::uint64_t misses;
+
+    /** Number of expired listings that OneDataShare confirmed were unchanged. */
+    std::uint64_t revalidations;
+
+    /** Number of listings discarded because a resource they describe was removed or created. */
+    std::uint64_t invalidations;
+
+    /** Number of listings discarded to stay within the memory bound. */
+    std::uint64_t evictions;
+
+    /** Number of listings currently cached. */
+    std::size_t entries;
+
+    /** Approximate number of bytes of listings currently cached. */
+    std::size_t bytes;
+};
+
+/**
+ * Cache of listed resources that Endpoint objects can share, keyed by endpoint type, credential id, and the path or id
+ * of the listed resource. A cached listing is used until its time to live expires, after which it is revalidated
+ * with If-None-Match or If-Modified-Since when OneDataShare provided an ETag or Last-Modified header for it, and
+ * listed again otherwise. Removing a resource or creating a directory through an Endpoint using the cache discards
+ * the affected listings. Caching is opt in, enabled by passing a cache to Endpoint::create.
+ */
+class Listing_cache {
+public:
+    /**
+     * Creates a new, empty Listing_cache with the specified options, passing ownership of the Listing_cache object to
+     * the caller.
+     *
+     * @param options borrowed reference to the options controlling the cache
+     *
+     * @return a shared pointer to a new Listing_cache object
+     */
+    static std::shared_ptr<Listing_cache> create(const Listing_cache_options& options = {});
+
+    /// @private
+    virtual ~Listing_cache() = 0;
+
+    /// @private
+    Listing_cache(const Listing_cache&) = delete;
+
+    /// @private
+    Listing_cache& operator=(const Listing_cache&) = delete;
+
+    /// @private
+    Listing_cache(Listing_cache&&) = delete;
+
+    /// @private
+    Listing_cache& operator=(Listing_cache&&) = delete;
+
+    /**
+     * Gets the counters describing how the cache has been used.
+     *
+     * @return the counters
+     */
+    virtual Listing_cache_stats stats() const = 0;
+
+    /**
+     * Discards every cached listing.
+     */
+    virtual void clear() = 0;
+
+protected:
+    /// @private
+    Listing_cache();
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_LISTING_CACHE_H
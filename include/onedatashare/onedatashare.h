@@ -10,9 +10,15 @@
 #define ONEDATASHARE_ONEDATASHARE_H
 
 #include "credential_service.h"
+#include "directory_watcher.h"
 #include "endpoint.h"
 #include "endpoint_type.h"
+#include "listing_cache.h"
 #include "ods_error.h"
+#include "resource_table.h"
+#include "sync_planner.h"
+#include "transfer_monitor.h"
+#include "transfer_optimizer.h"
 #include "transfer_service.h"
 
 /**
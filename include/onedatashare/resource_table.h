@@ -0,0 +1,291 @@
+/**
+ * @file resource_table.h
+ * Defines a compact representation of many resources from an endpoint's file system.
+ */
+
+#ifndef ONEDATASHARE_RESOURCE_TABLE_H
+#define ONEDATASHARE_RESOURCE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Onedatashare {
+
+struct Resource;
+
+/**
+ * Table of resources stored column by column. Every id, name, link, and permissions string is stored in a single
+ * string arena while sizes, times, and flags are stored in parallel arrays, so a table of a million resources takes a
+ * handful of allocations instead of millions and scanning a single column touches only that column's memory.
+ * Permissions strings, which tend to repeat, can be interned so each distinct string is stored once.
+ */
+class Resource_table {
+public:
+    /**
+     * Lightweight view of a single resource in a Resource_table. Strings returned by a view are valid until the table
+     * is modified or destroyed.
+     */
+    class View {
+    public:
+        /**
+         * Gets the id of the resource.
+         *
+         * @return the id if the resource has an id, no value otherwise
+         */
+        std::optional<std::string_view> id() const;
+
+        /**
+         * Gets the name of the resource.
+         *
+         * @return the name
+         */
+        std::string_view name() const;
+
+        /**
+         * Gets the size of the resource in bytes.
+         *
+         * @return the size
+         */
+        long size() const;
+
+        /**
+         * Gets the time the resource was created.
+         *
+         * @return the time
+         */
+        long time() const;
+
+        /**
+         * Checks if the resource is a directory.
+         *
+         * @return true if the resource is a directory, false otherwise
+         */
+        bool is_directory() const;
+
+        /**
+         * Checks if the resource is a file.
+         *
+         * @return true if the resource is a file, false otherwise
+         */
+        bool is_file() const;
+
+        /**
+         * Gets the symbolic link of the resource.
+         *
+         * @return the link if the resource is a symbolic link, no value otherwise
+         */
+        std::optional<std::string_view> link() const;
+
+        /**
+         * Gets the permissions of the resource.
+         *
+         * @return the permissions if the resource has permissions, no value otherwise
+         */
+        std::optional<std::string_view> permissions() const;
+
+        /**
+         * Copies the resource into a Resource object without contained resources.
+         *
+         * @return the created Resource
+         */
+        Resource to_resource() const;
+
+    private:
+        friend class Resource_table;
+
+        View(const Resource_table* table, std::size_t index);
+
+        /** Table the resource is stored in. */
+        const Resource_table* table_;
+
+        /** Position of the resource in the table. */
+        std::size_t index_;
+    };
+
+    /**
+     * Iterator over the resources of a Resource_table, yielding a View of each resource.
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = View;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = View;
+
+        View operator*() const;
+
+        Iterator& operator++();
+
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& other) const;
+
+        bool operator!=(const Iterator& other) const;
+
+    private:
+        friend class Resource_table;
+
+        Iterator(const Resource_table* table, std::size_t index);
+
+        /** Table being iterated over. */
+        const Resource_table* table_;
+
+        /** Position of the current resource. */
+        std::size_t index_;
+    };
+
+    /**
+     * Creates a new, empty Resource_table.
+     *
+     * @param intern_permissions if each distinct permissions string is stored once rather than once per resource
+     */
+    explicit Resource_table(bool intern_permissions = true);
+
+    /**
+     * Gets the number of resources in the table.
+     *
+     * @return the number of resources
+     */
+    std::size_t size() const;
+
+    /**
+     * Checks if the table contains no resources.
+     *
+     * @return true if the table is empty, false otherwise
+     */
+    bool empty() const;
+
+    /**
+     * Gets a view of the resource at the specified position.
+     *
+     * @param index the position of the resource, which must be less than the size of the table
+     *
+     * @return view of the resource
+     */
+    View operator[](std::size_t index) const;
+
+    Iterator begin() const;
+
+    Iterator end() const;
+
+    /**
+     * Reserves memory for the specified number of resources and characters of strings.
+     *
+     * @param resources the number of resources to reserve memory for
+     * @param arena_bytes the number of characters of ids, names, links, and permissions to reserve memory for
+     */
+    void reserve(std::size_t resources, std::size_t arena_bytes = 0);
+
+    /**
+     * Adds a resource to the end of the table.
+     *
+     * @param id the id of the resource if the resource has an id, no value otherwise
+     * @param name the name of the resource
+     * @param size the size of the resource in bytes
+     * @param time the time the resource was created
+     * @param is_directory if the resource is a directory
+     * @param is_file if the resource is a file
+     * @param link the symbolic link of the resource if the resource is a symbolic link, no value otherwise
+     * @param permissions the permissions of the resource if the resource has permissions, no value otherwise
+     */
+    void add(std::optional<std::string_view> id,
+             std::string_view name,
+             long size,
+             long time,
+             bool is_directory,
+             bool is_file,
+             std::optional<std::string_view> link,
+             std::optional<std::string_view> permissions);
+
+    /**
+     * Adds a copy of the specified resource to the end of the table, ignoring its contained resources.
+     *
+     * @param resource borrowed reference to the resource to add
+     */
+    void add(const Resource& resource);
+
+    /**
+     * Removes every resource from the table, keeping the allocated memory for reuse.
+     */
+    void clear();
+
+private:
+    /**
+     * Location of a string within the arena.
+     */
+    struct Span {
+        /** Offset of the string. */
+        std::uint64_t offset;
+
+        /** Size of the string, or absent_size if there is no string. */
+        std::uint32_t size;
+    };
+
+    /** Size marking a span with no string. */
+    static constexpr std::uint32_t absent_size {UINT32_MAX};
+
+    /** Flag set for resources that are directories. */
+    static constexpr std::uint8_t directory_flag {1};
+
+    /** Flag set for resources that are files. */
+    static constexpr std::uint8_t file_flag {2};
+
+    /**
+     * Appends the specified string to the arena.
+     *
+     * @param str the string to append, or no value to store no string
+     *
+     * @return the location of the string
+     */
+    Span store(std::optional<std::string_view> str);
+
+    /**
+     * Gets the string at the specified location in the arena.
+     *
+     * @param span the location of the string
+     *
+     * @return the string, or no value if the span has no string
+     */
+    std::optional<std::string_view> load(Span span) const;
+
+    /** If each distinct permissions string is stored once. */
+    const bool intern_permissions_;
+
+    /** Characters of every id, name, link, and permissions string. */
+    std::string arena_;
+
+    /** Locations of the ids. */
+    std::vector<Span> ids_;
+
+    /** Locations of the names. */
+    std::vector<Span> names_;
+
+    /** Locations of the links. */
+    std::vector<Span> links_;
+
+    /** Locations of the permissions. */
+    std::vector<Span> permissions_;
+
+    /** Sizes of the resources. */
+    std::vector<long> sizes_;
+
+    /** Times of the resources. */
+    std::vector<long> times_;
+
+    /** Directory and file flags of the resources. */
+    std::vector<std::uint8_t> flags_;
+
+    /** Locations of the interned permissions strings, by string. */
+    std::unordered_map<std::string, Span> interned_;
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_RESOURCE_TABLE_H
@@ -0,0 +1,124 @@
+/**
+ * @file sync_planner.h
+ * Defines structs and classes needed to plan the transfers that bring one endpoint's directory in sync with another.
+ */
+
+#ifndef ONEDATASHARE_SYNC_PLANNER_H
+#define ONEDATASHARE_SYNC_PLANNER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "endpoint.h"
+#include "transfer_service.h"
+
+namespace Onedatashare {
+
+/**
+ * Options controlling how a Sync_planner compares two directory trees and groups its results into jobs.
+ */
+struct Sync_options {
+    /** If resources on the destination that are not on the source are deleted. */
+    bool delete_extraneous {false};
+
+    /** Greatest amount, in the units of Resource::time, by which a source file may be newer than the destination's copy
+     * of the same size before the copy is transferred again. */
+    long time_tolerance {2};
+
+    /** Maximum number of resources named by each transfer or delete job. */
+    std::size_t batch_size {256};
+
+    /** Maximum number of directories listed at once across both endpoints. */
+    int max_concurrency {16};
+};
+
+/**
+ * Resources to delete from a directory on the destination of a sync.
+ */
+struct Sync_delete {
+    /** Path or id, depending on the endpoint type, used to locate the directory containing the resources. */
+    std::string directory_identifier;
+
+    /** Names or ids, depending on the endpoint type, used to locate the resources to delete from within the
+     * directory. */
+    std::vector<std::string> resource_identifiers;
+};
+
+/**
+ * Service planning the transfers and deletes that make a directory tree on a destination endpoint mirror a directory
+ * tree on a source endpoint. Each pair of matching directories is listed on both endpoints at once, and the two
+ * listings are sorted by name and merge-joined, so that only the listings of the directories in flight are held in
+ * memory rather than either whole tree. A file is transferred if the destination lacks it or holds a copy whose size
+ * differs or whose time is older than the source's by more than the tolerance. A directory the destination lacks is
+ * transferred whole without being listed. A resource whose counterpart on the destination is of the other kind,
+ * directory or file, replaces it. Symbolic links are compared like files and not followed.
+ */
+class Sync_planner {
+public:
+    /**
+     * Creates a new Sync_planner with the specified options, passing ownership of the Sync_planner object to the
+     * caller.
+     *
+     * @param options borrowed reference to the options controlling how directories are compared
+     *
+     * @return a unique pointer to a new Sync_planner object
+     */
+    static std::unique_ptr<Sync_planner> create(const Sync_options& options = {});
+
+    /// @private
+    virtual ~Sync_planner() = 0;
+
+    /// @private
+    Sync_planner(const Sync_planner&) = delete;
+
+    /// @private
+    Sync_planner& operator=(const Sync_planner&) = delete;
+
+    /// @private
+    Sync_planner(Sync_planner&&) = delete;
+
+    /// @private
+    Sync_planner& operator=(Sync_planner&&) = delete;
+
+    /**
+     * Compares the tree beneath the specified source directory against the tree beneath the specified destination
+     * directory, passing each job needed to make the destination mirror the source to a callback as soon as the
+     * directories it concerns are compared. Each job names resources from a single directory, at most the batch size
+     * of them. The deletes of a directory are passed before its transfers, so that running the jobs in the order they
+     * are received replaces resources rather than colliding with them. The callbacks are invoked on the calling
+     * thread and should not block for long since no listing is compared while they run. If a listing fails or a
+     * callback throws, no new listings are started and the exception is rethrown once the listings already started
+     * complete.
+     *
+     * @param source borrowed reference to the endpoint to mirror
+     * @param source_directory borrowed reference to the path or id, depending on the endpoint type, that the source
+     * endpoint needs in order to locate the directory to mirror
+     * @param destination borrowed reference to the endpoint to bring in sync
+     * @param destination_directory borrowed reference to the path or id, depending on the endpoint type, that the
+     * destination endpoint needs in order to locate the directory to bring in sync
+     * @param on_transfer borrowed reference to the callback invoked with the source and destination of each transfer
+     * job, ready to be passed to Transfer_service::transfer
+     * @param on_delete borrowed reference to the callback invoked with each delete job, which is only invoked when
+     * deleting extraneous resources or replacing a resource with one of the other kind
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    virtual void plan(const Endpoint& source,
+                      const std::string& source_directory,
+                      const Endpoint& destination,
+                      const std::string& destination_directory,
+                      const std::function<void(const Source& source, const Destination& destination)>& on_transfer,
+                      const std::function<void(const Sync_delete& job)>& on_delete) const = 0;
+
+protected:
+    /// @private
+    Sync_planner();
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_SYNC_PLANNER_H
@@ -0,0 +1,94 @@
+/**
+ * @file transfer_monitor.h
+ * Defines structs and classes needed to observe the progress of submitted transfer jobs.
+ */
+
+#ifndef ONEDATASHARE_TRANSFER_MONITOR_H
+#define ONEDATASHARE_TRANSFER_MONITOR_H
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+
+#include "transfer_service.h"
+
+namespace Onedatashare {
+
+/**
+ * Contains the kinds of events a Transfer_monitor reports.
+ */
+enum class Transfer_event_type {
+    /** Indicates the first status checked of a job still in progress, or a change to its state, bytes transferred,
+     * or files done since the status before it. */
+    progress,
+    /** Indicates a job that transferred every resource. */
+    completed,
+    /** Indicates a job that stopped because of an error. */
+    failed,
+    /** Indicates a job that was cancelled before it completed. */
+    cancelled
+};
+
+/**
+ * Identifies a job being tracked by a Transfer_monitor.
+ */
+using Track_id = std::uint64_t;
+
+/**
+ * Service observing the progress of any number of transfer jobs from a single thread. The statuses of every job due
+ * to be checked are fetched together with Transfer_service::status_many, so tens of thousands of jobs can be tracked
+ * with a handful of requests per poll. Each job is polled adaptively: often while it is queued or starting and again
+ * once it is nearly done, and less and less often while it makes steady progress in between. A job stops being
+ * tracked once it completes, fails, or is cancelled. Callbacks are invoked on the monitoring thread and should not
+ * block for long since no job is polled while a callback runs.
+ */
+class Transfer_monitor {
+public:
+    /// @private
+    virtual ~Transfer_monitor() = 0;
+
+    /// @private
+    Transfer_monitor(const Transfer_monitor&) = delete;
+
+    /// @private
+    Transfer_monitor& operator=(const Transfer_monitor&) = delete;
+
+    /// @private
+    Transfer_monitor(Transfer_monitor&&) = delete;
+
+    /// @private
+    Transfer_monitor& operator=(Transfer_monitor&&) = delete;
+
+    /**
+     * Starts tracking the specified transfer job. The job is first polled immediately, reporting its status as
+     * progress unless it has already ended, and every later poll reports an event only if the status changed.
+     *
+     * @param job_id borrowed reference to the id of the transfer job to track
+     * @param on_event moved callback invoked with the kind of each event and the status of the job when it occurred
+     * @param on_error moved callback invoked with the job id and the exception when checking the status of the job or
+     * invoking on_event fails, or nullptr to ignore failures. The job keeps being tracked after a failure.
+     *
+     * @return the id identifying the tracking of the job
+     */
+    virtual Track_id track(const std::string& job_id,
+                           std::function<void(Transfer_event_type type, const Transfer_status& status)> on_event,
+                           std::function<void(const std::string& job_id, std::exception_ptr error)> on_error =
+                               nullptr) = 0;
+
+    /**
+     * Stops tracking the job identified by the specified id. Callbacks already being invoked on the monitoring thread
+     * may still complete after this returns. Does nothing if the id does not identify a tracked job.
+     *
+     * @param id the id returned when the job started being tracked
+     */
+    virtual void untrack(Track_id id) = 0;
+
+protected:
+    /// @private
+    Transfer_monitor();
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_TRANSFER_MONITOR_H
@@ -0,0 +1,106 @@
+/**
+ * @file transfer_optimizer.h
+ * Defines structs and classes needed to choose transfer options from the dataset and from past transfers.
+ */
+
+#ifndef ONEDATASHARE_TRANSFER_OPTIMIZER_H
+#define ONEDATASHARE_TRANSFER_OPTIMIZER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "transfer_service.h"
+
+namespace Onedatashare {
+
+/**
+ * Summary of the resources named by a transfer, used to choose its options.
+ */
+struct Dataset_profile {
+    /** Number of resources transferred. */
+    std::uint64_t file_count {0};
+
+    /** Total size in bytes of the resources transferred. */
+    std::uint64_t total_bytes {0};
+};
+
+/**
+ * Service choosing the concurrency, parallelism, and pipelining of transfer jobs. Each pair of endpoints is tuned
+ * separately for small, medium, and large files, since the options that suit many small files differ from those that
+ * suit a few large ones. The first job of a kind is given options from a heuristic model of the dataset: many
+ * concurrent files and deep pipelining for small files, and parallel streams for large ones. Each job reports its
+ * throughput once it ends, failed and cancelled jobs reporting 0, and later jobs of the same kind are given options
+ * found by hill climbing: one option at a time is doubled or halved, and the change is kept while the throughput
+ * improves. What has been learned is saved to a local history file after each report and loaded again when a
+ * Transfer_optimizer is created with the same file, so tuning carries over between runs.
+ */
+class Transfer_optimizer {
+public:
+    /**
+     * Creates a new Transfer_optimizer keeping its history in the file at the specified path, passing ownership of
+     * the Transfer_optimizer object to the caller. A missing or malformed history file starts tuning afresh.
+     *
+     * @param history_path borrowed reference to the path of the history file, or an empty string to keep the history
+     * in memory only
+     *
+     * @return a unique pointer to a new Transfer_optimizer object
+     */
+    static std::unique_ptr<Transfer_optimizer> create(const std::string& history_path);
+
+    /// @private
+    virtual ~Transfer_optimizer() = 0;
+
+    /// @private
+    Transfer_optimizer(const Transfer_optimizer&) = delete;
+
+    /// @private
+    Transfer_optimizer& operator=(const Transfer_optimizer&) = delete;
+
+    /// @private
+    Transfer_optimizer(Transfer_optimizer&&) = delete;
+
+    /// @private
+    Transfer_optimizer& operator=(Transfer_optimizer&&) = delete;
+
+    /**
+     * Chooses the options of a transfer of the specified dataset from the specified source to the specified
+     * destination. Only the concurrency, parallelism, and pipelining are set. This method is thread safe.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param profile borrowed reference to the summary of the resources transferred
+     *
+     * @return the options to use for the transfer
+     */
+    virtual Transfer_options recommend(const Source& source,
+                                       const Destination& destination,
+                                       const Dataset_profile& profile) = 0;
+
+    /**
+     * Reports the throughput of a transfer that ended so that later recommendations can improve on it, then saves the
+     * history file. Transfers that failed or were cancelled are reported with a throughput of 0, which moves the
+     * search past the options they used. A history file that cannot be written is left as it was, keeping what has
+     * been learned in memory. Reports of transfers that left the concurrency, parallelism, or pipelining unset are
+     * ignored. This method is thread safe.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param profile borrowed reference to the summary of the resources transferred
+     * @param options borrowed reference to the options the transfer used
+     * @param throughput the throughput of the transfer in bytes per second, or 0 if it failed or was cancelled
+     */
+    virtual void record(const Source& source,
+                        const Destination& destination,
+                        const Dataset_profile& profile,
+                        const Transfer_options& options,
+                        double throughput) = 0;
+
+protected:
+    /// @private
+    Transfer_optimizer();
+};
+
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_TRANSFER_OPTIMIZER_H
@@ -9,7 +9,11 @@
 #ifndef ONEDATASHARE_TRANSFER_SERVICE_H
 #define ONEDATASHARE_TRANSFER_SERVICE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -17,6 +21,10 @@
 
 namespace Onedatashare {
 
+class Endpoint;
+class Transfer_monitor;
+class Transfer_optimizer;
+
 /**
  * Indicates the destination endpoint of a transfer. Different endpoint types may differ slightly in behavior and
  * functionality as described in {@link Endpoint_type}.
@@ -52,21 +60,135 @@ struct Source {
 };
 
 /**
- * Options to use in a transfer request.
+ * Options to use in a transfer request. Each option left unset is chosen by OneDataShare, and a request whose options
+ * are all unset is sent without any. Many small files over a long, fast network usually transfer fastest with more
+ * concurrent files and deeper pipelining, while few large files benefit more from parallel streams.
  */
 struct Transfer_options {
-    // TODO: define
+    /** Number of files transferred at once, which must be positive. */
+    std::optional<int> concurrency {};
+
+    /** Number of parallel streams used to transfer each file, which must be positive. */
+    std::optional<int> parallelism {};
+
+    /** Number of commands sent ahead on each connection without waiting for the replies to those before them, which
+     * must be positive. */
+    std::optional<int> pipelining {};
+
+    /** Number of bytes read and written at a time, which must be positive. */
+    std::optional<std::uint64_t> chunk_size {};
+
+    /** If data is compressed while in transit. */
+    std::optional<bool> compress {};
+
+    /** If each file is checked against the source's checksum after it is transferred. */
+    std::optional<bool> verify {};
+};
+
+/**
+ * Handle to a transfer split into sub-jobs by Transfer_service::transfer_sharded.
+ */
+struct Sharded_job {
+    /** Ids of the sub-jobs that were started. */
+    std::vector<std::string> job_ids;
+
+    /** Sources of the sub-jobs that could not be started, each of which may be passed to Transfer_service::transfer
+     * to try again. */
+    std::vector<Source> unsubmitted;
 };
 
 /**
- * Status of a submitted transfer job.
+ * State of a submitted transfer job.
+ */
+enum class Transfer_state {
+    /** The job is waiting to be started. */
+    queued,
+
+    /** The job is transferring resources. */
+    running,
+
+    /** The job transferred every resource. */
+    completed,
+
+    /** The job stopped because of an error. */
+    failed,
+
+    /** The job was cancelled before it completed. */
+    cancelled
+};
+
+/**
+ * Status of a submitted transfer job, as reported by OneDataShare when the status was checked.
  */
 class Transfer_status {
-    // TODO: define
 public:
     /// @private
     virtual ~Transfer_status() = 0;
 
+    /**
+     * Gets the id of the transfer job.
+     *
+     * @return borrowed reference to the id of the job
+     */
+    virtual const std::string& id() const = 0;
+
+    /**
+     * Gets the state of the transfer job.
+     *
+     * @return the state of the job
+     */
+    virtual Transfer_state state() const = 0;
+
+    /**
+     * Gets the number of bytes the transfer job has transferred.
+     *
+     * @return the number of bytes transferred
+     */
+    virtual std::uint64_t bytes_transferred() const = 0;
+
+    /**
+     * Gets the number of files the transfer job has finished transferring.
+     *
+     * @return the number of files done
+     */
+    virtual std::uint64_t files_done() const = 0;
+
+    /**
+     * Gets the number of files the transfer job transfers in total.
+     *
+     * @return the total number of files
+     */
+    virtual std::uint64_t files_total() const = 0;
+
+    /**
+     * Gets the rate at which the transfer job has transferred bytes. If OneDataShare does not report it, it is
+     * computed from the bytes transferred and the time between the start of the job and its end or last update.
+     *
+     * @return the throughput in bytes per second, or 0 if it is unknown
+     */
+    virtual double throughput() const = 0;
+
+    /**
+     * Gets the time the transfer job started.
+     *
+     * @return the start time in milliseconds since the Unix epoch, or no value if the job has not started
+     */
+    virtual std::optional<long> start_time() const = 0;
+
+    /**
+     * Gets the time the transfer job ended.
+     *
+     * @return the end time in milliseconds since the Unix epoch, or no value if the job has not ended
+     */
+    virtual std::optional<long> end_time() const = 0;
+
+    /**
+     * Gets the time OneDataShare last updated the status of the transfer job.
+     *
+     * @return the update time in milliseconds since the Unix epoch, or no value if it is not reported
+     */
+    virtual std::optional<long> last_updated() const = 0;
+
 protected:
     /// @private
     Transfer_status();
@@ -129,6 +251,7 @@ public:
      *
      * @return the id of the new transfer job
      *
+     * @exception invalid_argument if an option is set to a value that is not positive
      * @exception Connection_error if unable to connect to OneDataShare
      * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
      */
@@ -136,6 +259,109 @@ public:
                                  const Destination& destination,
                                  const Transfer_options& options) const = 0;
 
+    /**
+     * Starts a new transfer job without waiting for OneDataShare to respond. Behaves like transfer otherwise. The
+     * source, destination, and options are serialized before returning, so they need not outlive the call.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param options borrowed reference to the the options to use for this transfer request
+     *
+     * @return future holding the id of the new transfer job, or the Connection_error or Unexpected_response_error
+     * that transfer would throw
+     *
+     * @exception invalid_argument if an option is set to a value that is not positive, thrown before the request is
+     * sent
+     *
+     * @see transfer
+     */
+    virtual std::future<std::string> transfer_async(const Source& source,
+                                                    const Destination& destination,
+                                                    const Transfer_options& options) const = 0;
+
+    /**
+     * Starts a new transfer job with options chosen by the specified Transfer_optimizer. The source directory is
+     * listed to profile the resources being transferred, the optimizer recommends options for them, and the job is
+     * tracked with this Transfer_service's monitor so that its throughput is reported to the optimizer once it
+     * ends, improving the options of later jobs between the same endpoints. A job that fails, is cancelled, or whose
+     * status fails to be checked several times in a row is reported with a throughput of 0. The same preconditions as
+     * transfer apply, and the source endpoint must be able to list the source directory.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param source_endpoint borrowed reference to the endpoint the source directory is listed with, which must be
+     * the endpoint named by the source
+     * @param optimizer shared pointer to the optimizer choosing the options, kept alive until the job ends
+     *
+     * @return the id of the new transfer job
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     *
+     * @see transfer
+     * @see monitor
+     */
+    virtual std::string transfer_optimized(const Source& source,
+                                           const Destination& destination,
+                                           const Endpoint& source_endpoint,
+                                           std::shared_ptr<Transfer_optimizer> optimizer) const = 0;
+
+    /**
+     * Starts a transfer split into sub-jobs of balanced size, so that a very long list of resources is sent in several
+     * small requests rather than one large one and a failed sub-job does not lose the rest. The source directory is
+     * listed to find the size of each resource, and the resources are divided among at most the specified number of
+     * sub-jobs so that each transfers about the same number of bytes. Directories count as empty since listings do not
+     * report their sizes. Every sub-job uses the same options and is started at once. The same preconditions as
+     * transfer apply, and the source endpoint must be able to list the source directory.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param options borrowed reference to the options to use for every sub-job
+     * @param source_endpoint borrowed reference to the endpoint the source directory is listed with, which must be
+     * the endpoint named by the source
+     * @param shard_count the greatest number of sub-jobs to start
+     *
+     * @return handle to the started sub-jobs, along with the sources of any that could not be started
+     *
+     * @exception invalid_argument if an option is set to a value that is not positive
+     * @exception Connection_error if unable to connect to OneDataShare, or if no sub-job could be started because of
+     * one
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare, or if no sub-job
+     * could be started because of one
+     *
+     * @see transfer
+     * @see status_sharded
+     */
+    virtual Sharded_job transfer_sharded(const Source& source,
+                                         const Destination& destination,
+                                         const Transfer_options& options,
+                                         const Endpoint& source_endpoint,
+                                         std::size_t shard_count) const = 0;
+
+    /**
+     * Checks the status of every sub-job of the specified sharded transfer with status_many and combines them into
+     * one Transfer_status, whose ownership is passed to the caller. The combined id joins the sub-job ids with commas.
+     * Bytes and files are summed, and the resources named by each unsubmitted shard count towards the total files.
+     * The start time is the earliest, and the end time and last update are the latest. Since the sub-jobs run side by
+     * side, the throughput is the bytes of every sub-job over the time from the start time to the end time, or to the
+     * last update while the job runs, and is the sum of the throughputs of the sub-jobs only when those times are
+     * unknown. The combined job is queued until a sub-job starts and running while any sub-job has not ended. Once
+     * every sub-job has ended, it failed if any sub-job failed or any shard was unsubmitted, was cancelled if any
+     * sub-job was cancelled, and completed otherwise, and the statuses of the sub-jobs tell which to retry.
+     *
+     * @param job borrowed reference to the handle of the sharded transfer
+     *
+     * @return unique pointer to the combined status of the sub-jobs
+     *
+     * @exception invalid_argument if the job has no started sub-jobs, thrown before any request is made
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare, including one
+     * missing the status of a sub-job
+     *
+     * @see status_many
+     */
+    virtual std::unique_ptr<Transfer_status> status_sharded(const Sharded_job& job) const = 0;
+
     /**
      * Checks the status of the specified transfer job by creating a new Transfer_status object whose ownership is
      * passed to the caller. It is expected that the authentication token used to create this Transfer_service
@@ -151,6 +377,34 @@ public:
      */
     virtual std::unique_ptr<Transfer_status> status(const std::string& id) const = 0;
 
+    /**
+     * Checks the status of each of the specified transfer jobs, passing ownership of the new Transfer_status objects
+     * to the caller. The ids are sent in batches, each batch checking many jobs in a single request, and every batch
+     * is sent at once rather than waiting for the batch before it, so checking thousands of jobs takes a handful of
+     * round trips. Ids that appear more than once are checked once. The same preconditions as status apply to every
+     * id.
+     *
+     * @param ids borrowed reference to the ids of the transfer jobs to check
+     *
+     * @return unique pointers to the statuses of the transfer jobs, in the same order as the ids
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare, including one
+     * missing the status of a requested job
+     *
+     * @see status
+     */
+    virtual std::vector<std::unique_ptr<Transfer_status>> status_many(const std::vector<std::string>& ids) const = 0;
+
+    /**
+     * Gets the Transfer_monitor owned by this Transfer_service, which tracks jobs by checking their statuses with
+     * this Transfer_service. The monitor and its thread are created on first use and stopped when this
+     * Transfer_service is destroyed.
+     *
+     * @return borrowed reference to the monitor, valid until this Transfer_service is destroyed
+     */
+    virtual Transfer_monitor& monitor() const = 0;
+
 protected:
     /// @private
     Transfer_service();
@@ -0,0 +1,199 @@
+/**
+ * @file body_sink.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "body_sink.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** Largest expected body size that capacity is reserved for up front. */
+constexpr std::size_t max_expected_size {64 * 1024 * 1024};
+
+/** Error message aborting a request whose body is no longer drained. */
+constexpr auto abandoned_msg {"Response body is no longer drained since the draining sink failed"};
+
+} // namespace
+
+Body_sink::Body_sink() = default;
+
+Body_sink::~Body_sink() = default;
+
+void Body_sink::start(int) {}
+
+void Body_sink::expect(std::size_t) {}
+
+bool Body_sink::ready()
+{
+    return true;
+}
+
+void Body_sink::set_resume(std::function<void()>) {}
+
+String_sink::String_sink(std::string& body, std::size_t padding) : body_ {body}, padding_ {padding} {}
+
+void String_sink::expect(std::size_t size)
+{
+    if (size <= max_expected_size) {
+        body_.reserve(body_.size() + size + padding_);
+    }
+}
+
+void String_sink::write(const char* data, std::size_t size)
+{
+    const auto needed {body_.size() + size + padding_};
+    if (needed > body_.capacity()) {
+        body_.reserve(std::max(needed, 2 * body_.capacity()));
+    }
+    body_.append(data, size);
+}
+
+Fd_sink::Fd_sink(int fd) : fd_ {fd} {}
+
+void Fd_sink::write(const char* data, std::size_t size)
+{
+    while (size > 0) {
+        const auto written {::write(fd_, data, size)};
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw Connection_error {std::strerror(errno)};
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+Handoff_sink::Handoff_sink(std::size_t capacity)
+    : capacity_ {capacity},
+      mutex_ {},
+      cv_ {},
+      queued_ {},
+      status_ {},
+      expected_ {},
+      resume_ {},
+      paused_ {false},
+      abandoned_ {false},
+      closed_ {false}
+{}
+
+void Handoff_sink::start(int status)
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    status_ = status;
+    cv_.notify_one();
+}
+
+void Handoff_sink::expect(std::size_t size)
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    expected_ = size;
+    cv_.notify_one();
+}
+
+void Handoff_sink::write(const char* data, std::size_t size)
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    if (abandoned_) {
+        throw Connection_error {abandoned_msg};
+    }
+    queued_.append(data, size);
+    cv_.notify_one();
+}
+
+bool Handoff_sink::ready()
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    if (abandoned_ || !resume_ || queued_.size() < capacity_) {
+        return true;
+    }
+    paused_ = true;
+
+    return false;
+}
+
+void Handoff_sink::set_resume(std::function<void()> resume)
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    resume_ = std::move(resume);
+}
+
+void Handoff_sink::close()
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    closed_ = true;
+    // notified while locked since the draining thread may destroy this object as soon as it sees the sink closed
+    cv_.notify_one();
+}
+
+void Handoff_sink::drain_into(Body_sink& sink)
+{
+    std::string chunk {};
+    std::exception_ptr error {};
+
+    std::unique_lock<std::mutex> lock {mutex_};
+    while (true) {
+        cv_.wait(lock, [this] { return closed_ || status_ || expected_ || !queued_.empty(); });
+        const auto status {std::exchange(status_, std::nullopt)};
+        const auto expected {std::exchange(expected_, std::nullopt)};
+        chunk.swap(queued_);
+        const auto done {closed_};
+        if (paused_ && resume_) {
+            // the queue was just emptied, so the paused request can take more chunks
+            paused_ = false;
+            resume_();
+        }
+        lock.unlock();
+
+        if (!error) {
+            try {
+                if (status) {
+                    sink.start(*status);
+                }
+                if (expected) {
+                    sink.expect(*expected);
+                }
+                if (!chunk.empty()) {
+                    sink.write(chunk.data(), chunk.size());
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        chunk.clear();
+
+        lock.lock();
+        if (error && !abandoned_) {
+            // fail the next write so that the request is aborted instead of receiving a body nobody reads
+            abandoned_ = true;
+            queued_.clear();
+            if (paused_ && resume_) {
+                paused_ = false;
+                resume_();
+            }
+        }
+        if (done) {
+            break;
+        }
+    }
+    lock.unlock();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
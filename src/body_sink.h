@@ -0,0 +1,255 @@
+/**
+ * @file body_sink.h
+ * Defines destinations that a response body is written to while it is received.
+ */
+
+#ifndef ONEDATASHARE_BODY_SINK_H
+#define ONEDATASHARE_BODY_SINK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Destination that a response body is written to chunk by chunk as it is received, so that the body does not have to
+ * be held in memory all at once.
+ */
+class Body_sink {
+public:
+    virtual ~Body_sink() = 0;
+
+    Body_sink(const Body_sink&) = delete;
+
+    Body_sink& operator=(const Body_sink&) = delete;
+
+    Body_sink(Body_sink&&) = delete;
+
+    Body_sink& operator=(Body_sink&&) = delete;
+
+    /**
+     * Tells the sink the http response status code before the first chunk of the body is written. The default
+     * implementation does nothing.
+     *
+     * @param status the http response status code
+     */
+    virtual void start(int status);
+
+    /**
+     * Tells the sink how many bytes the body is expected to contain, once known. May be called more than once, for
+     * example when a request is redirected. The default implementation does nothing.
+     *
+     * @param size the expected size of the body in bytes
+     */
+    virtual void expect(std::size_t size);
+
+    /**
+     * Writes the next chunk of the body to the sink.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     *
+     * @exception Connection_error if the chunk could not be written, which aborts the request
+     */
+    virtual void write(const char* data, std::size_t size) = 0;
+
+    /**
+     * Checks if the sink can take the next chunk of the body now. A sink that is not ready pauses the request until it
+     * calls the function passed to set_resume, and is then asked again. The default implementation is always ready.
+     *
+     * @return true if the next chunk may be written, false to pause the request
+     */
+    virtual bool ready();
+
+    /**
+     * Sets the function the sink calls to resume a request it paused, or clears it when passed an empty function once
+     * the request completes. Only set by REST callers able to pause a request, so a sink without a resume function
+     * must always be ready. The default implementation ignores the function.
+     *
+     * @param resume moved function resuming the paused request, which may be called from any thread
+     */
+    virtual void set_resume(std::function<void()> resume);
+
+protected:
+    Body_sink();
+};
+
+/**
+ * Body_sink appending the body to a string.
+ */
+class String_sink : public Body_sink {
+public:
+    /**
+     * Creates a new String_sink appending to the specified string.
+     *
+     * @param body borrowed reference to the string appended to, which must outlive this object
+     * @param padding number of bytes of spare capacity kept after the appended body
+     */
+    explicit String_sink(std::string& body, std::size_t padding = 0);
+
+    /**
+     * Reserves capacity for the expected body so that it is received without reallocating. Expected sizes beyond a
+     * sanity limit are ignored since they come from the server.
+     *
+     * @param size the expected size of the body in bytes
+     */
+    void expect(std::size_t size) override;
+
+    /**
+     * Appends the chunk to the string, at least doubling its capacity whenever it runs out.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     */
+    void write(const char* data, std::size_t size) override;
+
+private:
+    /** The string appended to. */
+    std::string& body_;
+
+    /** Number of bytes of spare capacity kept after the appended body. */
+    const std::size_t padding_;
+};
+
+/**
+ * Body_sink writing the body to a file descriptor.
+ */
+class Fd_sink : public Body_sink {
+public:
+    /**
+     * Creates a new Fd_sink writing to the specified file descriptor.
+     *
+     * @param fd the open file descriptor written to, which is not closed by this object
+     */
+    explicit Fd_sink(int fd);
+
+    /**
+     * Writes the entire chunk to the file descriptor.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     *
+     * @exception Connection_error if writing to the file descriptor fails
+     */
+    void write(const char* data, std::size_t size) override;
+
+private:
+    /** The file descriptor written to. */
+    const int fd_;
+};
+
+/**
+ * Body_sink handing the body from the thread receiving it to another thread that drains it into a different sink, so
+ * that the body is processed on the draining thread. Chunks are queued up to a capacity, beyond which the request is
+ * paused until the draining thread catches up. Safe to use from two threads.
+ */
+class Handoff_sink : public Body_sink {
+public:
+    /** Default number of bytes queued before the request is paused. */
+    static constexpr std::size_t default_capacity {1024 * 1024};
+
+    /**
+     * Creates a new Handoff_sink queueing up to the specified number of bytes.
+     *
+     * @param capacity number of bytes queued before the request is paused
+     */
+    explicit Handoff_sink(std::size_t capacity = default_capacity);
+
+    /**
+     * Queues the status code to be passed to the draining sink.
+     *
+     * @param status the http response status code
+     */
+    void start(int status) override;
+
+    /**
+     * Queues the expected size to be passed to the draining sink.
+     *
+     * @param size the expected size of the body in bytes
+     */
+    void expect(std::size_t size) override;
+
+    /**
+     * Queues the chunk to be written to the draining sink.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     *
+     * @exception Connection_error if the draining sink failed, which aborts the request
+     */
+    void write(const char* data, std::size_t size) override;
+
+    /**
+     * Checks if fewer bytes than the capacity are queued. Always ready if no resume function is set, since the request
+     * could then not be resumed.
+     *
+     * @return true if the next chunk may be queued, false to pause the request
+     */
+    bool ready() override;
+
+    /**
+     * Sets the function called once the draining thread has emptied the queue of a paused request.
+     *
+     * @param resume moved function resuming the paused request
+     */
+    void set_resume(std::function<void()> resume) override;
+
+    /**
+     * Marks the body as complete, letting drain_into return once the queue is empty. Must be called exactly once, after
+     * the request has completed.
+     */
+    void close();
+
+    /**
+     * Writes the queued body to the specified sink on the calling thread until the sink is closed. If the specified
+     * sink throws, the rest of the body is discarded by aborting the request, and the exception is rethrown once the
+     * request has completed.
+     *
+     * @param sink borrowed reference to the sink the body is written to
+     *
+     * @exception any exception thrown by the specified sink
+     */
+    void drain_into(Body_sink& sink);
+
+private:
+    /** Number of bytes queued before the request is paused. */
+    const std::size_t capacity_;
+
+    /** Guards the members below. */
+    std::mutex mutex_;
+
+    /** Notified whenever something is queued or the sink is closed. */
+    std::condition_variable cv_;
+
+    /** Chunks queued and not yet drained. */
+    std::string queued_;
+
+    /** Status code not yet passed to the draining sink. */
+    std::optional<int> status_;
+
+    /** Expected size not yet passed to the draining sink. */
+    std::optional<std::size_t> expected_;
+
+    /** Function resuming the paused request, if set. */
+    std::function<void()> resume_;
+
+    /** If the request was paused because the queue was full. */
+    bool paused_;
+
+    /** If the draining sink failed, so the rest of the body is to be discarded. */
+    bool abandoned_;
+
+    /** If the request has completed. */
+    bool closed_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_BODY_SINK_H
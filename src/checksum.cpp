@@ -0,0 +1,340 @@
+/**
+ * @file checksum.cpp
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "checksum.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ONEDATASHARE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** The CRC32C polynomial, bit reversed. */
+constexpr std::uint32_t crc32c_polynomial {0x82f63b78};
+
+/** Primes used by xxHash64. */
+constexpr std::uint64_t prime_1 {11400714785074694791ULL};
+constexpr std::uint64_t prime_2 {14029467366897019727ULL};
+constexpr std::uint64_t prime_3 {1609587929392839161ULL};
+constexpr std::uint64_t prime_4 {9650029242287828579ULL};
+constexpr std::uint64_t prime_5 {2870177450012600261ULL};
+
+/**
+ * Creates the tables used to compute CRC32C 8 bytes at a time, where table n holds the checksum of each byte followed
+ * by n zero bytes.
+ *
+ * @return the created tables
+ */
+std::array<std::array<std::uint32_t, 256>, 8> make_crc32c_tables()
+{
+    std::array<std::array<std::uint32_t, 256>, 8> tables {};
+    for (std::uint32_t byte {0}; byte < 256; ++byte) {
+        auto crc {byte};
+        for (auto bit {0}; bit < 8; ++bit) {
+            crc = (crc & 1) != 0 ? (crc >> 1) ^ crc32c_polynomial : crc >> 1;
+        }
+        tables[0][byte] = crc;
+    }
+    for (std::size_t table {1}; table < tables.size(); ++table) {
+        for (std::size_t byte {0}; byte < 256; ++byte) {
+            const auto previous {tables[table - 1][byte]};
+            tables[table][byte] = (previous >> 8) ^ tables[0][previous & 0xff];
+        }
+    }
+    return tables;
+}
+
+/**
+ * Extends the inverted CRC32C register with the specified data, 8 bytes at a time.
+ *
+ * @param crc the inverted register
+ * @param data borrowed pointer to the data
+ * @param size the number of bytes of data
+ *
+ * @return the extended inverted register
+ */
+std::uint32_t crc32c_software(std::uint32_t crc, const unsigned char* data, std::size_t size)
+{
+    static const auto tables {make_crc32c_tables()};
+
+    for (; size >= 8; data += 8, size -= 8) {
+        std::uint32_t low {};
+        std::uint32_t high {};
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = tables[7][low & 0xff] ^ tables[6][(low >> 8) & 0xff] ^ tables[5][(low >> 16) & 0xff] ^
+              tables[4][low >> 24] ^ tables[3][high & 0xff] ^ tables[2][(high >> 8) & 0xff] ^
+              tables[1][(high >> 16) & 0xff] ^ tables[0][high >> 24];
+    }
+    for (; size > 0; ++data, --size) {
+        crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xff];
+    }
+    return crc;
+}
+
+#ifdef ONEDATASHARE_X86_SIMD
+
+/**
+ * Extends the inverted CRC32C register with the specified data using the SSE4.2 crc32 instruction.
+ *
+ * @param crc the inverted register
+ * @param data borrowed pointer to the data
+ * @param size the number of bytes of data
+ *
+ * @return the extended inverted register
+ */
+__attribute__((target("sse4.2"))) std::uint32_t crc32c_sse42(std::uint32_t crc,
+                                                             const unsigned char* data,
+                                                             std::size_t size)
+{
+    std::uint64_t wide {crc};
+    for (; size >= 8; data += 8, size -= 8) {
+        std::uint64_t word {};
+        std::memcpy(&word, data, 8);
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = static_cast<std::uint32_t>(wide);
+    for (; size > 0; ++data, --size) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+
+#endif
+
+/**
+ * Selects the fastest implementation of CRC32C supported by the processor.
+ *
+ * @return the selected implementation
+ */
+std::uint32_t (*select_crc32c())(std::uint32_t, const unsigned char*, std::size_t)
+{
+#ifdef ONEDATASHARE_X86_SIMD
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42;
+    }
+#endif
+    return crc32c_software;
+}
+
+/**
+ * Multiplies two polynomials modulo the CRC32C polynomial, both represented bit reversed.
+ *
+ * @param a the first polynomial
+ * @param b the second polynomial
+ *
+ * @return the product
+ */
+std::uint32_t multiply_modulo(std::uint32_t a, std::uint32_t b)
+{
+    std::uint32_t product {0};
+    for (std::uint32_t bit {1U << 31}; bit != 0; bit >>= 1) {
+        if ((a & bit) != 0) {
+            product ^= b;
+        }
+        b = (b & 1) != 0 ? (b >> 1) ^ crc32c_polynomial : b >> 1;
+    }
+    return product;
+}
+
+/**
+ * Computes x raised to the power of 8 times the specified number of bytes, modulo the CRC32C polynomial, by
+ * repeated squaring.
+ *
+ * @param bytes the number of bytes
+ *
+ * @return the power, represented bit reversed
+ */
+std::uint32_t shift_bytes(std::uint64_t bytes)
+{
+    // x^1 represented bit reversed
+    std::uint32_t power_of_two {1U << 30};
+    // x^0 represented bit reversed
+    std::uint32_t result {1U << 31};
+    // start at x^8, since each byte shifts by 8 bits
+    for (auto i {0}; i < 3; ++i) {
+        power_of_two = multiply_modulo(power_of_two, power_of_two);
+    }
+    for (; bytes != 0; bytes >>= 1) {
+        if ((bytes & 1) != 0) {
+            result = multiply_modulo(power_of_two, result);
+        }
+        power_of_two = multiply_modulo(power_of_two, power_of_two);
+    }
+    return result;
+}
+
+/**
+ * Rotates the bits of the specified value left.
+ *
+ * @param value the value to rotate
+ * @param bits the number of bits to rotate by, between 1 and 63
+ *
+ * @return the rotated value
+ */
+std::uint64_t rotate_left(std::uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * Reads 8 bytes in native byte order, which may be unaligned.
+ *
+ * @param data borrowed pointer to the bytes to read
+ *
+ * @return the bytes as an integer
+ */
+std::uint64_t read_64(const char* data)
+{
+    std::uint64_t value {};
+    std::memcpy(&value, data, 8);
+    return value;
+}
+
+/**
+ * Reads 4 bytes in native byte order, which may be unaligned.
+ *
+ * @param data borrowed pointer to the bytes to read
+ *
+ * @return the bytes as an integer
+ */
+std::uint32_t read_32(const char* data)
+{
+    std::uint32_t value {};
+    std::memcpy(&value, data, 4);
+    return value;
+}
+
+/**
+ * Mixes 8 bytes of input into an xxHash64 accumulator.
+ */
+std::uint64_t xxh64_round(std::uint64_t accumulator, std::uint64_t input)
+{
+    accumulator += input * prime_2;
+    return rotate_left(accumulator, 31) * prime_1;
+}
+
+/**
+ * Merges an xxHash64 accumulator into the hash.
+ */
+std::uint64_t xxh64_merge(std::uint64_t hash, std::uint64_t accumulator)
+{
+    hash ^= xxh64_round(0, accumulator);
+    return hash * prime_1 + prime_4;
+}
+
+} // namespace
+
+std::uint32_t crc32c_update(std::uint32_t crc, const char* data, std::size_t size)
+{
+    static const auto update {select_crc32c()};
+    return ~update(~crc, reinterpret_cast<const unsigned char*>(data), size);
+}
+
+std::uint32_t crc32c_combine(std::uint32_t first, std::uint32_t second, std::uint64_t second_size)
+{
+    // appending n zero bytes to data multiplies its checksum by x^(8n), after which the second checksum is added
+    return multiply_modulo(shift_bytes(second_size), first) ^ second;
+}
+
+Xxh64::Xxh64(std::uint64_t seed)
+    : seed_ {seed},
+      accumulators_ {seed + prime_1 + prime_2, seed + prime_2, seed, seed - prime_1},
+      buffer_ {},
+      buffered_ {0},
+      total_ {0}
+{
+}
+
+void Xxh64::update(const char* data, std::size_t size)
+{
+    total_ += size;
+
+    // complete a partially filled stripe first
+    if (buffered_ > 0) {
+        const auto fill {std::min(size, sizeof(buffer_) - buffered_)};
+        std::memcpy(buffer_ + buffered_, data, fill);
+        buffered_ += fill;
+        data += fill;
+        size -= fill;
+        if (buffered_ < sizeof(buffer_)) {
+            return;
+        }
+        for (auto lane {0}; lane < 4; ++lane) {
+            accumulators_[lane] = xxh64_round(accumulators_[lane], read_64(buffer_ + lane * 8));
+        }
+        buffered_ = 0;
+    }
+
+    for (; size >= 32; data += 32, size -= 32) {
+        accumulators_[0] = xxh64_round(accumulators_[0], read_64(data));
+        accumulators_[1] = xxh64_round(accumulators_[1], read_64(data + 8));
+        accumulators_[2] = xxh64_round(accumulators_[2], read_64(data + 16));
+        accumulators_[3] = xxh64_round(accumulators_[3], read_64(data + 24));
+    }
+
+    std::memcpy(buffer_, data, size);
+    buffered_ = size;
+}
+
+std::uint64_t Xxh64::digest() const
+{
+    std::uint64_t hash {};
+    if (total_ >= 32) {
+        hash = rotate_left(accumulators_[0], 1) + rotate_left(accumulators_[1], 7) +
+               rotate_left(accumulators_[2], 12) + rotate_left(accumulators_[3], 18);
+        for (const auto accumulator : accumulators_) {
+            hash = xxh64_merge(hash, accumulator);
+        }
+    } else {
+        hash = seed_ + prime_5;
+    }
+    hash += total_;
+
+    const auto* data {buffer_};
+    auto size {buffered_};
+    for (; size >= 8; data += 8, size -= 8) {
+        hash ^= xxh64_round(0, read_64(data));
+        hash = rotate_left(hash, 27) * prime_1 + prime_4;
+    }
+    if (size >= 4) {
+        hash ^= read_32(data) * prime_1;
+        hash = rotate_left(hash, 23) * prime_2 + prime_3;
+        data += 4;
+        size -= 4;
+    }
+    for (; size > 0; ++data, --size) {
+        hash ^= static_cast<unsigned char>(*data) * prime_5;
+        hash = rotate_left(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::string to_hex(std::uint64_t value, int digits)
+{
+    constexpr auto hex_digits {"0123456789abcdef"};
+    std::string hex(digits, '0');
+    for (auto i {digits - 1}; i >= 0 && value != 0; --i, value >>= 4) {
+        hex[i] = hex_digits[value & 0xf];
+    }
+    return hex;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
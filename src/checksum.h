@@ -0,0 +1,98 @@
+/**
+ * @file checksum.h
+ * Defines the checksums used to verify the integrity of downloaded files.
+ */
+
+#ifndef ONEDATASHARE_CHECKSUM_H
+#define ONEDATASHARE_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Extends the CRC32C (Castagnoli) checksum of some data with the data that follows it. Uses the SSE4.2 crc32
+ * instruction when the processor supports it, falling back to a table driven implementation processing 8 bytes at a
+ * time otherwise.
+ *
+ * @param crc the checksum of the preceding data, or 0 for no preceding data
+ * @param data borrowed pointer to the data that follows
+ * @param size the number of bytes of data
+ *
+ * @return the checksum of the preceding data followed by the specified data
+ */
+std::uint32_t crc32c_update(std::uint32_t crc, const char* data, std::size_t size);
+
+/**
+ * Combines the CRC32C checksums of two consecutive blocks of data into the checksum of both blocks, which lets
+ * blocks received out of order be checksummed as they arrive. Takes time logarithmic in the size of the second block.
+ *
+ * @param first the checksum of the first block
+ * @param second the checksum of the second block
+ * @param second_size the number of bytes in the second block
+ *
+ * @return the checksum of the first block followed by the second block
+ */
+std::uint32_t crc32c_combine(std::uint32_t first, std::uint32_t second, std::uint64_t second_size);
+
+/**
+ * Incremental computation of the 64-bit xxHash of data received in pieces.
+ */
+class Xxh64 {
+public:
+    /**
+     * Creates a new Xxh64 that has hashed no data.
+     *
+     * @param seed the seed of the hash
+     */
+    explicit Xxh64(std::uint64_t seed = 0);
+
+    /**
+     * Hashes the data that follows the data hashed so far.
+     *
+     * @param data borrowed pointer to the data
+     * @param size the number of bytes of data
+     */
+    void update(const char* data, std::size_t size);
+
+    /**
+     * Gets the hash of the data hashed so far, leaving this object unchanged.
+     *
+     * @return the hash
+     */
+    std::uint64_t digest() const;
+
+private:
+    /** The seed of the hash. */
+    const std::uint64_t seed_;
+
+    /** Accumulators of the stripes of 32 bytes hashed so far. */
+    std::uint64_t accumulators_[4];
+
+    /** Bytes received that do not yet fill a stripe. */
+    char buffer_[32];
+
+    /** Number of bytes in the buffer. */
+    std::size_t buffered_;
+
+    /** Number of bytes hashed so far. */
+    std::uint64_t total_;
+};
+
+/**
+ * Formats the specified value as lower case hexadecimal, padded with zeros to the specified number of digits.
+ *
+ * @param value the value to format
+ * @param digits the number of digits
+ *
+ * @return the formatted value
+ */
+std::string to_hex(std::uint64_t value, int digits);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_CHECKSUM_H
@@ -0,0 +1,154 @@
+/**
+ * @file chunked_upload.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "chunked_upload.h"
+#include "error_message.h"
+#include "local_file.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** Content type header. */
+constexpr auto header_content_type {"Content-Type"};
+
+/** Value of content type header for the raw bytes of a part. */
+constexpr auto header_octet_stream {"application/octet-stream"};
+
+/** Header describing the range of bytes of the file held by a part. */
+constexpr auto header_content_range {"Content-Range"};
+
+/**
+ * Creates the headers of the part holding the specified range of the file.
+ *
+ * @param headers borrowed reference to the headers sent with every part
+ * @param offset the offset of the first byte of the range
+ * @param length the number of bytes in the range
+ * @param total the size of the file in bytes
+ *
+ * @return the created headers
+ */
+std::unordered_multimap<std::string, std::string> part_headers(
+    const std::unordered_multimap<std::string, std::string>& headers,
+    std::uint64_t offset,
+    std::uint64_t length,
+    std::uint64_t total)
+{
+    auto part {headers};
+    part.erase(header_content_type);
+    part.emplace(header_content_type, header_octet_stream);
+    part.emplace(header_content_range,
+                 length == 0 ? "bytes */" + std::to_string(total)
+                             : "bytes " + std::to_string(offset) + "-" + std::to_string(offset + length - 1) + "/" +
+                                   std::to_string(total));
+    return part;
+}
+
+} // namespace
+
+void chunked_upload(const Rest& rest,
+                    const std::string& url,
+                    const std::unordered_multimap<std::string, std::string>& headers,
+                    const std::string& local_path,
+                    const Upload_options& options)
+{
+    const Local_file file {local_path, O_RDONLY};
+    struct stat info {};
+    if (::fstat(file.fd(), &info) != 0) {
+        file.throw_errno();
+    }
+    const auto total {static_cast<std::uint64_t>(info.st_size)};
+#ifdef POSIX_FADV_SEQUENTIAL
+    // parts are read in order, so the kernel may read ahead of them
+    ::posix_fadvise(file.fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const auto part_size {std::max<std::uint64_t>(options.part_size, 1)};
+    const auto parts {std::max<std::uint64_t>((total + part_size - 1) / part_size, 1)};
+
+    struct Completed {
+        std::uint64_t length;
+        std::future<Response> response;
+    };
+
+    std::mutex mutex {};
+    std::condition_variable completed_cv {};
+    std::deque<Completed> completed {};
+
+    std::uint64_t next {0};
+    std::uint64_t sent {0};
+    auto in_flight {0};
+    std::exception_ptr error {};
+    while (true) {
+        while (!error && in_flight < std::max(options.max_concurrency, 1) && next < parts) {
+            const auto offset {next++ * part_size};
+            const auto length {std::min(part_size, total - offset)};
+            try {
+                auto data {file.read(offset, length)};
+                rest.post_async(url,
+                                part_headers(headers, offset, length, total),
+                                std::move(data),
+                                [&mutex, &completed_cv, &completed, length](std::future<Response> response) {
+                                    {
+                                        const std::lock_guard<std::mutex> lock {mutex};
+                                        completed.push_back(Completed {length, std::move(response)});
+                                    }
+                                    completed_cv.notify_one();
+                                });
+                ++in_flight;
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        if (in_flight == 0) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock {mutex};
+        completed_cv.wait(lock, [&completed] { return !completed.empty(); });
+        auto done {std::move(completed.front())};
+        completed.pop_front();
+        lock.unlock();
+        --in_flight;
+
+        try {
+            const auto response {done.response.get()};
+            if (response.status() != 200) {
+                throw Unexpected_response_error {Err::expect_200_msg, response.status()};
+            }
+            sent += done.length;
+            if (options.on_progress) {
+                options.on_progress(sent, total);
+            }
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
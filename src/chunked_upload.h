@@ -0,0 +1,43 @@
+/**
+ * @file chunked_upload.h
+ * Defines the upload of a local file as parts sent concurrently.
+ */
+
+#ifndef ONEDATASHARE_CHUNKED_UPLOAD_H
+#define ONEDATASHARE_CHUNKED_UPLOAD_H
+
+#include <string>
+#include <unordered_map>
+
+#include <onedatashare/endpoint.h>
+
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Uploads the local file at the specified path by POSTing its parts to the specified url. Each part is read from disk
+ * with a single pread into its own buffer just before it is sent, and names the bytes of the file it holds with a
+ * Content-Range header, so parts may arrive in any order. No more than the maximum number of parts is in flight, and
+ * so held in memory, at once. An empty file is sent as a single empty part.
+ *
+ * @param rest borrowed reference to the object to use for making REST API calls
+ * @param url borrowed reference to the url receiving the parts
+ * @param headers borrowed reference to the headers sent with every part, whose Content-Type is replaced
+ * @param local_path borrowed reference to the path of the local file to upload
+ * @param options borrowed reference to the options controlling how the file is sent
+ *
+ * @exception Connection_error if unable to connect to the url or unable to read the local file
+ * @exception Unexpected_response_error if a part is answered with a status other than 200
+ */
+void chunked_upload(const Rest& rest,
+                    const std::string& url,
+                    const std::unordered_multimap<std::string, std::string>& headers,
+                    const std::string& local_path,
+                    const Upload_options& options);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_CHUNKED_UPLOAD_H
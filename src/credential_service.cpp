@@ -8,7 +8,7 @@
 #include <onedatashare/credential_service.h>
 
 #include "credential_service_impl.h"
-#include "curl_rest.h"
+#include "retry_rest.h"
 #include "util.h"
 
 namespace Onedatashare {
@@ -23,7 +23,7 @@ std::unique_ptr<Credential_service> Credential_service::create(const std::string
 {
     return std::make_unique<Internal::Credential_service_impl>(ods_auth_token,
                                                                url,
-                                                               std::make_unique<Internal::Curl_rest>());
+                                                               Internal::Retry_rest::shared());
 }
 
 Credential_service::Credential_service() = default;
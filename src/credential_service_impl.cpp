@@ -5,8 +5,8 @@
  * @date 7/10/20
  */
 
-#include <iomanip>
-#include <sstream>
+#include <future>
+#include <memory>
 #include <stdexcept>
 #include <utility>
 
@@ -16,13 +16,20 @@
 
 #include "credential_service_impl.h"
 #include "error_message.h"
+#include "json_parser_pool.h"
+#include "json_writer.h"
 #include "ods_rest_api.h"
+#include "single_flight.h"
 #include "util.h"
 
 namespace Onedatashare {
 namespace Internal {
 
 namespace {
+
+/** Characters reserved for the field names and punctuation of an AccountEndpointCredential json object. */
+constexpr std::size_t credential_overhead {64};
+
 /**
  * Converts a credential endpoint type to the string needed for the REST API.
  *
@@ -88,92 +95,184 @@ std::string create_account_endpoint_credential(const std::string& account_id,
                                                const std::string* username,
                                                const std::string* secret)
 {
-    std::ostringstream stream {};
-    stream << "{"
-           << "\"" << Api::endpoint_credential_account_id << "\":\"" << Util::escape_json(account_id) << "\",\""
-           << Api::endpoint_credential_uri << "\":\"" << Util::escape_json(uri);
+    std::string json {};
+    json.reserve(credential_overhead + account_id.size() + uri.size() + (username ? username->size() : 0) +
+                 (secret ? secret->size() : 0));
+
+    Json_writer writer {json};
+    writer.begin_object();
+    writer.field<Api::endpoint_credential_account_id>(account_id);
+    writer.field<Api::endpoint_credential_uri>(uri);
     if (username != nullptr) {
-        stream << "\",\"" << Api::endpoint_credential_username << "\":\"" << Util::escape_json(*username);
+        writer.field<Api::endpoint_credential_username>(*username);
     }
     if (secret != nullptr) {
-        stream << "\",\"" << Api::endpoint_credential_secret << "\":\"" << Util::escape_json(*secret);
+        writer.field<Api::endpoint_credential_secret>(*secret);
     }
-    stream << "\"}";
+    writer.end_object();
 
-    return stream.str();
+    return json;
 }
 
-} // namespace
-
-Credential_service_impl::Credential_service_impl(const std::string& ods_auth_token,
-                                                 const std::string& ods_url,
-                                                 std::unique_ptr<Rest> rest_caller)
-    : ods_url_ {ods_url},
-      headers_ {Util::create_headers(ods_auth_token)},
-      rest_caller_ {std::move(rest_caller)}
-{}
-
-std::string Credential_service_impl::oauth_url(Oauth_endpoint_type type) const
+/**
+ * Gets the OAuth url from the response to an oauth REST API call.
+ *
+ * @param response borrowed reference to the response to parse
+ *
+ * @return the OAuth url
+ *
+ * @exception Unexpected_response_error if the response is not a redirect to the OAuth url
+ */
+std::string parse_oauth_url_response(const Response& response)
 {
-    // if get throws an exception, propagate it up
-    const auto response {rest_caller_->get(ods_url_ + Api::oauth_path + "?type=" + as_string(type), headers_)};
-
-    if (response.status != 303) {
-        throw Unexpected_response_error {Err::expect_303_msg, response.status};
+    if (response.status() != 303) {
+        throw Unexpected_response_error {Err::expect_303_msg, response.status()};
     }
 
     // find url contained in a Location header (there should only be one Location header)
-    const auto iter {response.headers.find("Location")};
+    const auto location {response.header("Location")};
 
     // check that there was a Location header
-    if (iter == response.headers.end()) {
-        throw Unexpected_response_error {Err::expect_location_msg, response.status};
+    if (!location) {
+        throw Unexpected_response_error {Err::expect_location_msg, response.status()};
     }
 
     // return the url
-    return iter->second;
+    return std::string {*location};
 }
 
-void Credential_service_impl::register_credential(Credential_endpoint_type type,
-                                                  const std::string& cred_id,
-                                                  const std::string& uri,
-                                                  const std::string* username,
-                                                  const std::string* secret) const
+/**
+ * Checks that the specified response to a register credential REST API call has a 200 status code.
+ *
+ * @param response borrowed reference to the response to check
+ *
+ * @exception Unexpected_response_error if the response does not have a 200 status code
+ */
+void expect_200(const Response& response)
 {
-    // if post throws an exception, propogate it up
-    const auto response {rest_caller_->post(ods_url_ + Api::cred_path + "/" + as_string(type),
-                                            headers_,
-                                            create_account_endpoint_credential(cred_id, uri, username, secret))};
-
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
     }
 }
 
-std::vector<std::string> Credential_service_impl::credential_id_list(const Endpoint_type type) const
+/**
+ * Creates the list of credential ids from the response to a credential list REST API call.
+ *
+ * @param response borrowed reference to the response to parse
+ *
+ * @return the list of credential ids
+ *
+ * @exception Unexpected_response_error if the response is not a successful CredList response
+ */
+std::vector<std::string> parse_credential_id_list_response(const Response& response)
 {
-    // if get throws an exception, propogate it up
-    const auto response {rest_caller_->get(ods_url_ + Api::cred_path + "/" + Util::as_string(type), headers_)};
-
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
     }
 
-    simdjson::dom::parser parser {};
+    const auto parser {Json_parser_pool::shared().acquire()};
     std::vector<std::string> cred_list {};
 
     try {
         // parse json string array in CredList json object from response body
-        for (auto e : parser.parse(response.body).get_object().value()[Api::cred_list_credential_list].get_array()) {
+        for (auto e : parse_body(*parser, response).get_object().value()[Api::cred_list_credential_list].get_array()) {
             cred_list.push_back(e.get_c_str().take_value());
         }
     } catch (simdjson::simdjson_error e) {
         // bad response body
-        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status};
+        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status()};
     }
 
     return cred_list;
 }
 
+/**
+ * Gets the credential id lists in flight across every Credential_service_impl, so that identical requests made at
+ * once by many threads go to OneDataShare once.
+ *
+ * @return borrowed reference to the credential id lists in flight
+ */
+Single_flight<std::vector<std::string>>& credential_id_lists_in_flight()
+{
+    static Single_flight<std::vector<std::string>> flights {};
+    return flights;
+}
+
+} // namespace
+
+Credential_service_impl::Credential_service_impl(const std::string& ods_auth_token,
+                                                 const std::string& ods_url,
+                                                 std::shared_ptr<Rest> rest_caller)
+    : ods_url_ {ods_url},
+      headers_ {Util::create_headers(ods_auth_token)},
+      rest_caller_ {std::move(rest_caller)}
+{}
+
+std::string Credential_service_impl::oauth_url(Oauth_endpoint_type type) const
+{
+    // if get throws an exception, propagate it up
+    return parse_oauth_url_response(
+        rest_caller_->get(ods_url_ + Api::oauth_path + "?type=" + as_string(type), headers_));
+}
+
+void Credential_service_impl::register_credential(Credential_endpoint_type type,
+                                                  const std::string& cred_id,
+                                                  const std::string& uri,
+                                                  const std::string* username,
+                                                  const std::string* secret) const
+{
+    // if post throws an exception, propogate it up
+    expect_200(rest_caller_->post(ods_url_ + Api::cred_path + "/" + as_string(type),
+                                  headers_,
+                                  create_account_endpoint_credential(cred_id, uri, username, secret)));
+}
+
+std::vector<std::string> Credential_service_impl::credential_id_list(const Endpoint_type type) const
+{
+    const auto url {ods_url_ + Api::cred_path + "/" + Util::as_string(type)};
+    return credential_id_lists_in_flight().run(request_key(url, headers_), [&] {
+        // if get throws an exception, propogate it up
+        return parse_credential_id_list_response(rest_caller_->get(url, headers_));
+    });
+}
+
+std::future<std::string> Credential_service_impl::oauth_url_async(Oauth_endpoint_type type) const
+{
+    auto promise {std::make_shared<std::promise<std::string>>()};
+    auto future {promise->get_future()};
+    rest_caller_->get_async(ods_url_ + Api::oauth_path + "?type=" + as_string(type),
+                            headers_,
+                            fulfill(std::move(promise), parse_oauth_url_response));
+
+    return future;
+}
+
+std::future<void> Credential_service_impl::register_credential_async(Credential_endpoint_type type,
+                                                                     const std::string& cred_id,
+                                                                     const std::string& uri,
+                                                                     const std::string* username,
+                                                                     const std::string* secret) const
+{
+    auto promise {std::make_shared<std::promise<void>>()};
+    auto future {promise->get_future()};
+    rest_caller_->post_async(ods_url_ + Api::cred_path + "/" + as_string(type),
+                             headers_,
+                             create_account_endpoint_credential(cred_id, uri, username, secret),
+                             fulfill(std::move(promise), expect_200));
+
+    return future;
+}
+
+std::future<std::vector<std::string>> Credential_service_impl::credential_id_list_async(Endpoint_type type) const
+{
+    auto promise {std::make_shared<std::promise<std::vector<std::string>>>()};
+    auto future {promise->get_future()};
+    rest_caller_->get_async(ods_url_ + Api::cred_path + "/" + Util::as_string(type),
+                            headers_,
+                            fulfill(std::move(promise), parse_credential_id_list_response));
+
+    return future;
+}
+
 } // namespace Internal
 } // namespace Onedatashare
@@ -9,6 +9,7 @@
 #ifndef ONEDATASHARE_CREDENTIAL_SERVICE_IMPL_H
 #define ONEDATASHARE_CREDENTIAL_SERVICE_IMPL_H
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -31,11 +32,11 @@ public:
      *
      * @param ods_auth_token borrowed reference to the token to use for REST API calls
      * @param ods_url borrowed reference to the url to make REST API calls to
-     * @param rest_caller moved pointer to object to use for making REST API calls
+     * @param rest_caller shared pointer to object to use for making REST API calls
      */
     Credential_service_impl(const std::string& ods_auth_token,
                             const std::string& ods_url,
-                            std::unique_ptr<Rest> rest_caller);
+                            std::shared_ptr<Rest> rest_caller);
 
     /**
      * Makes a REST API call to get the OAuth url needed to register an endpoint of the specified type.
@@ -81,12 +82,51 @@ public:
      */
     std::vector<std::string> credential_id_list(Endpoint_type type) const override;
 
+    /**
+     * Starts a REST API call to get the OAuth url needed to register an endpoint of the specified type.
+     *
+     * @param type the endpoint type to get the OAuth url for
+     *
+     * @return future holding the OAuth url, or the Connection_error or Unexpected_response_error raised
+     */
+    std::future<std::string> oauth_url_async(Oauth_endpoint_type type) const override;
+
+    /**
+     * Starts a REST API call to register the specified credentials.
+     *
+     * @param type the endpoint type to register
+     * @param cred_id borrowed reference to the credential identifier to associate with the registered endpoint
+     * @param uri borrowed reference to the uri of the endpoint to register
+     * @param username borrowed pointer to the username needed to log in to the endpoint or nullptr to register an
+     * endpoint without a username
+     * @param secret borrowed pointer to the password needed to log in to the endpoint or nullptr to register an
+     * endpoint without a password
+     *
+     * @return future that becomes ready once the call completes, or holds the Connection_error or
+     * Unexpected_response_error raised
+     */
+    std::future<void> register_credential_async(Credential_endpoint_type type,
+                                                const std::string& cred_id,
+                                                const std::string& uri,
+                                                const std::string* username,
+                                                const std::string* secret) const override;
+
+    /**
+     * Starts a REST API call to get the list of credential identifiers of the specified type that are registered.
+     *
+     * @param type the endpoint type to list the registered credential identifiers of
+     *
+     * @return future holding the registered credential identifiers, or the Connection_error or
+     * Unexpected_response_error raised
+     */
+    std::future<std::vector<std::string>> credential_id_list_async(Endpoint_type type) const override;
+
 private:
     /** Url to the OneDataShare server to make REST API calls to. */
     const std::string ods_url_;
 
     /** Pointer to the object used to make REST API calls. */
-    const std::unique_ptr<Rest> rest_caller_;
+    const std::shared_ptr<Rest> rest_caller_;
 
     /** Headers used in REST API calls. */
     const std::unordered_multimap<std::string, std::string> headers_;
@@ -0,0 +1,457 @@
+/**
+ * @file curl_multi_rest.cpp
+ */
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "curl_multi_rest.h"
+#include "curl_request.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** Error message given to requests that have not completed when the event loop stops. */
+constexpr auto cancelled_msg {"Request cancelled before it completed"};
+
+/**
+ * Invokes the specified callback with a future holding the specified result.
+ *
+ * @param callback borrowed reference to the callback to invoke
+ * @param request function producing the result, which may throw
+ */
+template <typename F>
+void complete(const Response_callback& callback, F request) noexcept
+{
+    std::promise<Response> promise {};
+    try {
+        promise.set_value(request());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+
+    try {
+        callback(promise.get_future());
+    } catch (...) {
+        // an exception escaping a callback must not take down the event loop
+    }
+}
+
+/**
+ * Sets the connection options of the specified handle according to the specified options.
+ *
+ * @param handle borrowed pointer to the handle to set up
+ * @param options borrowed reference to the options to use
+ */
+void set_connection_options(CURL* handle, const Curl_multi_options& options)
+{
+    if (options.http2) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        // wait for a pending connection to find out if it can multiplex instead of opening another connection
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+
+    if (!options.ca_info.empty()) {
+        curl_easy_setopt(handle, CURLOPT_CAINFO, options.ca_info.c_str());
+    }
+}
+
+} // namespace
+
+struct Curl_multi_rest::Transfer {
+    /** Url to make the request to. */
+    std::string url;
+
+    /** Headers of the request. */
+    std::unordered_multimap<std::string, std::string> headers;
+
+    /** Data to POST, or no value to make a GET request. */
+    std::optional<std::string> data;
+
+    /** Sink the response body is written to, or nullptr to collect the body into the Response. */
+    Body_sink* sink;
+
+    /** Callback invoked once the request completes. */
+    Response_callback callback;
+
+    /** Lease on the handle the request runs on, once the request has started. */
+    std::optional<Curl_pool::Lease> lease;
+
+    /** State of the request, once the request has started. */
+    std::unique_ptr<Curl_request> request;
+};
+
+Curl_multi_rest::Curl_multi_rest(const Curl_multi_options& options)
+    : options_ {options},
+      pool_ {options.pool},
+      multi_ {curl_multi_init()},
+      wake_pipe_ {-1, -1},
+      mutex_ {},
+      submitted_ {},
+      resumed_ {},
+      stopping_ {false},
+      waiting_ {},
+      running_ {},
+      sockets_ {},
+      deadline_ {},
+      thread_ {}
+{
+    if (pipe(wake_pipe_) != 0) {
+        curl_multi_cleanup(multi_);
+        throw Connection_error {"Unable to create event loop wake pipe"};
+    }
+    for (auto fd : wake_pipe_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, socket_callback);
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, timer_callback);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+
+    if (options_.http2) {
+        curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#if LIBCURL_VERSION_NUM >= 0x074300
+        // the stream limit was added in libcurl 7.67.0, older versions use the limit advertised by the server
+        curl_multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS, options_.max_concurrent_streams);
+#endif
+    }
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, options_.max_host_connections);
+
+    thread_ = std::thread {&Curl_multi_rest::run, this};
+}
+
+Curl_multi_rest::~Curl_multi_rest()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        stopping_ = true;
+    }
+    wake();
+    thread_.join();
+
+    curl_multi_cleanup(multi_);
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+}
+
+std::shared_ptr<Curl_multi_rest> Curl_multi_rest::shared()
+{
+    static std::mutex mutex {};
+    static std::weak_ptr<Curl_multi_rest> instance {};
+
+    std::lock_guard<std::mutex> lock {mutex};
+    auto rest {instance.lock()};
+    if (!rest) {
+        rest = std::make_shared<Curl_multi_rest>();
+        instance = rest;
+    }
+
+    return rest;
+}
+
+Response Curl_multi_rest::get(const std::string& url,
+                              const std::unordered_multimap<std::string, std::string>& headers) const
+{
+    expect_blocking_allowed();
+    return get_async(url, headers).get();
+}
+
+Response Curl_multi_rest::get(const std::string& url,
+                              const std::unordered_multimap<std::string, std::string>& headers,
+                              Body_sink& sink) const
+{
+    expect_blocking_allowed();
+    auto promise {std::make_shared<std::promise<Response>>()};
+    auto future {promise->get_future()};
+    get_async(url, headers, sink, fulfill(std::move(promise), [](Response response) { return response; }));
+
+    return future.get();
+}
+
+Response Curl_multi_rest::post(const std::string& url,
+                               const std::unordered_multimap<std::string, std::string>& headers,
+                               const std::string& data) const
+{
+    expect_blocking_allowed();
+    return post_async(url, headers, data).get();
+}
+
+void Curl_multi_rest::get_async(const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers,
+                                Response_callback callback) const
+{
+    submit(std::make_unique<Transfer>(
+        Transfer {url, headers, std::nullopt, nullptr, std::move(callback), std::nullopt, nullptr}));
+}
+
+void Curl_multi_rest::get_async(const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers,
+                                Body_sink& sink,
+                                Response_callback callback) const
+{
+    submit(std::make_unique<Transfer>(
+        Transfer {url, headers, std::nullopt, &sink, std::move(callback), std::nullopt, nullptr}));
+}
+
+void Curl_multi_rest::post_async(const std::string& url,
+                                 const std::unordered_multimap<std::string, std::string>& headers,
+                                 std::string data,
+                                 Response_callback callback) const
+{
+    submit(std::make_unique<Transfer>(
+        Transfer {url, headers, std::move(data), nullptr, std::move(callback), std::nullopt, nullptr}));
+}
+
+void Curl_multi_rest::submit(std::unique_ptr<Transfer> transfer) const
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        submitted_.push_back(std::move(transfer));
+    }
+    wake();
+}
+
+void Curl_multi_rest::resume(CURL* handle) const
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        resumed_.push_back(handle);
+    }
+    wake();
+}
+
+void Curl_multi_rest::wake() const
+{
+    const char byte {0};
+    // a full pipe already guarantees a wake up, so a failed write can be ignored
+    [[maybe_unused]] const auto written {write(wake_pipe_[1], &byte, 1)};
+}
+
+void Curl_multi_rest::run()
+{
+    std::vector<pollfd> fds {};
+    std::vector<std::unique_ptr<Transfer>> picked_up {};
+    std::vector<CURL*> to_resume {};
+    int running_count {0};
+    mark_event_loop_thread();
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            if (stopping_) {
+                break;
+            }
+            picked_up.swap(submitted_);
+            to_resume.swap(resumed_);
+        }
+        for (auto& t : picked_up) {
+            waiting_.push_back(std::move(t));
+        }
+        picked_up.clear();
+        for (const auto handle : to_resume) {
+            // a handle that completed since its sink asked to resume may already run another request, which is not
+            // paused, so unpausing it does nothing
+            if (running_.count(handle) > 0) {
+                curl_easy_pause(handle, CURLPAUSE_CONT);
+            }
+        }
+        to_resume.clear();
+        start_waiting();
+
+        // wait on the wake pipe and every socket libcurl is interested in
+        fds.clear();
+        fds.push_back({wake_pipe_[0], POLLIN, 0});
+        for (const auto& [socket, events] : sockets_) {
+            fds.push_back({socket, events, 0});
+        }
+
+        auto timeout_ms {-1};
+        if (deadline_) {
+            const auto remaining {std::chrono::ceil<std::chrono::milliseconds>(*deadline_ - Clock::now())};
+            timeout_ms = static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+        }
+
+        poll(fds.data(), fds.size(), timeout_ms);
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+
+        for (auto it {fds.begin() + 1}; it != fds.end(); ++it) {
+            if (it->revents == 0) {
+                continue;
+            }
+            auto flags {0};
+            if (it->revents & POLLIN) {
+                flags |= CURL_CSELECT_IN;
+            }
+            if (it->revents & POLLOUT) {
+                flags |= CURL_CSELECT_OUT;
+            }
+            if (it->revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                flags |= CURL_CSELECT_ERR;
+            }
+            curl_multi_socket_action(multi_, it->fd, flags, &running_count);
+        }
+
+        if (deadline_ && *deadline_ <= Clock::now()) {
+            deadline_.reset();
+            curl_multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running_count);
+        }
+
+        finish_completed();
+    }
+
+    // fail every request that has not completed
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        for (auto& t : submitted_) {
+            waiting_.push_back(std::move(t));
+        }
+        submitted_.clear();
+    }
+    for (auto& [handle, transfer] : running_) {
+        curl_multi_remove_handle(multi_, handle);
+        waiting_.push_back(std::move(transfer));
+    }
+    running_.clear();
+    for (auto& t : waiting_) {
+        if (t->sink != nullptr) {
+            t->sink->set_resume(nullptr);
+        }
+        t->request.reset();
+        t->lease.reset();
+        complete(t->callback, []() -> Response { throw Connection_error {cancelled_msg}; });
+    }
+    waiting_.clear();
+}
+
+void Curl_multi_rest::start_waiting()
+{
+    while (!waiting_.empty()) {
+        auto lease {pool_.try_acquire()};
+        if (!lease) {
+            // every handle is in use, so the rest wait until a request completes
+            return;
+        }
+
+        auto transfer {std::move(waiting_.front())};
+        waiting_.pop_front();
+
+        const auto handle {lease->get()};
+        transfer->lease = std::move(lease);
+        transfer->request = std::make_unique<Curl_request>(handle,
+                                                           transfer->url,
+                                                           transfer->headers,
+                                                           transfer->data ? &*transfer->data : nullptr,
+                                                           transfer->sink);
+        set_connection_options(handle, options_);
+        if (transfer->sink != nullptr) {
+            transfer->sink->set_resume([this, handle] { resume(handle); });
+        }
+
+        running_.emplace(handle, std::move(transfer));
+        curl_multi_add_handle(multi_, handle);
+    }
+}
+
+void Curl_multi_rest::finish_completed()
+{
+    int remaining {0};
+    while (const auto message {curl_multi_info_read(multi_, &remaining)}) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        const auto handle {message->easy_handle};
+        const auto result {message->data.result};
+        curl_multi_remove_handle(multi_, handle);
+
+        const auto node {running_.extract(handle)};
+        if (node.empty()) {
+            continue;
+        }
+        auto& transfer {node.mapped()};
+
+        std::optional<Response> response {};
+        std::exception_ptr error {};
+        try {
+            response.emplace(transfer->request->finish(result));
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // the sink must not resume the handle once it is returned to the pool
+        if (transfer->sink != nullptr) {
+            transfer->sink->set_resume(nullptr);
+        }
+
+        // return the handle to the pool before invoking the callback so that follow up requests can use it
+        transfer->request.reset();
+        transfer->lease.reset();
+
+        complete(transfer->callback, [&] {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return std::move(*response);
+        });
+    }
+
+    // completed requests returned handles to the pool
+    start_waiting();
+}
+
+int Curl_multi_rest::socket_callback(CURL*, curl_socket_t socket, int what, void* userp, void*)
+{
+    auto& sockets {static_cast<Curl_multi_rest*>(userp)->sockets_};
+    switch (what) {
+    case CURL_POLL_IN:
+        sockets[socket] = POLLIN;
+        break;
+    case CURL_POLL_OUT:
+        sockets[socket] = POLLOUT;
+        break;
+    case CURL_POLL_INOUT:
+        sockets[socket] = POLLIN | POLLOUT;
+        break;
+    case CURL_POLL_REMOVE:
+        sockets.erase(socket);
+        break;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+int Curl_multi_rest::timer_callback(CURLM*, long timeout_ms, void* userp)
+{
+    auto& deadline {static_cast<Curl_multi_rest*>(userp)->deadline_};
+    if (timeout_ms < 0) {
+        deadline.reset();
+    } else {
+        deadline = Clock::now() + std::chrono::milliseconds {timeout_ms};
+    }
+
+    return 0;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,260 @@
+/**
+ * @file curl_multi_rest.h
+ * Defines a class wrapping the libcurl multi interface used to make many REST API calls concurrently.
+ */
+
+#ifndef ONEDATASHARE_CURL_MULTI_REST_H
+#define ONEDATASHARE_CURL_MULTI_REST_H
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "curl_pool.h"
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Options controlling the connections used by a Curl_multi_rest object.
+ */
+struct Curl_multi_options {
+    /** Options of the handle pool, which bounds the number of requests in flight at once. */
+    Curl_pool_options pool {256, 64, std::chrono::seconds {60}};
+
+    /** If HTTP/2 is negotiated during the TLS handshake. When it is, concurrent requests to the same host are
+     * multiplexed as streams over a single connection. Servers that do not support HTTP/2 fall back to HTTP/1.1. */
+    bool http2 {true};
+
+    /** Maximum number of concurrent streams on a single HTTP/2 connection. Requests beyond the limit open another
+     * connection. */
+    long max_concurrent_streams {100};
+
+    /** Maximum number of connections to a single host, or 0 for no limit. */
+    long max_host_connections {0};
+
+    /** Path to the CA certificate bundle used to verify servers, or empty to use the libcurl default. */
+    std::string ca_info {};
+};
+
+/**
+ * Class using the libcurl multi interface to perform REST requests. A single event loop thread drives every request
+ * with curl_multi_socket_action, so any number of requests can be in flight without a thread per request. Requests
+ * beyond the number of handles in the pool wait in a queue until a handle is returned. Safe to use from multiple
+ * threads. Unless disabled, requests to the same host are multiplexed over a single HTTP/2 connection.
+ */
+class Curl_multi_rest : public Rest {
+public:
+    using Rest::get_async;
+    using Rest::post_async;
+
+    /**
+     * Creates a new Curl_multi_rest object and starts its event loop thread.
+     *
+     * @param options borrowed reference to the options controlling the connections used
+     */
+    explicit Curl_multi_rest(const Curl_multi_options& options = {});
+
+    /**
+     * Stops the event loop thread. Requests that have not completed fail with a Connection_error.
+     */
+    ~Curl_multi_rest() override;
+
+    /**
+     * Gets the Curl_multi_rest object shared by every service created without an explicit REST caller, creating it if
+     * no service currently holds it.
+     *
+     * @return shared pointer to the shared object
+     */
+    static std::shared_ptr<Curl_multi_rest> shared();
+
+    /**
+     * Performs a GET request on the event loop thread, blocking until it completes.
+     *
+     * @param url borrowed refrence to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     *
+     * @return the Response object created from the values set by libcurl
+     *
+     * @exception Connection_error if unable to connect to the sepcified url
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers) const override;
+
+    /**
+     * Performs a GET request on the event loop thread, blocking until it completes. The response body is written to
+     * the specified sink on the event loop thread as it is received.
+     *
+     * @param url borrowed refrence to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param sink borrowed reference to the sink the response body is written to
+     *
+     * @return the Response object created from the values set by libcurl, with an empty body
+     *
+     * @exception Connection_error if unable to connect to the sepcified url or unable to write to the sink
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers,
+                 Body_sink& sink) const override;
+
+    /**
+     * Performs a POST request on the event loop thread, blocking until it completes.
+     *
+     * @param url borrowed reference to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param data borrowed reference to the json string passed in to libcurl to send as the POST data for the request
+     *
+     * @return the Response object created from the values set by libcurl
+     *
+     * @exception Connection_error if unable to connect to the sepcified url
+     */
+    Response post(const std::string& url,
+                  const std::unordered_multimap<std::string, std::string>& headers,
+                  const std::string& data) const override;
+
+    /**
+     * Queues a GET request to be made by the event loop thread, which invokes the specified callback once the request
+     * completes.
+     *
+     * @param url borrowed refrence to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param callback moved callback invoked on the event loop thread with the Response or the Connection_error
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Response_callback callback) const override;
+
+    /**
+     * Queues a GET request to be made by the event loop thread, which writes the response body to the specified sink
+     * as it is received and invokes the specified callback once the request completes. A sink that is not ready
+     * pauses the request without blocking the event loop until it resumes the request.
+     *
+     * @param url borrowed refrence to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param sink borrowed reference to the sink the response body is written to, which must outlive the request
+     * @param callback moved callback invoked on the event loop thread with the Response or the exception raised by the
+     * request
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Body_sink& sink,
+                   Response_callback callback) const override;
+
+    /**
+     * Queues a POST request to be made by the event loop thread, which invokes the specified callback once the
+     * request completes.
+     *
+     * @param url borrowed reference to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param data moved json string sent as the POST data for the request
+     * @param callback moved callback invoked on the event loop thread with the Response or the Connection_error
+     */
+    void post_async(const std::string& url,
+                    const std::unordered_multimap<std::string, std::string>& headers,
+                    std::string data,
+                    Response_callback callback) const override;
+
+private:
+    /** Clock used for libcurl timeouts. */
+    using Clock = std::chrono::steady_clock;
+
+    /** A request waiting for or running on the event loop thread. */
+    struct Transfer;
+
+    /**
+     * Hands the specified request to the event loop thread.
+     *
+     * @param transfer moved pointer to the request to queue
+     */
+    void submit(std::unique_ptr<Transfer> transfer) const;
+
+    /**
+     * Hands the specified paused request to the event loop thread to be resumed.
+     *
+     * @param handle borrowed pointer to the handle of the paused request
+     */
+    void resume(CURL* handle) const;
+
+    /**
+     * Wakes the event loop thread if it is waiting on its sockets.
+     */
+    void wake() const;
+
+    /**
+     * Runs the event loop until the object is destroyed.
+     */
+    void run();
+
+    /**
+     * Adds queued requests to the multi handle while handles are available in the pool.
+     */
+    void start_waiting();
+
+    /**
+     * Completes every request libcurl reports as done, invoking their callbacks.
+     */
+    void finish_completed();
+
+    /**
+     * Used by libcurl to tell the event loop which events to wait for on a socket.
+     */
+    static int socket_callback(CURL* handle, curl_socket_t socket, int what, void* userp, void* socketp);
+
+    /**
+     * Used by libcurl to tell the event loop when to call curl_multi_socket_action with CURL_SOCKET_TIMEOUT.
+     */
+    static int timer_callback(CURLM* multi, long timeout_ms, void* userp);
+
+    /** Options controlling the connections used. */
+    const Curl_multi_options options_;
+
+    /** Pool that request handles are checked out of. */
+    mutable Curl_pool pool_;
+
+    /** Multi handle driving every running request. */
+    CURLM* const multi_;
+
+    /** Pipe written to in order to wake the event loop thread. */
+    int wake_pipe_[2];
+
+    /** Guards the fields below. */
+    mutable std::mutex mutex_;
+
+    /** Requests handed to the event loop thread that it has not picked up yet. */
+    mutable std::vector<std::unique_ptr<Transfer>> submitted_;
+
+    /** Handles of paused requests whose sinks are ready again, not yet resumed by the event loop thread. */
+    mutable std::vector<CURL*> resumed_;
+
+    /** If the event loop thread should stop. */
+    bool stopping_;
+
+    /** Requests picked up by the event loop thread that are waiting for a handle. Used only by the event loop. */
+    std::deque<std::unique_ptr<Transfer>> waiting_;
+
+    /** Requests added to the multi handle, by handle. Used only by the event loop. */
+    std::unordered_map<CURL*, std::unique_ptr<Transfer>> running_;
+
+    /** Events libcurl wants to wait for, by socket. Used only by the event loop. */
+    std::unordered_map<curl_socket_t, short> sockets_;
+
+    /** Time libcurl wants its timeout handled, if any. Used only by the event loop. */
+    std::optional<Clock::time_point> deadline_;
+
+    /** The event loop thread. */
+    std::thread thread_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_CURL_MULTI_REST_H
@@ -0,0 +1,202 @@
+/**
+ * @file curl_pool.cpp
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "curl_pool.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+/**
+ * Initializes libcurl when created and cleans up libcurl when destroyed.
+ */
+class Curl_init {
+public:
+    /**
+     * Initializes the global data needed for libcurl.
+     */
+    Curl_init()
+    {
+        curl_global_init(CURL_GLOBAL_ALL);
+    }
+
+    /**
+     * Cleans up the global data needed for libcurl.
+     */
+    ~Curl_init()
+    {
+        curl_global_cleanup();
+    }
+};
+
+/** Static object that initializes libcurl global data at the start of the program and frees libcurl global data once
+ * the program terminates. */
+static Curl_init libcurl_global_data_handler {};
+
+/**
+ * Sets the options every handle checked out of a pool starts with.
+ *
+ * @param handle borrowed pointer to the handle to configure
+ */
+void set_default_options(CURL* handle)
+{
+    // keep idle connections from being silently dropped by middleboxes between requests
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+}
+
+} // namespace
+
+Curl_pool::Lease::Lease(Curl_pool* pool, CURL* handle) : pool_ {pool}, handle_ {handle} {}
+
+Curl_pool::Lease::Lease(Lease&& other) noexcept
+    : pool_ {std::exchange(other.pool_, nullptr)},
+      handle_ {std::exchange(other.handle_, nullptr)}
+{}
+
+Curl_pool::Lease& Curl_pool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        if (pool_ != nullptr) {
+            pool_->release(handle_);
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+}
+
+Curl_pool::Lease::~Lease()
+{
+    if (pool_ != nullptr) {
+        pool_->release(handle_);
+    }
+}
+
+CURL* Curl_pool::Lease::get() const
+{
+    return handle_;
+}
+
+Curl_pool::Curl_pool(const Curl_pool_options& options)
+    : options_ {options},
+      share_locks_ {},
+      share_ {curl_share_init()},
+      mutex_ {},
+      returned_ {},
+      idle_ {},
+      checked_out_ {0}
+{
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_share);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_share);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    // the connection cache is not shared since libcurl does not support sharing it between handles in use on
+    // different threads at once, so each handle reuses the connections in its own cache instead
+    idle_.reserve(options_.max_idle_handles);
+}
+
+Curl_pool::~Curl_pool()
+{
+    // every lease must have been returned by now since leases borrow the pool
+    for (auto& h : idle_) {
+        curl_easy_cleanup(h.handle);
+    }
+    curl_share_cleanup(share_);
+}
+
+Curl_pool::Lease Curl_pool::acquire()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    returned_.wait(lock, [this] { return checked_out_ < options_.max_handles; });
+
+    return checkout(lock);
+}
+
+std::optional<Curl_pool::Lease> Curl_pool::try_acquire()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    if (checked_out_ >= options_.max_handles) {
+        return std::nullopt;
+    }
+
+    return checkout(lock);
+}
+
+std::size_t Curl_pool::idle_count() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return idle_.size();
+}
+
+Curl_pool::Lease Curl_pool::checkout(std::unique_lock<std::mutex>& lock)
+{
+    ++checked_out_;
+
+    CURL* handle {nullptr};
+    evict_idle(Clock::now());
+    if (!idle_.empty()) {
+        // reuse the most recently returned handle since it is the most likely to still have a live connection
+        handle = idle_.back().handle;
+        idle_.pop_back();
+    }
+    lock.unlock();
+
+    if (handle == nullptr) {
+        handle = curl_easy_init();
+        curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+    }
+    set_default_options(handle);
+
+    return Lease {this, handle};
+}
+
+void Curl_pool::release(CURL* handle)
+{
+    // clear options from the previous request, keeping the handle's live connections and attached share handle
+    curl_easy_reset(handle);
+
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        --checked_out_;
+        const auto now {Clock::now()};
+        idle_.push_back({handle, now});
+        evict_idle(now);
+    }
+    returned_.notify_one();
+}
+
+void Curl_pool::evict_idle(Clock::time_point now)
+{
+    // idle handles are ordered by return time, so expired handles and handles over the count limit are at the front
+    const auto expired {std::find_if(idle_.begin(), idle_.end(), [&](const Idle_handle& h) {
+        return now - h.since < options_.max_idle_time;
+    })};
+    auto evict_end {expired};
+    if (static_cast<std::size_t>(idle_.end() - evict_end) > options_.max_idle_handles) {
+        evict_end = idle_.end() - options_.max_idle_handles;
+    }
+
+    for (auto it {idle_.begin()}; it != evict_end; ++it) {
+        curl_easy_cleanup(it->handle);
+    }
+    idle_.erase(idle_.begin(), evict_end);
+}
+
+void Curl_pool::lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userp)
+{
+    static_cast<Curl_pool*>(userp)->share_locks_[data].lock();
+}
+
+void Curl_pool::unlock_share(CURL*, curl_lock_data data, void* userp)
+{
+    static_cast<Curl_pool*>(userp)->share_locks_[data].unlock();
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,191 @@
+/**
+ * @file curl_pool.h
+ * Defines a thread-safe pool of reusable libcurl easy handles sharing one DNS and TLS session cache.
+ */
+
+#ifndef ONEDATASHARE_CURL_POOL_H
+#define ONEDATASHARE_CURL_POOL_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Options controlling the size of a Curl_pool and how long it keeps idle handles alive.
+ */
+struct Curl_pool_options {
+    /** Maximum number of handles that may be checked out at once. Callers acquiring beyond this block. */
+    std::size_t max_handles {16};
+
+    /** Maximum number of idle handles kept alive for reuse. */
+    std::size_t max_idle_handles {16};
+
+    /** Time after which an idle handle, along with its open connections, is cleaned up. */
+    std::chrono::seconds max_idle_time {60};
+};
+
+/**
+ * Pool of libcurl easy handles. Returned handles keep their open connections alive between requests in their own
+ * connection caches, so a handle's repeated requests to the same host skip the TCP and TLS handshakes, and all handles
+ * share a single DNS cache and TLS session cache, so a handle's first request to a host skips the DNS lookup and
+ * resumes a TLS session instead of negotiating a new one.
+ */
+class Curl_pool {
+public:
+    /**
+     * Easy handle checked out of a Curl_pool. The handle is returned to the pool when the lease is destroyed.
+     */
+    class Lease {
+    public:
+        Lease(const Lease&) = delete;
+
+        Lease& operator=(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept;
+
+        Lease& operator=(Lease&& other) noexcept;
+
+        ~Lease();
+
+        /**
+         * Gets the leased handle.
+         *
+         * @return borrowed pointer to the leased handle
+         */
+        CURL* get() const;
+
+    private:
+        friend class Curl_pool;
+
+        Lease(Curl_pool* pool, CURL* handle);
+
+        /** Pool the handle is returned to, or nullptr if the lease was moved from. */
+        Curl_pool* pool_;
+
+        /** The leased handle. */
+        CURL* handle_;
+    };
+
+    /**
+     * Creates a new, empty Curl_pool with the specified options.
+     *
+     * @param options borrowed reference to the options to use
+     */
+    explicit Curl_pool(const Curl_pool_options& options = {});
+
+    ~Curl_pool();
+
+    Curl_pool(const Curl_pool&) = delete;
+
+    Curl_pool& operator=(const Curl_pool&) = delete;
+
+    Curl_pool(Curl_pool&&) = delete;
+
+    Curl_pool& operator=(Curl_pool&&) = delete;
+
+    /**
+     * Checks out a handle, reusing the most recently returned idle handle if there is one. Blocks while the maximum
+     * number of handles are checked out. The handle's options are reset to the pool defaults.
+     *
+     * @return the lease owning the checked out handle
+     */
+    Lease acquire();
+
+    /**
+     * Checks out a handle in the same way as acquire, except that no handle is checked out instead of blocking while
+     * the maximum number of handles are checked out.
+     *
+     * @return the lease owning the checked out handle, or no value if the maximum number of handles are checked out
+     */
+    std::optional<Lease> try_acquire();
+
+    /**
+     * Gets the number of idle handles currently held by the pool.
+     *
+     * @return the number of idle handles
+     */
+    std::size_t idle_count() const;
+
+private:
+    /** Clock used to track how long handles have been idle. */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A handle that is not checked out along with the time it was returned.
+     */
+    struct Idle_handle {
+        /** The idle handle. */
+        CURL* handle;
+
+        /** The time the handle was returned to the pool. */
+        Clock::time_point since;
+    };
+
+    /**
+     * Checks out a handle once the pool mutex is held and there is room to check out another handle.
+     *
+     * @param lock borrowed reference to the held lock on the pool mutex, which is released before returning
+     *
+     * @return the lease owning the checked out handle
+     */
+    Lease checkout(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Returns the specified handle to the pool.
+     *
+     * @param handle owned pointer to the handle to return
+     */
+    void release(CURL* handle);
+
+    /**
+     * Cleans up idle handles that have exceeded the idle time or idle count limits. The pool mutex must be held.
+     *
+     * @param now the current time
+     */
+    void evict_idle(Clock::time_point now);
+
+    /**
+     * Used by libcurl to lock the data of the share handle.
+     */
+    static void lock_share(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+
+    /**
+     * Used by libcurl to unlock the data of the share handle.
+     */
+    static void unlock_share(CURL* handle, curl_lock_data data, void* userp);
+
+    /** Options the pool was created with. */
+    const Curl_pool_options options_;
+
+    /** One mutex per kind of data held by the share handle. */
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+
+    /** Share handle attached to every handle created by the pool. */
+    CURLSH* share_;
+
+    /** Guards the fields below. */
+    mutable std::mutex mutex_;
+
+    /** Signaled whenever a handle is returned. */
+    std::condition_variable returned_;
+
+    /** Idle handles ordered from least to most recently returned. */
+    std::vector<Idle_handle> idle_;
+
+    /** Number of handles currently checked out. */
+    std::size_t checked_out_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_CURL_POOL_H
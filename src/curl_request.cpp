@@ -0,0 +1,208 @@
+/**
+ * @file curl_request.cpp
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+#include <utility>
+
+#include <onedatashare/ods_error.h>
+
+#include "curl_request.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/**
+ * String separating keys from values when setting request headers.
+ */
+constexpr auto header_delim {": "};
+
+/**
+ * Characters trimmed from the ends of header keys and values.
+ */
+constexpr std::string_view whitespace_chars {" \t\r\n"};
+
+/**
+ * Name of the header containing the size of the response body.
+ */
+constexpr std::string_view content_length_key {"content-length"};
+
+/**
+ * Checks if the specified header key matches the specified lower case key, ignoring case.
+ *
+ * @param key the key to check
+ * @param lower_key the lower case key to compare against
+ *
+ * @return true if the keys match, false otherwise
+ */
+bool key_equals(std::string_view key, std::string_view lower_key)
+{
+    return key.size() == lower_key.size() && std::equal(key.begin(), key.end(), lower_key.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           });
+}
+
+/**
+ * Finds the part of the specified range of the specified string that is not surrounded by whitespace.
+ *
+ * @param str the string containing the range
+ * @param begin the start of the range
+ * @param end the end of the range
+ *
+ * @return pair of the start and the end of the trimmed range
+ */
+std::pair<std::size_t, std::size_t> trim(std::string_view str, std::size_t begin, std::size_t end)
+{
+    while (begin < end && whitespace_chars.find(str[begin]) != std::string_view::npos) {
+        ++begin;
+    }
+    while (end > begin && whitespace_chars.find(str[end - 1]) != std::string_view::npos) {
+        --end;
+    }
+    return {begin, end};
+}
+
+} // namespace
+
+Curl_request::Curl_request(CURL* handle,
+                           const std::string& url,
+                           const std::unordered_multimap<std::string, std::string>& headers,
+                           const std::string* post_data,
+                           Body_sink* sink)
+    : handle_ {handle},
+      headers_slist_ {nullptr},
+      buffer_ {},
+      header_spans_ {},
+      headers_size_ {0},
+      body_sink_ {buffer_, Response::body_padding},
+      sink_ {sink != nullptr ? sink : &body_sink_},
+      started_ {false},
+      sink_error_ {}
+{
+    curl_easy_setopt(handle_, CURLOPT_URL, url.c_str());
+    if (post_data != nullptr) {
+        // the size is set explicitly so that binary data containing null bytes is sent whole
+        curl_easy_setopt(handle_, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t) post_data->size());
+        curl_easy_setopt(handle_, CURLOPT_POSTFIELDS, post_data->c_str());
+    } else {
+        curl_easy_setopt(handle_, CURLOPT_HTTPGET, 1L);
+    }
+    curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(handle_, CURLOPT_HEADERFUNCTION, header_callback);
+
+    for (auto h : headers) {
+        headers_slist_ = curl_slist_append(headers_slist_, (h.first + header_delim + h.second).c_str());
+    }
+    curl_easy_setopt(handle_, CURLOPT_HTTPHEADER, headers_slist_);
+
+    curl_easy_setopt(handle_, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(handle_, CURLOPT_WRITEDATA, this);
+}
+
+Curl_request::~Curl_request()
+{
+    // free owned pointer to curl_slist
+    curl_slist_free_all(headers_slist_);
+}
+
+Response Curl_request::finish(CURLcode result)
+{
+    // an exception from the sink aborts the request, so it takes precedence over the resulting write error
+    if (sink_error_) {
+        std::rethrow_exception(sink_error_);
+    }
+
+    // check that the request was successful
+    if (result != CURLE_OK) {
+        throw Connection_error {curl_easy_strerror(result)};
+    }
+
+    long status {-1};
+    curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &status);
+
+    if (sink_ != &body_sink_) {
+        // only the headers were collected
+        buffer_.resize(headers_size_);
+    }
+
+    return Response {std::move(buffer_), std::move(header_spans_), headers_size_, (int) status};
+}
+
+std::size_t Curl_request::write_callback(char* buffer, std::size_t size, std::size_t nmemb, void* userp)
+{
+    auto& request {*static_cast<Curl_request*>(userp)};
+    try {
+        if (!request.started_) {
+            long status {-1};
+            curl_easy_getinfo(request.handle_, CURLINFO_RESPONSE_CODE, &status);
+            request.sink_->start((int) status);
+            request.started_ = true;
+        }
+        if (!request.sink_->ready()) {
+            // libcurl hands the same chunk over again once the sink resumes the request
+            return CURL_WRITEFUNC_PAUSE;
+        }
+        request.sink_->write(buffer, size * nmemb);
+    } catch (...) {
+        // exceptions must not cross libcurl, so the exception is held until finish and the request is aborted
+        request.sink_error_ = std::current_exception();
+        return 0;
+    }
+    return size * nmemb;
+}
+
+std::size_t Curl_request::header_callback(char* buffer, std::size_t size, std::size_t nmemb, void* userp)
+{
+    auto& request {*static_cast<Curl_request*>(userp)};
+    const std::string_view line {buffer, size * nmemb};
+    auto& raw {request.buffer_};
+
+    if (raw.size() != request.headers_size_) {
+        // ignore trailers received after the body since the body directly follows the headers in the buffer
+        return line.size();
+    }
+    if (line.substr(0, 5) == "HTTP/") {
+        // a new status line starts the headers of the next response, such as the final response after a 100 Continue
+        raw.clear();
+        request.header_spans_.clear();
+        request.headers_size_ = 0;
+        return line.size();
+    }
+
+    const auto colon {line.find(':')};
+    if (colon == std::string_view::npos) {
+        return line.size();
+    }
+
+    // append the raw line and locate the key and value within it
+    const auto start {raw.size()};
+    raw.append(line);
+    const auto [key_begin, key_end] {trim(raw, start, start + colon)};
+    const auto [value_begin, value_end] {trim(raw, start + colon + 1, raw.size())};
+    request.header_spans_.push_back({key_begin, key_end - key_begin, value_begin, value_end - value_begin});
+    request.headers_size_ = raw.size();
+
+    const std::string_view key {raw.data() + key_begin, key_end - key_begin};
+    if (key_equals(key, content_length_key)) {
+        // let the sink prepare for the body, ignoring malformed lengths
+        std::size_t length {0};
+        const auto [end, err] {std::from_chars(raw.data() + value_begin, raw.data() + value_end, length)};
+        if (err == std::errc {}) {
+            try {
+                request.sink_->expect(length);
+            } catch (...) {
+                // the expected size is only a hint
+            }
+        }
+    }
+
+    return line.size();
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,113 @@
+/**
+ * @file curl_request.h
+ * Defines the per-request state shared by the libcurl based REST callers.
+ */
+
+#ifndef ONEDATASHARE_CURL_REQUEST_H
+#define ONEDATASHARE_CURL_REQUEST_H
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "body_sink.h"
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Sets up a libcurl handle to make a request and collects the raw response headers into a single buffer while the
+ * request runs. The response body is either appended to the same buffer or written to a Body_sink supplied by the
+ * caller.
+ */
+class Curl_request {
+public:
+    /**
+     * Sets up the specified handle to make a GET request, or a POST request if post data is specified, to the
+     * specified url with the specified headers.
+     *
+     * @param handle borrowed pointer to the handle to set up, which must outlive this object
+     * @param url borrowed reference to the url to make the request to
+     * @param headers borrowed reference to the multi-map used to construct the request headers
+     * @param post_data borrowed pointer to the data to POST, which must outlive this object, or nullptr to make a GET
+     * request
+     * @param sink borrowed pointer to the sink the response body is written to, which must outlive this object, or
+     * nullptr to collect the body into the Response
+     */
+    Curl_request(CURL* handle,
+                 const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers,
+                 const std::string* post_data,
+                 Body_sink* sink = nullptr);
+
+    ~Curl_request();
+
+    Curl_request(const Curl_request&) = delete;
+
+    Curl_request& operator=(const Curl_request&) = delete;
+
+    Curl_request(Curl_request&&) = delete;
+
+    Curl_request& operator=(Curl_request&&) = delete;
+
+    /**
+     * Creates the Response from the data collected by the finished request, moving the collected data out of this
+     * object.
+     *
+     * @param result the result libcurl finished the request with
+     *
+     * @return the Response object created from the values set by libcurl, whose body is empty if a sink was specified
+     *
+     * @exception Connection_error if the request failed to connect to the specified url
+     * @exception any exception thrown by the sink, which aborts the request
+     */
+    Response finish(CURLcode result);
+
+private:
+    /**
+     * Used by libcurl to hand a chunk of the response body to the sink of the specified request.
+     */
+    static std::size_t write_callback(char* buffer, std::size_t size, std::size_t nmemb, void* userp);
+
+    /**
+     * Used by libcurl to add a response header to the specified request.
+     */
+    static std::size_t header_callback(char* buffer, std::size_t size, std::size_t nmemb, void* userp);
+
+    /** Handle the request is made on. */
+    CURL* const handle_;
+
+    /** Owned list of request headers handed to libcurl. */
+    curl_slist* headers_slist_;
+
+    /** Buffer the raw response header lines are collected into, followed by the body when no sink is specified. */
+    std::string buffer_;
+
+    /** Locations of the response headers within the buffer. */
+    std::vector<Response::Header_span> header_spans_;
+
+    /** Size of the header lines at the start of the buffer. */
+    std::size_t headers_size_;
+
+    /** Sink appending the response body to the buffer. */
+    String_sink body_sink_;
+
+    /** Sink the response body is written to. */
+    Body_sink* const sink_;
+
+    /** If the sink has been told the status code. */
+    bool started_;
+
+    /** Exception thrown by the sink, if any. */
+    std::exception_ptr sink_error_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_CURL_REQUEST_H
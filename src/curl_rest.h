@@ -12,16 +12,28 @@
 #include <string>
 #include <unordered_map>
 
+#include "curl_pool.h"
 #include "rest.h"
 
 namespace Onedatashare {
 namespace Internal {
 
 /**
- * Class using libcurl to perform REST requests.
+ * Class using libcurl to perform REST requests. Requests are made on handles checked out of a pool so that
+ * connections, DNS lookups, and TLS sessions are reused across requests. Safe to use from multiple threads.
+ *
+ * Not used by any service, which all share the Curl_multi_rest event loop built on the same handle pool. Kept as a
+ * blocking reference backend for tests exercising the pooled handles directly.
  */
 class Curl_rest : public Rest {
 public:
+    /**
+     * Creates a new Curl_rest object whose handle pool uses the specified options.
+     *
+     * @param options borrowed reference to the options of the handle pool
+     */
+    explicit Curl_rest(const Curl_pool_options& options = {});
+
     /**
      * Uses libcurl to perform a GET request to the specified url with the specified headers.
      *
@@ -35,6 +47,22 @@ public:
     Response get(const std::string& url,
                  const std::unordered_multimap<std::string, std::string>& headers) const override;
 
+    /**
+     * Uses libcurl to perform a GET request to the specified url with the specified headers, writing the response
+     * body to the specified sink as it is received.
+     *
+     * @param url borrowed refrence to the string set as the url
+     * @param headers borrowed refrence to the multi-map used to construct the request headers
+     * @param sink borrowed reference to the sink the response body is written to
+     *
+     * @return the Response object created from the values set by libcurl, with an empty body
+     *
+     * @exception Connection_error if unable to connect to the sepcified url or unable to write to the sink
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers,
+                 Body_sink& sink) const override;
+
     /**
      * Uses libcurl to perform a POST request to the specified url with the specified headers and data.
      *
@@ -50,6 +78,10 @@ public:
     Response post(const std::string& url,
                   const std::unordered_multimap<std::string, std::string>& headers,
                   const std::string& data) const override;
+
+private:
+    /** Pool of handles used to make requests. */
+    mutable Curl_pool pool_;
 };
 
 } // namespace Internal
@@ -0,0 +1,20 @@
+/**
+ * @file directory_watcher.cpp
+ */
+
+#include <onedatashare/directory_watcher.h>
+
+#include "directory_watcher_impl.h"
+
+namespace Onedatashare {
+
+std::unique_ptr<Directory_watcher> Directory_watcher::create(const Directory_watcher_options& options)
+{
+    return std::make_unique<Internal::Directory_watcher_impl>(options);
+}
+
+Directory_watcher::Directory_watcher() = default;
+
+Directory_watcher::~Directory_watcher() = default;
+
+} // namespace Onedatashare
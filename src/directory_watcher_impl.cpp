@@ -0,0 +1,279 @@
+/**
+ * @file directory_watcher_impl.cpp
+ */
+
+#include <algorithm>
+
+#include "directory_watcher_impl.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/**
+ * Combines the specified hash into the specified seed.
+ *
+ * @param seed the seed being combined into
+ * @param hash the hash to combine
+ *
+ * @return the combined hash
+ */
+std::uint64_t combine(std::uint64_t seed, std::uint64_t hash)
+{
+    return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+/**
+ * Computes the fingerprint of the name, size, time, and type of the specified resource.
+ *
+ * @param resource borrowed reference to the resource
+ *
+ * @return the fingerprint
+ */
+std::uint64_t fingerprint(const Resource& resource)
+{
+    auto hash {static_cast<std::uint64_t>(std::hash<std::string> {}(resource.name))};
+    hash = combine(hash, std::hash<long> {}(resource.size));
+    hash = combine(hash, std::hash<long> {}(resource.time));
+    return combine(hash, resource.is_directory ? 1 : 0);
+}
+
+/**
+ * Invokes the error callback of a watch if it has one, ignoring anything it throws.
+ *
+ * @param on_error borrowed reference to the error callback, which may be empty
+ * @param identifier borrowed reference to the path or id of the watched directory
+ * @param error the exception to pass to the callback
+ */
+void report(const std::function<void(const std::string& identifier, std::exception_ptr error)>& on_error,
+            const std::string& identifier,
+            std::exception_ptr error)
+{
+    if (!on_error) {
+        return;
+    }
+    try {
+        on_error(identifier, error);
+    } catch (...) {
+        // the watching thread must keep running for the remaining watches
+    }
+}
+
+} // namespace
+
+Listing_differ::Listing_differ() : entries_ {}, initialized_ {false} {}
+
+bool Listing_differ::update(const std::string& directory, Resource listing, std::vector<Watch_event>& events)
+{
+    auto contained {listing.contained_resources ? std::move(*listing.contained_resources) : std::vector<Resource> {}};
+
+    std::unordered_map<std::string, Entry> entries {};
+    entries.reserve(contained.size());
+
+    auto changed {false};
+    for (auto& resource : contained) {
+        auto key {resource.id ? *resource.id : resource.name};
+        const auto print {fingerprint(resource)};
+
+        // entries matched against the new listing are removed so that only removed resources are left behind
+        const auto previous {entries_.find(key)};
+        if (initialized_) {
+            if (previous == entries_.end()) {
+                events.push_back(Watch_event {Watch_event_type::added, directory, resource});
+                changed = true;
+            } else if (previous->second.fingerprint != print) {
+                events.push_back(Watch_event {Watch_event_type::modified, directory, resource});
+                changed = true;
+            }
+        }
+        if (previous != entries_.end()) {
+            entries_.erase(previous);
+        }
+        entries.insert_or_assign(std::move(key), Entry {print, std::move(resource)});
+    }
+
+    if (initialized_) {
+        for (auto& [key, entry] : entries_) {
+            events.push_back(Watch_event {Watch_event_type::removed, directory, std::move(entry.resource)});
+            changed = true;
+        }
+    }
+
+    entries_ = std::move(entries);
+    initialized_ = true;
+    return changed;
+}
+
+Directory_watcher_impl::Directory_watcher_impl(const Directory_watcher_options& options)
+    : options_ {options},
+      mutex_ {},
+      changed_cv_ {},
+      watches_ {},
+      schedule_ {},
+      completed_ {},
+      in_flight_ {0},
+      next_id_ {1},
+      stopping_ {false},
+      thread_ {}
+{
+    thread_ = std::thread {&Directory_watcher_impl::run, this};
+}
+
+Directory_watcher_impl::~Directory_watcher_impl()
+{
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        stopping_ = true;
+    }
+    changed_cv_.notify_all();
+    thread_.join();
+}
+
+Watch_id Directory_watcher_impl::watch(
+    const Endpoint& endpoint,
+    const std::string& identifier,
+    std::function<void(const Watch_event& event)> on_event,
+    std::function<void(const std::string& identifier, std::exception_ptr error)> on_error)
+{
+    Watch_id id {};
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        id = next_id_++;
+        watches_.emplace(id,
+                         std::shared_ptr<Watch>(new Watch {endpoint,
+                                                           identifier,
+                                                           std::move(on_event),
+                                                           std::move(on_error),
+                                                           options_.min_interval,
+                                                           Listing_differ {}}));
+        schedule_.emplace(std::chrono::steady_clock::now(), id);
+    }
+    changed_cv_.notify_all();
+    return id;
+}
+
+void Directory_watcher_impl::unwatch(Watch_id id)
+{
+    // the scheduled listing of the watch is skipped once it is due
+    const std::lock_guard<std::mutex> lock {mutex_};
+    watches_.erase(id);
+}
+
+void Directory_watcher_impl::run()
+{
+    const auto max_in_flight {static_cast<std::size_t>(std::max(options_.max_concurrency, 1))};
+
+    std::unique_lock<std::mutex> lock {mutex_};
+    // listings in flight are waited on before stopping, since they queue themselves into this object once completed
+    while (!stopping_ || in_flight_ > 0) {
+        // compare every listing that has been received
+        if (!completed_.empty()) {
+            auto poll {std::move(completed_.front())};
+            completed_.pop_front();
+            --in_flight_;
+            if (!stopping_) {
+                lock.unlock();
+                complete(std::move(poll));
+                lock.lock();
+            }
+            continue;
+        }
+
+        // start every due listing the concurrency limit allows
+        if (!stopping_ && in_flight_ < max_in_flight && !schedule_.empty() &&
+            schedule_.top().first <= std::chrono::steady_clock::now()) {
+            const auto id {schedule_.top().second};
+            schedule_.pop();
+
+            const auto watch {watches_.find(id)};
+            if (watch == watches_.end()) {
+                continue;
+            }
+            ++in_flight_;
+
+            auto started {watch->second};
+            lock.unlock();
+            start(id, std::move(started));
+            lock.lock();
+            continue;
+        }
+
+        // sleep until a listing is received or due, or a watch is added
+        if (!stopping_ && in_flight_ < max_in_flight && !schedule_.empty()) {
+            changed_cv_.wait_until(lock, schedule_.top().first);
+        } else {
+            changed_cv_.wait(lock);
+        }
+    }
+}
+
+void Directory_watcher_impl::start(Watch_id id, std::shared_ptr<Watch> watch)
+{
+    const auto& endpoint {watch->endpoint};
+    const auto& identifier {watch->identifier};
+    auto on_listed {[this, id, watch](std::future<Resource> listing) {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        completed_.push_back(Poll {id, watch, std::move(listing)});
+        // notified while locked since the watcher may be destroyed as soon as its last listing is seen
+        changed_cv_.notify_all();
+    }};
+
+    try {
+        endpoint.list_async(identifier, on_listed);
+    } catch (...) {
+        std::promise<Resource> failed {};
+        failed.set_exception(std::current_exception());
+        on_listed(failed.get_future());
+    }
+}
+
+void Directory_watcher_impl::complete(Poll poll)
+{
+    auto& watch {*poll.watch};
+
+    std::vector<Watch_event> events {};
+    auto changed {false};
+    std::exception_ptr error {};
+    try {
+        changed = watch.differ.update(watch.identifier, poll.listing.get(), events);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    {
+        // callbacks of a watch that was removed while it was being listed are not invoked
+        const std::lock_guard<std::mutex> lock {mutex_};
+        if (watches_.find(poll.id) == watches_.end()) {
+            return;
+        }
+    }
+
+    if (error) {
+        report(watch.on_error, watch.identifier, error);
+    }
+    for (const auto& event : events) {
+        try {
+            watch.on_event(event);
+        } catch (...) {
+            report(watch.on_error, watch.identifier, std::current_exception());
+        }
+    }
+
+    if (changed) {
+        watch.interval = options_.min_interval;
+    } else {
+        const auto grown {std::chrono::duration_cast<std::chrono::milliseconds>(watch.interval *
+                                                                                options_.backoff_factor)};
+        watch.interval = std::clamp(grown, options_.min_interval, std::max(options_.min_interval,
+                                                                           options_.max_interval));
+    }
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    if (watches_.find(poll.id) != watches_.end()) {
+        schedule_.emplace(std::chrono::steady_clock::now() + watch.interval, poll.id);
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
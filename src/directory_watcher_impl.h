@@ -0,0 +1,191 @@
+/**
+ * @file directory_watcher_impl.h
+ * Defines the internal implementation of the service observing changes to directories.
+ */
+
+#ifndef ONEDATASHARE_DIRECTORY_WATCHER_IMPL_H
+#define ONEDATASHARE_DIRECTORY_WATCHER_IMPL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <onedatashare/directory_watcher.h>
+#include <onedatashare/endpoint.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Compares consecutive listings of a directory. Only a fingerprint of each resource's name, size, time, and type is
+ * compared, so each comparison takes time linear in the number of resources.
+ */
+class Listing_differ {
+public:
+    Listing_differ();
+
+    /**
+     * Compares the specified listing against the previous one, keeping it for the next comparison. The first listing
+     * reports no changes.
+     *
+     * @param directory borrowed reference to the path or id of the listed directory
+     * @param listing moved listing of the directory
+     * @param events borrowed reference to the vector each change is appended to
+     *
+     * @return true if the listing differs from the previous one, false otherwise
+     */
+    bool update(const std::string& directory, Resource listing, std::vector<Watch_event>& events);
+
+private:
+    /**
+     * A resource from the previous listing.
+     */
+    struct Entry {
+        /** Fingerprint of the name, size, time, and type of the resource. */
+        std::uint64_t fingerprint;
+
+        /** The resource as it was listed. */
+        Resource resource;
+    };
+
+    /** Resources of the previous listing, by id or name. */
+    std::unordered_map<std::string, Entry> entries_;
+
+    /** If a listing has been compared. */
+    bool initialized_;
+};
+
+/**
+ * Directory_watcher polling every directory from one thread, keeping up to the maximum number of listings in flight.
+ */
+class Directory_watcher_impl : public Directory_watcher {
+public:
+    /**
+     * Creates a new Directory_watcher_impl with the specified options and starts its watching thread.
+     *
+     * @param options borrowed reference to the options controlling how often directories are listed
+     */
+    explicit Directory_watcher_impl(const Directory_watcher_options& options);
+
+    /**
+     * Stops the watching thread, waiting for any callback being invoked to return and for the listings in flight to
+     * complete.
+     */
+    ~Directory_watcher_impl() override;
+
+    Watch_id watch(const Endpoint& endpoint,
+                   const std::string& identifier,
+                   std::function<void(const Watch_event& event)> on_event,
+                   std::function<void(const std::string& identifier, std::exception_ptr error)> on_error) override;
+
+    void unwatch(Watch_id id) override;
+
+private:
+    /**
+     * A watched directory.
+     */
+    struct Watch {
+        /** Endpoint the directory is on. */
+        const Endpoint& endpoint;
+
+        /** Path or id of the directory. */
+        const std::string identifier;
+
+        /** Callback invoked with each change. */
+        const std::function<void(const Watch_event& event)> on_event;
+
+        /** Callback invoked with each failure, or nullptr. */
+        const std::function<void(const std::string& identifier, std::exception_ptr error)> on_error;
+
+        /** Current time between listings, only used by the watching thread. */
+        std::chrono::milliseconds interval;
+
+        /** Comparer of the listings, only used by the watching thread. */
+        Listing_differ differ;
+    };
+
+    /**
+     * A listing that has completed.
+     */
+    struct Poll {
+        /** The id of the watch. */
+        Watch_id id;
+
+        /** The watched directory. */
+        std::shared_ptr<Watch> watch;
+
+        /** The ready listing. */
+        std::future<Resource> listing;
+    };
+
+    /** Time a watch is next due to be listed. */
+    using Due = std::pair<std::chrono::steady_clock::time_point, Watch_id>;
+
+    /**
+     * Runs the watching thread until the watcher is destroyed.
+     */
+    void run();
+
+    /**
+     * Starts listing the specified watched directory, queueing the listing once it completes.
+     *
+     * @param id the id of the watch
+     * @param watch moved pointer to the watched directory
+     */
+    void start(Watch_id id, std::shared_ptr<Watch> watch);
+
+    /**
+     * Compares a completed listing and invokes the callbacks, then schedules the next listing of the directory.
+     *
+     * @param poll moved listing that has completed
+     */
+    void complete(Poll poll);
+
+    /** Options controlling how often directories are listed. */
+    const Directory_watcher_options options_;
+
+    /** Mutex guarding every member below other than the thread. */
+    std::mutex mutex_;
+
+    /** Notified when a watch is added, a listing completes, or the watcher is destroyed. */
+    std::condition_variable changed_cv_;
+
+    /** Watched directories, by id. */
+    std::unordered_map<Watch_id, std::shared_ptr<Watch>> watches_;
+
+    /** When each watch is next due to be listed, soonest first. Unwatched ids are skipped. */
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> schedule_;
+
+    /** Listings that have completed and have not been compared yet, in the order they completed. */
+    std::deque<Poll> completed_;
+
+    /** Number of listings started and not compared yet. */
+    std::size_t in_flight_;
+
+    /** Id of the next watch. */
+    Watch_id next_id_;
+
+    /** If the watcher is being destroyed. */
+    bool stopping_;
+
+    /** The watching thread. */
+    std::thread thread_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_DIRECTORY_WATCHER_IMPL_H
@@ -5,10 +5,14 @@
  * @date 7/20/20
  */
 
+#include <stdexcept>
+
 #include <onedatashare/endpoint.h>
 
-#include "curl_rest.h"
 #include "endpoint_impl.h"
+#include "error_message.h"
+#include "listing_cache_impl.h"
+#include "retry_rest.h"
 #include "util.h"
 
 namespace Onedatashare {
@@ -29,7 +33,26 @@ std::unique_ptr<Endpoint> Endpoint::create(Endpoint_type type,
                                                      cred_id,
                                                      ods_auth_token,
                                                      url,
-                                                     std::make_unique<Internal::Curl_rest>());
+                                                     Internal::Retry_rest::shared());
+}
+
+std::unique_ptr<Endpoint> Endpoint::create(Endpoint_type type,
+                                           const std::string& cred_id,
+                                           const std::string& ods_auth_token,
+                                           const std::string& url,
+                                           std::shared_ptr<Listing_cache> cache)
+{
+    auto cache_impl {std::dynamic_pointer_cast<Internal::Listing_cache_impl>(std::move(cache))};
+    if (!cache_impl) {
+        throw std::invalid_argument(Internal::Err::unknown_listing_cache_msg);
+    }
+
+    return std::make_unique<Internal::Endpoint_impl>(type,
+                                                     cred_id,
+                                                     ods_auth_token,
+                                                     url,
+                                                     Internal::Retry_rest::shared(),
+                                                     std::move(cache_impl));
 }
 
 Endpoint::Endpoint() = default;
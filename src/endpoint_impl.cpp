@@ -5,8 +5,16 @@
  * @date 7/20/20
  */
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
-#include <sstream>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -14,9 +22,15 @@
 
 #include <onedatashare/ods_error.h>
 
+#include "chunked_upload.h"
 #include "endpoint_impl.h"
 #include "error_message.h"
+#include "json_parser_pool.h"
+#include "json_writer.h"
 #include "ods_rest_api.h"
+#include "ranged_download.h"
+#include "single_flight.h"
+#include "stat_parser.h"
 #include "util.h"
 
 namespace Onedatashare {
@@ -24,6 +38,24 @@ namespace Internal {
 
 namespace {
 
+/** Characters reserved for the field names and punctuation of an operation json object. */
+constexpr std::size_t operation_overhead {80};
+
+/** Header holding the ETag of a cached listing when revalidating it. */
+constexpr auto header_if_none_match {"If-None-Match"};
+
+/** Header holding the Last-Modified time of a cached listing when revalidating it. */
+constexpr auto header_if_modified_since {"If-Modified-Since"};
+
+/** Header holding the validator of a listing to use when revalidating it. */
+constexpr auto header_etag {"ETag"};
+
+/** Header holding the time a listing was last modified to use when revalidating it. */
+constexpr auto header_last_modified {"Last-Modified"};
+
+/** Status code indicating that a revalidated listing is unchanged. */
+constexpr auto status_not_modified {304};
+
 /**
  * Gets the list api path for the sepcified type.
  *
@@ -157,41 +189,36 @@ std::string select_download_path(Endpoint_type type)
 }
 
 /**
- * Creates a Resource object containing the data stored in the specified Stat json object. It is expected that the
- * specified dom conforms to the Stat object specifications.
+ * Gets the upload api path for the specified type.
  *
- * @param obj borrowed reference to the dom containing the Stat json object to parse
+ * @param type endpoint to get the api path for
  *
- * @return the Resource created from parsing the specified dom
+ * @return the api path
  *
- * @throw simdjson_error if simdjson encounters an error parsing the dom
+ * @exception invalid_argument if passed an invalid Endpoint_type value
  */
-Resource create_resource(const simdjson::dom::object& obj)
-{
-    // recursively add contained resoruces
-    std::vector<Resource> contained {};
-    auto files {obj[Api::stat_files]};
-    if (!files.error()) {
-        for (const auto& r : files.value()) {
-            // propogate up simdjson_error if thrown
-            contained.push_back(create_resource(r.get_object().value()));
-        }
+std::string select_upload_path(Endpoint_type type)
+{
+    switch (type) {
+    case Endpoint_type::dropbox:
+        return Api::dropbox_upload_path;
+    case Endpoint_type::google_drive:
+        return Api::google_drive_upload_path;
+    case Endpoint_type::sftp:
+        return Api::sftp_upload_path;
+    case Endpoint_type::ftp:
+        return Api::ftp_upload_path;
+    case Endpoint_type::box:
+        return Api::box_upload_path;
+    case Endpoint_type::s3:
+        return Api::s3_upload_path;
+    case Endpoint_type::gftp:
+        return Api::gftp_upload_path;
+    case Endpoint_type::http:
+        return Api::http_upload_path;
     }
 
-    auto id {obj[Api::stat_id]};
-    auto link {obj[Api::stat_link]};
-    auto permissions {obj[Api::stat_permissions]};
-
-    // if simdjson_error is thrown, the dom must not meet the specification, so propogate the exception
-    return {id.error() ? std::nullopt : std::optional {id.get_c_str().value()},
-            obj[Api::stat_name].get_c_str().value(),
-            obj[Api::stat_size].get_int64().value(),
-            obj[Api::stat_time].get_int64().value(),
-            obj[Api::stat_dir].get_bool().value(),
-            obj[Api::stat_file].get_bool().value(),
-            link.error() ? std::nullopt : std::optional {link.get_c_str().value()},
-            permissions.error() ? std::nullopt : std::optional {permissions.get_c_str().value()},
-            files.error() ? std::nullopt : std::optional {contained}};
+    throw std::invalid_argument(Err::unknown_enum_msg);
 }
 
 /**
@@ -209,13 +236,18 @@ std::string create_delete_operation(const std::string& cred_id,
                                     const std::string& id,
                                     const std::string& to_delete)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::delete_operation_cred_id << "\":\"" << Util::escape_json(cred_id) << "\",\""
-           << Api::delete_operation_path << "\":\"" << Util::escape_json(path) << "\",\"" << Api::delete_operation_id
-           << "\":\"" << Util::escape_json(id) << "\",\"" << Api::delete_operation_to_delete << "\":\""
-           << Util::escape_json(to_delete) << "\"}";
-
-    return stream.str();
+    std::string json {};
+    json.reserve(operation_overhead + cred_id.size() + path.size() + id.size() + to_delete.size());
+
+    Json_writer writer {json};
+    writer.begin_object();
+    writer.field<Api::delete_operation_cred_id>(cred_id);
+    writer.field<Api::delete_operation_path>(path);
+    writer.field<Api::delete_operation_id>(id);
+    writer.field<Api::delete_operation_to_delete>(to_delete);
+    writer.end_object();
+
+    return json;
 }
 
 /**
@@ -233,13 +265,18 @@ std::string create_mkdir_operation(const std::string& cred_id,
                                    const std::string& id,
                                    const std::string& folder_to_create)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::mkdir_operation_cred_id << "\":\"" << Util::escape_json(cred_id) << "\",\""
-           << Api::mkdir_operation_path << "\":\"" << Util::escape_json(path) << "\",\"" << Api::mkdir_operation_id
-           << "\":\"" << Util::escape_json(id) << "\",\"" << Api::mkdir_operation_folder_to_create << "\":\""
-           << Util::escape_json(folder_to_create) << "\"}";
-
-    return stream.str();
+    std::string json {};
+    json.reserve(operation_overhead + cred_id.size() + path.size() + id.size() + folder_to_create.size());
+
+    Json_writer writer {json};
+    writer.begin_object();
+    writer.field<Api::mkdir_operation_cred_id>(cred_id);
+    writer.field<Api::mkdir_operation_path>(path);
+    writer.field<Api::mkdir_operation_id>(id);
+    writer.field<Api::mkdir_operation_folder_to_create>(folder_to_create);
+    writer.end_object();
+
+    return json;
 }
 
 /**
@@ -257,13 +294,225 @@ std::string create_download_operation(const std::string& cred_id,
                                       const std::string& id,
                                       const std::string& file_to_download)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::download_operation_cred_id << "\":\"" << Util::escape_json(cred_id) << "\",\""
-           << Api::download_operation_path << "\":\"" << Util::escape_json(path) << "\",\""
-           << Api::download_operation_id << "\":\"" << Util::escape_json(id) << "\",\""
-           << Api::download_operation_file_to_download << "\":\"" << Util::escape_json(file_to_download) << "\"}";
+    std::string json {};
+    json.reserve(operation_overhead + cred_id.size() + path.size() + id.size() + file_to_download.size());
+
+    Json_writer writer {json};
+    writer.begin_object();
+    writer.field<Api::download_operation_cred_id>(cred_id);
+    writer.field<Api::download_operation_path>(path);
+    writer.field<Api::download_operation_id>(id);
+    writer.field<Api::download_operation_file_to_download>(file_to_download);
+    writer.end_object();
+
+    return json;
+}
+
+/**
+ * Checks that the specified Resource created from a list response meets the guarantees of list.
+ *
+ * @param resource borrowed reference to the Resource to check
+ * @param type the type of endpoint the response was received from
+ * @param status the status code of the response
+ *
+ * @exception Unexpected_response_error if the Resource does not meet the guarantees of list
+ */
+void check_listed_resource(const Resource& resource, Endpoint_type type, int status)
+{
+    if (!resource.contained_resources && resource.is_directory) {
+        throw Unexpected_response_error {Err::expect_resources_msg, status};
+    }
+
+    if (!resource.id && (type == Endpoint_type::box || type == Endpoint_type::google_drive)) {
+        throw Unexpected_response_error {Err::expect_id_msg, status};
+    }
+}
+
+/**
+ * Creates the Resource object from the response to a list REST API call.
+ *
+ * @param response borrowed reference to the response to parse
+ * @param type the type of endpoint the response was received from
+ *
+ * @return the created Resource
+ *
+ * @exception Unexpected_response_error if the response is not a successful list response
+ */
+Resource parse_list_response(const Response& response, Endpoint_type type)
+{
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
+    }
+
+    const auto parser {Json_parser_pool::shared().acquire()};
+    auto [obj, err] {parse_body(*parser, response).get_object()};
+
+    if (err) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status()};
+    }
+
+    Resource resource {};
+    try {
+        resource = create_resource(obj);
+    } catch (simdjson::simdjson_error e) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status()};
+    }
+    check_listed_resource(resource, type, response.status());
+
+    return resource;
+}
+
+/**
+ * Checks that the specified response has a 200 status code.
+ *
+ * @param response borrowed reference to the response to check
+ *
+ * @exception Unexpected_response_error if the response does not have a 200 status code
+ */
+void expect_200(const Response& response)
+{
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
+    }
+}
+
+/**
+ * Creates the headers of a request revalidating the specified cached listing.
+ *
+ * @param headers borrowed reference to the headers used in every REST API call
+ * @param lookup borrowed reference to the lookup that found the expired listing
+ *
+ * @return the headers with the validators of the listing added
+ */
+std::unordered_multimap<std::string, std::string> conditional_headers(
+    const std::unordered_multimap<std::string, std::string>& headers,
+    const Listing_cache_impl::Lookup& lookup)
+{
+    auto conditional {headers};
+    if (lookup.etag) {
+        conditional.emplace(header_if_none_match, *lookup.etag);
+    }
+    if (lookup.last_modified) {
+        conditional.emplace(header_if_modified_since, *lookup.last_modified);
+    }
+
+    return conditional;
+}
+
+/**
+ * Creates the Resource object from the response to a list REST API call made through the specified cache, reusing
+ * the cached listing if OneDataShare confirmed it is unchanged and caching the received listing otherwise.
+ *
+ * @param cache borrowed reference to the cache of listings
+ * @param type the type of endpoint the response was received from
+ * @param cred_id borrowed reference to the credential id of the endpoint
+ * @param identifier borrowed reference to the path or id of the listed resource
+ * @param lookup borrowed reference to the lookup made before the list REST API call
+ * @param response borrowed reference to the response to parse
+ *
+ * @return the created Resource
+ *
+ * @exception Unexpected_response_error if the response is not a successful list response
+ */
+Resource resolve_cached_listing(Listing_cache_impl& cache,
+                                Endpoint_type type,
+                                const std::string& cred_id,
+                                const std::string& identifier,
+                                const Listing_cache_impl::Lookup& lookup,
+                                const Response& response)
+{
+    if (response.status() == status_not_modified && lookup.resource) {
+        cache.refresh(type, cred_id, identifier, lookup);
+        return *lookup.resource;
+    }
+
+    const auto to_string {[](std::optional<std::string_view> header) {
+        return header ? std::optional<std::string> {*header} : std::nullopt;
+    }};
+
+    auto resource {std::make_shared<const Resource>(parse_list_response(response, type))};
+    cache.store(type,
+                cred_id,
+                identifier,
+                resource,
+                to_string(response.header(header_etag)),
+                to_string(response.header(header_last_modified)),
+                lookup.generation);
+
+    return *resource;
+}
+
+/**
+ * Discards the cached listings affected by creating or removing a resource within a directory.
+ *
+ * @param cache borrowed reference to the pointer to the cache of listings, which may be nullptr
+ * @param type the type of endpoint the resource is on
+ * @param cred_id borrowed reference to the credential id of the endpoint
+ * @param identifier borrowed reference to the path or id of the directory
+ * @param changed borrowed reference to the name or id of the created or removed resource
+ */
+void invalidate_listings(const std::shared_ptr<Listing_cache_impl>& cache,
+                         Endpoint_type type,
+                         const std::string& cred_id,
+                         const std::string& identifier,
+                         const std::string& changed)
+{
+    if (!cache) {
+        return;
+    }
+
+    cache->invalidate(type, cred_id, identifier);
+    if (Util::uses_ids(type)) {
+        cache->invalidate(type, cred_id, changed);
+    } else {
+        // a removed directory takes every listing beneath it along with it
+        cache->invalidate_tree(type, cred_id, Util::join_path(identifier, changed));
+    }
+}
+
+/**
+ * Creates a Response_callback that discards the cached listings affected by an operation once it completes, whether
+ * or not it succeeded, then fulfills the specified promise like fulfill with expect_200 does. Listings are discarded
+ * even when the response is an exception, since OneDataShare may have applied the operation before the failure.
+ *
+ * @param promise shared pointer to the promise to fulfill
+ * @param cache shared pointer to the cache of listings, which may be nullptr
+ * @param type the type of endpoint the resource is on
+ * @param cred_id the credential id of the endpoint
+ * @param identifier the path or id of the directory
+ * @param changed the name or id of the created or removed resource
+ *
+ * @return the created callback
+ */
+Response_callback invalidate_then_expect_200(std::shared_ptr<std::promise<void>> promise,
+                                             std::shared_ptr<Listing_cache_impl> cache,
+                                             Endpoint_type type,
+                                             std::string cred_id,
+                                             std::string identifier,
+                                             std::string changed)
+{
+    auto expect {fulfill(std::move(promise), expect_200)};
+    return [expect {std::move(expect)},
+            cache {std::move(cache)},
+            type,
+            cred_id {std::move(cred_id)},
+            identifier {std::move(identifier)},
+            changed {std::move(changed)}](std::future<Response> response) {
+        invalidate_listings(cache, type, cred_id, identifier, changed);
+        expect(std::move(response));
+    };
+}
 
-    return stream.str();
+/**
+ * Gets the listings in flight across every Endpoint_impl, so that identical listings requested at once by many
+ * threads, through one Endpoint_impl or many, go to OneDataShare once.
+ *
+ * @return borrowed reference to the listings in flight
+ */
+Single_flight<Resource>& listings_in_flight()
+{
+    static Single_flight<Resource> flights {};
+    return flights;
 }
 
 } // namespace
@@ -272,87 +521,370 @@ Endpoint_impl::Endpoint_impl(Endpoint_type type,
                              const std::string& cred_id,
                              const std::string& ods_auth_token,
                              const std::string& ods_url,
-                             std::unique_ptr<Rest> rest_caller)
+                             std::shared_ptr<Rest> rest_caller,
+                             std::shared_ptr<Listing_cache_impl> cache)
     : type_ {type},
       cred_id_ {cred_id},
       ods_url_ {ods_url},
       rest_caller_ {std::move(rest_caller)},
-      headers_ {Util::create_headers(ods_auth_token)}
+      headers_ {Util::create_headers(ods_auth_token)},
+      cache_ {std::move(cache)}
 {}
 
+Endpoint_type Endpoint_impl::type() const
+{
+    return type_;
+}
+
+const std::string& Endpoint_impl::cred_id() const
+{
+    return cred_id_;
+}
+
 Resource Endpoint_impl::list(const std::string& identifier) const
 {
-    // if get throws an expcetion, propagate it up
-    const auto response {rest_caller_->get(ods_url_ + select_list_path(type_) + "?" + Api::get_ls_cred_id_param + "=" +
-                                               cred_id_ + "&" + Api::get_ls_path_param + "=" + identifier + "&" +
-                                               Api::get_ls_identifier_param + "=" + identifier,
-                                           headers_)};
+    const auto url {list_url(identifier)};
+    if (!cache_) {
+        return listings_in_flight().run(request_key(url, headers_), [&] {
+            // if get throws an expcetion, propagate it up
+            return parse_list_response(rest_caller_->get(url, headers_), type_);
+        });
+    }
 
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+    const auto lookup {cache_->lookup(type_, cred_id_, identifier)};
+    if (lookup.fresh) {
+        return *lookup.resource;
     }
 
-    simdjson::dom::parser parser {};
-    auto [obj, err] {parser.parse(response.body).get_object()};
+    // only callers sharing a cache share a revalidation, so that the listing is stored in every cache that lacks it
+    const auto key {request_key(url, headers_) + "\ncache " +
+                    std::to_string(reinterpret_cast<std::uintptr_t>(cache_.get()))};
+    return listings_in_flight().run(key, [&] {
+        // if get throws an expcetion, propagate it up
+        const auto response {rest_caller_->get(url, conditional_headers(headers_, lookup))};
+        return resolve_cached_listing(*cache_, type_, cred_id_, identifier, lookup, response);
+    });
+}
 
-    if (err) {
-        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status};
+Resource Endpoint_impl::list_stream(const std::string& identifier,
+                                    const std::function<void(Resource)>& on_resource) const
+{
+    const std::function<void(const simdjson::dom::object&)> on_entry {
+        [&on_resource](const simdjson::dom::object& obj) { on_resource(create_resource(obj)); }};
+
+    return list_entries(identifier, on_entry);
+}
+
+Resource Endpoint_impl::list_table(const std::string& identifier, Resource_table& contained) const
+{
+    const std::function<void(const simdjson::dom::object&)> on_entry {
+        [&contained](const simdjson::dom::object& obj) { add_resource(obj, contained); }};
+
+    return list_entries(identifier, on_entry);
+}
+
+void Endpoint_impl::remove(const std::string& identifier, const std::string& to_delete) const
+{
+    // invalidate before and after so that no listing received while removing stays cached, even if the request fails
+    // after OneDataShare has already removed the resource
+    invalidate_listings(cache_, type_, cred_id_, identifier, to_delete);
+
+    // if post throws an expcetion, propagate it up
+    try {
+        expect_200(rest_caller_->post(ods_url_ + select_rm_path(type_),
+                                      headers_,
+                                      create_delete_operation(cred_id_, identifier, identifier, to_delete)));
+    } catch (...) {
+        invalidate_listings(cache_, type_, cred_id_, identifier, to_delete);
+        throw;
     }
+    invalidate_listings(cache_, type_, cred_id_, identifier, to_delete);
+}
 
-    Resource resource {};
+void Endpoint_impl::mkdir(const std::string& identifier, const std::string& folder_to_create) const
+{
+    // invalidate before and after so that no listing received while creating stays cached, even if the request fails
+    // after OneDataShare has already created the directory
+    invalidate_listings(cache_, type_, cred_id_, identifier, folder_to_create);
+
+    // if post throws an expcetion, propagate it up
     try {
-        resource = create_resource(obj);
-    } catch (simdjson::simdjson_error e) {
-        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status};
+        expect_200(rest_caller_->post(ods_url_ + select_mkdir_path(type_),
+                                      headers_,
+                                      create_mkdir_operation(cred_id_, identifier, identifier, folder_to_create)));
+    } catch (...) {
+        invalidate_listings(cache_, type_, cred_id_, identifier, folder_to_create);
+        throw;
     }
+    invalidate_listings(cache_, type_, cred_id_, identifier, folder_to_create);
+}
 
-    if (!resource.contained_resources && resource.is_directory) {
-        throw Unexpected_response_error {Err::expect_resources_msg, response.status};
+void Endpoint_impl::download(const std::string& identifier, const std::string& file_to_download) const
+{
+    // if post throws an expcetion, propagate it up
+    expect_200(rest_caller_->post(ods_url_ + select_download_path(type_),
+                                  headers_,
+                                  create_download_operation(cred_id_, identifier, identifier, file_to_download)));
+}
+
+Download_result Endpoint_impl::download_file(const std::string& identifier,
+                                             const std::string& file_to_download,
+                                             const std::string& local_path,
+                                             const Download_options& options) const
+{
+    const auto escaped_identifier {Util::escape_url(identifier)};
+    const auto url {ods_url_ + select_download_path(type_) + "?" + Api::get_download_cred_id_param + "=" +
+                    Util::escape_url(cred_id_) + "&" + Api::get_download_path_param + "=" + escaped_identifier + "&" +
+                    Api::get_download_id_param + "=" + escaped_identifier + "&" + Api::get_download_file_param + "=" +
+                    Util::escape_url(file_to_download)};
+    return ranged_download(*rest_caller_, url, headers_, local_path, options);
+}
+
+void Endpoint_impl::upload(const std::string& identifier,
+                           const std::string& local_path,
+                           const Upload_options& options) const
+{
+    const auto file_name {local_path.substr(local_path.find_last_of('/') + 1)};
+    const auto escaped_identifier {Util::escape_url(identifier)};
+    const auto url {ods_url_ + select_upload_path(type_) + "?" + Api::post_upload_cred_id_param + "=" +
+                    Util::escape_url(cred_id_) + "&" + Api::post_upload_path_param + "=" + escaped_identifier + "&" +
+                    Api::post_upload_id_param + "=" + escaped_identifier + "&" + Api::post_upload_file_name_param +
+                    "=" + Util::escape_url(file_name)};
+
+    // invalidate before and after so that no listing received while uploading stays cached, even if the upload fails
+    // after some of its parts have already created the file
+    invalidate_listings(cache_, type_, cred_id_, identifier, file_name);
+    try {
+        chunked_upload(*rest_caller_, url, headers_, local_path, options);
+    } catch (...) {
+        invalidate_listings(cache_, type_, cred_id_, identifier, file_name);
+        throw;
     }
+    invalidate_listings(cache_, type_, cred_id_, identifier, file_name);
+}
+
+void Endpoint_impl::list_recursive(
+    const std::string& root,
+    const List_recursive_options& options,
+    const std::function<void(const std::string& identifier, int depth, const Resource& directory)>& on_directory)
+    const
+{
+    /** A listing whose request has completed. */
+    struct Completed_listing {
+        std::string identifier;
+        int depth;
+        std::future<Response> response;
+    };
+
+    // directories waiting to be listed, in the order they were found
+    std::deque<std::pair<std::string, int>> pending {{root, 0}};
+    // completed listings are handed from the rest caller's thread to this one
+    std::mutex mutex {};
+    std::condition_variable completed_cv {};
+    std::deque<Completed_listing> completed {};
+
+    const auto max_in_flight {static_cast<std::size_t>(std::max(options.max_concurrency, 1))};
+    std::size_t in_flight {0};
+    std::exception_ptr error {};
+
+    while (true) {
+        while (!error && !pending.empty() && in_flight < max_in_flight) {
+            auto [identifier, depth] {std::move(pending.front())};
+            pending.pop_front();
+
+            const auto url {list_url(identifier)};
+            try {
+                // the callback touches only state that outlives every request, since every request is waited on
+                rest_caller_->get_async(url,
+                                        headers_,
+                                        [&mutex, &completed_cv, &completed, identifier {std::move(identifier)}, depth](
+                                            std::future<Response> response) mutable {
+                                            const std::lock_guard<std::mutex> lock {mutex};
+                                            completed.push_back({std::move(identifier), depth, std::move(response)});
+                                            completed_cv.notify_one();
+                                        });
+                ++in_flight;
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        if (in_flight == 0) {
+            break;
+        }
 
-    if (!resource.id && (type_ == Endpoint_type::box || type_ == Endpoint_type::google_drive)) {
-        throw Unexpected_response_error {Err::expect_id_msg, response.status};
+        std::unique_lock<std::mutex> lock {mutex};
+        completed_cv.wait(lock, [&completed] { return !completed.empty(); });
+        auto listing {std::move(completed.front())};
+        completed.pop_front();
+        lock.unlock();
+        --in_flight;
+
+        if (error) {
+            // wait for the remaining listings without starting new ones
+            continue;
+        }
+
+        try {
+            const auto response {listing.response.get()};
+            const auto resource {parse_list_response(response, type_)};
+            on_directory(listing.identifier, listing.depth, resource);
+
+            if (resource.contained_resources && listing.depth < options.max_depth) {
+                for (const auto& contained : *resource.contained_resources) {
+                    if (contained.is_directory && !contained.link) {
+                        pending.emplace_back(
+                            Util::child_identifier(type_, listing.identifier, contained, response.status()),
+                            listing.depth + 1);
+                    }
+                }
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
     }
 
-    return resource;
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-void Endpoint_impl::remove(const std::string& identifier, const std::string& to_delete) const
+std::future<Resource> Endpoint_impl::list_async(const std::string& identifier) const
 {
-    // if post throws an expcetion, propagate it up
-    const auto response {rest_caller_->post(ods_url_ + select_rm_path(type_),
-                                            headers_,
-                                            create_delete_operation(cred_id_, identifier, identifier, to_delete))};
+    auto promise {std::make_shared<std::promise<Resource>>()};
+    auto future {promise->get_future()};
+    list_async(identifier, [promise {std::move(promise)}](std::future<Resource> listing) {
+        try {
+            promise->set_value(listing.get());
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
 
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
-    }
+    return future;
 }
 
-void Endpoint_impl::mkdir(const std::string& identifier, const std::string& folder_to_create) const
+void Endpoint_impl::list_async(const std::string& identifier,
+                               std::function<void(std::future<Resource> listing)> on_listed) const
 {
-    // if post throws an expcetion, propagate it up
-    const auto response {
-        rest_caller_->post(ods_url_ + select_mkdir_path(type_),
-                           headers_,
-                           create_mkdir_operation(cred_id_, identifier, identifier, folder_to_create))};
+    if (cache_) {
+        auto lookup {cache_->lookup(type_, cred_id_, identifier)};
+        if (lookup.fresh) {
+            std::promise<Resource> cached {};
+            cached.set_value(*lookup.resource);
+            on_listed(cached.get_future());
+            return;
+        }
 
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+        const auto headers {conditional_headers(headers_, lookup)};
+        rest_caller_->get_async(list_url(identifier),
+                                headers,
+                                deliver(std::move(on_listed),
+                                        [cache {cache_},
+                                         type {type_},
+                                         cred_id {cred_id_},
+                                         identifier,
+                                         lookup {std::move(lookup)}](const Response& response) {
+                                            return resolve_cached_listing(
+                                                *cache, type, cred_id, identifier, lookup, response);
+                                        }));
+        return;
     }
+
+    rest_caller_->get_async(list_url(identifier),
+                            headers_,
+                            deliver(std::move(on_listed), [type {type_}](const Response& response) {
+                                return parse_list_response(response, type);
+                            }));
 }
 
-void Endpoint_impl::download(const std::string& identifier, const std::string& file_to_download) const
+std::future<void> Endpoint_impl::remove_async(const std::string& identifier, const std::string& to_delete) const
 {
-    // if post throws an expcetion, propagate it up
-    const auto response {
-        rest_caller_->post(ods_url_ + select_download_path(type_),
-                           headers_,
-                           create_download_operation(cred_id_, identifier, identifier, file_to_download))};
+    invalidate_listings(cache_, type_, cred_id_, identifier, to_delete);
+
+    auto promise {std::make_shared<std::promise<void>>()};
+    auto future {promise->get_future()};
+    rest_caller_->post_async(
+        ods_url_ + select_rm_path(type_),
+        headers_,
+        create_delete_operation(cred_id_, identifier, identifier, to_delete),
+        invalidate_then_expect_200(std::move(promise), cache_, type_, cred_id_, identifier, to_delete));
+
+    return future;
+}
+
+std::future<void> Endpoint_impl::mkdir_async(const std::string& identifier,
+                                             const std::string& folder_to_create) const
+{
+    invalidate_listings(cache_, type_, cred_id_, identifier, folder_to_create);
+
+    auto promise {std::make_shared<std::promise<void>>()};
+    auto future {promise->get_future()};
+    rest_caller_->post_async(
+        ods_url_ + select_mkdir_path(type_),
+        headers_,
+        create_mkdir_operation(cred_id_, identifier, identifier, folder_to_create),
+        invalidate_then_expect_200(std::move(promise), cache_, type_, cred_id_, identifier, folder_to_create));
+
+    return future;
+}
 
-    if (response.status != 200) {
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+std::future<void> Endpoint_impl::download_async(const std::string& identifier,
+                                                const std::string& file_to_download) const
+{
+    auto promise {std::make_shared<std::promise<void>>()};
+    auto future {promise->get_future()};
+    rest_caller_->post_async(ods_url_ + select_download_path(type_),
+                             headers_,
+                             create_download_operation(cred_id_, identifier, identifier, file_to_download),
+                             fulfill(std::move(promise), expect_200));
+
+    return future;
+}
+
+std::string Endpoint_impl::list_url(const std::string& identifier) const
+{
+    const auto escaped_identifier {Util::escape_url(identifier)};
+    return ods_url_ + select_list_path(type_) + "?" + Api::get_ls_cred_id_param + "=" + Util::escape_url(cred_id_) +
+           "&" + Api::get_ls_path_param + "=" + escaped_identifier + "&" + Api::get_ls_identifier_param + "=" +
+           escaped_identifier;
+}
+
+Resource Endpoint_impl::list_entries(const std::string& identifier,
+                                     const std::function<void(const simdjson::dom::object&)>& on_entry) const
+{
+    // the body is received on the thread completing requests and parsed on the calling thread, so that a slow or
+    // blocking callback only pauses this request instead of every request sharing that thread
+    expect_blocking_allowed();
+    Handoff_sink handoff {};
+    auto promise {std::make_shared<std::promise<Response>>()};
+    auto received {promise->get_future()};
+    rest_caller_->get_async(list_url(identifier),
+                            headers_,
+                            handoff,
+                            [promise {std::move(promise)}, &handoff](std::future<Response> response) {
+                                try {
+                                    promise->set_value(response.get());
+                                } catch (...) {
+                                    promise->set_exception(std::current_exception());
+                                }
+                                handoff.close();
+                            });
+
+    // if the callback throws an exception, propagate it up once the request has been aborted
+    Stat_stream_sink sink {on_entry};
+    handoff.drain_into(sink);
+
+    // if get throws an expcetion, propagate it up
+    const auto response {received.get()};
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
     }
+
+    auto resource {sink.finish()};
+    check_listed_resource(resource, type_, response.status());
+
+    return resource;
 }
 
 } // namespace Internal
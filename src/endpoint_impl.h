@@ -9,13 +9,18 @@
 #ifndef ONEDATASHARE_ENDPOINT_IMPL_H
 #define ONEDATASHARE_ENDPOINT_IMPL_H
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include <simdjson/simdjson.h>
+
 #include <onedatashare/endpoint.h>
 #include <onedatashare/endpoint_type.h>
 
+#include "listing_cache_impl.h"
 #include "rest.h"
 
 namespace Onedatashare {
@@ -34,13 +39,19 @@ public:
      * @param cred_id borrowed reference to the credential id of the endpoint to use
      * @param ods_auth_token borrowed reference to the OneDataShare authentication token to use
      * @param ods_url borrowed reference to the url that OneDataShare is running on
-     * @param rest_caller moved pointer to the object to use for making REST API calls
+     * @param rest_caller shared pointer to the object to use for making REST API calls
+     * @param cache shared pointer to the cache of listings to use, or nullptr to list without caching
      */
     Endpoint_impl(Endpoint_type type,
                   const std::string& cred_id,
                   const std::string& ods_auth_token,
                   const std::string& ods_url,
-                  std::unique_ptr<Rest> rest_caller);
+                  std::shared_ptr<Rest> rest_caller,
+                  std::shared_ptr<Listing_cache_impl> cache = nullptr);
+
+    Endpoint_type type() const override;
+
+    const std::string& cred_id() const override;
 
     /**
      * Makes a REST API call to create the Resource object corresponding to the specified resource.
@@ -55,6 +66,56 @@ public:
      */
     Resource list(const std::string& identifier) const override;
 
+    /**
+     * Makes a REST API call to list the specified resource, passing each contained resource to the specified callback
+     * as soon as it is parsed from the response body.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param on_resource borrowed reference to the callback invoked with each contained resource
+     *
+     * @return the created Resource, whose list of contained resources is empty if the Resource is a directory
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    Resource list_stream(const std::string& identifier,
+                         const std::function<void(Resource)>& on_resource) const override;
+
+    /**
+     * Makes a REST API call to list the specified resource, adding each contained resource to the specified table as
+     * soon as it is parsed from the response body.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param contained borrowed reference to the table the contained resources are added to
+     *
+     * @return the created Resource, whose list of contained resources is empty if the Resource is a directory
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    Resource list_table(const std::string& identifier, Resource_table& contained) const override;
+
+    /**
+     * Makes REST API calls to list the specified resource and every directory beneath it, keeping up to the maximum
+     * number of listings in flight through the asynchronous interface of the rest caller.
+     *
+     * @param root borrowed reference to the path or id, dependending on the endpoint type, that the endpoint needs in
+     * order to locate the resource to start from
+     * @param options borrowed reference to the options controlling the walk
+     * @param on_directory borrowed reference to the callback invoked with the path or id, depth, and Resource of
+     * each listed resource
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    void list_recursive(
+        const std::string& root,
+        const List_recursive_options& options,
+        const std::function<void(const std::string& identifier, int depth, const Resource& directory)>& on_directory)
+        const override;
+
     /**
      * Makes a REST API call to remove the specified resource.
      *
@@ -93,7 +154,128 @@ public:
      */
     void download(const std::string& identifier, const std::string& file_to_download) const override;
 
+    /**
+     * Makes ranged REST API calls to download the contents of the specified file to the specified local path.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to download
+     * @param file_to_download borrowed reference to the name or id depending on the endpoint type, that the
+     * endpoint needs in order to locate the file to download from within the specified directory
+     * @param local_path borrowed reference to the path of the local file to write
+     * @param options borrowed reference to the options controlling how the file is fetched
+     *
+     * @return the size of the file and its checksum, if requested
+     *
+     * @exception Connection_error if unable to connect to OneDataShare or unable to write the local file
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare or the checksum
+     * does not match the expected digest
+     */
+    Download_result download_file(const std::string& identifier,
+                                  const std::string& file_to_download,
+                                  const std::string& local_path,
+                                  const Download_options& options) const override;
+
+    /**
+     * Makes REST API calls sending the parts of the specified local file concurrently.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory to upload the file into
+     * @param local_path borrowed reference to the path of the local file to upload
+     * @param options borrowed reference to the options controlling how the file is sent
+     *
+     * @exception Connection_error if unable to connect to OneDataShare or unable to read the local file
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    void upload(const std::string& identifier,
+                const std::string& local_path,
+                const Upload_options& options) const override;
+
+    /**
+     * Starts a REST API call to create the Resource object corresponding to the specified resource.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     *
+     * @return future holding the created Resource, or the Connection_error or Unexpected_response_error raised
+     */
+    std::future<Resource> list_async(const std::string& identifier) const override;
+
+    /**
+     * Starts a REST API call to create the Resource object corresponding to the specified resource, invoking the
+     * specified callback once the call completes.
+     *
+     * @param identifier borrowed reference to the path or id, dependending on the endpoint type, that the endpoint
+     * needs in order to locate the resource
+     * @param on_listed moved callback invoked with a ready future holding the created Resource, or the
+     * Connection_error or Unexpected_response_error raised
+     */
+    void list_async(const std::string& identifier,
+                    std::function<void(std::future<Resource> listing)> on_listed) const override;
+
+    /**
+     * Starts a REST API call to remove the specified resource.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to remove
+     * @param to_delete borrowed reference to the name or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the resource to remove from within the specified directory
+     *
+     * @return future that becomes ready once the call completes, or holds the Connection_error or
+     * Unexpected_response_error raised
+     */
+    std::future<void> remove_async(const std::string& identifier, const std::string& to_delete) const override;
+
+    /**
+     * Starts a REST API call to create a directory with the specified name.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory to create the new directory under
+     * @param folder_to_create borrowed reference to the name of the directory to create
+     *
+     * @return future that becomes ready once the call completes, or holds the Connection_error or
+     * Unexpected_response_error raised
+     */
+    std::future<void> mkdir_async(const std::string& identifier, const std::string& folder_to_create) const override;
+
+    /**
+     * Starts a REST API call to download the specified file.
+     *
+     * @param identifier borrowed reference to the path or id, depending on the endpoint type, that the endpoint
+     * needs in order to locate the directory containing the resource to download
+     * @param file_to_download borrowed reference to the name or id depending on the endpoint type, that the
+     * endpoint needs in order to locate the file to download from within the specified directory
+     *
+     * @return future that becomes ready once the call completes, or holds the Connection_error or
+     * Unexpected_response_error raised
+     */
+    std::future<void> download_async(const std::string& identifier,
+                                     const std::string& file_to_download) const override;
+
 private:
+    /**
+     * Creates the url of the REST API call listing the specified resource.
+     *
+     * @param identifier borrowed reference to the path or id of the resource to list
+     *
+     * @return the url to make the GET request to
+     */
+    std::string list_url(const std::string& identifier) const;
+
+    /**
+     * Makes a REST API call to list the specified resource, passing the dom of each contained Stat object to the
+     * specified callback.
+     *
+     * @param identifier borrowed reference to the path or id of the resource to list
+     * @param on_entry borrowed reference to the callback invoked with each contained Stat object
+     *
+     * @return the created Resource, whose list of contained resources is empty if the Resource is a directory
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    Resource list_entries(const std::string& identifier,
+                          const std::function<void(const simdjson::dom::object&)>& on_entry) const;
+
     /** Type of the endpoint used in REST API calls. */
     const Endpoint_type type_;
 
@@ -104,10 +286,13 @@ private:
     const std::string ods_url_;
 
     /** Pointer to the object used to make REST API calls. */
-    const std::unique_ptr<Rest> rest_caller_;
+    const std::shared_ptr<Rest> rest_caller_;
 
     /** Headers used in REST API calls. */
     const std::unordered_multimap<std::string, std::string> headers_;
+
+    /** Pointer to the cache of listings, or nullptr if listings are not cached. */
+    const std::shared_ptr<Listing_cache_impl> cache_;
 };
 
 } // namespace Internal
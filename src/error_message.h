@@ -25,6 +25,9 @@ constexpr auto expect_200_msg {"Expected a 200 response code"};
 /** Error message when using an undefined value of an enumeration. */
 constexpr auto unknown_enum_msg {"Unknown enumeration type"};
 
+/** Error message when a Listing_cache not created by Listing_cache::create is used. */
+constexpr auto unknown_listing_cache_msg {"Listing cache must be created by Listing_cache::create"};
+
 /** Error message when unable to parse the expected JSON response. */
 constexpr auto invalid_json_body_msg {"Unable to parse expected JSON response body"};
 
@@ -34,6 +37,33 @@ constexpr auto expect_resources_msg {"Expected parsed directory to define contai
 /** Error message when a parsed resource from an id-endpoint defines no field for id. */
 constexpr auto expect_id_msg {"Expected parsed resource to define an id"};
 
+/** Error message when a 206 status code is expected and not received. */
+constexpr auto expect_206_msg {"Expected a 206 response code"};
+
+/** Error message when a partial response has no valid Content-Range header. */
+constexpr auto expect_content_range_msg {"Expected a valid \"Content-Range\" header in the response headers"};
+
+/** Error message when a partial response body does not match the requested range. */
+constexpr auto range_size_msg {"Expected the response body to match the requested range"};
+
+/** Error message when the checksum of a downloaded file does not match the expected digest. */
+constexpr auto checksum_mismatch_msg {"Checksum of the downloaded file does not match the expected digest"};
+
+/** Error message when a local file ends before the range being read from it. */
+constexpr auto local_file_truncated_msg {"Local file ended before the range being read"};
+
+/** Error message when a transfer job status response omits a requested job. */
+constexpr auto expect_job_status_msg {"Expected the response to include the status of every requested job"};
+
+/** Error message when a transfer option is set to a value that is not positive. */
+constexpr auto invalid_transfer_option_msg {"Transfer options must be positive"};
+
+/** Error message when a sharded transfer has no started sub-jobs. */
+constexpr auto empty_sharded_job_msg {"Sharded job must have at least one started sub-job"};
+
+/** Error message when a blocking request is made on the thread that completes requests. */
+constexpr auto blocking_on_event_loop_msg {"Blocking requests cannot be made on the thread that completes requests"};
+
 } // namespace Err
 } // namespace Internal
 } // namespace Onedatashare
@@ -0,0 +1,136 @@
+/**
+ * @file json_escape.cpp
+ */
+
+#include "json_escape.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ONEDATASHARE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/**
+ * Checks if the specified character must be escaped in a json string.
+ *
+ * @param c the character to check
+ *
+ * @return true if the character must be escaped, false otherwise
+ */
+bool needs_escape(char c)
+{
+    return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+}
+
+/**
+ * Finds the first character that must be escaped starting at the specified position, one character at a time.
+ *
+ * @param str the string to scan
+ * @param start the position to start scanning from
+ *
+ * @return the position of the first character that must be escaped, or the size of the string if there is none
+ */
+std::size_t find_scalar(std::string_view str, std::size_t start)
+{
+    for (auto i {start}; i < str.size(); ++i) {
+        if (needs_escape(str[i])) {
+            return i;
+        }
+    }
+    return str.size();
+}
+
+#ifdef ONEDATASHARE_X86_SIMD
+
+/**
+ * Finds the first character that must be escaped, 16 characters at a time.
+ *
+ * @param str the string to scan
+ *
+ * @return the position of the first character that must be escaped, or the size of the string if there is none
+ */
+std::size_t find_sse2(std::string_view str)
+{
+    const auto quote {_mm_set1_epi8('"')};
+    const auto backslash {_mm_set1_epi8('\\')};
+    const auto max_control {_mm_set1_epi8(0x1f)};
+
+    std::size_t i {0};
+    for (; i + 16 <= str.size(); i += 16) {
+        const auto chunk {_mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + i))};
+        // a character is a control character exactly when it is unchanged by an unsigned min with 0x1f
+        const auto control {_mm_cmpeq_epi8(_mm_min_epu8(chunk, max_control), chunk)};
+        const auto special {_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))};
+        const auto mask {_mm_movemask_epi8(_mm_or_si128(control, special))};
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return find_scalar(str, i);
+}
+
+/**
+ * Finds the first character that must be escaped, 32 characters at a time.
+ *
+ * @param str the string to scan
+ *
+ * @return the position of the first character that must be escaped, or the size of the string if there is none
+ */
+__attribute__((target("avx2"))) std::size_t find_avx2(std::string_view str)
+{
+    const auto quote {_mm256_set1_epi8('"')};
+    const auto backslash {_mm256_set1_epi8('\\')};
+    const auto max_control {_mm256_set1_epi8(0x1f)};
+
+    std::size_t i {0};
+    for (; i + 32 <= str.size(); i += 32) {
+        const auto chunk {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(str.data() + i))};
+        const auto control {_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, max_control), chunk)};
+        const auto special {_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash))};
+        const auto mask {static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(control, special)))};
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return find_scalar(str, i);
+}
+
+#endif
+
+/**
+ * Selects the fastest implementation of find_json_escape supported by the processor.
+ *
+ * @return the selected implementation
+ */
+std::size_t (*select_find())(std::string_view)
+{
+#ifdef ONEDATASHARE_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return find_avx2;
+    }
+    // every x86-64 processor supports SSE2
+    return find_sse2;
+#else
+    return [](std::string_view str) { return find_scalar(str, 0); };
+#endif
+}
+
+} // namespace
+
+std::size_t find_json_escape(std::string_view str)
+{
+    // short strings, such as most ids, are not worth the vector setup
+    if (str.size() < 16) {
+        return find_scalar(str, 0);
+    }
+
+    static const auto find {select_find()};
+    return find(str);
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,80 @@
+/**
+ * @file json_escape.h
+ * Defines functions used to escape the special characters of json strings.
+ */
+
+#ifndef ONEDATASHARE_JSON_ESCAPE_H
+#define ONEDATASHARE_JSON_ESCAPE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Finds the first character of the specified string that must be escaped in a json string, which is a quote, a
+ * backslash, or a control character. Scans 32 or 16 characters at a time with AVX2 or SSE2 when the processor
+ * supports them, falling back to scanning one character at a time otherwise.
+ *
+ * @param str the string to scan
+ *
+ * @return the position of the first character that must be escaped, or the size of the string if there is none
+ */
+std::size_t find_json_escape(std::string_view str);
+
+/**
+ * Appends the specified string to the specified buffer with its json special characters escaped. Runs of characters
+ * that need no escaping are found with find_json_escape and appended at once. Control characters without a short
+ * escape sequence are written as \u00XX.
+ *
+ * @param buffer borrowed reference to the buffer to append to
+ * @param str the string to escape
+ */
+inline void append_escaped_json(std::string& buffer, std::string_view str)
+{
+    constexpr auto hex_digits {"0123456789abcdef"};
+
+    while (true) {
+        const auto run {find_json_escape(str)};
+        buffer.append(str.data(), run);
+        if (run == str.size()) {
+            return;
+        }
+
+        const auto c {static_cast<unsigned char>(str[run])};
+        str.remove_prefix(run + 1);
+        switch (c) {
+        case '"':
+            buffer.append("\\\"", 2);
+            break;
+        case '\\':
+            buffer.append("\\\\", 2);
+            break;
+        case '\b':
+            buffer.append("\\b", 2);
+            break;
+        case '\f':
+            buffer.append("\\f", 2);
+            break;
+        case '\n':
+            buffer.append("\\n", 2);
+            break;
+        case '\r':
+            buffer.append("\\r", 2);
+            break;
+        case '\t':
+            buffer.append("\\t", 2);
+            break;
+        default:
+            const char escaped[] {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xf]};
+            buffer.append(escaped, sizeof(escaped));
+        }
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_JSON_ESCAPE_H
@@ -0,0 +1,106 @@
+/**
+ * @file json_parser_pool.cpp
+ */
+
+#include <utility>
+
+#include "json_parser_pool.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+static_assert(Response::body_padding >= simdjson::SIMDJSON_PADDING,
+              "response bodies must be padded enough to be parsed in place");
+
+Json_parser_pool::Lease::Lease(Json_parser_pool* pool, std::unique_ptr<simdjson::dom::parser> parser)
+    : pool_ {pool},
+      parser_ {std::move(parser)}
+{}
+
+Json_parser_pool::Lease::Lease(Lease&& other) noexcept
+    : pool_ {std::exchange(other.pool_, nullptr)},
+      parser_ {std::move(other.parser_)}
+{}
+
+Json_parser_pool::Lease& Json_parser_pool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        if (pool_ != nullptr) {
+            pool_->release(std::move(parser_));
+        }
+        pool_ = std::exchange(other.pool_, nullptr);
+        parser_ = std::move(other.parser_);
+    }
+    return *this;
+}
+
+Json_parser_pool::Lease::~Lease()
+{
+    if (pool_ != nullptr) {
+        pool_->release(std::move(parser_));
+    }
+}
+
+simdjson::dom::parser& Json_parser_pool::Lease::operator*() const
+{
+    return *parser_;
+}
+
+simdjson::dom::parser* Json_parser_pool::Lease::operator->() const
+{
+    return parser_.get();
+}
+
+Json_parser_pool::Json_parser_pool(const Json_parser_pool_options& options) : options_ {options}, mutex_ {}, idle_ {}
+{
+    idle_.reserve(options_.max_idle_parsers);
+}
+
+Json_parser_pool& Json_parser_pool::shared()
+{
+    static Json_parser_pool pool {};
+    return pool;
+}
+
+Json_parser_pool::Lease Json_parser_pool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        if (!idle_.empty()) {
+            // reuse the most recently returned parser since its buffers are the most likely to still be cached
+            auto parser {std::move(idle_.back())};
+            idle_.pop_back();
+            return Lease {this, std::move(parser)};
+        }
+    }
+
+    return Lease {this, std::make_unique<simdjson::dom::parser>()};
+}
+
+std::size_t Json_parser_pool::idle_count() const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return idle_.size();
+}
+
+void Json_parser_pool::release(std::unique_ptr<simdjson::dom::parser> parser)
+{
+    if (parser->capacity() > options_.max_parser_capacity) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (idle_.size() < options_.max_idle_parsers) {
+        idle_.push_back(std::move(parser));
+    }
+    // otherwise the parser is freed once the lock is released
+}
+
+simdjson::simdjson_result<simdjson::dom::element> parse_body(simdjson::dom::parser& parser, const Response& response)
+{
+    const auto body {response.body()};
+    return parser.parse(body.data(), body.size(), response.body_capacity() - body.size() < simdjson::SIMDJSON_PADDING);
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,149 @@
+/**
+ * @file json_parser_pool.h
+ * Defines a thread-safe pool of reusable simdjson parsers.
+ */
+
+#ifndef ONEDATASHARE_JSON_PARSER_POOL_H
+#define ONEDATASHARE_JSON_PARSER_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <simdjson/simdjson.h>
+
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Options controlling how many parsers a Json_parser_pool keeps and how large they may grow.
+ */
+struct Json_parser_pool_options {
+    /** Maximum number of idle parsers kept for reuse. */
+    std::size_t max_idle_parsers {8};
+
+    /** Largest document capacity in bytes of a parser kept for reuse. Parsers that grew beyond this while parsing an
+     * unusually large document are freed instead of holding on to their buffers. */
+    std::size_t max_parser_capacity {16 * 1024 * 1024};
+};
+
+/**
+ * Pool of simdjson parsers. A parser keeps its internal buffers between documents, so reusing parsers avoids
+ * reallocating those buffers on every parse. Parsers are created on demand, so acquiring never blocks.
+ */
+class Json_parser_pool {
+public:
+    /**
+     * Parser checked out of a Json_parser_pool. The parser is returned to the pool when the lease is destroyed.
+     */
+    class Lease {
+    public:
+        Lease(const Lease&) = delete;
+
+        Lease& operator=(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept;
+
+        Lease& operator=(Lease&& other) noexcept;
+
+        ~Lease();
+
+        /**
+         * Gets the leased parser.
+         *
+         * @return borrowed reference to the leased parser, valid until the lease is destroyed
+         */
+        simdjson::dom::parser& operator*() const;
+
+        /**
+         * Gets the leased parser.
+         *
+         * @return borrowed pointer to the leased parser, valid until the lease is destroyed
+         */
+        simdjson::dom::parser* operator->() const;
+
+    private:
+        friend class Json_parser_pool;
+
+        Lease(Json_parser_pool* pool, std::unique_ptr<simdjson::dom::parser> parser);
+
+        /** Pool the parser is returned to, or nullptr if the lease was moved from. */
+        Json_parser_pool* pool_;
+
+        /** The leased parser. */
+        std::unique_ptr<simdjson::dom::parser> parser_;
+    };
+
+    /**
+     * Creates a new, empty Json_parser_pool with the specified options.
+     *
+     * @param options borrowed reference to the options to use
+     */
+    explicit Json_parser_pool(const Json_parser_pool_options& options = {});
+
+    Json_parser_pool(const Json_parser_pool&) = delete;
+
+    Json_parser_pool& operator=(const Json_parser_pool&) = delete;
+
+    Json_parser_pool(Json_parser_pool&&) = delete;
+
+    Json_parser_pool& operator=(Json_parser_pool&&) = delete;
+
+    /**
+     * Gets the pool shared by every service.
+     *
+     * @return borrowed reference to the shared pool
+     */
+    static Json_parser_pool& shared();
+
+    /**
+     * Checks out a parser, reusing the most recently returned idle parser if there is one.
+     *
+     * @return the lease owning the checked out parser
+     */
+    Lease acquire();
+
+    /**
+     * Gets the number of idle parsers currently held by the pool.
+     *
+     * @return the number of idle parsers
+     */
+    std::size_t idle_count() const;
+
+private:
+    /**
+     * Returns the specified parser to the pool, freeing it if the pool is full or the parser grew too large.
+     *
+     * @param parser moved pointer to the parser to return
+     */
+    void release(std::unique_ptr<simdjson::dom::parser> parser);
+
+    /** Options the pool was created with. */
+    const Json_parser_pool_options options_;
+
+    /** Guards the fields below. */
+    mutable std::mutex mutex_;
+
+    /** Idle parsers ordered from least to most recently returned. */
+    std::vector<std::unique_ptr<simdjson::dom::parser>> idle_;
+};
+
+/**
+ * Parses the body of the specified response with the specified parser. The body is parsed in place when the response
+ * buffer has enough spare capacity for simdjson's padding, which is the case for responses received by the libcurl
+ * based REST callers, and copied into a padded buffer otherwise.
+ *
+ * @param parser borrowed reference to the parser to use
+ * @param response borrowed reference to the response whose body is parsed, which must outlive the parsed document
+ *
+ * @return the root of the parsed document or the error encountered
+ */
+simdjson::simdjson_result<simdjson::dom::element> parse_body(simdjson::dom::parser& parser, const Response& response);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_JSON_PARSER_POOL_H
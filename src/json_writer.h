@@ -0,0 +1,171 @@
+/**
+ * @file json_writer.h
+ * Defines a class used to serialize json objects directly into a string.
+ */
+
+#ifndef ONEDATASHARE_JSON_WRITER_H
+#define ONEDATASHARE_JSON_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "json_escape.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Serializes json values into a borrowed string. Field names are template arguments referring to the constants in
+ * ods_rest_api.h, so their sizes are known at compile time and each field name is copied without being measured or
+ * escaped. Commas between members and elements are inserted automatically.
+ */
+class Json_writer {
+public:
+    /**
+     * Creates a new Json_writer appending to the specified buffer. Reserving the buffer ahead of time avoids
+     * reallocating it as values are written.
+     *
+     * @param buffer borrowed reference to the buffer to append to, which must outlive this object
+     */
+    explicit Json_writer(std::string& buffer) : buffer_ {buffer}, needs_comma_ {false} {}
+
+    /**
+     * Writes the start of a json object.
+     */
+    void begin_object()
+    {
+        separate();
+        buffer_.push_back('{');
+        needs_comma_ = false;
+    }
+
+    /**
+     * Writes the end of a json object.
+     */
+    void end_object()
+    {
+        buffer_.push_back('}');
+        needs_comma_ = true;
+    }
+
+    /**
+     * Writes the start of a json array.
+     */
+    void begin_array()
+    {
+        separate();
+        buffer_.push_back('[');
+        needs_comma_ = false;
+    }
+
+    /**
+     * Writes the end of a json array.
+     */
+    void end_array()
+    {
+        buffer_.push_back(']');
+        needs_comma_ = true;
+    }
+
+    /**
+     * Writes the name of a member of the current json object, to be followed by its value.
+     *
+     * @tparam Name reference to the field name constant
+     */
+    template <const char* const& Name>
+    void key()
+    {
+        constexpr std::string_view name {Name};
+
+        separate();
+        buffer_.push_back('"');
+        buffer_.append(name.data(), name.size());
+        buffer_.append("\":", 2);
+        needs_comma_ = false;
+    }
+
+    /**
+     * Writes a json string, escaping its special characters.
+     *
+     * @param str the string to write
+     */
+    void value(std::string_view str)
+    {
+        separate();
+        buffer_.push_back('"');
+        append_escaped_json(buffer_, str);
+        buffer_.push_back('"');
+        needs_comma_ = true;
+    }
+
+    /**
+     * Writes a member of the current json object whose value is a json string.
+     *
+     * @tparam Name reference to the field name constant
+     *
+     * @param str the string value of the member
+     */
+    template <const char* const& Name>
+    void field(std::string_view str)
+    {
+        key<Name>();
+        value(str);
+    }
+
+    /**
+     * Writes a member of the current json object whose value is a json number.
+     *
+     * @tparam Name reference to the field name constant
+     *
+     * @param number the number value of the member
+     */
+    template <const char* const& Name>
+    void number_field(std::uint64_t number)
+    {
+        key<Name>();
+        char digits[20];
+        const auto end {std::to_chars(digits, digits + sizeof(digits), number).ptr};
+        buffer_.append(digits, end - digits);
+        needs_comma_ = true;
+    }
+
+    /**
+     * Writes a member of the current json object whose value is a json boolean.
+     *
+     * @tparam Name reference to the field name constant
+     *
+     * @param boolean the boolean value of the member
+     */
+    template <const char* const& Name>
+    void bool_field(bool boolean)
+    {
+        key<Name>();
+        buffer_.append(boolean ? "true" : "false");
+        needs_comma_ = true;
+    }
+
+private:
+    /**
+     * Writes a comma if a value precedes the value about to be written.
+     */
+    void separate()
+    {
+        if (needs_comma_) {
+            buffer_.push_back(',');
+        }
+    }
+
+    /** Buffer the json is written to. */
+    std::string& buffer_;
+
+    /** If a comma must be written before the next value. */
+    bool needs_comma_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_JSON_WRITER_H
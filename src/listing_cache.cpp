@@ -0,0 +1,20 @@
+/**
+ * @file listing_cache.cpp
+ */
+
+#include <onedatashare/listing_cache.h>
+
+#include "listing_cache_impl.h"
+
+namespace Onedatashare {
+
+std::shared_ptr<Listing_cache> Listing_cache::create(const Listing_cache_options& options)
+{
+    return std::make_shared<Internal::Listing_cache_impl>(options);
+}
+
+Listing_cache::Listing_cache() = default;
+
+Listing_cache::~Listing_cache() = default;
+
+} // namespace Onedatashare
@@ -0,0 +1,267 @@
+/**
+ * @file listing_cache_impl.cpp
+ */
+
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+#include "listing_cache_impl.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/**
+ * Creates the key a listing is cached under.
+ *
+ * @param type the type of endpoint the resource is on
+ * @param cred_id borrowed reference to the credential id of the endpoint
+ * @param identifier borrowed reference to the path or id of the resource
+ *
+ * @return the created key
+ */
+std::string make_key(Endpoint_type type, const std::string& cred_id, const std::string& identifier)
+{
+    // the credential id is terminated so that keys of one endpoint never prefix keys of another
+    std::string key {};
+    key.reserve(cred_id.size() + identifier.size() + 2);
+    key.push_back(static_cast<char>(type));
+    key.append(cred_id);
+    key.push_back('\0');
+    key.append(identifier);
+
+    return key;
+}
+
+/**
+ * Gets the part of the specified key identifying the endpoint of the listing.
+ *
+ * @param key borrowed reference to the key created by make_key
+ *
+ * @return view of the prefix of the key up to and including the terminator of the credential id
+ */
+std::string_view endpoint_prefix(const std::string& key)
+{
+    return std::string_view {key}.substr(0, key.find('\0', 1) + 1);
+}
+
+/**
+ * Approximates the number of bytes used by the specified string beyond the object holding it.
+ *
+ * @param str borrowed reference to the string
+ *
+ * @return the approximate number of bytes
+ */
+std::size_t string_bytes(const std::string& str)
+{
+    return str.capacity() > std::string {}.capacity() ? str.capacity() : 0;
+}
+
+/**
+ * Approximates the number of bytes used by the specified resource, including its contained resources.
+ *
+ * @param resource borrowed reference to the resource
+ *
+ * @return the approximate number of bytes
+ */
+std::size_t resource_bytes(const Resource& resource)
+{
+    auto bytes {sizeof(Resource) + string_bytes(resource.name)};
+    for (const auto* str : {&resource.id, &resource.link, &resource.permissions}) {
+        if (*str) {
+            bytes += string_bytes(**str);
+        }
+    }
+    if (resource.contained_resources) {
+        for (const auto& contained : *resource.contained_resources) {
+            bytes += resource_bytes(contained);
+        }
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+Listing_cache_impl::Listing_cache_impl(const Listing_cache_options& options)
+    : options_ {options},
+      mutex_ {},
+      entries_ {},
+      index_ {},
+      stats_ {},
+      generation_ {0},
+      invalidated_ {},
+      cleared_ {0}
+{}
+
+Listing_cache_stats Listing_cache_impl::stats() const
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    return stats_;
+}
+
+void Listing_cache_impl::clear()
+{
+    const std::lock_guard<std::mutex> lock {mutex_};
+    entries_.clear();
+    index_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+
+    // every endpoint is invalidated at once, so the invalidations recorded for each of them are superseded
+    cleared_ = ++generation_;
+    invalidated_.clear();
+}
+
+Listing_cache_impl::Lookup Listing_cache_impl::lookup(Endpoint_type type,
+                                                      const std::string& cred_id,
+                                                      const std::string& identifier)
+{
+    const auto key {make_key(type, cred_id, identifier)};
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    const auto found {index_.find(key)};
+    if (found == index_.end()) {
+        return {nullptr, false, std::nullopt, std::nullopt, generation_};
+    }
+
+    // move the listing to the front of the least recently used order
+    const auto position {found->second};
+    entries_.splice(entries_.begin(), entries_, position);
+
+    const auto fresh {std::chrono::steady_clock::now() < position->expiry};
+    if (fresh) {
+        ++stats_.hits;
+    }
+
+    return {position->resource, fresh, position->etag, position->last_modified, generation_};
+}
+
+void Listing_cache_impl::store(Endpoint_type type,
+                               const std::string& cred_id,
+                               const std::string& identifier,
+                               std::shared_ptr<const Resource> resource,
+                               std::optional<std::string> etag,
+                               std::optional<std::string> last_modified,
+                               std::uint64_t generation)
+{
+    auto key {make_key(type, cred_id, identifier)};
+    const auto bytes {sizeof(Entry) + key.size() + resource_bytes(*resource)};
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    ++stats_.misses;
+    if (outdated(key, generation)) {
+        return;
+    }
+
+    insert({std::move(key),
+            std::move(resource),
+            std::move(etag),
+            std::move(last_modified),
+            std::chrono::steady_clock::now() + options_.ttl,
+            bytes});
+}
+
+void Listing_cache_impl::refresh(Endpoint_type type,
+                                 const std::string& cred_id,
+                                 const std::string& identifier,
+                                 const Lookup& lookup)
+{
+    auto key {make_key(type, cred_id, identifier)};
+    const auto bytes {sizeof(Entry) + key.size() + resource_bytes(*lookup.resource)};
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    ++stats_.revalidations;
+    if (outdated(key, lookup.generation)) {
+        return;
+    }
+
+    // reinserted rather than updated in place since the listing may have been evicted while it was revalidated
+    insert({std::move(key),
+            lookup.resource,
+            lookup.etag,
+            lookup.last_modified,
+            std::chrono::steady_clock::now() + options_.ttl,
+            bytes});
+}
+
+void Listing_cache_impl::invalidate(Endpoint_type type, const std::string& cred_id, const std::string& identifier)
+{
+    const auto key {make_key(type, cred_id, identifier)};
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    record_invalidation(key);
+    const auto found {index_.find(key)};
+    if (found != index_.end()) {
+        erase(found->second);
+        ++stats_.invalidations;
+    }
+}
+
+void Listing_cache_impl::invalidate_tree(Endpoint_type type, const std::string& cred_id, const std::string& path)
+{
+    const auto key {make_key(type, cred_id, path)};
+    const auto prefix {!path.empty() && path.back() == '/' ? key : key + "/"};
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    record_invalidation(key);
+    const auto found {index_.find(key)};
+    if (found != index_.end()) {
+        erase(found->second);
+        ++stats_.invalidations;
+    }
+
+    // the keys beneath the path share its prefix, so they are adjacent in the index
+    for (auto position {index_.lower_bound(prefix)};
+         position != index_.end() && position->first.compare(0, prefix.size(), prefix) == 0;) {
+        erase((position++)->second);
+        ++stats_.invalidations;
+    }
+}
+
+void Listing_cache_impl::insert(Entry entry)
+{
+    const auto found {index_.find(entry.key)};
+    if (found != index_.end()) {
+        erase(found->second);
+    }
+
+    stats_.bytes += entry.bytes;
+    ++stats_.entries;
+    entries_.push_front(std::move(entry));
+    index_.emplace(entries_.front().key, entries_.begin());
+
+    // evict the least recently used listings, keeping the newest listing even if it alone exceeds the bound
+    while (stats_.bytes > options_.max_bytes && entries_.size() > 1) {
+        erase(std::prev(entries_.end()));
+        ++stats_.evictions;
+    }
+}
+
+bool Listing_cache_impl::outdated(const std::string& key, std::uint64_t generation) const
+{
+    if (cleared_ > generation) {
+        return true;
+    }
+
+    const auto found {invalidated_.find(std::string {endpoint_prefix(key)})};
+    return found != invalidated_.end() && found->second > generation;
+}
+
+void Listing_cache_impl::record_invalidation(const std::string& key)
+{
+    invalidated_[std::string {endpoint_prefix(key)}] = ++generation_;
+}
+
+void Listing_cache_impl::erase(std::list<Entry>::iterator position)
+{
+    stats_.bytes -= position->bytes;
+    --stats_.entries;
+    index_.erase(position->key);
+    entries_.erase(position);
+}
+
+} // namespace Internal
+} // namespace Onedatashare
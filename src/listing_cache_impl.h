@@ -0,0 +1,210 @@
+/**
+ * @file listing_cache_impl.h
+ * Defines the internal implementation of the cache of listed resources.
+ */
+
+#ifndef ONEDATASHARE_LISTING_CACHE_IMPL_H
+#define ONEDATASHARE_LISTING_CACHE_IMPL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/endpoint_type.h>
+#include <onedatashare/listing_cache.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Listing_cache keeping listings in least recently used order, safe to use from multiple threads at once.
+ */
+class Listing_cache_impl : public Listing_cache {
+public:
+    /**
+     * Result of looking up a listing.
+     */
+    struct Lookup {
+        /** The cached listing, or nullptr if the listing is not cached. */
+        std::shared_ptr<const Resource> resource;
+
+        /** If the listing may be used without a request. */
+        bool fresh;
+
+        /** The ETag header received with the listing, if any. */
+        std::optional<std::string> etag;
+
+        /** The Last-Modified header received with the listing, if any. */
+        std::optional<std::string> last_modified;
+
+        /** Number of invalidations of any listing before the lookup, used to discard listings requested before an
+         * invalidation of their endpoint. */
+        std::uint64_t generation;
+    };
+
+    /**
+     * Creates a new, empty Listing_cache_impl with the specified options.
+     *
+     * @param options borrowed reference to the options controlling the cache
+     */
+    explicit Listing_cache_impl(const Listing_cache_options& options);
+
+    Listing_cache_stats stats() const override;
+
+    void clear() override;
+
+    /**
+     * Looks up the listing of the specified resource, counting a hit if the listing is fresh.
+     *
+     * @param type the type of endpoint the resource is on
+     * @param cred_id borrowed reference to the credential id of the endpoint
+     * @param identifier borrowed reference to the path or id of the resource
+     *
+     * @return the result of the lookup
+     */
+    Lookup lookup(Endpoint_type type, const std::string& cred_id, const std::string& identifier);
+
+    /**
+     * Caches a listing received in full, counting a miss. The listing is discarded instead if a listing of the same
+     * endpoint was invalidated since the specified generation, since it may have been received before the
+     * invalidation.
+     *
+     * @param type the type of endpoint the resource is on
+     * @param cred_id borrowed reference to the credential id of the endpoint
+     * @param identifier borrowed reference to the path or id of the resource
+     * @param resource the listed resource
+     * @param etag the ETag header received with the listing, if any
+     * @param last_modified the Last-Modified header received with the listing, if any
+     * @param generation the generation of the lookup made before requesting the listing
+     */
+    void store(Endpoint_type type,
+               const std::string& cred_id,
+               const std::string& identifier,
+               std::shared_ptr<const Resource> resource,
+               std::optional<std::string> etag,
+               std::optional<std::string> last_modified,
+               std::uint64_t generation);
+
+    /**
+     * Renews the time to live of a listing that OneDataShare confirmed is unchanged, counting a revalidation.
+     *
+     * @param type the type of endpoint the resource is on
+     * @param cred_id borrowed reference to the credential id of the endpoint
+     * @param identifier borrowed reference to the path or id of the resource
+     * @param lookup borrowed reference to the lookup that found the expired listing
+     */
+    void refresh(Endpoint_type type, const std::string& cred_id, const std::string& identifier, const Lookup& lookup);
+
+    /**
+     * Discards the listing of the specified resource.
+     *
+     * @param type the type of endpoint the resource is on
+     * @param cred_id borrowed reference to the credential id of the endpoint
+     * @param identifier borrowed reference to the path or id of the resource
+     */
+    void invalidate(Endpoint_type type, const std::string& cred_id, const std::string& identifier);
+
+    /**
+     * Discards the listing of the resource at the specified path along with the listings of every resource beneath
+     * it.
+     *
+     * @param type the type of endpoint the resources are on
+     * @param cred_id borrowed reference to the credential id of the endpoint
+     * @param path borrowed reference to the path of the resource
+     */
+    void invalidate_tree(Endpoint_type type, const std::string& cred_id, const std::string& path);
+
+private:
+    /**
+     * A cached listing.
+     */
+    struct Entry {
+        /** Key the listing is cached under. */
+        std::string key;
+
+        /** The listed resource. */
+        std::shared_ptr<const Resource> resource;
+
+        /** The ETag header received with the listing, if any. */
+        std::optional<std::string> etag;
+
+        /** The Last-Modified header received with the listing, if any. */
+        std::optional<std::string> last_modified;
+
+        /** When the listing stops being fresh. */
+        std::chrono::steady_clock::time_point expiry;
+
+        /** Approximate number of bytes used by the listing. */
+        std::size_t bytes;
+    };
+
+    /**
+     * Inserts or replaces the listing under the specified key and evicts listings until the memory bound is met.
+     * Expects the mutex to be held.
+     *
+     * @param entry moved listing to insert
+     */
+    void insert(Entry entry);
+
+    /**
+     * Checks if a listing of the endpoint of the specified key was invalidated since the specified generation. Expects
+     * the mutex to be held.
+     *
+     * @param key borrowed reference to the key of the listing
+     * @param generation the generation of the lookup made before requesting the listing
+     *
+     * @return true if the listing may have been received before an invalidation, false otherwise
+     */
+    bool outdated(const std::string& key, std::uint64_t generation) const;
+
+    /**
+     * Records an invalidation of a listing of the endpoint of the specified key. Expects the mutex to be held.
+     *
+     * @param key borrowed reference to the key of the invalidated listing
+     */
+    void record_invalidation(const std::string& key);
+
+    /**
+     * Removes the listing at the specified position. Expects the mutex to be held.
+     *
+     * @param position the position of the listing in the least recently used order
+     */
+    void erase(std::list<Entry>::iterator position);
+
+    /** Options controlling the cache. */
+    const Listing_cache_options options_;
+
+    /** Mutex guarding every member below. */
+    mutable std::mutex mutex_;
+
+    /** Cached listings, most recently used first. */
+    std::list<Entry> entries_;
+
+    /** Positions of the cached listings, ordered by key so that the listings beneath a path are adjacent. */
+    std::map<std::string, std::list<Entry>::iterator> index_;
+
+    /** Counters describing how the cache has been used, with entries and bytes kept up to date. */
+    Listing_cache_stats stats_;
+
+    /** Number of invalidations so far. */
+    std::uint64_t generation_;
+
+    /** Generation of the last invalidation of a listing of each endpoint, by the key prefix of the endpoint. */
+    std::unordered_map<std::string, std::uint64_t> invalidated_;
+
+    /** Generation of the last time the cache was cleared. */
+    std::uint64_t cleared_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_LISTING_CACHE_IMPL_H
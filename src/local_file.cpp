@@ -0,0 +1,68 @@
+/**
+ * @file local_file.cpp
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "error_message.h"
+#include "local_file.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+Local_file::Local_file(const std::string& path, int flags)
+    : path_ {path}, fd_ {::open(path.c_str(), flags | O_CLOEXEC, 0644)}
+{
+    if (fd_ < 0) {
+        throw_errno();
+    }
+}
+
+Local_file::~Local_file()
+{
+    ::close(fd_);
+}
+
+int Local_file::fd() const
+{
+    return fd_;
+}
+
+const std::string& Local_file::path() const
+{
+    return path_;
+}
+
+std::string Local_file::read(std::uint64_t offset, std::size_t length) const
+{
+    std::string data(length, '\0');
+    std::size_t read {0};
+    while (read < length) {
+        const auto count {::pread(fd_, data.data() + read, length - read, static_cast<off_t>(offset + read))};
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno();
+        }
+        if (count == 0) {
+            throw Connection_error {path_ + ": " + Err::local_file_truncated_msg};
+        }
+        read += count;
+    }
+    return data;
+}
+
+void Local_file::throw_errno() const
+{
+    throw Connection_error {path_ + ": " + std::strerror(errno)};
+}
+
+} // namespace Internal
+} // namespace Onedatashare
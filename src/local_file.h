@@ -0,0 +1,84 @@
+/**
+ * @file local_file.h
+ * Defines an owner of an open local file used when moving file contents to and from OneDataShare.
+ */
+
+#ifndef ONEDATASHARE_LOCAL_FILE_H
+#define ONEDATASHARE_LOCAL_FILE_H
+
+#include <cstdint>
+#include <string>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Open file descriptor of a local file, closed when destroyed.
+ */
+class Local_file {
+public:
+    /**
+     * Opens the local file at the specified path, creating it with mode 0644 if O_CREAT is among the flags.
+     *
+     * @param path borrowed reference to the path of the file
+     * @param flags the flags to open the file with
+     *
+     * @exception Connection_error if the file could not be opened
+     */
+    Local_file(const std::string& path, int flags);
+
+    ~Local_file();
+
+    Local_file(const Local_file&) = delete;
+
+    Local_file& operator=(const Local_file&) = delete;
+
+    Local_file(Local_file&&) = delete;
+
+    Local_file& operator=(Local_file&&) = delete;
+
+    /**
+     * Gets the file descriptor.
+     *
+     * @return the file descriptor
+     */
+    int fd() const;
+
+    /**
+     * Gets the path the file was opened at.
+     *
+     * @return borrowed reference to the path
+     */
+    const std::string& path() const;
+
+    /**
+     * Reads the specified range of the file.
+     *
+     * @param offset the offset of the first byte of the range
+     * @param length the number of bytes in the range
+     *
+     * @return the bytes read
+     *
+     * @exception Connection_error if the file could not be read or ends before the range does
+     */
+    std::string read(std::uint64_t offset, std::size_t length) const;
+
+    /**
+     * Raises a Connection_error describing the current value of errno for this file.
+     *
+     * @exception Connection_error always
+     */
+    [[noreturn]] void throw_errno() const;
+
+private:
+    /** Path the file was opened at. */
+    const std::string path_;
+
+    /** The file descriptor. */
+    const int fd_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_LOCAL_FILE_H
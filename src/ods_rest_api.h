@@ -115,9 +115,39 @@ constexpr auto s3_download_path {"/api/s3/download"};
 /** Path of the REST API call for downloading a file from an SFTP endpoint. */
 constexpr auto sftp_download_path {"/api/sftp/download"};
 
+/** Path of the REST API call for uploading a file to a Box endpoint. */
+constexpr auto box_upload_path {"/api/box/upload"};
+
+/** Path of the REST API call for uploading a file to a Dropbox endpoint. */
+constexpr auto dropbox_upload_path {"/api/dropbox/upload"};
+
+/** Path of the REST API call for uploading a file to an FTP endpoint. */
+constexpr auto ftp_upload_path {"/api/ftp/upload"};
+
+/** Path of the REST API call for uploading a file to a Google Drive endpoint. */
+constexpr auto google_drive_upload_path {"/api/googledrive/upload"};
+
+/** Path of the REST API call for uploading a file to a GFTP endpoint. */
+constexpr auto gftp_upload_path {"/api/gsiftp/upload"};
+
+/** Path of the REST API call for uploading a file to an HTTP endpoint. */
+constexpr auto http_upload_path {"/api/http/upload"};
+
+/** Path of the REST API call for uploading a file to an S3 endpoint. */
+constexpr auto s3_upload_path {"/api/s3/upload"};
+
+/** Path of the REST API call for uploading a file to an SFTP endpoint. */
+constexpr auto sftp_upload_path {"/api/sftp/upload"};
+
 /** Path of the REST API call for making transfers. */
 constexpr auto transfer_job_path {"/api/transfer-job"};
 
+/** Path of the REST API call for checking the status of transfers. */
+constexpr auto transfer_job_status_path {"/api/transfer-job/status"};
+
+/** Parameter of the GET transfer job status api call indicating the comma separated ids of the jobs to check. */
+constexpr auto get_status_ids_param {"ids"};
+
 /** Parameter of the GET ls api call indicating the credential id. */
 constexpr auto get_ls_cred_id_param {"credId"};
 
@@ -229,6 +259,30 @@ constexpr auto download_operation_id {"id"};
 /** Field of DownloadOperation json object indicating the target file. */
 constexpr auto download_operation_file_to_download {"fileToDownload"};
 
+/** Parameter of the GET download api call indicating the credential id. */
+constexpr auto get_download_cred_id_param {"credId"};
+
+/** Parameter of the GET download api call indicating the path to the target directory. */
+constexpr auto get_download_path_param {"path"};
+
+/** Parameter of the GET download api call indicating the id of the target directory. */
+constexpr auto get_download_id_param {"id"};
+
+/** Parameter of the GET download api call indicating the target file. */
+constexpr auto get_download_file_param {"fileToDownload"};
+
+/** Parameter of the POST upload api call indicating the credential id. */
+constexpr auto post_upload_cred_id_param {"credId"};
+
+/** Parameter of the POST upload api call indicating the path to the target directory. */
+constexpr auto post_upload_path_param {"path"};
+
+/** Parameter of the POST upload api call indicating the id of the target directory. */
+constexpr auto post_upload_id_param {"id"};
+
+/** Parameter of the POST upload api call indicating the name of the uploaded file. */
+constexpr auto post_upload_file_name_param {"fileName"};
+
 /** Field of EntityInfo json object indicating resource id. */
 constexpr auto entity_info_id {"id"};
 
@@ -262,6 +316,69 @@ constexpr auto transfer_job_request_source {"source"};
 /** Field of TransferJob json object indicating destination of transfer. */
 constexpr auto transfer_job_request_destination {"destination"};
 
+/** Field of TransferJob json object indicating options of transfer. */
+constexpr auto transfer_job_request_options {"options"};
+
+/** Field of TransferOptions json object indicating the number of files transferred at once. */
+constexpr auto transfer_options_concurrency {"concurrencyThreadCount"};
+
+/** Field of TransferOptions json object indicating the number of parallel streams per file. */
+constexpr auto transfer_options_parallelism {"parallelThreadCount"};
+
+/** Field of TransferOptions json object indicating the pipelining depth. */
+constexpr auto transfer_options_pipelining {"pipeSize"};
+
+/** Field of TransferOptions json object indicating the chunk size in bytes. */
+constexpr auto transfer_options_chunk_size {"chunkSize"};
+
+/** Field of TransferOptions json object indicating if data is compressed. */
+constexpr auto transfer_options_compress {"compress"};
+
+/** Field of TransferOptions json object indicating if transferred files are verified. */
+constexpr auto transfer_options_verify {"verify"};
+
+/** Field of TransferJobStatus json object indicating the job id. */
+constexpr auto transfer_status_id {"id"};
+
+/** Field of TransferJobStatus json object indicating the state of the job. */
+constexpr auto transfer_status_state {"status"};
+
+/** Field of TransferJobStatus json object indicating the number of bytes transferred. */
+constexpr auto transfer_status_bytes_transferred {"bytesTransferred"};
+
+/** Field of TransferJobStatus json object indicating the number of files transferred. */
+constexpr auto transfer_status_files_done {"filesDone"};
+
+/** Field of TransferJobStatus json object indicating the total number of files to transfer. */
+constexpr auto transfer_status_files_total {"filesTotal"};
+
+/** Field of TransferJobStatus json object indicating the throughput in bytes per second. */
+constexpr auto transfer_status_throughput {"throughput"};
+
+/** Field of TransferJobStatus json object indicating the time the job started. */
+constexpr auto transfer_status_start_time {"startTime"};
+
+/** Field of TransferJobStatus json object indicating the time the job ended. */
+constexpr auto transfer_status_end_time {"endTime"};
+
+/** Field of TransferJobStatus json object indicating the time the status was last updated. */
+constexpr auto transfer_status_last_updated {"lastUpdated"};
+
+/** Value of the TransferJobStatus state field indicating a queued job. */
+constexpr auto transfer_state_queued {"QUEUED"};
+
+/** Value of the TransferJobStatus state field indicating a running job. */
+constexpr auto transfer_state_running {"RUNNING"};
+
+/** Value of the TransferJobStatus state field indicating a completed job. */
+constexpr auto transfer_state_completed {"COMPLETED"};
+
+/** Value of the TransferJobStatus state field indicating a failed job. */
+constexpr auto transfer_state_failed {"FAILED"};
+
+/** Value of the TransferJobStatus state field indicating a cancelled job. */
+constexpr auto transfer_state_cancelled {"CANCELLED"};
+
 } // namespace Api
 } // namespace Internal
 } // namespace Onedatashare
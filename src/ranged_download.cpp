@@ -0,0 +1,825 @@
+/**
+ * @file ranged_download.cpp
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "checksum.h"
+#include "error_message.h"
+#include "local_file.h"
+#include "ranged_download.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** Header requesting a range of bytes of the response body. */
+constexpr auto header_range {"Range"};
+
+/** Header making a range request conditional on the file being unchanged. */
+constexpr auto header_if_range {"If-Range"};
+
+/** Header describing the range of bytes contained by a partial response body. */
+constexpr auto header_content_range {"Content-Range"};
+
+/** Header holding the ETag of the file. */
+constexpr auto header_etag {"ETag"};
+
+/** Header holding the time the file was last modified. */
+constexpr auto header_last_modified {"Last-Modified"};
+
+/** Header holding the hexadecimal CRC32C checksum of the file. */
+constexpr auto header_checksum_crc32c {"X-Checksum-CRC32C"};
+
+/** Header holding the hexadecimal xxHash64 checksum of the file. */
+constexpr auto header_checksum_xxh64 {"X-Checksum-XXH64"};
+
+/** First line of a state file, identifying its format. */
+constexpr auto state_magic {"odsdownload 1"};
+
+/** Value of a chunk in the list of chunks of a state file once the chunk has been received. */
+constexpr auto chunk_received {'1'};
+
+/** Value of a chunk in the list of chunks of a state file until the chunk has been received. */
+constexpr auto chunk_missing {'0'};
+
+/** The http response status code for a partial response. */
+constexpr auto status_partial_content {206};
+
+/**
+ * Progress of a download, as recorded in its state file.
+ */
+struct Download_state {
+    /** Size of the file in bytes. */
+    std::uint64_t total;
+
+    /** Number of bytes in each chunk. */
+    std::uint64_t chunk_size;
+
+    /** ETag or Last-Modified value of the file, or empty if the file has neither. */
+    std::string validator;
+
+    /** One character per chunk, indicating if the chunk has been received. */
+    std::string chunks;
+};
+
+/**
+ * State file of a download in progress, updated in place as chunks are received.
+ */
+class State_file {
+public:
+    /**
+     * Writes the specified state to the state file at the specified path, replacing any existing state file.
+     *
+     * @param path borrowed reference to the path of the state file
+     * @param state borrowed reference to the state to write
+     *
+     * @exception Connection_error if the state file could not be written
+     */
+    State_file(const std::string& path, const Download_state& state)
+        : file_ {path, O_WRONLY | O_CREAT | O_TRUNC}, chunks_offset_ {}
+    {
+        auto contents {std::string {state_magic} + "\n" + std::to_string(state.total) + " " +
+                       std::to_string(state.chunk_size) + "\n" + state.validator + "\n"};
+        chunks_offset_ = contents.size();
+        contents += state.chunks + "\n";
+
+        Fd_sink {file_.fd()}.write(contents.data(), contents.size());
+    }
+
+    /**
+     * Records that the specified chunk has been received.
+     *
+     * @param chunk the index of the chunk
+     *
+     * @exception Connection_error if the state file could not be written
+     */
+    void mark(std::size_t chunk)
+    {
+        if (::pwrite(file_.fd(), &chunk_received, 1, chunks_offset_ + chunk) != 1) {
+            file_.throw_errno();
+        }
+    }
+
+private:
+    /** The open state file. */
+    const Local_file file_;
+
+    /** Offset of the list of chunks within the state file. */
+    std::size_t chunks_offset_;
+};
+
+/**
+ * Gets the number of chunks of the specified size needed to hold the specified number of bytes.
+ *
+ * @param total the number of bytes
+ * @param chunk_size the number of bytes in each chunk
+ *
+ * @return the number of chunks
+ */
+std::size_t count_chunks(std::uint64_t total, std::uint64_t chunk_size)
+{
+    return static_cast<std::size_t>((total + chunk_size - 1) / chunk_size);
+}
+
+/**
+ * Gets the number of bytes in the specified chunk.
+ *
+ * @param state borrowed reference to the state of the download
+ * @param chunk the index of the chunk
+ *
+ * @return the number of bytes in the chunk
+ */
+std::uint64_t chunk_length(const Download_state& state, std::size_t chunk)
+{
+    return std::min(state.chunk_size, state.total - chunk * state.chunk_size);
+}
+
+/**
+ * Loads the state of an interrupted download of the specified local file.
+ *
+ * @param state_path borrowed reference to the path of the state file
+ * @param local_path borrowed reference to the path of the local file
+ *
+ * @return the state of the download, or no value if there is no state file, the state file is malformed, or the
+ * local file does not match it
+ */
+std::optional<Download_state> load_state(const std::string& state_path, const std::string& local_path)
+{
+    std::ifstream in {state_path};
+    std::string magic {};
+    std::string sizes {};
+    Download_state state {};
+    if (!std::getline(in, magic) || magic != state_magic || !std::getline(in, sizes) ||
+        !std::getline(in, state.validator) || !std::getline(in, state.chunks)) {
+        return std::nullopt;
+    }
+
+    const auto separator {sizes.find(' ')};
+    if (separator == std::string::npos) {
+        return std::nullopt;
+    }
+    const auto [total_end, total_err] {std::from_chars(sizes.data(), sizes.data() + separator, state.total)};
+    const auto [chunk_end, chunk_err] {
+        std::from_chars(sizes.data() + separator + 1, sizes.data() + sizes.size(), state.chunk_size)};
+    if (total_err != std::errc {} || chunk_err != std::errc {} || state.chunk_size == 0 ||
+        state.chunks.size() != count_chunks(state.total, state.chunk_size) ||
+        state.chunks.find_first_not_of(std::string {chunk_received} + chunk_missing) != std::string::npos) {
+        return std::nullopt;
+    }
+
+    // the local file was preallocated to its full size before the state file was written
+    struct stat local {};
+    if (::stat(local_path.c_str(), &local) != 0 || static_cast<std::uint64_t>(local.st_size) != state.total) {
+        return std::nullopt;
+    }
+
+    return state;
+}
+
+/**
+ * Allocates the specified number of bytes for the specified file so that chunks can be written anywhere within it
+ * without fragmenting the file or running out of space midway.
+ *
+ * @param file borrowed reference to the file
+ * @param size the size of the file in bytes
+ *
+ * @exception Connection_error if the space could not be allocated
+ */
+void preallocate(const Local_file& file, std::uint64_t size)
+{
+#ifndef __APPLE__
+    const auto err {::posix_fallocate(file.fd(), 0, static_cast<off_t>(size))};
+    if (err == 0) {
+        return;
+    }
+    if (err != EINVAL && err != EOPNOTSUPP) {
+        errno = err;
+        file.throw_errno();
+    }
+#endif
+    // fall back to a sparse file on file systems that cannot allocate space up front
+    if (::ftruncate(file.fd(), static_cast<off_t>(size)) != 0) {
+        file.throw_errno();
+    }
+}
+
+/**
+ * Gets the value of If-Range to send with requests for the file described by the specified response. Weak ETags are
+ * skipped since they cannot be used with If-Range.
+ *
+ * @param response borrowed reference to a response for the file
+ *
+ * @return the ETag or Last-Modified value of the file, or an empty string if the response has neither
+ */
+std::string validator(const Response& response)
+{
+    const auto etag {response.header(header_etag)};
+    if (etag && etag->substr(0, 2) != "W/") {
+        return std::string {*etag};
+    }
+    const auto last_modified {response.header(header_last_modified)};
+    return last_modified ? std::string {*last_modified} : std::string {};
+}
+
+/**
+ * Creates the headers requesting the specified range of the file.
+ *
+ * @param headers borrowed reference to the headers sent with every request
+ * @param offset the offset of the first byte of the range
+ * @param length the number of bytes in the range
+ * @param validator borrowed reference to the If-Range value to send, or an empty string to send none
+ *
+ * @return the created headers
+ */
+std::unordered_multimap<std::string, std::string> range_headers(
+    const std::unordered_multimap<std::string, std::string>& headers,
+    std::uint64_t offset,
+    std::uint64_t length,
+    const std::string& validator)
+{
+    auto ranged {headers};
+    ranged.emplace(header_range, "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + length - 1));
+    if (!validator.empty()) {
+        ranged.emplace(header_if_range, validator);
+    }
+    return ranged;
+}
+
+/**
+ * Gets the total size of the file from the Content-Range header of the specified partial response.
+ *
+ * @param response borrowed reference to the partial response
+ *
+ * @return the total size of the file
+ *
+ * @exception Unexpected_response_error if the response has no valid Content-Range header
+ */
+std::uint64_t content_range_total(const Response& response)
+{
+    const auto content_range {response.header(header_content_range)};
+    const auto total {content_range ? parse_content_range_total(*content_range) : std::nullopt};
+    if (!total) {
+        throw Unexpected_response_error {Err::expect_content_range_msg, response.status()};
+    }
+    return *total;
+}
+
+/**
+ * Checks that the specified response delivered the specified chunk of an unchanged file.
+ *
+ * @param response borrowed reference to the response
+ * @param sink borrowed reference to the sink the response body was written to
+ * @param state borrowed reference to the state of the download
+ * @param chunk the index of the chunk
+ *
+ * @exception Resource_changed if the file changed since the download started
+ * @exception Unexpected_response_error if the response is not a partial response for the chunk
+ */
+void check_chunk(const Response& response, const Range_sink& sink, const Download_state& state, std::size_t chunk)
+{
+    if (response.status() == 200) {
+        throw Resource_changed {};
+    }
+    if (response.status() != status_partial_content) {
+        throw Unexpected_response_error {Err::expect_206_msg, response.status()};
+    }
+    if (content_range_total(response) != state.total) {
+        throw Resource_changed {};
+    }
+    if (sink.written() != chunk_length(state, chunk)) {
+        throw Unexpected_response_error {Err::range_size_msg, response.status()};
+    }
+}
+
+/**
+ * Checksum of a download, computed over each chunk as it is received. CRC32C checksums are kept per chunk and
+ * combined at the end, so chunks may arrive in any order. xxHash64 must see the file in order, so chunks received
+ * ahead of the first chunk not yet hashed are held in memory until it arrives. Chunks received before the download
+ * was interrupted are read back from the local file.
+ */
+class Download_digest {
+public:
+    /**
+     * Creates a new Download_digest.
+     *
+     * @param algorithm the checksum to compute
+     * @param max_concurrency the maximum number of requests in flight at once
+     */
+    Download_digest(Checksum_algorithm algorithm, int max_concurrency)
+        : algorithm_ {algorithm},
+          window_ {2 * static_cast<std::size_t>(std::max(max_concurrency, 1))},
+          state_ {nullptr},
+          file_ {nullptr},
+          streamed_crc_ {0},
+          hash_ {},
+          crcs_ {},
+          buffers_ {},
+          complete_ {},
+          frontier_ {0},
+          server_digest_ {},
+          status_ {200}
+    {
+    }
+
+    /**
+     * Gets the observer of a response body received in order from the start of the file, which may turn out to be
+     * either the first chunk or the whole file.
+     *
+     * @return the observer, or nullptr if no checksum is computed
+     */
+    Range_sink::Observer stream()
+    {
+        switch (algorithm_) {
+        case Checksum_algorithm::crc32c:
+            return [this](const char* data, std::size_t size) {
+                streamed_crc_ = crc32c_update(streamed_crc_, data, size);
+            };
+        case Checksum_algorithm::xxh64:
+            return [this](const char* data, std::size_t size) { hash_.update(data, size); };
+        default:
+            return nullptr;
+        }
+    }
+
+    /**
+     * Prepares to checksum the chunks of the download.
+     *
+     * @param state borrowed reference to the state of the download, which must outlive this object
+     * @param file borrowed reference to the local file, which must outlive this object
+     * @param first_streamed if the first chunk was received through the observer returned by stream
+     *
+     * @exception Connection_error if reading a chunk received before an interruption from the local file fails
+     */
+    void start(const Download_state& state, const Local_file& file, bool first_streamed)
+    {
+        state_ = &state;
+        file_ = &file;
+        crcs_.assign(state.chunks.size(), std::nullopt);
+        buffers_.assign(state.chunks.size(), std::nullopt);
+        complete_.assign(state.chunks.size(), false);
+        for (std::size_t chunk {0}; chunk < state.chunks.size(); ++chunk) {
+            complete_[chunk] = state.chunks[chunk] == chunk_received;
+        }
+        if (first_streamed && !state.chunks.empty()) {
+            crcs_[0] = streamed_crc_;
+            frontier_ = 1;
+        }
+        advance();
+    }
+
+    /**
+     * Gets the observer of the response body of the specified chunk.
+     *
+     * @param chunk the index of the chunk
+     *
+     * @return the observer, or nullptr if no checksum is computed
+     */
+    Range_sink::Observer observer(std::size_t chunk)
+    {
+        switch (algorithm_) {
+        case Checksum_algorithm::crc32c: {
+            auto* crc {&crcs_[chunk].emplace(0)};
+            return [crc](const char* data, std::size_t size) { *crc = crc32c_update(*crc, data, size); };
+        }
+        case Checksum_algorithm::xxh64: {
+            auto* buffer {&buffers_[chunk].emplace()};
+            buffer->reserve(chunk_length(*state_, chunk));
+            return [buffer](const char* data, std::size_t size) { buffer->append(data, size); };
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    /**
+     * Checks if the specified chunk can be requested without holding more chunks in memory than the window allows.
+     *
+     * @param chunk the index of the chunk
+     *
+     * @return true if the chunk can be requested
+     */
+    bool admits(std::size_t chunk) const
+    {
+        return algorithm_ != Checksum_algorithm::xxh64 || chunk < frontier_ + window_;
+    }
+
+    /**
+     * Records a response, remembering the digest it carries, if any.
+     *
+     * @param response borrowed reference to the response
+     */
+    void offer(const Response& response)
+    {
+        status_ = response.status();
+        const auto header {algorithm_ == Checksum_algorithm::crc32c ? header_checksum_crc32c : header_checksum_xxh64};
+        if (const auto digest {response.header(header)}) {
+            server_digest_ = lower_case(*digest);
+        }
+    }
+
+    /**
+     * Records that the specified chunk has been received, hashing every chunk it makes hashable in order.
+     *
+     * @param chunk the index of the chunk
+     *
+     * @exception Connection_error if reading a chunk received before an interruption from the local file fails
+     */
+    void received(std::size_t chunk)
+    {
+        complete_[chunk] = true;
+        advance();
+    }
+
+    /**
+     * Completes the checksum and compares it against the expected digest, or the digest supplied by the server if
+     * none is expected.
+     *
+     * @param size the size of the file in bytes
+     * @param expected borrowed reference to the expected hexadecimal digest, or an empty string for none
+     *
+     * @return the outcome of the download
+     *
+     * @exception Connection_error if reading a chunk received before an interruption from the local file fails
+     * @exception Unexpected_response_error if the checksum does not match the expected digest
+     */
+    Download_result finish(std::uint64_t size, const std::string& expected)
+    {
+        if (algorithm_ == Checksum_algorithm::none) {
+            return Download_result {size, std::nullopt, false};
+        }
+
+        const auto digest {algorithm_ == Checksum_algorithm::crc32c ? to_hex(crc32c(), 8) : to_hex(xxh64(), 16)};
+        const auto compared {expected.empty() ? server_digest_ : lower_case(expected)};
+        if (!compared.empty() && compared != digest) {
+            throw Unexpected_response_error {Err::checksum_mismatch_msg, status_};
+        }
+        return Download_result {size, digest, !compared.empty()};
+    }
+
+private:
+    /**
+     * Converts the specified hexadecimal digest to lower case.
+     */
+    static std::string lower_case(std::string_view digest)
+    {
+        std::string lower {digest};
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+        return lower;
+    }
+
+    /**
+     * Hashes every received chunk following the chunks hashed so far, releasing the memory holding them.
+     */
+    void advance()
+    {
+        if (algorithm_ != Checksum_algorithm::xxh64) {
+            return;
+        }
+        for (; frontier_ < complete_.size() && complete_[frontier_]; ++frontier_) {
+            auto& buffer {buffers_[frontier_]};
+            if (!buffer) {
+                buffer = file_->read(frontier_ * state_->chunk_size, chunk_length(*state_, frontier_));
+            }
+            hash_.update(buffer->data(), buffer->size());
+            buffer.reset();
+        }
+    }
+
+    /**
+     * Combines the checksums of every chunk into the checksum of the file.
+     */
+    std::uint32_t crc32c() const
+    {
+        if (state_ == nullptr) {
+            return streamed_crc_;
+        }
+        std::uint32_t crc {0};
+        for (std::size_t chunk {0}; chunk < crcs_.size(); ++chunk) {
+            const auto length {chunk_length(*state_, chunk)};
+            auto chunk_crc {crcs_[chunk]};
+            if (!chunk_crc) {
+                const auto data {file_->read(chunk * state_->chunk_size, length)};
+                chunk_crc = crc32c_update(0, data.data(), data.size());
+            }
+            crc = crc32c_combine(crc, *chunk_crc, length);
+        }
+        return crc;
+    }
+
+    /**
+     * Hashes the chunks not yet hashed into the hash of the file.
+     */
+    std::uint64_t xxh64()
+    {
+        advance();
+        return hash_.digest();
+    }
+
+    /** The checksum computed. */
+    const Checksum_algorithm algorithm_;
+
+    /** Number of chunks past the first chunk not yet hashed that may be requested. */
+    const std::size_t window_;
+
+    /** State of the download, or nullptr if the whole file was streamed. */
+    const Download_state* state_;
+
+    /** The local file. */
+    const Local_file* file_;
+
+    /** CRC32C checksum of the body received in order from the start of the file. */
+    std::uint32_t streamed_crc_;
+
+    /** xxHash64 of the file up to the first chunk not yet hashed. */
+    Xxh64 hash_;
+
+    /** CRC32C checksum of each chunk received so far. */
+    std::vector<std::optional<std::uint32_t>> crcs_;
+
+    /** Contents of each chunk requested but not yet hashed. */
+    std::vector<std::optional<std::string>> buffers_;
+
+    /** If each chunk has been received. */
+    std::vector<bool> complete_;
+
+    /** Index of the first chunk not yet hashed. */
+    std::size_t frontier_;
+
+    /** Lower case digest supplied by the server, or an empty string if none was supplied. */
+    std::string server_digest_;
+
+    /** Status code of the last response, reported if the checksum does not match. */
+    int status_;
+};
+
+/**
+ * Requests every chunk not yet received concurrently, writing each in place and recording it in the state file once
+ * received. If a request fails, no new requests are started and the exception is rethrown once the requests already
+ * started complete.
+ *
+ * @param rest borrowed reference to the object to use for making REST API calls
+ * @param url borrowed reference to the url serving the file
+ * @param headers borrowed reference to the headers sent with every request
+ * @param file borrowed reference to the preallocated local file
+ * @param state borrowed reference to the state of the download
+ * @param record borrowed reference to the state file
+ * @param digest borrowed reference to the checksum of the download
+ * @param max_concurrency the maximum number of requests in flight at once
+ */
+void fetch_chunks(const Rest& rest,
+                  const std::string& url,
+                  const std::unordered_multimap<std::string, std::string>& headers,
+                  const Local_file& file,
+                  const Download_state& state,
+                  State_file& record,
+                  Download_digest& digest,
+                  int max_concurrency)
+{
+    struct Completed {
+        std::size_t chunk;
+        std::future<Response> response;
+    };
+
+    // sinks must outlive their requests, so each is kept until its request completes
+    std::vector<std::unique_ptr<Range_sink>> sinks(state.chunks.size());
+
+    std::mutex mutex {};
+    std::condition_variable completed_cv {};
+    std::deque<Completed> completed {};
+
+    std::size_t next {0};
+    auto in_flight {0};
+    std::exception_ptr error {};
+    while (true) {
+        while (!error && in_flight < std::max(max_concurrency, 1) && next < state.chunks.size() &&
+               digest.admits(next)) {
+            const auto chunk {next++};
+            if (state.chunks[chunk] == chunk_received) {
+                continue;
+            }
+
+            const auto offset {chunk * state.chunk_size};
+            const auto length {chunk_length(state, chunk)};
+            sinks[chunk] = std::make_unique<Range_sink>(file.fd(), offset, length, false, digest.observer(chunk));
+            ++in_flight;
+            rest.get_async(url,
+                           range_headers(headers, offset, length, state.validator),
+                           *sinks[chunk],
+                           [&mutex, &completed_cv, &completed, chunk](std::future<Response> response) {
+                               {
+                                   const std::lock_guard<std::mutex> lock {mutex};
+                                   completed.push_back(Completed {chunk, std::move(response)});
+                               }
+                               completed_cv.notify_one();
+                           });
+        }
+        if (in_flight == 0) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock {mutex};
+        completed_cv.wait(lock, [&completed] { return !completed.empty(); });
+        auto done {std::move(completed.front())};
+        completed.pop_front();
+        lock.unlock();
+        --in_flight;
+
+        try {
+            const auto response {done.response.get()};
+            check_chunk(response, *sinks[done.chunk], state, done.chunk);
+            record.mark(done.chunk);
+            digest.offer(response);
+            digest.received(done.chunk);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        sinks[done.chunk].reset();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * Downloads the file from the start, replacing the local file and recording its progress in a new state file.
+ *
+ * @param rest borrowed reference to the object to use for making REST API calls
+ * @param url borrowed reference to the url serving the file
+ * @param headers borrowed reference to the headers sent with every request
+ * @param local_path borrowed reference to the path of the local file to write
+ * @param state_path borrowed reference to the path of the state file
+ * @param options borrowed reference to the options controlling how the file is fetched
+ *
+ * @return the outcome of the download
+ */
+Download_result download_fresh(const Rest& rest,
+                               const std::string& url,
+                               const std::unordered_multimap<std::string, std::string>& headers,
+                               const std::string& local_path,
+                               const std::string& state_path,
+                               const Download_options& options)
+{
+    const Local_file file {local_path, O_RDWR | O_CREAT | O_TRUNC};
+    const auto chunk_size {std::max<std::uint64_t>(options.chunk_size, 1)};
+    Download_digest digest {options.checksum, options.max_concurrency};
+
+    // the first chunk reveals the size of the file, or the whole file if ranges are not supported
+    Range_sink first {file.fd(), 0, chunk_size, true, digest.stream()};
+    const auto response {rest.get(url, range_headers(headers, 0, chunk_size, ""), first)};
+    digest.offer(response);
+    if (response.status() == 200) {
+        ::unlink(state_path.c_str());
+        return digest.finish(first.written(), options.expected_digest);
+    }
+    if (response.status() != status_partial_content) {
+        throw Unexpected_response_error {Err::expect_206_msg, response.status()};
+    }
+
+    Download_state state {content_range_total(response), chunk_size, validator(response), {}};
+    state.chunks.assign(count_chunks(state.total, chunk_size), chunk_missing);
+    if (first.written() != std::min(chunk_size, state.total)) {
+        throw Unexpected_response_error {Err::range_size_msg, response.status()};
+    }
+    if (!state.chunks.empty()) {
+        state.chunks[0] = chunk_received;
+    }
+
+    preallocate(file, state.total);
+    State_file record {state_path, state};
+    digest.start(state, file, true);
+    fetch_chunks(rest, url, headers, file, state, record, digest, options.max_concurrency);
+    ::unlink(state_path.c_str());
+    return digest.finish(state.total, options.expected_digest);
+}
+
+} // namespace
+
+Range_sink::Range_sink(int fd, std::uint64_t offset, std::uint64_t length, bool whole_allowed, Observer observer)
+    : fd_ {fd},
+      offset_ {offset},
+      length_ {length},
+      whole_allowed_ {whole_allowed},
+      whole_ {false},
+      written_ {0},
+      observer_ {std::move(observer)}
+{
+}
+
+void Range_sink::start(int status)
+{
+    if (status == 200) {
+        if (!whole_allowed_) {
+            throw Resource_changed {};
+        }
+        whole_ = true;
+    } else if (status != status_partial_content) {
+        throw Unexpected_response_error {Err::expect_206_msg, status};
+    }
+}
+
+void Range_sink::write(const char* data, std::size_t size)
+{
+    if (!whole_ && written_ + size > length_) {
+        throw Unexpected_response_error {Err::range_size_msg, status_partial_content};
+    }
+    if (observer_) {
+        observer_(data, size);
+    }
+
+    while (size > 0) {
+        const auto written {::pwrite(fd_, data, size, static_cast<off_t>(offset_ + written_))};
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw Connection_error {std::strerror(errno)};
+        }
+        data += written;
+        size -= written;
+        written_ += written;
+    }
+}
+
+std::uint64_t Range_sink::written() const
+{
+    return written_;
+}
+
+const char* Resource_changed::what() const noexcept
+{
+    return "Resource changed since its download started";
+}
+
+std::optional<std::uint64_t> parse_content_range_total(std::string_view content_range)
+{
+    const auto slash {content_range.rfind('/')};
+    if (content_range.substr(0, 6) != "bytes " || slash == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    std::uint64_t total {};
+    const auto begin {content_range.data() + slash + 1};
+    const auto end {content_range.data() + content_range.size()};
+    const auto [ptr, err] {std::from_chars(begin, end, total)};
+    if (err != std::errc {} || ptr != end) {
+        return std::nullopt;
+    }
+    return total;
+}
+
+Download_result ranged_download(const Rest& rest,
+                                const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers,
+                                const std::string& local_path,
+                                const Download_options& options)
+{
+    const auto state_path {local_path + download_state_suffix};
+
+    if (const auto state {load_state(state_path, local_path)}) {
+        try {
+            const Local_file file {local_path, O_RDWR};
+            State_file record {state_path, *state};
+            Download_digest digest {options.checksum, options.max_concurrency};
+            digest.start(*state, file, false);
+            fetch_chunks(rest, url, headers, file, *state, record, digest, options.max_concurrency);
+            ::unlink(state_path.c_str());
+            return digest.finish(state->total, options.expected_digest);
+        } catch (const Resource_changed&) {
+            // the chunks already received belong to an older version of the file
+        }
+    }
+
+    try {
+        return download_fresh(rest, url, headers, local_path, state_path, options);
+    } catch (const Resource_changed&) {
+        // the state file is kept, so downloading again detects the change and starts over
+        throw Unexpected_response_error {Err::expect_206_msg, 200};
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,151 @@
+/**
+ * @file ranged_download.h
+ * Defines the download of a file over concurrent range requests, resumable after an interruption.
+ */
+
+#ifndef ONEDATASHARE_RANGED_DOWNLOAD_H
+#define ONEDATASHARE_RANGED_DOWNLOAD_H
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <onedatashare/endpoint.h>
+
+#include "body_sink.h"
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/** Suffix appended to the path of a local file to name the file recording its interrupted download. */
+constexpr auto download_state_suffix {".odsdownload"};
+
+/**
+ * Body_sink writing the body of a response to a range request in place within a file with pwrite, so that many
+ * ranges of the same file can be received at once.
+ */
+class Range_sink : public Body_sink {
+public:
+    /** Callback passed each piece of the body before it is written. */
+    using Observer = std::function<void(const char* data, std::size_t size)>;
+
+    /**
+     * Creates a new Range_sink writing the specified range of the file.
+     *
+     * @param fd the open file descriptor written to, which is not closed by this object
+     * @param offset the offset of the first byte of the range
+     * @param length the number of bytes in the range
+     * @param whole_allowed if a 200 response carrying the whole file is accepted in place of the range, in which case
+     * the body is written starting at the offset
+     * @param observer callback passed each piece of the body before it is written, or nullptr for none
+     */
+    Range_sink(int fd, std::uint64_t offset, std::uint64_t length, bool whole_allowed, Observer observer = nullptr);
+
+    /**
+     * Checks that the response is a partial response, or a whole response if whole responses are allowed.
+     *
+     * @param status the http response status code
+     *
+     * @exception Resource_changed if a whole response is received when a partial response is expected
+     * @exception Unexpected_response_error if the response is neither partial nor whole
+     */
+    void start(int status) override;
+
+    /**
+     * Writes the chunk after the chunks already written.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     *
+     * @exception Connection_error if writing to the file descriptor fails
+     * @exception Unexpected_response_error if a partial response body exceeds the range
+     */
+    void write(const char* data, std::size_t size) override;
+
+    /**
+     * Gets the number of bytes written so far.
+     *
+     * @return the number of bytes written
+     */
+    std::uint64_t written() const;
+
+private:
+    /** The file descriptor written to. */
+    const int fd_;
+
+    /** Offset of the first byte of the range. */
+    const std::uint64_t offset_;
+
+    /** Number of bytes in the range. */
+    const std::uint64_t length_;
+
+    /** If a whole response is accepted. */
+    const bool whole_allowed_;
+
+    /** If a whole response is being received. */
+    bool whole_;
+
+    /** Number of bytes written so far. */
+    std::uint64_t written_;
+
+    /** Callback passed each piece of the body before it is written. */
+    const Observer observer_;
+};
+
+/**
+ * Raised when a range request is answered with the whole file, meaning that the file changed since its interrupted
+ * download was recorded.
+ */
+class Resource_changed : public std::exception {
+public:
+    const char* what() const noexcept override;
+};
+
+/**
+ * Gets the total size of the file from the value of a Content-Range header, such as "bytes 0-1023/4096".
+ *
+ * @param content_range the value of the header
+ *
+ * @return the total size, or no value if the header is malformed or the total size is unknown
+ */
+std::optional<std::uint64_t> parse_content_range_total(std::string_view content_range);
+
+/**
+ * Downloads the file served at the specified url to the specified local path. The first chunk is requested on its
+ * own to learn the size of the file, then the local file is preallocated and the remaining chunks are requested
+ * concurrently, each written in place. The chunks received so far are recorded in a state file so that downloading
+ * the same url to the same path again after an interruption fetches only the missing chunks, unless an If-Range
+ * request shows that the file changed, in which case the download starts over.
+ *
+ * If a checksum is requested, each chunk is checksummed as it is received. CRC32C checksums of chunks received out
+ * of order are combined once every chunk is received, while xxHash64 requires the file in order, so chunks received
+ * ahead of the first missing chunk are held in memory and no more chunks are requested than fit a window of twice
+ * the maximum concurrency past the first missing chunk.
+ *
+ * @param rest borrowed reference to the object to use for making REST API calls
+ * @param url borrowed reference to the url serving the file in response to GET requests
+ * @param headers borrowed reference to the headers sent with every request
+ * @param local_path borrowed reference to the path of the local file to write
+ * @param options borrowed reference to the options controlling how the file is fetched
+ *
+ * @return the size of the file and its checksum, if requested
+ *
+ * @exception Connection_error if unable to connect to the url or unable to write the local file
+ * @exception Unexpected_response_error if an unexpected response is received or the checksum does not match the
+ * expected digest
+ */
+Download_result ranged_download(const Rest& rest,
+                                const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers,
+                                const std::string& local_path,
+                                const Download_options& options);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_RANGED_DOWNLOAD_H
@@ -0,0 +1,478 @@
+/**
+ * @file rate_limited_rest.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <onedatashare/ods_error.h>
+
+#include "curl_multi_rest.h"
+#include "rate_limited_rest.h"
+#include "timer_queue.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** Error message given to requests still queued when the Rate_limited_rest object is destroyed. */
+constexpr auto cancelled_msg {"Request cancelled before it was started"};
+
+/** Status the server responds with when the client exceeds its rate limit. */
+constexpr auto status_too_many_requests {429};
+
+/** Status the server responds with when it sheds load. */
+constexpr auto status_unavailable {503};
+
+/** Weight of each new round trip time in the smoothed round trip time. */
+constexpr auto rtt_smoothing {0.1};
+
+/**
+ * Gets the host, along with the scheme and port, of the specified url.
+ *
+ * @param url borrowed reference to the url
+ *
+ * @return the url up to the start of its path, query, or fragment
+ */
+std::string host_of(const std::string& url)
+{
+    const auto scheme {url.find("://")};
+    const auto host_start {scheme == std::string::npos ? 0 : scheme + 3};
+    return url.substr(0, url.find_first_of("/?#", host_start));
+}
+
+/**
+ * Creates a ready future holding the specified exception.
+ *
+ * @param error the exception
+ *
+ * @return the future
+ */
+std::future<Response> failed(std::exception_ptr error)
+{
+    std::promise<Response> promise {};
+    promise.set_exception(std::move(error));
+    return promise.get_future();
+}
+
+} // namespace
+
+struct Rate_limited_rest::State : std::enable_shared_from_this<State> {
+    /**
+     * A request waiting for the limits to allow it.
+     */
+    struct Queued {
+        /** Starts the request through the inner REST caller, invoking the callback once it completes. */
+        std::function<void(const Rest& inner, Response_callback callback)> start;
+
+        /** Callback of the request. */
+        Response_callback callback;
+
+        /** Host the request is made to if its round trip time is tracked as a signal of the load on the server, or an
+         * empty string otherwise. */
+        std::string host;
+    };
+
+    /**
+     * Round trip times of the timed requests made to one host.
+     */
+    struct Round_trips {
+        /** Smoothed round trip time, in seconds. */
+        double smoothed;
+
+        /** Least round trip time, in seconds, over the current window. */
+        double least;
+
+        /** Least round trip time, in seconds, over the previous window. */
+        double previous_least;
+
+        /** Start of the current window. */
+        Clock::time_point window_start;
+    };
+
+    State(std::weak_ptr<Rest> inner, const Rate_limit_options& options)
+        : inner {std::move(inner)},
+          options {options},
+          rate {options.max_rate},
+          tokens {options.burst},
+          refilled {Clock::now()},
+          limit {std::clamp(options.initial_concurrency, options.min_concurrency, options.max_concurrency)},
+          since_backoff {limit}
+    {}
+
+    /**
+     * Queues the specified request and starts every queued request the limits allow.
+     *
+     * @param request moved request to queue
+     */
+    void submit(Queued request)
+    {
+        {
+            const std::lock_guard<std::mutex> lock {mutex};
+            queue.push_back(std::move(request));
+        }
+        dispatch();
+    }
+
+    /**
+     * Starts queued requests in order until the queue is empty or a limit is reached, scheduling a wake up on the
+     * shared Timer_queue for when the token bucket next holds a token. Only one thread dispatches at a time, and a
+     * thread asking to dispatch while another is dispatching leaves the work to the other thread, so requests that
+     * complete before their start returns do not recurse into dispatch.
+     */
+    void dispatch()
+    {
+        {
+            const std::lock_guard<std::mutex> lock {mutex};
+            if (dispatching) {
+                redispatch = true;
+                return;
+            }
+            dispatching = true;
+        }
+
+        while (true) {
+            std::optional<Queued> next {};
+            std::optional<Clock::time_point> wake {};
+            auto done {false};
+            {
+                const std::lock_guard<std::mutex> lock {mutex};
+                if (!queue.empty() && in_flight < std::max(options.min_concurrency, limit)) {
+                    const auto now {Clock::now()};
+                    refill(now);
+                    if (tokens >= 1) {
+                        tokens -= 1;
+                        ++in_flight;
+                        next.emplace(std::move(queue.front()));
+                        queue.pop_front();
+                    } else if (!waking) {
+                        waking = true;
+                        wake = now + std::chrono::duration_cast<Clock::duration>(
+                                         std::chrono::duration<double> {(1 - tokens) / rate});
+                    }
+                }
+                if (!next) {
+                    done = !redispatch;
+                    redispatch = false;
+                    dispatching = !done;
+                }
+            }
+
+            if (wake) {
+                Timer_queue::shared().schedule(*wake, [self {shared_from_this()}] {
+                    {
+                        const std::lock_guard<std::mutex> lock {self->mutex};
+                        self->waking = false;
+                    }
+                    self->dispatch();
+                });
+            }
+            if (next) {
+                start(std::move(*next));
+            } else if (done) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Starts the specified request through the inner REST caller, failing it if the inner REST caller has been
+     * destroyed.
+     *
+     * @param request moved request to start
+     */
+    void start(Queued request)
+    {
+        const auto sent {Clock::now()};
+        auto callback {[self {shared_from_this()},
+                        sent,
+                        host {std::move(request.host)},
+                        callback {request.callback}](std::future<Response> response) {
+            self->complete(sent, host, callback, std::move(response));
+        }};
+
+        const auto inner {this->inner.lock()};
+        if (!inner) {
+            callback(failed(std::make_exception_ptr(Connection_error {cancelled_msg})));
+            return;
+        }
+        try {
+            request.start(*inner, callback);
+        } catch (...) {
+            callback(failed(std::current_exception()));
+        }
+    }
+
+    /**
+     * Adjusts the limits according to the outcome of a request, passes the outcome to the request's callback, and
+     * schedules the queued requests to be started on the shared Timer_queue, since this runs on a thread owned by the
+     * inner REST caller.
+     *
+     * @param sent the time the request was started
+     * @param host borrowed reference to the host the request was made to if its round trip time is a signal of the
+     * load on the server, or an empty string otherwise
+     * @param callback borrowed reference to the callback of the request
+     * @param response moved future holding the response or exception of the request
+     */
+    void complete(Clock::time_point sent,
+                  const std::string& host,
+                  const Response_callback& callback,
+                  std::future<Response> response)
+    {
+        std::optional<Response> received {};
+        std::exception_ptr error {};
+        try {
+            received.emplace(response.get());
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        auto waiting {false};
+        {
+            const std::lock_guard<std::mutex> lock {mutex};
+            --in_flight;
+            if (received) {
+                adapt(received->status(), host, sent);
+            }
+            waiting = !queue.empty();
+        }
+
+        if (waiting) {
+            Timer_queue::shared().schedule(Clock::now(), [self {shared_from_this()}] { self->dispatch(); });
+        }
+
+        std::promise<Response> outcome {};
+        if (received) {
+            outcome.set_value(std::move(*received));
+        } else {
+            outcome.set_exception(error);
+        }
+        callback(outcome.get_future());
+    }
+
+    /**
+     * Adjusts the limits according to the status and round trip time of a response. Must be called with the mutex
+     * held.
+     *
+     * @param status the http response status code
+     * @param host borrowed reference to the host the request was made to if its round trip time is a signal of the
+     * load on the server, or an empty string otherwise
+     * @param sent the time the request was started
+     */
+    void adapt(int status, const std::string& host, Clock::time_point sent)
+    {
+        ++since_backoff;
+        auto overloaded {status == status_too_many_requests || status == status_unavailable};
+
+        if (!host.empty() && !overloaded) {
+            const auto now {Clock::now()};
+            const auto seconds {std::chrono::duration<double> {now - sent}.count()};
+            const auto [entry, inserted] {round_trips.try_emplace(host, Round_trips {seconds, seconds, seconds, now})};
+            auto& trips {entry->second};
+            if (!inserted) {
+                trips.smoothed += (seconds - trips.smoothed) * rtt_smoothing;
+                if (now - trips.window_start >= std::chrono::duration<double> {options.rtt_window}) {
+                    // start a new window, keeping the previous one so that the least round trip time never rests on
+                    // only a few samples
+                    trips.previous_least = trips.least;
+                    trips.least = seconds;
+                    trips.window_start = now;
+                } else {
+                    trips.least = std::min(trips.least, seconds);
+                }
+            }
+            overloaded = trips.smoothed > std::min(trips.least, trips.previous_least) * options.rtt_tolerance;
+        }
+
+        if (!overloaded) {
+            limit = std::min(options.max_concurrency, limit + 1 / limit);
+            rate = std::min(options.max_rate, rate + options.rate_increase / rate);
+            return;
+        }
+
+        // back off at most once per round trip, since every request in flight when the server became overloaded
+        // reports it
+        if (since_backoff < limit) {
+            return;
+        }
+        since_backoff = 0;
+        limit = std::max(options.min_concurrency, limit * options.backoff);
+        if (status == status_too_many_requests) {
+            rate = std::max(options.min_rate, rate * options.backoff);
+            tokens = std::min(tokens, 1.0);
+        }
+    }
+
+    /**
+     * Adds the tokens accumulated since the bucket was last refilled. Must be called with the mutex held.
+     *
+     * @param now the current time
+     */
+    void refill(Clock::time_point now)
+    {
+        tokens = std::min(options.burst, tokens + std::chrono::duration<double> {now - refilled}.count() * rate);
+        refilled = now;
+    }
+
+    /** REST caller making each request, held weakly so that the last reference to it is never dropped by one of its
+     * own callbacks. */
+    const std::weak_ptr<Rest> inner;
+
+    /** Options controlling the limits. */
+    const Rate_limit_options options;
+
+    /** Guards every member below. */
+    mutable std::mutex mutex {};
+
+    /** Requests waiting for the limits to allow them. */
+    std::deque<Queued> queue {};
+
+    /** Number of requests started per second. */
+    double rate;
+
+    /** Number of requests that may be started before waiting for the bucket to refill. */
+    double tokens;
+
+    /** Time the bucket was last refilled. */
+    Clock::time_point refilled;
+
+    /** Number of requests allowed in flight at once. */
+    double limit;
+
+    /** Number of requests in flight. */
+    double in_flight {0};
+
+    /** Number of responses received since the limits last backed off, starting at the limit so that the first
+     * overloaded response backs off. */
+    double since_backoff;
+
+    /** Round trip times of the timed requests made to each host. */
+    std::unordered_map<std::string, Round_trips> round_trips {};
+
+    /** If a thread is dispatching. */
+    bool dispatching {false};
+
+    /** If dispatch was asked for while a thread was dispatching. */
+    bool redispatch {false};
+
+    /** If a wake up is scheduled for when the bucket next holds a token. */
+    bool waking {false};
+};
+
+Rate_limited_rest::Rate_limited_rest(std::shared_ptr<Rest> inner, const Rate_limit_options& options)
+    : inner_ {inner}, state_ {std::make_shared<State>(std::move(inner), options)}
+{}
+
+Rate_limited_rest::~Rate_limited_rest()
+{
+    std::deque<State::Queued> queued {};
+    {
+        const std::lock_guard<std::mutex> lock {state_->mutex};
+        queued.swap(state_->queue);
+    }
+    for (auto& request : queued) {
+        request.callback(failed(std::make_exception_ptr(Connection_error {cancelled_msg})));
+    }
+}
+
+std::shared_ptr<Rate_limited_rest> Rate_limited_rest::shared()
+{
+    static std::mutex mutex {};
+    static std::weak_ptr<Rate_limited_rest> instance {};
+
+    std::lock_guard<std::mutex> lock {mutex};
+    auto rest {instance.lock()};
+    if (!rest) {
+        rest = std::make_shared<Rate_limited_rest>(Curl_multi_rest::shared());
+        instance = rest;
+    }
+
+    return rest;
+}
+
+Response Rate_limited_rest::get(const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers) const
+{
+    expect_blocking_allowed();
+    return get_async(url, headers).get();
+}
+
+Response Rate_limited_rest::post(const std::string& url,
+                                 const std::unordered_multimap<std::string, std::string>& headers,
+                                 const std::string& data) const
+{
+    expect_blocking_allowed();
+    return post_async(url, headers, data).get();
+}
+
+Response Rate_limited_rest::get(const std::string& url,
+                                const std::unordered_multimap<std::string, std::string>& headers,
+                                Body_sink& sink) const
+{
+    expect_blocking_allowed();
+    const auto promise {std::make_shared<std::promise<Response>>()};
+    auto response {promise->get_future()};
+    get_async(url, headers, sink, fulfill(promise, [](Response received) { return received; }));
+    return response.get();
+}
+
+void Rate_limited_rest::get_async(const std::string& url,
+                                  const std::unordered_multimap<std::string, std::string>& headers,
+                                  Response_callback callback) const
+{
+    state_->submit({[url, headers](const Rest& inner, Response_callback done) {
+                        inner.get_async(url, headers, std::move(done));
+                    },
+                    std::move(callback),
+                    state_->options.rtt_tolerance > 0 ? host_of(url) : std::string {}});
+}
+
+void Rate_limited_rest::get_async(const std::string& url,
+                                  const std::unordered_multimap<std::string, std::string>& headers,
+                                  Body_sink& sink,
+                                  Response_callback callback) const
+{
+    state_->submit({[url, headers, &sink](const Rest& inner, Response_callback done) {
+                        inner.get_async(url, headers, sink, std::move(done));
+                    },
+                    std::move(callback),
+                    {}});
+}
+
+void Rate_limited_rest::post_async(const std::string& url,
+                                   const std::unordered_multimap<std::string, std::string>& headers,
+                                   std::string data,
+                                   Response_callback callback) const
+{
+    // the data is moved into the request when it starts, since each queued request is started once
+    state_->submit({[url, headers, data {std::move(data)}](const Rest& inner, Response_callback done) mutable {
+                        inner.post_async(url, headers, std::move(data), std::move(done));
+                    },
+                    std::move(callback),
+                    {}});
+}
+
+double Rate_limited_rest::concurrency_limit() const
+{
+    const std::lock_guard<std::mutex> lock {state_->mutex};
+    return state_->limit;
+}
+
+double Rate_limited_rest::rate() const
+{
+    const std::lock_guard<std::mutex> lock {state_->mutex};
+    return state_->rate;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,168 @@
+/**
+ * @file rate_limited_rest.h
+ * Defines a REST caller adapting the rate and concurrency of the requests made through another REST caller to the
+ * load the server sustains.
+ */
+
+#ifndef ONEDATASHARE_RATE_LIMITED_REST_H
+#define ONEDATASHARE_RATE_LIMITED_REST_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Options controlling how a Rate_limited_rest object limits the requests made through it.
+ */
+struct Rate_limit_options {
+    /** Greatest number of requests started per second. */
+    double max_rate {500};
+
+    /** Least number of requests started per second, however often the server asks for fewer. */
+    double min_rate {1};
+
+    /** Number of requests that may be started at once after a period without requests. */
+    double burst {32};
+
+    /** Requests per second added to the rate over each second in which no response has a 429 status. */
+    double rate_increase {10};
+
+    /** Number of requests allowed in flight at once before any response is received. */
+    double initial_concurrency {16};
+
+    /** Least number of requests allowed in flight at once. */
+    double min_concurrency {1};
+
+    /** Greatest number of requests allowed in flight at once. */
+    double max_concurrency {256};
+
+    /** Factor the rate and concurrency limit are multiplied by when the server is overloaded. */
+    double backoff {0.5};
+
+    /** Factor by which the smoothed round trip time of a host may exceed its least recent round trip time before the
+     * host is treated as overloaded, or 0 to back off on 429 and 503 statuses only. Round trip times only signal load
+     * when every request to a host takes about as long to serve, so this is off by default: requests whose service
+     * times differ, such as listings of small and large directories, would otherwise look like an overloaded server. */
+    double rtt_tolerance {0};
+
+    /** Seconds over which the least recent round trip time of a host is taken, so that it follows a lasting change in
+     * the network rather than holding the least round trip time ever seen. */
+    double rtt_window {10};
+};
+
+/**
+ * Decorator limiting the requests made through another REST caller with a token bucket, bounding the number of
+ * requests started per second, and an additive-increase, multiplicative-decrease limit on the number of requests in
+ * flight. The concurrency limit grows by one over each round trip and is multiplied by the backoff once per round
+ * trip when a response has a 429 or 503 status. A 429 status also backs off the rate, which then grows back linearly.
+ * When a round trip time tolerance is set, the limit also backs off when the smoothed round trip time of GET requests
+ * to a host rises beyond the tolerance of the least round trip time to that host over a recent window. Requests
+ * beyond either limit wait in a queue and are started in the order they were made, so the limits find the load the
+ * server sustains without tuning the number of threads making requests. Only GET requests without a sink are timed,
+ * since the round trip time of transfers grows with their size rather than with the load on the server. Queued
+ * requests are started on the shared Timer_queue, never on a thread owned by the inner REST caller.
+ */
+class Rate_limited_rest : public Rest {
+public:
+    using Rest::get_async;
+    using Rest::post_async;
+
+    /**
+     * Creates a new Rate_limited_rest object making requests through the specified REST caller.
+     *
+     * @param inner shared pointer to the REST caller making each request
+     * @param options borrowed reference to the options controlling the limits
+     */
+    explicit Rate_limited_rest(std::shared_ptr<Rest> inner, const Rate_limit_options& options = {});
+
+    /**
+     * Destroys the object. Requests still queued fail with a Connection_error.
+     */
+    ~Rate_limited_rest() override;
+
+    /**
+     * Gets the Rate_limited_rest object, wrapping the shared Curl_multi_rest object with the default options, shared
+     * by every service created without an explicit REST caller, creating it if no service currently holds it.
+     * Sharing it lets the limits account for every request made to the server by the process.
+     *
+     * @return shared pointer to the shared object
+     */
+    static std::shared_ptr<Rate_limited_rest> shared();
+
+    /**
+     * Performs a GET request once the limits allow it, blocking until it completes.
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers) const override;
+
+    /**
+     * Performs a POST request once the limits allow it, blocking until it completes.
+     */
+    Response post(const std::string& url,
+                  const std::unordered_multimap<std::string, std::string>& headers,
+                  const std::string& data) const override;
+
+    /**
+     * Performs a GET request writing to a sink once the limits allow it, blocking until it completes.
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers,
+                 Body_sink& sink) const override;
+
+    /**
+     * Starts a GET request once the limits allow it.
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Response_callback callback) const override;
+
+    /**
+     * Starts a GET request writing to a sink once the limits allow it.
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Body_sink& sink,
+                   Response_callback callback) const override;
+
+    /**
+     * Starts a POST request once the limits allow it.
+     */
+    void post_async(const std::string& url,
+                    const std::unordered_multimap<std::string, std::string>& headers,
+                    std::string data,
+                    Response_callback callback) const override;
+
+    /**
+     * Gets the current limit on the number of requests in flight.
+     *
+     * @return the concurrency limit
+     */
+    double concurrency_limit() const;
+
+    /**
+     * Gets the current limit on the number of requests started per second.
+     *
+     * @return the rate
+     */
+    double rate() const;
+
+private:
+    /** The limits and the queue of waiting requests, shared with the requests in flight. */
+    struct State;
+
+    /** REST caller making each request. */
+    const std::shared_ptr<Rest> inner_;
+
+    /** Shared state. */
+    const std::shared_ptr<State> state_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_RATE_LIMITED_REST_H
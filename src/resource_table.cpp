@@ -0,0 +1,226 @@
+/**
+ * @file resource_table.cpp
+ */
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/resource_table.h>
+
+namespace Onedatashare {
+
+Resource_table::View::View(const Resource_table* table, std::size_t index) : table_ {table}, index_ {index} {}
+
+std::optional<std::string_view> Resource_table::View::id() const
+{
+    return table_->load(table_->ids_[index_]);
+}
+
+std::string_view Resource_table::View::name() const
+{
+    return *table_->load(table_->names_[index_]);
+}
+
+long Resource_table::View::size() const
+{
+    return table_->sizes_[index_];
+}
+
+long Resource_table::View::time() const
+{
+    return table_->times_[index_];
+}
+
+bool Resource_table::View::is_directory() const
+{
+    return table_->flags_[index_] & directory_flag;
+}
+
+bool Resource_table::View::is_file() const
+{
+    return table_->flags_[index_] & file_flag;
+}
+
+std::optional<std::string_view> Resource_table::View::link() const
+{
+    return table_->load(table_->links_[index_]);
+}
+
+std::optional<std::string_view> Resource_table::View::permissions() const
+{
+    return table_->load(table_->permissions_[index_]);
+}
+
+Resource Resource_table::View::to_resource() const
+{
+    const auto copy {[](std::optional<std::string_view> str) {
+        return str ? std::optional<std::string> {*str} : std::nullopt;
+    }};
+
+    return {copy(id()),
+            std::string {name()},
+            size(),
+            time(),
+            is_directory(),
+            is_file(),
+            copy(link()),
+            copy(permissions()),
+            std::nullopt};
+}
+
+Resource_table::Iterator::Iterator(const Resource_table* table, std::size_t index) : table_ {table}, index_ {index} {}
+
+Resource_table::View Resource_table::Iterator::operator*() const
+{
+    return View {table_, index_};
+}
+
+Resource_table::Iterator& Resource_table::Iterator::operator++()
+{
+    ++index_;
+    return *this;
+}
+
+Resource_table::Iterator Resource_table::Iterator::operator++(int)
+{
+    auto previous {*this};
+    ++index_;
+    return previous;
+}
+
+bool Resource_table::Iterator::operator==(const Iterator& other) const
+{
+    return table_ == other.table_ && index_ == other.index_;
+}
+
+bool Resource_table::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+Resource_table::Resource_table(bool intern_permissions)
+    : intern_permissions_ {intern_permissions},
+      arena_ {},
+      ids_ {},
+      names_ {},
+      links_ {},
+      permissions_ {},
+      sizes_ {},
+      times_ {},
+      flags_ {},
+      interned_ {}
+{}
+
+std::size_t Resource_table::size() const
+{
+    return names_.size();
+}
+
+bool Resource_table::empty() const
+{
+    return names_.empty();
+}
+
+Resource_table::View Resource_table::operator[](std::size_t index) const
+{
+    return View {this, index};
+}
+
+Resource_table::Iterator Resource_table::begin() const
+{
+    return Iterator {this, 0};
+}
+
+Resource_table::Iterator Resource_table::end() const
+{
+    return Iterator {this, size()};
+}
+
+void Resource_table::reserve(std::size_t resources, std::size_t arena_bytes)
+{
+    arena_.reserve(arena_bytes);
+    ids_.reserve(resources);
+    names_.reserve(resources);
+    links_.reserve(resources);
+    permissions_.reserve(resources);
+    sizes_.reserve(resources);
+    times_.reserve(resources);
+    flags_.reserve(resources);
+}
+
+void Resource_table::add(std::optional<std::string_view> id,
+                         std::string_view name,
+                         long size,
+                         long time,
+                         bool is_directory,
+                         bool is_file,
+                         std::optional<std::string_view> link,
+                         std::optional<std::string_view> permissions)
+{
+    ids_.push_back(store(id));
+    names_.push_back(store(name));
+    links_.push_back(store(link));
+
+    if (intern_permissions_ && permissions) {
+        const auto [iter, inserted] {interned_.try_emplace(std::string {*permissions}, Span {0, absent_size})};
+        if (inserted) {
+            iter->second = store(permissions);
+        }
+        permissions_.push_back(iter->second);
+    } else {
+        permissions_.push_back(store(permissions));
+    }
+
+    sizes_.push_back(size);
+    times_.push_back(time);
+    flags_.push_back((is_directory ? directory_flag : 0) | (is_file ? file_flag : 0));
+}
+
+void Resource_table::add(const Resource& resource)
+{
+    const auto view {[](const std::optional<std::string>& str) {
+        return str ? std::optional<std::string_view> {*str} : std::nullopt;
+    }};
+
+    add(view(resource.id),
+        resource.name,
+        resource.size,
+        resource.time,
+        resource.is_directory,
+        resource.is_file,
+        view(resource.link),
+        view(resource.permissions));
+}
+
+void Resource_table::clear()
+{
+    arena_.clear();
+    ids_.clear();
+    names_.clear();
+    links_.clear();
+    permissions_.clear();
+    sizes_.clear();
+    times_.clear();
+    flags_.clear();
+    interned_.clear();
+}
+
+Resource_table::Span Resource_table::store(std::optional<std::string_view> str)
+{
+    if (!str) {
+        return {0, absent_size};
+    }
+
+    const Span span {arena_.size(), static_cast<std::uint32_t>(str->size())};
+    arena_.append(*str);
+    return span;
+}
+
+std::optional<std::string_view> Resource_table::load(Span span) const
+{
+    if (span.size == absent_size) {
+        return std::nullopt;
+    }
+
+    return std::string_view {arena_}.substr(span.offset, span.size);
+}
+
+} // namespace Onedatashare
@@ -5,14 +5,211 @@
  * @date 6/5/20
  */
 
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+#include "error_message.h"
 #include "rest.h"
 
 namespace Onedatashare {
 namespace Internal {
 
+namespace {
+
+/**
+ * Checks if the specified strings are equal, ignoring case.
+ *
+ * @param a the first string
+ * @param b the second string
+ *
+ * @return true if the strings are equal ignoring case, false otherwise
+ */
+bool equals_ignore_case(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+/** Whether the current thread is the event loop thread of an asynchronous Rest object. */
+thread_local bool on_event_loop_thread {false};
+
+} // namespace
+
+void mark_event_loop_thread()
+{
+    on_event_loop_thread = true;
+}
+
+void expect_blocking_allowed()
+{
+    if (on_event_loop_thread) {
+        throw std::logic_error {Err::blocking_on_event_loop_msg};
+    }
+}
+
+Response::Response(std::string buffer, std::vector<Header_span> headers, std::size_t body_offset, int status)
+    : buffer_ {std::move(buffer)},
+      headers_ {std::move(headers)},
+      body_offset_ {body_offset},
+      status_ {status}
+{}
+
+Response::Response(const std::unordered_multimap<std::string, std::string>& headers, std::string body, int status)
+    : buffer_ {},
+      headers_ {},
+      body_offset_ {0},
+      status_ {status}
+{
+    headers_.reserve(headers.size());
+    for (const auto& [key, value] : headers) {
+        body_offset_ += key.size() + value.size() + 4;
+    }
+
+    // lay out the headers as raw header lines in front of the body
+    buffer_.reserve(body_offset_ + body.size() + body_padding);
+    for (const auto& [key, value] : headers) {
+        const auto key_offset {buffer_.size()};
+        buffer_.append(key).append(": ");
+        const auto value_offset {buffer_.size()};
+        buffer_.append(value).append("\r\n");
+        headers_.push_back({key_offset, key.size(), value_offset, value.size()});
+    }
+    buffer_.append(body);
+}
+
+int Response::status() const
+{
+    return status_;
+}
+
+std::string_view Response::body() const
+{
+    return std::string_view {buffer_}.substr(body_offset_);
+}
+
+std::size_t Response::body_capacity() const
+{
+    return buffer_.capacity() - body_offset_;
+}
+
+std::string Response::release_body()
+{
+    // shift the body over the headers within the same allocation
+    buffer_.erase(0, body_offset_);
+    headers_.clear();
+    body_offset_ = 0;
+
+    return std::move(buffer_);
+}
+
+void Response::clear_body()
+{
+    buffer_.resize(body_offset_);
+}
+
+std::optional<std::string_view> Response::header(std::string_view key) const
+{
+    const std::string_view buffer {buffer_};
+    for (const auto& h : headers_) {
+        if (equals_ignore_case(buffer.substr(h.key_offset, h.key_size), key)) {
+            return buffer.substr(h.value_offset, h.value_size);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::size_t Response::header_count() const
+{
+    return headers_.size();
+}
+
 Rest::Rest() = default;
 
 Rest::~Rest() = default;
 
+namespace {
+
+/**
+ * Invokes the specified callback with the result of the specified request.
+ *
+ * @param callback borrowed reference to the callback to invoke
+ * @param request function making the request
+ */
+template <typename F>
+void complete(const Response_callback& callback, F request)
+{
+    std::promise<Response> promise {};
+    try {
+        promise.set_value(request());
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    callback(promise.get_future());
+}
+
+} // namespace
+
+Response Rest::get(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Body_sink& sink) const
+{
+    auto response {get(url, headers)};
+    const auto body {response.body()};
+    sink.start(response.status());
+    sink.expect(body.size());
+    sink.write(body.data(), body.size());
+    response.clear_body();
+
+    return response;
+}
+
+void Rest::get_async(const std::string& url,
+                     const std::unordered_multimap<std::string, std::string>& headers,
+                     Response_callback callback) const
+{
+    complete(callback, [&] { return get(url, headers); });
+}
+
+void Rest::get_async(const std::string& url,
+                     const std::unordered_multimap<std::string, std::string>& headers,
+                     Body_sink& sink,
+                     Response_callback callback) const
+{
+    complete(callback, [&] { return get(url, headers, sink); });
+}
+
+void Rest::post_async(const std::string& url,
+                      const std::unordered_multimap<std::string, std::string>& headers,
+                      std::string data,
+                      Response_callback callback) const
+{
+    complete(callback, [&] { return post(url, headers, data); });
+}
+
+std::future<Response> Rest::get_async(const std::string& url,
+                                      const std::unordered_multimap<std::string, std::string>& headers) const
+{
+    auto promise {std::make_shared<std::promise<Response>>()};
+    auto future {promise->get_future()};
+    get_async(url, headers, fulfill(std::move(promise), [](Response response) { return response; }));
+
+    return future;
+}
+
+std::future<Response> Rest::post_async(const std::string& url,
+                                       const std::unordered_multimap<std::string, std::string>& headers,
+                                       std::string data) const
+{
+    auto promise {std::make_shared<std::promise<Response>>()};
+    auto future {promise->get_future()};
+    post_async(url, headers, std::move(data), fulfill(std::move(promise), [](Response response) { return response; }));
+
+    return future;
+}
+
 } // namespace Internal
 } // namespace Onedatashare
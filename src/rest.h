@@ -9,28 +9,146 @@
 #ifndef ONEDATASHARE_REST_H
 #define ONEDATASHARE_REST_H
 
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "body_sink.h"
 
 namespace Onedatashare {
 namespace Internal {
 
 /**
- * Holds the response from a request made via the get or post functions.
+ * Holds the response from a request made via the get or post functions. The raw header lines and the body are kept
+ * in a single buffer, with headers located by offsets into the buffer, so a Response can be moved without copying
+ * and headers are looked up without allocating.
  */
-struct Response {
-    /** Multi-map storing response headers as (key, value) pairs. */
-    const std::unordered_multimap<std::string, std::string> headers;
+class Response {
+public:
+    /** Spare capacity kept after the body of responses received by the libcurl based REST callers, which lets parsers
+     * that read past the end of their input parse the body in place. */
+    static constexpr std::size_t body_padding {64};
+
+    /**
+     * Location of a header within the buffer of a Response.
+     */
+    struct Header_span {
+        /** Offset of the header key. */
+        std::size_t key_offset;
+
+        /** Size of the header key. */
+        std::size_t key_size;
+
+        /** Offset of the header value. */
+        std::size_t value_offset;
+
+        /** Size of the header value. */
+        std::size_t value_size;
+    };
+
+    /**
+     * Creates a new Response from a buffer of raw header lines followed by the body.
+     *
+     * @param buffer moved buffer holding the raw header lines followed by the body
+     * @param headers moved list of the locations of the headers within the buffer
+     * @param body_offset offset of the body within the buffer
+     * @param status the http response status code
+     */
+    Response(std::string buffer, std::vector<Header_span> headers, std::size_t body_offset, int status);
+
+    /**
+     * Creates a new Response with the specified headers, body, and status.
+     *
+     * @param headers borrowed reference to the multi-map of (key, value) header pairs
+     * @param body moved string containing the response body
+     * @param status the http response status code
+     */
+    Response(const std::unordered_multimap<std::string, std::string>& headers, std::string body, int status);
+
+    /**
+     * Gets the http response status code.
+     *
+     * @return the status code
+     */
+    int status() const;
+
+    /**
+     * Gets the response body.
+     *
+     * @return view of the body, valid until this object is modified or destroyed
+     */
+    std::string_view body() const;
+
+    /**
+     * Gets the number of bytes from the start of the body to the end of the allocated buffer, which includes any
+     * spare capacity after the body.
+     *
+     * @return the capacity available to the body
+     */
+    std::size_t body_capacity() const;
+
+    /**
+     * Moves the response body out of this object without copying it into a new allocation. The headers and body of
+     * this object are left empty.
+     *
+     * @return the response body
+     */
+    std::string release_body();
+
+    /**
+     * Discards the response body, keeping the headers and status.
+     */
+    void clear_body();
 
-    /** Json string containing the response body. */
-    const std::string body;
+    /**
+     * Gets the value of the first header with the specified key, ignoring case.
+     *
+     * @param key the key of the header to find
+     *
+     * @return view of the header value, valid until this object is modified or destroyed, or no value if there is no
+     * header with the key
+     */
+    std::optional<std::string_view> header(std::string_view key) const;
+
+    /**
+     * Gets the number of headers in the response.
+     *
+     * @return the number of headers
+     */
+    std::size_t header_count() const;
+
+private:
+    /** Raw header lines followed by the body. */
+    std::string buffer_;
+
+    /** Locations of the headers within the buffer, in the order received. */
+    std::vector<Header_span> headers_;
+
+    /** Offset of the body within the buffer. */
+    std::size_t body_offset_;
 
     /** The http response status code. */
-    const int status;
+    int status_;
 };
 
 /**
- * Class used to perform REST requests.
+ * Callback invoked once an asynchronous request completes. The future passed to the callback is ready and either
+ * holds the Response or rethrows the exception raised while making the request when get is called.
+ */
+using Response_callback = std::function<void(std::future<Response> response)>;
+
+/**
+ * Class used to perform REST requests. Asynchronous implementations complete requests and invoke callbacks on an
+ * event loop thread shared by every caller, so callbacks must not call the blocking get or post functions, which
+ * throw std::logic_error when called on that thread, and should hand off any lengthy work to another thread.
  */
 class Rest {
 public:
@@ -74,10 +192,167 @@ public:
                           const std::unordered_multimap<std::string, std::string>& headers,
                           const std::string& data) const = 0;
 
+    /**
+     * Performs a GET request to the specified url with the specified headers, writing the response body to the
+     * specified sink as it is received instead of holding it in memory. The default implementation calls get and
+     * writes the whole body to the sink once it is received.
+     *
+     * @param url borrowed reference to the string containing url to make the GET request to, ideally containing the
+     * protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     * @param sink borrowed reference to the sink the response body is written to
+     *
+     * @return the Response object containing the response headers and http status, with an empty body
+     *
+     * @exception Connection_error if unable to connect to the sepcified url or unable to write to the sink
+     */
+    virtual Response get(const std::string& url,
+                         const std::unordered_multimap<std::string, std::string>& headers,
+                         Body_sink& sink) const;
+
+    /**
+     * Starts a GET request to the specified url with the specified headers, invoking the specified callback once the
+     * request completes. The default implementation makes the request by calling get, invoking the callback before
+     * returning. Callbacks may be invoked on a thread owned by the Rest object and should not block.
+     *
+     * @param url borrowed reference to the string containing the url to make the GET request to, ideally containing
+     * the protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     * @param callback moved callback invoked with the Response or the Connection_error raised by the request
+     */
+    virtual void get_async(const std::string& url,
+                           const std::unordered_multimap<std::string, std::string>& headers,
+                           Response_callback callback) const;
+
+    /**
+     * Starts a GET request to the specified url with the specified headers, writing the response body to the
+     * specified sink as it is received and invoking the specified callback once the request completes. The default
+     * implementation makes the request by calling get with the sink, invoking the callback before returning.
+     *
+     * @param url borrowed reference to the string containing the url to make the GET request to, ideally containing
+     * the protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     * @param sink borrowed reference to the sink the response body is written to, which must outlive the request
+     * @param callback moved callback invoked with the Response, whose body is empty, or the exception raised by the
+     * request
+     */
+    virtual void get_async(const std::string& url,
+                           const std::unordered_multimap<std::string, std::string>& headers,
+                           Body_sink& sink,
+                           Response_callback callback) const;
+
+    /**
+     * Starts a POST request to the specified url with the specified headers and data, invoking the specified callback
+     * once the request completes. The default implementation makes the request by calling post, invoking the
+     * callback before returning. Callbacks may be invoked on a thread owned by the Rest object and should not block.
+     *
+     * @param url borrowed reference to the string containing the url to make the POST request to, ideally
+     * containing the protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the POST request
+     * @param data moved string containing the json data for the POST request
+     * @param callback moved callback invoked with the Response or the Connection_error raised by the request
+     */
+    virtual void post_async(const std::string& url,
+                            const std::unordered_multimap<std::string, std::string>& headers,
+                            std::string data,
+                            Response_callback callback) const;
+
+    /**
+     * Starts a GET request to the specified url with the specified headers.
+     *
+     * @param url borrowed reference to the string containing the url to make the GET request to, ideally containing
+     * the protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     *
+     * @return future holding the Response or the Connection_error raised by the request
+     */
+    std::future<Response> get_async(const std::string& url,
+                                    const std::unordered_multimap<std::string, std::string>& headers) const;
+
+    /**
+     * Starts a POST request to the specified url with the specified headers and data.
+     *
+     * @param url borrowed reference to the string containing the url to make the POST request to, ideally
+     * containing the protocol
+     * @param headers borrowed reference to the multi-map containing the headers for the POST request
+     * @param data moved string containing the json data for the POST request
+     *
+     * @return future holding the Response or the Connection_error raised by the request
+     */
+    std::future<Response> post_async(const std::string& url,
+                                     const std::unordered_multimap<std::string, std::string>& headers,
+                                     std::string data) const;
+
 protected:
     Rest();
 };
 
+/**
+ * Marks the calling thread as the event loop thread of an asynchronous Rest object. Such a thread completes the
+ * requests of every caller sharing the Rest object, so it must not wait on a request itself, as the request could only
+ * complete once the thread stops waiting.
+ */
+void mark_event_loop_thread();
+
+/**
+ * Checks that the calling thread is allowed to wait for a request to complete. Called by the blocking functions of
+ * the asynchronous Rest objects, so that a blocking request made from a callback fails instead of deadlocking.
+ *
+ * @exception std::logic_error if the calling thread was marked as an event loop thread
+ */
+void expect_blocking_allowed();
+
+/**
+ * Creates a Response_callback that fulfills the specified promise with the result of passing the Response to the
+ * specified function, or with the exception raised by either the request or the function.
+ *
+ * @param promise shared pointer to the promise to fulfill
+ * @param handle_response function converting the Response into the value of the promise
+ *
+ * @return the created callback
+ */
+template <typename T, typename F>
+Response_callback fulfill(std::shared_ptr<std::promise<T>> promise, F handle_response)
+{
+    return [promise {std::move(promise)},
+            handle_response {std::move(handle_response)}](std::future<Response> response) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                handle_response(response.get());
+                promise->set_value();
+            } else {
+                promise->set_value(handle_response(response.get()));
+            }
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+}
+
+/**
+ * Creates a Response_callback that invokes the specified callback with a ready future holding the result of passing
+ * the Response to the specified function, or the exception raised by either the request or the function.
+ *
+ * @param on_done moved callback invoked with the result
+ * @param handle_response function converting the Response into the result
+ *
+ * @return the created callback
+ */
+template <typename T, typename F>
+Response_callback deliver(std::function<void(std::future<T>)> on_done, F handle_response)
+{
+    return [on_done {std::move(on_done)},
+            handle_response {std::move(handle_response)}](std::future<Response> response) {
+        std::promise<T> promise {};
+        try {
+            promise.set_value(handle_response(response.get()));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        on_done(promise.get_future());
+    };
+}
+
 } // namespace Internal
 } // namespace Onedatashare
 
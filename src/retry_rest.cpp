@@ -0,0 +1,426 @@
+/**
+ * @file retry_rest.cpp
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <onedatashare/ods_error.h>
+
+#include "rate_limited_rest.h"
+#include "retry_rest.h"
+#include "timer_queue.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** Header naming the number of seconds to wait before retrying. */
+constexpr auto retry_after_header {"Retry-After"};
+
+/** Number of recent latencies kept for choosing when to hedge. */
+constexpr std::size_t latency_samples {128};
+
+/** Longest Retry-After, in seconds, read before it is capped by the policy, which keeps the conversion to
+ * milliseconds from overflowing. */
+constexpr long long max_retry_after {1000000};
+
+/**
+ * Checks if a request answered with the specified status should be retried.
+ *
+ * @param status the http response status code
+ *
+ * @return true if the server uses the status to shed load or report a transient failure
+ */
+bool retried_status(int status)
+{
+    return status == 429 || status == 500 || status == 502 || status == 503 || status == 504;
+}
+
+/**
+ * Gets the delay asked for by the Retry-After header of the specified response. Only the delay-seconds form of the
+ * header is read, since the server does not send the http-date form.
+ *
+ * @param response borrowed reference to the response
+ *
+ * @return the delay, or no value if the response has no Retry-After header in the delay-seconds form
+ */
+std::optional<std::chrono::milliseconds> retry_after(const Response& response)
+{
+    const auto value {response.header(retry_after_header)};
+    if (!value) {
+        return std::nullopt;
+    }
+
+    long long seconds {};
+    const auto end {value->data() + value->size()};
+    const auto [parsed, error] {std::from_chars(value->data(), end, seconds)};
+    if (error != std::errc {} || parsed != end || seconds < 0) {
+        return std::nullopt;
+    }
+    return std::chrono::seconds {std::min(seconds, max_retry_after)};
+}
+
+/**
+ * The result of an attempt, holding either a Response or the exception raised while making it.
+ */
+struct Outcome {
+    /** The response, if the attempt received one. */
+    std::optional<Response> response;
+
+    /** The exception raised by the attempt, if it did not receive a response. */
+    std::exception_ptr error;
+};
+
+} // namespace
+
+struct Retry_rest::State {
+    explicit State(const Retry_policy& policy) : policy {policy} {}
+
+    /**
+     * Records the latency of a request that received a response that is not retried.
+     *
+     * @param latency the time from sending the request to receiving its response
+     */
+    void record(Clock::duration latency)
+    {
+        const std::lock_guard<std::mutex> lock {mutex};
+        if (latencies.size() < latency_samples) {
+            latencies.push_back(latency);
+        } else {
+            latencies[next_latency] = latency;
+            next_latency = (next_latency + 1) % latency_samples;
+        }
+    }
+
+    /**
+     * Gets how long an attempt may be pending before it is hedged.
+     *
+     * @return the hedge percentile of the recorded latencies, or no value if hedging is disabled or too few
+     * latencies have been recorded
+     */
+    std::optional<Clock::duration> hedge_after()
+    {
+        if (!policy.hedge) {
+            return std::nullopt;
+        }
+
+        std::vector<Clock::duration> sorted {};
+        {
+            const std::lock_guard<std::mutex> lock {mutex};
+            if (latencies.empty() || latencies.size() < std::min(policy.hedge_min_samples, latency_samples)) {
+                return std::nullopt;
+            }
+            sorted = latencies;
+        }
+
+        const auto percentile {std::clamp(policy.hedge_percentile, 0.0, 1.0)};
+        const auto nth {sorted.begin() + static_cast<std::ptrdiff_t>(percentile * (sorted.size() - 1) + 0.5)};
+        std::nth_element(sorted.begin(), nth, sorted.end());
+        return *nth;
+    }
+
+    /** Policy controlling retries and hedging. */
+    const Retry_policy policy;
+
+    /** Guards the recorded latencies. */
+    std::mutex mutex {};
+
+    /** Most recent latencies, overwritten in a ring once full. */
+    std::vector<Clock::duration> latencies {};
+
+    /** Index of the latency overwritten next once the ring is full. */
+    std::size_t next_latency {0};
+};
+
+class Retry_rest::Call : public std::enable_shared_from_this<Call> {
+public:
+    Call(std::weak_ptr<Rest> inner,
+         std::shared_ptr<State> state,
+         const std::string& url,
+         const std::unordered_multimap<std::string, std::string>& headers,
+         Response_callback callback)
+        : inner_ {std::move(inner)},
+          state_ {std::move(state)},
+          url_ {url},
+          headers_ {headers},
+          callback_ {std::move(callback)},
+          mutex_ {},
+          attempt_ {0},
+          outstanding_ {0},
+          hedged_ {false},
+          done_ {true},
+          last_ {}
+    {}
+
+    /**
+     * Starts the next attempt, scheduling its hedge if the policy allows one. If the inner REST caller has been
+     * destroyed, the outcome of the last attempt is delivered instead.
+     */
+    void start()
+    {
+        const auto inner {inner_.lock()};
+        if (!inner) {
+            deliver(std::move(last_));
+            return;
+        }
+
+        int attempt {};
+        {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            attempt = ++attempt_;
+            outstanding_ = 1;
+            hedged_ = false;
+            done_ = false;
+        }
+
+        if (const auto after {state_->hedge_after()}) {
+            Timer_queue::shared().schedule(Clock::now() + *after,
+                                           [self {shared_from_this()}, attempt] { self->hedge(attempt); });
+        }
+        send(*inner, attempt);
+    }
+
+private:
+    /**
+     * Sends a copy of the specified attempt through the specified REST caller.
+     *
+     * @param inner borrowed reference to the inner REST caller
+     * @param attempt the number of the attempt the copy belongs to
+     */
+    void send(const Rest& inner, int attempt)
+    {
+        const auto sent {Clock::now()};
+        try {
+            inner.get_async(url_, headers_, [self {shared_from_this()}, attempt, sent](auto response) {
+                self->complete(attempt, sent, std::move(response));
+            });
+        } catch (...) {
+            std::promise<Response> failed {};
+            failed.set_exception(std::current_exception());
+            complete(attempt, sent, failed.get_future());
+        }
+    }
+
+    /**
+     * Sends a second copy of the specified attempt if it is still pending and has not already been hedged.
+     *
+     * @param attempt the number of the attempt to hedge
+     */
+    void hedge(int attempt)
+    {
+        const auto inner {inner_.lock()};
+        if (!inner) {
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            if (attempt != attempt_ || done_ || hedged_) {
+                return;
+            }
+            hedged_ = true;
+            ++outstanding_;
+        }
+        send(*inner, attempt);
+    }
+
+    /**
+     * Handles the completion of a copy of the specified attempt. The first copy to complete with a result that is not
+     * retried ends the attempt and is delivered. A copy that fails while another copy is pending is dropped in favour
+     * of the other copy, and once every copy has failed the request is retried or, if its attempts are exhausted, the
+     * last failure is delivered.
+     *
+     * @param attempt the number of the attempt the copy belongs to
+     * @param sent the time the copy was sent
+     * @param response moved future holding the response or exception of the copy
+     */
+    void complete(int attempt, Clock::time_point sent, std::future<Response> response)
+    {
+        Outcome outcome {};
+        auto retry {false};
+        try {
+            outcome.response.emplace(response.get());
+            retry = retried_status(outcome.response->status());
+        } catch (const Connection_error&) {
+            outcome.error = std::current_exception();
+            retry = true;
+        } catch (...) {
+            outcome.error = std::current_exception();
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            if (attempt != attempt_ || done_ || (retry && --outstanding_ > 0)) {
+                return;
+            }
+            done_ = true;
+        }
+
+        if (!retry || attempt >= state_->policy.max_attempts) {
+            if (!retry && outcome.response) {
+                state_->record(Clock::now() - sent);
+            }
+            deliver(std::move(outcome));
+            return;
+        }
+        const auto wait {delay(attempt, outcome)};
+        last_ = std::move(outcome);
+        Timer_queue::shared().schedule(Clock::now() + wait, [self {shared_from_this()}] { self->start(); });
+    }
+
+    /**
+     * Gets the delay before retrying the request after the specified failed attempt.
+     *
+     * @param attempt the number of the failed attempt
+     * @param outcome borrowed reference to the outcome of the failed attempt
+     *
+     * @return the delay asked for by the Retry-After header of the response, capped by the maximum delay, or
+     * otherwise a delay chosen uniformly between zero and the base delay doubled for each earlier retry
+     */
+    std::chrono::milliseconds delay(int attempt, const Outcome& outcome) const
+    {
+        const auto& policy {state_->policy};
+        if (outcome.response) {
+            if (const auto after {retry_after(*outcome.response)}) {
+                return std::min(*after, policy.max_delay);
+            }
+        }
+
+        auto ceiling {policy.max_delay};
+        const auto doublings {attempt - 1};
+        if (doublings < 62 && policy.base_delay.count() <= (policy.max_delay.count() >> doublings)) {
+            ceiling = policy.base_delay * (1LL << doublings);
+        }
+        thread_local std::mt19937_64 engine {std::random_device {}()};
+        return std::chrono::milliseconds {
+            std::uniform_int_distribution<long long> {0, std::max<long long>(ceiling.count(), 0)}(engine)};
+    }
+
+    /**
+     * Passes the specified outcome to the callback of the request.
+     *
+     * @param outcome moved outcome to deliver
+     */
+    void deliver(Outcome outcome)
+    {
+        std::promise<Response> promise {};
+        if (outcome.response) {
+            promise.set_value(std::move(*outcome.response));
+        } else {
+            promise.set_exception(outcome.error);
+        }
+        callback_(promise.get_future());
+    }
+
+    /** REST caller making each attempt, held weakly so that the last reference to it is never dropped by one of its
+     * own callbacks, which may run on a thread it joins when destroyed. */
+    const std::weak_ptr<Rest> inner_;
+
+    /** Shared state of the Retry_rest object that made the request. */
+    const std::shared_ptr<State> state_;
+
+    /** The url of the request. */
+    const std::string url_;
+
+    /** The headers of the request. */
+    const std::unordered_multimap<std::string, std::string> headers_;
+
+    /** Callback invoked with the final outcome. */
+    const Response_callback callback_;
+
+    /** Guards every member below. */
+    std::mutex mutex_;
+
+    /** Number of the current attempt, starting from 1. */
+    int attempt_;
+
+    /** Number of copies of the current attempt that have not completed. */
+    int outstanding_;
+
+    /** If the current attempt has been hedged. */
+    bool hedged_;
+
+    /** If the current attempt has ended. */
+    bool done_;
+
+    /** Outcome of the last failed attempt, delivered if the request cannot be retried. */
+    Outcome last_;
+};
+
+Retry_rest::Retry_rest(std::shared_ptr<Rest> inner, const Retry_policy& policy)
+    : inner_ {std::move(inner)}, state_ {std::make_shared<State>(policy)}
+{}
+
+Retry_rest::~Retry_rest() = default;
+
+std::shared_ptr<Retry_rest> Retry_rest::shared()
+{
+    static std::mutex mutex {};
+    static std::weak_ptr<Retry_rest> instance {};
+
+    std::lock_guard<std::mutex> lock {mutex};
+    auto rest {instance.lock()};
+    if (!rest) {
+        rest = std::make_shared<Retry_rest>(Rate_limited_rest::shared());
+        instance = rest;
+    }
+
+    return rest;
+}
+
+Response Retry_rest::get(const std::string& url,
+                         const std::unordered_multimap<std::string, std::string>& headers) const
+{
+    expect_blocking_allowed();
+    return get_async(url, headers).get();
+}
+
+Response Retry_rest::post(const std::string& url,
+                          const std::unordered_multimap<std::string, std::string>& headers,
+                          const std::string& data) const
+{
+    return inner_->post(url, headers, data);
+}
+
+Response Retry_rest::get(const std::string& url,
+                         const std::unordered_multimap<std::string, std::string>& headers,
+                         Body_sink& sink) const
+{
+    return inner_->get(url, headers, sink);
+}
+
+void Retry_rest::get_async(const std::string& url,
+                           const std::unordered_multimap<std::string, std::string>& headers,
+                           Response_callback callback) const
+{
+    std::make_shared<Call>(inner_, state_, url, headers, std::move(callback))->start();
+}
+
+void Retry_rest::get_async(const std::string& url,
+                           const std::unordered_multimap<std::string, std::string>& headers,
+                           Body_sink& sink,
+                           Response_callback callback) const
+{
+    inner_->get_async(url, headers, sink, std::move(callback));
+}
+
+void Retry_rest::post_async(const std::string& url,
+                            const std::unordered_multimap<std::string, std::string>& headers,
+                            std::string data,
+                            Response_callback callback) const
+{
+    inner_->post_async(url, headers, std::move(data), std::move(callback));
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,153 @@
+/**
+ * @file retry_rest.h
+ * Defines a REST caller retrying and hedging the idempotent requests made through another REST caller.
+ */
+
+#ifndef ONEDATASHARE_RETRY_REST_H
+#define ONEDATASHARE_RETRY_REST_H
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "rest.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Policy controlling how a Retry_rest object retries and hedges GET requests.
+ */
+struct Retry_policy {
+    /** Maximum number of attempts made for each request, including the first. */
+    int max_attempts {4};
+
+    /** Upper bound of the delay before the first retry, doubled for each retry after it. */
+    std::chrono::milliseconds base_delay {100};
+
+    /** Greatest delay before any retry, including one asked for by a Retry-After header. */
+    std::chrono::milliseconds max_delay {10000};
+
+    /** If a second copy of an attempt is sent once the attempt has taken longer than the hedge percentile of recent
+     * request latencies. */
+    bool hedge {false};
+
+    /** Percentile, between 0 and 1, of recent request latencies after which an attempt is hedged. */
+    double hedge_percentile {0.95};
+
+    /** Number of latencies that must be recorded before any attempt is hedged. */
+    std::size_t hedge_min_samples {20};
+};
+
+/**
+ * Decorator retrying the GET requests made through another REST caller when they fail with a Connection_error or
+ * with a status the server uses to shed load (429, 500, 502, 503, or 504). Retries wait for the delay asked for by
+ * the Retry-After header of the response, or otherwise for a random delay of up to the base delay doubled for each
+ * earlier retry, so that clients turned away at the same time do not return at the same time. Once the attempts are
+ * exhausted, the last response is returned or the last exception raised. POST requests and GET requests writing to a
+ * sink are passed through unchanged, since they are not idempotent or cannot be replayed once part of the body has
+ * been written. When hedging, an attempt still pending after the hedge percentile of recent latencies is sent a
+ * second time and whichever copy completes first is used. Waiting and hedging are scheduled on the shared
+ * Timer_queue, so no thread blocks on a pending retry of an asynchronous request. A request whose retry comes due
+ * after the inner REST caller has been destroyed completes with the outcome of its last attempt.
+ */
+class Retry_rest : public Rest {
+public:
+    using Rest::get_async;
+    using Rest::post_async;
+
+    /**
+     * Creates a new Retry_rest object making requests through the specified REST caller.
+     *
+     * @param inner shared pointer to the REST caller making each attempt
+     * @param policy borrowed reference to the policy controlling retries and hedging
+     */
+    explicit Retry_rest(std::shared_ptr<Rest> inner, const Retry_policy& policy = {});
+
+    ~Retry_rest() override;
+
+    /**
+     * Gets the Retry_rest object, wrapping the shared Rate_limited_rest object with the default policy, shared by every
+     * service created without an explicit REST caller, creating it if no service currently holds it. Sharing it lets
+     * every service hedge against the same record of latencies.
+     *
+     * @return shared pointer to the shared object
+     */
+    static std::shared_ptr<Retry_rest> shared();
+
+    /**
+     * Performs a GET request, retrying it according to the policy.
+     *
+     * @param url borrowed reference to the url to make the GET request to
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     *
+     * @return the first Response whose status is not retried, or the last Response once the attempts are exhausted
+     *
+     * @exception Connection_error if every attempt is unable to connect to the specified url
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers) const override;
+
+    /**
+     * Performs a POST request through the inner REST caller without retrying it.
+     */
+    Response post(const std::string& url,
+                  const std::unordered_multimap<std::string, std::string>& headers,
+                  const std::string& data) const override;
+
+    /**
+     * Performs a GET request writing to a sink through the inner REST caller without retrying it.
+     */
+    Response get(const std::string& url,
+                 const std::unordered_multimap<std::string, std::string>& headers,
+                 Body_sink& sink) const override;
+
+    /**
+     * Starts a GET request, retrying it according to the policy and invoking the specified callback once it
+     * succeeds or its attempts are exhausted. The callback may be invoked on a thread owned by the inner REST caller
+     * or by the shared Timer_queue.
+     *
+     * @param url borrowed reference to the url to make the GET request to
+     * @param headers borrowed reference to the multi-map containing the headers for the GET request
+     * @param callback moved callback invoked with the final Response or the last exception raised
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Response_callback callback) const override;
+
+    /**
+     * Starts a GET request writing to a sink through the inner REST caller without retrying it.
+     */
+    void get_async(const std::string& url,
+                   const std::unordered_multimap<std::string, std::string>& headers,
+                   Body_sink& sink,
+                   Response_callback callback) const override;
+
+    /**
+     * Starts a POST request through the inner REST caller without retrying it.
+     */
+    void post_async(const std::string& url,
+                    const std::unordered_multimap<std::string, std::string>& headers,
+                    std::string data,
+                    Response_callback callback) const override;
+
+private:
+    /** Policy and recent latencies, shared with the requests in flight, which may outlive this object. */
+    struct State;
+
+    /** A request and its attempts. */
+    class Call;
+
+    /** REST caller making each attempt. */
+    const std::shared_ptr<Rest> inner_;
+
+    /** Shared state. */
+    const std::shared_ptr<State> state_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_RETRY_REST_H
@@ -0,0 +1,80 @@
+/**
+ * @file shard_partition.cpp
+ */
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+
+#include "shard_partition.h"
+#include "util.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+std::vector<std::uint64_t> resource_sizes(Endpoint_type type,
+                                          const Resource& directory,
+                                          const std::vector<std::string>& identifiers)
+{
+    std::unordered_map<std::string, std::uint64_t> listed {};
+    if (directory.contained_resources) {
+        const auto uses_ids {Util::uses_ids(type)};
+        for (const auto& resource : *directory.contained_resources) {
+            const auto identifier {uses_ids ? resource.id : std::optional<std::string> {resource.name}};
+            if (identifier && resource.size > 0) {
+                listed.emplace(*identifier, static_cast<std::uint64_t>(resource.size));
+            }
+        }
+    }
+
+    std::vector<std::uint64_t> sizes {};
+    sizes.reserve(identifiers.size());
+    for (const auto& identifier : identifiers) {
+        const auto size {listed.find(identifier)};
+        sizes.push_back(size == listed.end() ? 0 : size->second);
+    }
+    return sizes;
+}
+
+std::vector<std::vector<std::size_t>> partition_by_size(const std::vector<std::uint64_t>& sizes,
+                                                        std::size_t shard_count)
+{
+    const auto shards {std::clamp<std::size_t>(shard_count, 1, std::max<std::size_t>(sizes.size(), 1))};
+
+    std::vector<std::size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(
+        order.begin(), order.end(), [&sizes](std::size_t a, std::size_t b) { return sizes[a] > sizes[b]; });
+
+    // total size, number of items, and index of each shard, smallest total first, so that items of unknown size are
+    // spread evenly and ties are broken by index to keep the result deterministic
+    using Load = std::tuple<std::uint64_t, std::size_t, std::size_t>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads {};
+    for (std::size_t shard {0}; shard < shards; ++shard) {
+        loads.emplace(0, 0, shard);
+    }
+
+    std::vector<std::vector<std::size_t>> partition(shards);
+    for (const auto item : order) {
+        const auto [load, count, shard] {loads.top()};
+        loads.pop();
+        partition[shard].push_back(item);
+        loads.emplace(load + sizes[item], count + 1, shard);
+    }
+
+    for (auto& shard : partition) {
+        std::sort(shard.begin(), shard.end());
+    }
+    partition.erase(std::remove_if(partition.begin(),
+                                   partition.end(),
+                                   [](const std::vector<std::size_t>& shard) { return shard.empty(); }),
+                    partition.end());
+    return partition;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,52 @@
+/**
+ * @file shard_partition.h
+ * Defines functions used to split the resources of a transfer into sub-jobs of balanced size.
+ */
+
+#ifndef ONEDATASHARE_SHARD_PARTITION_H
+#define ONEDATASHARE_SHARD_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/endpoint_type.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Looks up the size of each of the specified resources in the listing of the directory containing them. Resources
+ * missing from the listing have an unknown size of 0, and so do directories, since listings do not report their sizes.
+ *
+ * @param type the type of endpoint the resources are on
+ * @param directory borrowed reference to the listing of the directory containing the resources
+ * @param identifiers borrowed reference to the names or ids, depending on the endpoint type, of the resources
+ *
+ * @return the size in bytes of each resource, in the same order as the identifiers
+ */
+std::vector<std::uint64_t> resource_sizes(Endpoint_type type,
+                                          const Resource& directory,
+                                          const std::vector<std::string>& identifiers);
+
+/**
+ * Splits items of the specified sizes into at most the specified number of shards whose total sizes are balanced,
+ * using the longest processing time rule: items are taken from largest to smallest and each is added to the shard
+ * with the smallest total so far, which keeps the largest shard within 4/3 of the best possible. Between shards of
+ * equal total, the one with the fewest items is chosen, so items of unknown size are spread evenly. Takes time
+ * O(n log n) in the number of items.
+ *
+ * @param sizes borrowed reference to the size of each item
+ * @param shard_count the greatest number of shards, treated as 1 if 0
+ *
+ * @return the indices of the items in each shard, in increasing order, with no empty shards
+ */
+std::vector<std::vector<std::size_t>> partition_by_size(const std::vector<std::uint64_t>& sizes,
+                                                        std::size_t shard_count);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_SHARD_PARTITION_H
@@ -0,0 +1,27 @@
+/**
+ * @file single_flight.cpp
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "single_flight.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+std::string request_key(const std::string& url, const std::unordered_multimap<std::string, std::string>& headers)
+{
+    std::vector<std::pair<std::string, std::string>> sorted {headers.begin(), headers.end()};
+    std::sort(sorted.begin(), sorted.end());
+
+    // neither urls nor header fields contain line breaks, so they separate the parts unambiguously
+    auto key {url};
+    for (const auto& [name, value] : sorted) {
+        key += "\n" + name + ": " + value;
+    }
+    return key;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
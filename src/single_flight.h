@@ -0,0 +1,113 @@
+/**
+ * @file single_flight.h
+ * Defines the coalescing of concurrent identical calls into a single call.
+ */
+
+#ifndef ONEDATASHARE_SINGLE_FLIGHT_H
+#define ONEDATASHARE_SINGLE_FLIGHT_H
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Coalesces concurrent calls with the same key so that only the first caller, the leader, makes the call while the
+ * others wait for and share its result. A key is forgotten as soon as its call completes, so calls made after it
+ * completes start a new call rather than reusing a stale result. Keys are spread across independently locked shards,
+ * and no lock is held while making the call or waiting on it, so unrelated keys rarely contend.
+ *
+ * @tparam T the type of the result, which is copied to every waiting caller
+ */
+template <typename T>
+class Single_flight {
+public:
+    /**
+     * Makes the specified call unless a call with the same key is in flight, in which case waits for that call
+     * instead.
+     *
+     * @param key borrowed reference to the key identifying identical calls
+     * @param call borrowed reference to the call to make if no identical call is in flight
+     *
+     * @return the result of the call
+     *
+     * @exception any exception thrown by the call, which is thrown to every caller sharing it
+     */
+    T run(const std::string& key, const std::function<T()>& call)
+    {
+        auto& shard {shards_[std::hash<std::string> {}(key) % shards_.size()]};
+
+        std::promise<T> promise {};
+        std::shared_future<T> in_flight {};
+        {
+            const std::lock_guard<std::mutex> lock {shard.mutex};
+            const auto [call_entry, leader] {shard.calls.try_emplace(key)};
+            if (leader) {
+                call_entry->second = promise.get_future().share();
+            } else {
+                in_flight = call_entry->second;
+            }
+        }
+        if (in_flight.valid()) {
+            return in_flight.get();
+        }
+
+        try {
+            auto result {call()};
+            forget(shard, key);
+            promise.set_value(result);
+            return result;
+        } catch (...) {
+            forget(shard, key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+private:
+    /**
+     * Part of the keys in flight, guarded by its own mutex.
+     */
+    struct Shard {
+        /** Guards the calls in flight. */
+        std::mutex mutex;
+
+        /** Shared result of each call in flight, by key. */
+        std::unordered_map<std::string, std::shared_future<T>> calls;
+    };
+
+    /**
+     * Removes the specified key from the calls in flight.
+     */
+    static void forget(Shard& shard, const std::string& key)
+    {
+        const std::lock_guard<std::mutex> lock {shard.mutex};
+        shard.calls.erase(key);
+    }
+
+    /** Shards of the keys in flight. */
+    std::array<Shard, 16> shards_ {};
+};
+
+/**
+ * Creates the key identifying a request by its url and headers, independent of the order of the headers.
+ *
+ * @param url borrowed reference to the url of the request
+ * @param headers borrowed reference to the headers of the request
+ *
+ * @return the key identifying the request
+ */
+std::string request_key(const std::string& url, const std::unordered_multimap<std::string, std::string>& headers);
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_SINGLE_FLIGHT_H
@@ -0,0 +1,314 @@
+/**
+ * @file stat_parser.cpp
+ */
+
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <onedatashare/ods_error.h>
+
+#include "error_message.h"
+#include "json_parser_pool.h"
+#include "ods_rest_api.h"
+#include "stat_parser.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/**
+ * Parses the specified json text into a dom object with the specified parser.
+ *
+ * @param parser borrowed reference to the parser to use
+ * @param json borrowed reference to the json text to parse, whose capacity is grown to fit simdjson's padding
+ * @param status the status code of the response the json text was received in
+ *
+ * @return the parsed dom, valid until the parser is used again
+ *
+ * @exception Unexpected_response_error if the json text is not a json object
+ */
+simdjson::dom::object parse_object(simdjson::dom::parser& parser, std::string& json, int status)
+{
+    // pad in place so that simdjson does not copy the text, keeping the capacity for the next entry
+    json.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+
+    auto [obj, err] {parser.parse(json.data(), json.size(), false).get_object()};
+    if (err) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, status};
+    }
+
+    return obj;
+}
+
+} // namespace
+
+Resource create_resource(const simdjson::dom::object& obj)
+{
+    Resource resource {};
+    auto has_name {false}, has_size {false}, has_time {false}, has_dir {false}, has_file {false};
+
+    // visit every field once rather than searching the object for each field
+    for (const auto [key, value] : obj) {
+        // if simdjson_error is thrown, the dom must not meet the specification, so propogate the exception
+        if (key == Api::stat_id) {
+            resource.id = value.get_c_str().value();
+        } else if (key == Api::stat_name) {
+            resource.name = value.get_c_str().value();
+            has_name = true;
+        } else if (key == Api::stat_size) {
+            resource.size = value.get_int64().value();
+            has_size = true;
+        } else if (key == Api::stat_time) {
+            resource.time = value.get_int64().value();
+            has_time = true;
+        } else if (key == Api::stat_dir) {
+            resource.is_directory = value.get_bool().value();
+            has_dir = true;
+        } else if (key == Api::stat_file) {
+            resource.is_file = value.get_bool().value();
+            has_file = true;
+        } else if (key == Api::stat_link) {
+            resource.link = value.get_c_str().value();
+        } else if (key == Api::stat_permissions) {
+            resource.permissions = value.get_c_str().value();
+        } else if (key == Api::stat_files) {
+            // recursively add contained resoruces
+            const auto files {value.get_array().value()};
+            resource.contained_resources.emplace();
+            resource.contained_resources->reserve(files.size());
+            for (const auto& r : files) {
+                resource.contained_resources->push_back(create_resource(r.get_object().value()));
+            }
+        }
+    }
+
+    if (!(has_name && has_size && has_time && has_dir && has_file)) {
+        throw simdjson::simdjson_error {simdjson::NO_SUCH_FIELD};
+    }
+
+    return resource;
+}
+
+void add_resource(const simdjson::dom::object& obj, Resource_table& table)
+{
+    std::optional<std::string_view> id {}, name {}, link {}, permissions {};
+    std::optional<long> size {}, time {};
+    std::optional<bool> is_directory {}, is_file {};
+
+    // views into the dom are copied straight into the table's arena without creating intermediate strings
+    for (const auto [key, value] : obj) {
+        // if simdjson_error is thrown, the dom must not meet the specification, so propogate the exception
+        if (key == Api::stat_id) {
+            id = value.get_string().value();
+        } else if (key == Api::stat_name) {
+            name = value.get_string().value();
+        } else if (key == Api::stat_size) {
+            size = value.get_int64().value();
+        } else if (key == Api::stat_time) {
+            time = value.get_int64().value();
+        } else if (key == Api::stat_dir) {
+            is_directory = value.get_bool().value();
+        } else if (key == Api::stat_file) {
+            is_file = value.get_bool().value();
+        } else if (key == Api::stat_link) {
+            link = value.get_string().value();
+        } else if (key == Api::stat_permissions) {
+            permissions = value.get_string().value();
+        }
+    }
+
+    if (!(name && size && time && is_directory && is_file)) {
+        throw simdjson::simdjson_error {simdjson::NO_SUCH_FIELD};
+    }
+
+    table.add(id, *name, *size, *time, *is_directory, *is_file, link, permissions);
+}
+
+Stat_stream_sink::Stat_stream_sink(const std::function<void(const simdjson::dom::object&)>& on_entry)
+    : on_entry_ {on_entry},
+      parser_ {Json_parser_pool::shared().acquire()},
+      status_ {200},
+      outer_ {},
+      entry_ {},
+      key_ {},
+      depth_ {0},
+      entry_depth_ {0},
+      files_next_ {false},
+      in_files_ {false},
+      in_string_ {false},
+      escaped_ {false},
+      complete_ {false}
+{}
+
+void Stat_stream_sink::start(int status)
+{
+    status_ = status;
+}
+
+void Stat_stream_sink::write(const char* data, std::size_t size)
+{
+    if (status_ != 200) {
+        // the body is an error rather than a Stat object
+        return;
+    }
+
+    // characters of the current entry are copied in bulk rather than one at a time
+    std::size_t entry_start {0};
+    for (std::size_t i {0}; i < size; ++i) {
+        if (!in_files_) {
+            scan_outer(data[i]);
+            entry_start = i + 1;
+            continue;
+        }
+
+        const auto was_in_entry {entry_depth_ > 0};
+        if (!scan_files(data[i])) {
+            entry_start = i + 1;
+        } else if (!was_in_entry) {
+            entry_.clear();
+            entry_start = i;
+        } else if (entry_depth_ == 0) {
+            entry_.append(data + entry_start, i + 1 - entry_start);
+            emit_entry();
+            entry_start = i + 1;
+        }
+    }
+
+    if (in_files_ && entry_depth_ > 0) {
+        entry_.append(data + entry_start, size - entry_start);
+    }
+}
+
+Resource Stat_stream_sink::finish()
+{
+    if (!complete_) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, status_};
+    }
+
+    const auto obj {parse_object(*parser_, outer_, status_)};
+    try {
+        return create_resource(obj);
+    } catch (const simdjson::simdjson_error& e) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, status_};
+    }
+}
+
+void Stat_stream_sink::scan_outer(char c)
+{
+    // anything following the outer object is kept so that simdjson rejects it if it is not whitespace
+    outer_.push_back(c);
+    if (complete_) {
+        return;
+    }
+
+    if (scan_string(c)) {
+        if (in_string_ && depth_ == 1 && c != '"' && key_.size() <= std::string_view {Api::stat_files}.size()) {
+            key_.push_back(c);
+        }
+        return;
+    }
+
+    switch (c) {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        return;
+    case ':':
+        files_next_ = depth_ == 1 && key_ == Api::stat_files;
+        return;
+    case '[':
+        if (files_next_) {
+            // the files array is left out of the outer object, keeping only its brackets
+            files_next_ = false;
+            in_files_ = true;
+            return;
+        }
+        ++depth_;
+        return;
+    case '{':
+        ++depth_;
+        break;
+    case '}':
+    case ']':
+        if (--depth_ == 0) {
+            complete_ = true;
+        }
+        break;
+    default:
+        break;
+    }
+    files_next_ = false;
+}
+
+bool Stat_stream_sink::scan_files(char c)
+{
+    if (entry_depth_ == 0) {
+        switch (c) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+        case ',':
+            return false;
+        case '{':
+            entry_depth_ = 1;
+            return true;
+        case ']':
+            outer_.push_back(c);
+            in_files_ = false;
+            return false;
+        default:
+            // every entry of the files array must be a Stat object
+            throw Unexpected_response_error {Err::invalid_json_body_msg, status_};
+        }
+    }
+
+    if (!scan_string(c)) {
+        if (c == '{' || c == '[') {
+            ++entry_depth_;
+        } else if (c == '}' || c == ']') {
+            --entry_depth_;
+        }
+    }
+    return true;
+}
+
+bool Stat_stream_sink::scan_string(char c)
+{
+    if (!in_string_) {
+        if (c == '"') {
+            in_string_ = true;
+            if (!in_files_ && depth_ == 1) {
+                key_.clear();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    if (escaped_) {
+        escaped_ = false;
+    } else if (c == '\\') {
+        escaped_ = true;
+    } else if (c == '"') {
+        in_string_ = false;
+    }
+    return true;
+}
+
+void Stat_stream_sink::emit_entry()
+{
+    const auto obj {parse_object(*parser_, entry_, status_)};
+    try {
+        on_entry_(obj);
+    } catch (const simdjson::simdjson_error& e) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, status_};
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
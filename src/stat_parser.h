@@ -0,0 +1,166 @@
+/**
+ * @file stat_parser.h
+ * Defines functions and classes used to create Resource objects from Stat json objects.
+ */
+
+#ifndef ONEDATASHARE_STAT_PARSER_H
+#define ONEDATASHARE_STAT_PARSER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <simdjson/simdjson.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/resource_table.h>
+
+#include "body_sink.h"
+#include "json_parser_pool.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Creates a Resource object containing the data stored in the specified Stat json object. It is expected that the
+ * specified dom conforms to the Stat object specifications.
+ *
+ * @param obj borrowed reference to the dom containing the Stat json object to parse
+ *
+ * @return the Resource created from parsing the specified dom
+ *
+ * @throw simdjson_error if simdjson encounters an error parsing the dom
+ */
+Resource create_resource(const simdjson::dom::object& obj);
+
+/**
+ * Adds the data stored in the specified Stat json object to the end of the specified table, without any contained
+ * resources. It is expected that the specified dom conforms to the Stat object specifications.
+ *
+ * @param obj borrowed reference to the dom containing the Stat json object to parse
+ * @param table borrowed reference to the table to add the resource to
+ *
+ * @throw simdjson_error if simdjson encounters an error parsing the dom
+ */
+void add_resource(const simdjson::dom::object& obj, Resource_table& table);
+
+/**
+ * Body_sink that parses a Stat json object as it is received, handing out the dom of each Stat object of its files
+ * array as soon as the object is complete. Only the Stat object currently being received is held in memory, along with
+ * the fields of the outer Stat object.
+ */
+class Stat_stream_sink : public Body_sink {
+public:
+    /**
+     * Creates a new Stat_stream_sink passing the dom of each contained Stat object to the specified callback. The dom
+     * is only valid until the callback returns.
+     *
+     * @param on_entry borrowed reference to the callback invoked with each contained Stat object, which must outlive
+     * this object
+     */
+    explicit Stat_stream_sink(const std::function<void(const simdjson::dom::object&)>& on_entry);
+
+    /**
+     * Records the status code, ignoring the body unless the status code is 200.
+     *
+     * @param status the http response status code
+     */
+    void start(int status) override;
+
+    /**
+     * Scans the chunk, invoking the callback for each contained resource completed by the chunk.
+     *
+     * @param data borrowed pointer to the non-null-terminated chunk
+     * @param size the size of the chunk in bytes
+     *
+     * @exception Unexpected_response_error if a contained Stat object is not valid, including when the callback throws
+     * simdjson_error
+     * @exception any other exception thrown by the callback
+     */
+    void write(const char* data, std::size_t size) override;
+
+    /**
+     * Creates the Resource for the outer Stat object once the whole body has been written. A directory's list of
+     * contained resources is empty since its contained resources were handed to the callback.
+     *
+     * @return the Resource created from the outer Stat object
+     *
+     * @exception Unexpected_response_error if the body was not a complete Stat object
+     */
+    Resource finish();
+
+private:
+    /**
+     * Scans a character outside of the files array.
+     *
+     * @param c the character to scan
+     */
+    void scan_outer(char c);
+
+    /**
+     * Scans a character inside of the files array.
+     *
+     * @param c the character to scan
+     *
+     * @return true if the character is part of an entry of the files array, false otherwise
+     */
+    bool scan_files(char c);
+
+    /**
+     * Updates the string state with the specified character.
+     *
+     * @param c the character to scan
+     *
+     * @return true if the character is part of a string, including its closing quote, false otherwise
+     */
+    bool scan_string(char c);
+
+    /**
+     * Parses the completed entry of the files array and hands its dom to the callback.
+     */
+    void emit_entry();
+
+    /** Callback invoked with each contained Stat object. */
+    const std::function<void(const simdjson::dom::object&)>& on_entry_;
+
+    /** Parser used for every entry, held for the lifetime of the sink. */
+    const Json_parser_pool::Lease parser_;
+
+    /** The http response status code. */
+    int status_;
+
+    /** The outer Stat object with the contents of its files array removed. */
+    std::string outer_;
+
+    /** The entry of the files array currently being received. */
+    std::string entry_;
+
+    /** Last string received directly inside the outer object, truncated to the length of the longest key matched. */
+    std::string key_;
+
+    /** Nesting depth within the outer object. */
+    int depth_;
+
+    /** Nesting depth within the current entry of the files array, or 0 between entries. */
+    int entry_depth_;
+
+    /** If the files key was just received and its value is expected next. */
+    bool files_next_;
+
+    /** If the files array is being scanned. */
+    bool in_files_;
+
+    /** If a string is being scanned. */
+    bool in_string_;
+
+    /** If the previous character was an escaping backslash within a string. */
+    bool escaped_;
+
+    /** If the outer object has been closed. */
+    bool complete_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_STAT_PARSER_H
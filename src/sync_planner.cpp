@@ -0,0 +1,20 @@
+/**
+ * @file sync_planner.cpp
+ */
+
+#include <onedatashare/sync_planner.h>
+
+#include "sync_planner_impl.h"
+
+namespace Onedatashare {
+
+std::unique_ptr<Sync_planner> Sync_planner::create(const Sync_options& options)
+{
+    return std::make_unique<Internal::Sync_planner_impl>(options);
+}
+
+Sync_planner::Sync_planner() = default;
+
+Sync_planner::~Sync_planner() = default;
+
+} // namespace Onedatashare
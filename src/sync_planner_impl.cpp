@@ -0,0 +1,221 @@
+/**
+ * @file sync_planner_impl.cpp
+ */
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iterator>
+
+#include <onedatashare/ods_error.h>
+
+#include "error_message.h"
+#include "sync_planner_impl.h"
+#include "util.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** The http response status code of a listing, reported when a listed resource has no id. */
+constexpr auto status_ok {200};
+
+/**
+ * Gets the name or id locating the specified resource from within the directory that contains it.
+ *
+ * @param type the type of endpoint the resource is on
+ * @param resource borrowed reference to the resource
+ *
+ * @return the id of the resource if the endpoint uses ids, the name of the resource otherwise
+ *
+ * @exception Unexpected_response_error if the endpoint uses ids and the resource has no id
+ */
+std::string resource_identifier(Endpoint_type type, const Resource& resource)
+{
+    if (Util::uses_ids(type)) {
+        if (!resource.id) {
+            throw Unexpected_response_error {Err::expect_id_msg, status_ok};
+        }
+        return *resource.id;
+    }
+    return resource.name;
+}
+
+/**
+ * Checks if the specified resource is a directory whose contents are compared rather than the directory itself.
+ *
+ * @param resource borrowed reference to the resource
+ *
+ * @return true if the resource is a directory that is not a symbolic link
+ */
+bool walked(const Resource& resource)
+{
+    return resource.is_directory && !resource.link;
+}
+
+/**
+ * Takes the resources contained by the specified listing, sorted by name.
+ *
+ * @param listing mutably borrowed reference to the listing
+ *
+ * @return the contained resources, or an empty list if the listing cannot contain resources
+ */
+std::vector<Resource> sorted_contents(Resource& listing)
+{
+    auto contents {listing.contained_resources ? std::move(*listing.contained_resources) : std::vector<Resource> {}};
+    std::sort(contents.begin(), contents.end(), [](const Resource& a, const Resource& b) { return a.name < b.name; });
+    return contents;
+}
+
+/**
+ * Passes the specified resource identifiers to the specified callback in batches of at most the specified size.
+ *
+ * @param identifiers borrowed reference to the resource identifiers
+ * @param batch_size the maximum number of identifiers in each batch
+ * @param emit borrowed reference to the callback invoked with each batch
+ */
+void emit_batches(const std::vector<std::string>& identifiers,
+                  std::size_t batch_size,
+                  const std::function<void(std::vector<std::string>)>& emit)
+{
+    const auto size {std::max<std::size_t>(batch_size, 1)};
+    for (auto begin {identifiers.begin()}; begin != identifiers.end();) {
+        const auto end {begin + std::min<std::size_t>(size, identifiers.end() - begin)};
+        emit(std::vector<std::string> {begin, end});
+        begin = end;
+    }
+}
+
+} // namespace
+
+Sync_diff diff_listings(const Sync_options& options,
+                        Endpoint_type source_type,
+                        const std::string& source_directory,
+                        Resource source_listing,
+                        Endpoint_type destination_type,
+                        const std::string& destination_directory,
+                        Resource destination_listing)
+{
+    const auto sources {sorted_contents(source_listing)};
+    const auto destinations {sorted_contents(destination_listing)};
+
+    Sync_diff diff {};
+    auto source {sources.begin()};
+    auto destination {destinations.begin()};
+    while (source != sources.end() || destination != destinations.end()) {
+        if (destination == destinations.end() || (source != sources.end() && source->name < destination->name)) {
+            diff.transfers.push_back(resource_identifier(source_type, *source));
+            ++source;
+        } else if (source == sources.end() || destination->name < source->name) {
+            if (options.delete_extraneous) {
+                diff.deletes.push_back(resource_identifier(destination_type, *destination));
+            }
+            ++destination;
+        } else {
+            if (walked(*source) && walked(*destination)) {
+                diff.directories.emplace_back(
+                    Util::child_identifier(source_type, source_directory, *source, status_ok),
+                    Util::child_identifier(destination_type, destination_directory, *destination, status_ok));
+            } else if (walked(*source) != walked(*destination)) {
+                diff.deletes.push_back(resource_identifier(destination_type, *destination));
+                diff.transfers.push_back(resource_identifier(source_type, *source));
+            } else if (source->size != destination->size || source->time > destination->time + options.time_tolerance) {
+                diff.transfers.push_back(resource_identifier(source_type, *source));
+            }
+            ++source;
+            ++destination;
+        }
+    }
+    return diff;
+}
+
+Sync_planner_impl::Sync_planner_impl(const Sync_options& options) : options_ {options} {}
+
+void Sync_planner_impl::plan(
+    const Endpoint& source,
+    const std::string& source_directory,
+    const Endpoint& destination,
+    const std::string& destination_directory,
+    const std::function<void(const Source& source, const Destination& destination)>& on_transfer,
+    const std::function<void(const Sync_delete& job)>& on_delete) const
+{
+    /** A pair of matching directories being listed. */
+    struct Listing_pair {
+        std::string source_identifier;
+        std::string destination_identifier;
+        std::future<Resource> source_listing;
+        std::future<Resource> destination_listing;
+    };
+
+    // pairs of directories waiting to be listed, taken from the back so that the tree is walked depth first and the
+    // number of pairs waiting stays proportional to the depth of the tree rather than its width
+    std::deque<std::pair<std::string, std::string>> pending {{source_directory, destination_directory}};
+    // pairs being listed, compared in the order they were started
+    std::deque<Listing_pair> in_flight {};
+
+    const auto max_in_flight {static_cast<std::size_t>(std::max(options_.max_concurrency / 2, 1))};
+    std::exception_ptr error {};
+
+    while (true) {
+        while (!error && !pending.empty() && in_flight.size() < max_in_flight) {
+            auto [source_identifier, destination_identifier] {std::move(pending.back())};
+            pending.pop_back();
+            try {
+                auto source_listing {source.list_async(source_identifier)};
+                auto destination_listing {destination.list_async(destination_identifier)};
+                in_flight.push_back({std::move(source_identifier),
+                                     std::move(destination_identifier),
+                                     std::move(source_listing),
+                                     std::move(destination_listing)});
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        if (in_flight.empty()) {
+            break;
+        }
+
+        auto listing {std::move(in_flight.front())};
+        in_flight.pop_front();
+        listing.source_listing.wait();
+        listing.destination_listing.wait();
+
+        if (error) {
+            // wait for the remaining listings without starting new ones
+            continue;
+        }
+
+        try {
+            auto diff {diff_listings(options_,
+                                     source.type(),
+                                     listing.source_identifier,
+                                     listing.source_listing.get(),
+                                     destination.type(),
+                                     listing.destination_identifier,
+                                     listing.destination_listing.get())};
+
+            emit_batches(diff.deletes, options_.batch_size, [&](std::vector<std::string> batch) {
+                on_delete(Sync_delete {listing.destination_identifier, std::move(batch)});
+            });
+            emit_batches(diff.transfers, options_.batch_size, [&](std::vector<std::string> batch) {
+                on_transfer(Source {source.type(), source.cred_id(), listing.source_identifier, std::move(batch)},
+                            Destination {destination.type(), destination.cred_id(), listing.destination_identifier});
+            });
+
+            // pushed in reverse so that the directories are compared in name order
+            std::move(diff.directories.rbegin(), diff.directories.rend(), std::back_inserter(pending));
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
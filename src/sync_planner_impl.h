@@ -0,0 +1,100 @@
+/**
+ * @file sync_planner_impl.h
+ * Defines the internal implementation of the service planning transfers that sync two directory trees.
+ */
+
+#ifndef ONEDATASHARE_SYNC_PLANNER_IMPL_H
+#define ONEDATASHARE_SYNC_PLANNER_IMPL_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/sync_planner.h>
+#include <onedatashare/transfer_service.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Differences between the listings of a source directory and the matching destination directory.
+ */
+struct Sync_diff {
+    /** Names or ids of the source resources to transfer, sorted by name. */
+    std::vector<std::string> transfers;
+
+    /** Names or ids of the destination resources to delete, sorted by name. */
+    std::vector<std::string> deletes;
+
+    /** Paths or ids of the directories found on both endpoints, on the source and on the destination. */
+    std::vector<std::pair<std::string, std::string>> directories;
+};
+
+/**
+ * Compares the listing of a source directory against the listing of the matching destination directory by sorting
+ * both by name and merge-joining them, taking time O(n log n) in the number of listed resources.
+ *
+ * @param options borrowed reference to the options controlling how resources are compared
+ * @param source_type the type of the source endpoint
+ * @param source_directory borrowed reference to the path or id of the source directory
+ * @param source_listing moved listing of the source directory
+ * @param destination_type the type of the destination endpoint
+ * @param destination_directory borrowed reference to the path or id of the destination directory
+ * @param destination_listing moved listing of the destination directory
+ *
+ * @return the differences between the listings
+ *
+ * @exception Unexpected_response_error if an endpoint that uses ids lists a resource without an id
+ */
+Sync_diff diff_listings(const Sync_options& options,
+                        Endpoint_type source_type,
+                        const std::string& source_directory,
+                        Resource source_listing,
+                        Endpoint_type destination_type,
+                        const std::string& destination_directory,
+                        Resource destination_listing);
+
+/**
+ * Sync_planner walking both trees from the calling thread, keeping up to half the maximum number of listings in flight
+ * on each endpoint.
+ */
+class Sync_planner_impl : public Sync_planner {
+public:
+    /**
+     * Creates a new Sync_planner_impl with the specified options.
+     *
+     * @param options borrowed reference to the options controlling how directories are compared
+     */
+    explicit Sync_planner_impl(const Sync_options& options);
+
+    /**
+     * Walks both trees depth first, comparing each pair of matching directories once both are listed.
+     *
+     * @param source borrowed reference to the endpoint to mirror
+     * @param source_directory borrowed reference to the path or id of the directory to mirror
+     * @param destination borrowed reference to the endpoint to bring in sync
+     * @param destination_directory borrowed reference to the path or id of the directory to bring in sync
+     * @param on_transfer borrowed reference to the callback invoked with each transfer job
+     * @param on_delete borrowed reference to the callback invoked with each delete job
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    void plan(const Endpoint& source,
+              const std::string& source_directory,
+              const Endpoint& destination,
+              const std::string& destination_directory,
+              const std::function<void(const Source& source, const Destination& destination)>& on_transfer,
+              const std::function<void(const Sync_delete& job)>& on_delete) const override;
+
+private:
+    /** The options controlling how directories are compared. */
+    const Sync_options options_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_SYNC_PLANNER_IMPL_H
@@ -0,0 +1,73 @@
+/**
+ * @file timer_queue.cpp
+ */
+
+#include <utility>
+
+#include "rest.h"
+#include "timer_queue.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+Timer_queue::Timer_queue() : mutex_ {}, cv_ {}, tasks_ {}, scheduled_ {0}, stopping_ {false}, thread_ {}
+{
+    thread_ = std::thread {[this] { run(); }};
+}
+
+Timer_queue::~Timer_queue()
+{
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+Timer_queue& Timer_queue::shared()
+{
+    static Timer_queue queue {};
+    return queue;
+}
+
+void Timer_queue::schedule(std::chrono::steady_clock::time_point when, std::function<void()> task)
+{
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        tasks_.push(Scheduled {when, scheduled_++, std::move(task)});
+    }
+    cv_.notify_one();
+}
+
+bool Timer_queue::Later::operator()(const Scheduled& a, const Scheduled& b) const
+{
+    return a.when != b.when ? a.when > b.when : a.sequence > b.sequence;
+}
+
+void Timer_queue::run()
+{
+    // delayed requests are started and may complete on this thread, which is shared like the event loop thread
+    mark_event_loop_thread();
+    std::unique_lock<std::mutex> lock {mutex_};
+    while (!stopping_) {
+        if (tasks_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+        if (tasks_.top().when > std::chrono::steady_clock::now()) {
+            cv_.wait_until(lock, tasks_.top().when);
+            continue;
+        }
+
+        // the task is moved out before popping since the top of a priority queue cannot be modified in place
+        auto task {std::move(const_cast<Scheduled&>(tasks_.top()).task)};
+        tasks_.pop();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
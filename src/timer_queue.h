@@ -0,0 +1,111 @@
+/**
+ * @file timer_queue.h
+ * Defines a thread running tasks at scheduled times.
+ */
+
+#ifndef ONEDATASHARE_TIMER_QUEUE_H
+#define ONEDATASHARE_TIMER_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Runs tasks on a single thread once their scheduled time arrives, in order of their scheduled times. Tasks should
+ * not block for long since they delay every task scheduled after them.
+ */
+class Timer_queue {
+public:
+    /**
+     * Creates a new Timer_queue and starts its thread.
+     */
+    Timer_queue();
+
+    /**
+     * Stops the thread, dropping the tasks that have not yet run.
+     */
+    ~Timer_queue();
+
+    Timer_queue(const Timer_queue&) = delete;
+
+    Timer_queue& operator=(const Timer_queue&) = delete;
+
+    Timer_queue(Timer_queue&&) = delete;
+
+    Timer_queue& operator=(Timer_queue&&) = delete;
+
+    /**
+     * Gets the Timer_queue shared by every part of the library that needs to run tasks later, creating it on first
+     * use.
+     *
+     * @return borrowed reference to the shared Timer_queue
+     */
+    static Timer_queue& shared();
+
+    /**
+     * Schedules the specified task to run on the thread of this Timer_queue once the specified time arrives. Tasks
+     * scheduled for the same time run in the order they were scheduled.
+     *
+     * @param when the time to run the task at
+     * @param task moved task to run
+     */
+    void schedule(std::chrono::steady_clock::time_point when, std::function<void()> task);
+
+private:
+    /**
+     * A task waiting for its scheduled time.
+     */
+    struct Scheduled {
+        /** Time the task runs at. */
+        std::chrono::steady_clock::time_point when;
+
+        /** Order the task was scheduled in, breaking ties between tasks scheduled for the same time. */
+        std::uint64_t sequence;
+
+        /** The task. */
+        std::function<void()> task;
+    };
+
+    /**
+     * Orders scheduled tasks so that the earliest is at the top of a priority queue.
+     */
+    struct Later {
+        bool operator()(const Scheduled& a, const Scheduled& b) const;
+    };
+
+    /**
+     * Runs each task once its time arrives until stopped.
+     */
+    void run();
+
+    /** Guards every member below. */
+    std::mutex mutex_;
+
+    /** Notified when a task is scheduled or the thread is stopped. */
+    std::condition_variable cv_;
+
+    /** Tasks waiting for their scheduled time. */
+    std::priority_queue<Scheduled, std::vector<Scheduled>, Later> tasks_;
+
+    /** Number of tasks scheduled so far. */
+    std::uint64_t scheduled_;
+
+    /** If the thread should stop. */
+    bool stopping_;
+
+    /** Thread running the tasks. */
+    std::thread thread_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_TIMER_QUEUE_H
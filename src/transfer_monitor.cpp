@@ -0,0 +1,13 @@
+/**
+ * @file transfer_monitor.cpp
+ */
+
+#include <onedatashare/transfer_monitor.h>
+
+namespace Onedatashare {
+
+Transfer_monitor::Transfer_monitor() = default;
+
+Transfer_monitor::~Transfer_monitor() = default;
+
+} // namespace Onedatashare
@@ -0,0 +1,245 @@
+/**
+ * @file transfer_monitor_impl.cpp
+ */
+
+#include <algorithm>
+
+#include <onedatashare/ods_error.h>
+
+#include "error_message.h"
+#include "transfer_monitor_impl.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** The http response status code of a status response, reported when it omits a tracked job. */
+constexpr auto status_ok {200};
+
+/**
+ * Invokes the error callback of a tracked job if it has one, ignoring anything it throws.
+ *
+ * @param on_error borrowed reference to the error callback, which may be empty
+ * @param job_id borrowed reference to the id of the tracked job
+ * @param error the exception to pass to the callback
+ */
+void report(const std::function<void(const std::string& job_id, std::exception_ptr error)>& on_error,
+            const std::string& job_id,
+            std::exception_ptr error)
+{
+    if (!on_error) {
+        return;
+    }
+    try {
+        on_error(job_id, error);
+    } catch (...) {
+        // the monitoring thread must keep running for the remaining jobs
+    }
+}
+
+/**
+ * Grows the specified time between polls by the backoff factor, within the minimum and maximum intervals.
+ *
+ * @param options borrowed reference to the options controlling how often jobs are polled
+ * @param current the current time between polls
+ *
+ * @return the grown time between polls
+ */
+std::chrono::milliseconds grow(const Transfer_monitor_options& options, std::chrono::milliseconds current)
+{
+    const auto grown {std::chrono::duration_cast<std::chrono::milliseconds>(current * options.backoff_factor)};
+    return std::clamp(grown, options.min_interval, std::max(options.min_interval, options.max_interval));
+}
+
+/**
+ * Gets the event reported for a job that has ended in the specified state.
+ *
+ * @param state the state of the job
+ *
+ * @return the event, or no value if the job has not ended
+ */
+std::optional<Transfer_event_type> final_event(Transfer_state state)
+{
+    switch (state) {
+    case Transfer_state::completed:
+        return Transfer_event_type::completed;
+    case Transfer_state::failed:
+        return Transfer_event_type::failed;
+    case Transfer_state::cancelled:
+        return Transfer_event_type::cancelled;
+    default:
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+std::chrono::milliseconds next_poll_interval(const Transfer_monitor_options& options,
+                                             const Transfer_status& status,
+                                             std::chrono::milliseconds current)
+{
+    const auto starting {status.state() == Transfer_state::queued || status.bytes_transferred() == 0};
+    const auto nearly_done {status.files_total() > 0 &&
+                            status.files_done() >= options.near_done_fraction * status.files_total()};
+    if (starting || nearly_done) {
+        return options.min_interval;
+    }
+    return grow(options, current);
+}
+
+Transfer_monitor_impl::Transfer_monitor_impl(Status_poller poll, const Transfer_monitor_options& options)
+    : poll_ {std::move(poll)},
+      options_ {options},
+      mutex_ {},
+      changed_cv_ {},
+      tracked_ {},
+      schedule_ {},
+      next_id_ {1},
+      stopping_ {false},
+      thread_ {}
+{
+    thread_ = std::thread {&Transfer_monitor_impl::run, this};
+}
+
+Transfer_monitor_impl::~Transfer_monitor_impl()
+{
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        stopping_ = true;
+    }
+    changed_cv_.notify_all();
+    thread_.join();
+}
+
+Track_id Transfer_monitor_impl::track(
+    const std::string& job_id,
+    std::function<void(Transfer_event_type type, const Transfer_status& status)> on_event,
+    std::function<void(const std::string& job_id, std::exception_ptr error)> on_error)
+{
+    Track_id id {};
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        id = next_id_++;
+        tracked_.emplace(id,
+                         std::shared_ptr<Tracked>(new Tracked {
+                             job_id, std::move(on_event), std::move(on_error), options_.min_interval, std::nullopt}));
+        schedule_.emplace(std::chrono::steady_clock::now(), id);
+    }
+    changed_cv_.notify_all();
+    return id;
+}
+
+void Transfer_monitor_impl::untrack(Track_id id)
+{
+    // the scheduled poll of the job is skipped once it is due
+    const std::lock_guard<std::mutex> lock {mutex_};
+    tracked_.erase(id);
+}
+
+void Transfer_monitor_impl::run()
+{
+    std::unique_lock<std::mutex> lock {mutex_};
+    while (!stopping_) {
+        if (schedule_.empty()) {
+            changed_cv_.wait(lock);
+            continue;
+        }
+        if (schedule_.top().first > std::chrono::steady_clock::now()) {
+            changed_cv_.wait_until(lock, schedule_.top().first);
+            continue;
+        }
+
+        // every job that is due is polled together, so jobs tracked at about the same time share their requests
+        std::vector<std::pair<Track_id, std::shared_ptr<Tracked>>> due {};
+        const auto now {std::chrono::steady_clock::now()};
+        while (!schedule_.empty() && schedule_.top().first <= now) {
+            const auto tracked {tracked_.find(schedule_.top().second)};
+            if (tracked != tracked_.end()) {
+                due.emplace_back(*tracked);
+            }
+            schedule_.pop();
+        }
+        if (due.empty()) {
+            continue;
+        }
+
+        lock.unlock();
+        poll(due);
+        lock.lock();
+    }
+}
+
+void Transfer_monitor_impl::poll(const std::vector<std::pair<Track_id, std::shared_ptr<Tracked>>>& due)
+{
+    std::vector<std::string> job_ids {};
+    job_ids.reserve(due.size());
+    for (const auto& [id, tracked] : due) {
+        job_ids.push_back(tracked->job_id);
+    }
+
+    Transfer_status_map statuses {};
+    std::exception_ptr error {};
+    try {
+        statuses = poll_(job_ids);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::vector<Due> next {};
+    next.reserve(due.size());
+    for (const auto& [id, tracked] : due) {
+        {
+            // callbacks of a job that was untracked while it was being polled are not invoked
+            const std::lock_guard<std::mutex> lock {mutex_};
+            if (tracked_.find(id) == tracked_.end()) {
+                continue;
+            }
+        }
+
+        const auto status {error ? statuses.end() : statuses.find(tracked->job_id)};
+        if (status == statuses.end()) {
+            report(tracked->on_error,
+                   tracked->job_id,
+                   error ? error
+                         : std::make_exception_ptr(Unexpected_response_error {Err::expect_job_status_msg, status_ok}));
+            tracked->interval = grow(options_, tracked->interval);
+        } else if (report_status(*tracked, *status->second)) {
+            tracked->interval = next_poll_interval(options_, *status->second, tracked->interval);
+        } else {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            tracked_.erase(id);
+            continue;
+        }
+        next.emplace_back(std::chrono::steady_clock::now() + tracked->interval, id);
+    }
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    for (const auto& due_next : next) {
+        if (tracked_.find(due_next.second) != tracked_.end()) {
+            schedule_.push(due_next);
+        }
+    }
+}
+
+bool Transfer_monitor_impl::report_status(Tracked& tracked, const Transfer_status& status) const
+{
+    const Progress progress {status.state(), status.bytes_transferred(), status.files_done()};
+    const auto changed {!tracked.last || tracked.last->state != progress.state ||
+                        tracked.last->bytes_transferred != progress.bytes_transferred ||
+                        tracked.last->files_done != progress.files_done};
+    tracked.last = progress;
+
+    const auto event {final_event(progress.state)};
+    if (event || changed) {
+        try {
+            tracked.on_event(event.value_or(Transfer_event_type::progress), status);
+        } catch (...) {
+            report(tracked.on_error, tracked.job_id, std::current_exception());
+        }
+    }
+    return !event;
+}
+
+} // namespace Internal
+} // namespace Onedatashare
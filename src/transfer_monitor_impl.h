@@ -0,0 +1,188 @@
+/**
+ * @file transfer_monitor_impl.h
+ * Defines the internal implementation of the service observing the progress of transfer jobs.
+ */
+
+#ifndef ONEDATASHARE_TRANSFER_MONITOR_IMPL_H
+#define ONEDATASHARE_TRANSFER_MONITOR_IMPL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <onedatashare/transfer_monitor.h>
+#include <onedatashare/transfer_service.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Statuses of transfer jobs, by job id.
+ */
+using Transfer_status_map = std::unordered_map<std::string, std::unique_ptr<Transfer_status>>;
+
+/**
+ * Options controlling how often a Transfer_monitor_impl polls each job.
+ */
+struct Transfer_monitor_options {
+    /** Time between polls of a job that is queued, starting, or nearly done. */
+    std::chrono::milliseconds min_interval {500};
+
+    /** Greatest time between polls of a job making steady progress. */
+    std::chrono::milliseconds max_interval {10000};
+
+    /** Factor the time between polls of a job grows by each time it is polled in steady progress. */
+    double backoff_factor {1.5};
+
+    /** Fraction of its files a job must have transferred to be treated as nearly done. */
+    double near_done_fraction {0.9};
+};
+
+/**
+ * Gets the time until a job with the specified status is next polled. Jobs that are queued, have not yet transferred
+ * any bytes, or have transferred at least the near done fraction of their files are polled every minimum interval,
+ * since those are when their state is about to change. Otherwise the interval grows from the current one.
+ *
+ * @param options borrowed reference to the options controlling how often jobs are polled
+ * @param status borrowed reference to the most recent status of the job
+ * @param current the current time between polls of the job
+ *
+ * @return the time until the job is next polled
+ */
+std::chrono::milliseconds next_poll_interval(const Transfer_monitor_options& options,
+                                             const Transfer_status& status,
+                                             std::chrono::milliseconds current);
+
+/**
+ * Transfer_monitor polling every due job with one call to a status poller from a single thread.
+ */
+class Transfer_monitor_impl : public Transfer_monitor {
+public:
+    /**
+     * Function fetching the statuses of the specified jobs, which may omit jobs whose statuses were not received.
+     */
+    using Status_poller = std::function<Transfer_status_map(const std::vector<std::string>& job_ids)>;
+
+    /**
+     * Creates a new Transfer_monitor_impl with the specified poller and options and starts its monitoring thread.
+     *
+     * @param poll moved function fetching the statuses of jobs
+     * @param options borrowed reference to the options controlling how often jobs are polled
+     */
+    explicit Transfer_monitor_impl(Status_poller poll, const Transfer_monitor_options& options = {});
+
+    /**
+     * Stops the monitoring thread, waiting for any poll or callback in progress to return.
+     */
+    ~Transfer_monitor_impl() override;
+
+    Track_id track(const std::string& job_id,
+                   std::function<void(Transfer_event_type type, const Transfer_status& status)> on_event,
+                   std::function<void(const std::string& job_id, std::exception_ptr error)> on_error) override;
+
+    void untrack(Track_id id) override;
+
+private:
+    /**
+     * The parts of a status whose change is reported as progress.
+     */
+    struct Progress {
+        /** State of the job. */
+        Transfer_state state;
+
+        /** Number of bytes transferred. */
+        std::uint64_t bytes_transferred;
+
+        /** Number of files transferred. */
+        std::uint64_t files_done;
+    };
+
+    /**
+     * A tracked job.
+     */
+    struct Tracked {
+        /** Id of the job. */
+        const std::string job_id;
+
+        /** Callback invoked with each event. */
+        const std::function<void(Transfer_event_type type, const Transfer_status& status)> on_event;
+
+        /** Callback invoked with each failure, or nullptr. */
+        const std::function<void(const std::string& job_id, std::exception_ptr error)> on_error;
+
+        /** Current time between polls, only used by the monitoring thread. */
+        std::chrono::milliseconds interval;
+
+        /** Progress at the last poll, or no value before the first poll, only used by the monitoring thread. */
+        std::optional<Progress> last;
+    };
+
+    /** Time a tracked job is next due to be polled. */
+    using Due = std::pair<std::chrono::steady_clock::time_point, Track_id>;
+
+    /**
+     * Runs the monitoring thread until the monitor is destroyed.
+     */
+    void run();
+
+    /**
+     * Polls the specified jobs together, invokes their callbacks, and schedules the next poll of each job still in
+     * progress.
+     *
+     * @param due borrowed reference to the ids and jobs that are due
+     */
+    void poll(const std::vector<std::pair<Track_id, std::shared_ptr<Tracked>>>& due);
+
+    /**
+     * Reports the specified status of the specified job, returning if the job is still in progress.
+     *
+     * @param tracked borrowed reference to the job
+     * @param status borrowed reference to the status of the job
+     *
+     * @return true if the job is still in progress, false if it has ended
+     */
+    bool report_status(Tracked& tracked, const Transfer_status& status) const;
+
+    /** Function fetching the statuses of jobs. */
+    const Status_poller poll_;
+
+    /** Options controlling how often jobs are polled. */
+    const Transfer_monitor_options options_;
+
+    /** Mutex guarding every member below other than the thread. */
+    std::mutex mutex_;
+
+    /** Notified when a job is tracked or the monitor is destroyed. */
+    std::condition_variable changed_cv_;
+
+    /** Tracked jobs, by id. */
+    std::unordered_map<Track_id, std::shared_ptr<Tracked>> tracked_;
+
+    /** When each tracked job is next due to be polled, soonest first. Untracked ids are skipped. */
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> schedule_;
+
+    /** Id of the next tracked job. */
+    Track_id next_id_;
+
+    /** If the monitor is being destroyed. */
+    bool stopping_;
+
+    /** The monitoring thread. */
+    std::thread thread_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_TRANSFER_MONITOR_IMPL_H
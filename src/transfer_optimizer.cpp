@@ -0,0 +1,20 @@
+/**
+ * @file transfer_optimizer.cpp
+ */
+
+#include <onedatashare/transfer_optimizer.h>
+
+#include "transfer_optimizer_impl.h"
+
+namespace Onedatashare {
+
+std::unique_ptr<Transfer_optimizer> Transfer_optimizer::create(const std::string& history_path)
+{
+    return std::make_unique<Internal::Transfer_optimizer_impl>(history_path);
+}
+
+Transfer_optimizer::Transfer_optimizer() = default;
+
+Transfer_optimizer::~Transfer_optimizer() = default;
+
+} // namespace Onedatashare
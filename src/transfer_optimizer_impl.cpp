@@ -0,0 +1,303 @@
+/**
+ * @file transfer_optimizer_impl.cpp
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+#include "shard_partition.h"
+#include "transfer_optimizer_impl.h"
+#include "util.h"
+
+namespace Onedatashare {
+namespace Internal {
+
+namespace {
+
+/** First line of a history file, identifying its format. */
+constexpr auto history_magic {"odsoptimizer 1"};
+
+/** Greatest average file size, in bytes, of a dataset of small files. */
+constexpr std::uint64_t small_file_limit {1024 * 1024};
+
+/** Greatest average file size, in bytes, of a dataset of medium files. */
+constexpr std::uint64_t medium_file_limit {100 * 1024 * 1024};
+
+/** Greatest value any tuned option is raised to. */
+constexpr auto max_tuned_option {64};
+
+/** Number of options tuned. */
+constexpr auto tuned_dimensions {3};
+
+/** Fraction by which changed options must beat the best throughput to replace the best options, so that noise in the
+ * measured throughput does not make the search wander. */
+constexpr auto min_improvement {0.05};
+
+/**
+ * Gets the name of the size class of the files in the specified dataset.
+ *
+ * @param profile borrowed reference to the summary of the resources transferred
+ *
+ * @return "small", "medium", or "large"
+ */
+const char* size_class(const Dataset_profile& profile)
+{
+    const auto average {profile.file_count == 0 ? 0 : profile.total_bytes / profile.file_count};
+    if (average <= small_file_limit) {
+        return "small";
+    } else if (average <= medium_file_limit) {
+        return "medium";
+    }
+    return "large";
+}
+
+/**
+ * Creates the key of the tuning state of the specified kind of transfer.
+ *
+ * @param source borrowed reference to the source of the transfer
+ * @param destination borrowed reference to the destination of the transfer
+ * @param profile borrowed reference to the summary of the resources transferred
+ *
+ * @return the key, whose parts are separated by tabs
+ */
+std::string tuning_key(const Source& source, const Destination& destination, const Dataset_profile& profile)
+{
+    return Util::as_string(source.type) + '\t' + source.cred_id + '\t' + Util::as_string(destination.type) + '\t' +
+           destination.cred_id + '\t' + size_class(profile);
+}
+
+/**
+ * Gets a mutable reference to the specified option.
+ *
+ * @param options mutably borrowed reference to the options
+ * @param dimension index of the option: 0 for concurrency, 1 for parallelism, 2 for pipelining
+ *
+ * @return mutably borrowed reference to the option
+ */
+int& option(Tuned_options& options, int dimension)
+{
+    return dimension == 0 ? options.concurrency : dimension == 1 ? options.parallelism : options.pipelining;
+}
+
+/**
+ * Moves the search on to the next direction, or to the next option once both directions of the current option have
+ * been tried.
+ *
+ * @param state mutably borrowed reference to the tuning state
+ */
+void advance(Tuning_state& state)
+{
+    if (state.direction > 0) {
+        state.direction = -1;
+    } else {
+        state.direction = 1;
+        state.dimension = (state.dimension + 1) % tuned_dimensions;
+    }
+}
+
+/**
+ * Gets the options to try next from the specified tuning state, advancing the search past changes that would leave
+ * the options unchanged. The search moves on even when every transfer with the best options failed, so that failing
+ * options are never recommended forever.
+ *
+ * @param state mutably borrowed reference to the tuning state
+ *
+ * @return the best options with one option doubled or halved, or the best options themselves if no option can be
+ * changed
+ */
+Tuned_options next_options(Tuning_state& state)
+{
+    for (auto tries {0}; tries < 2 * tuned_dimensions; ++tries) {
+        auto next {state.best};
+        auto& value {option(next, state.dimension)};
+        value = std::clamp(state.direction > 0 ? value * 2 : value / 2, 1, max_tuned_option);
+        if (value != option(state.best, state.dimension)) {
+            return next;
+        }
+        advance(state);
+    }
+    return state.best;
+}
+
+/**
+ * Checks if two sets of tuned options are equal.
+ *
+ * @param a borrowed reference to the first options
+ * @param b borrowed reference to the second options
+ *
+ * @return true if every option is equal
+ */
+bool same_options(const Tuned_options& a, const Tuned_options& b)
+{
+    return a.concurrency == b.concurrency && a.parallelism == b.parallelism && a.pipelining == b.pipelining;
+}
+
+/**
+ * Loads the tuning states saved in the history file at the specified path.
+ *
+ * @param path borrowed reference to the path of the history file
+ *
+ * @return the tuning states, or an empty map if there is no history file or it has a different format, skipping
+ * malformed lines
+ */
+std::unordered_map<std::string, Tuning_state> load_history(const std::string& path)
+{
+    std::unordered_map<std::string, Tuning_state> history {};
+    std::ifstream in {path};
+    std::string line {};
+    if (!std::getline(in, line) || line != history_magic) {
+        return history;
+    }
+
+    while (std::getline(in, line)) {
+        std::istringstream fields {line};
+        Tuning_state state {};
+        std::string key {};
+        if (!(fields >> state.best.concurrency >> state.best.parallelism >> state.best.pipelining >>
+              state.throughput >> state.dimension >> state.direction) ||
+            fields.get() != ' ' || !std::getline(fields, key)) {
+            continue;
+        }
+
+        const auto in_range {[](int value) { return value >= 1 && value <= max_tuned_option; }};
+        if (in_range(state.best.concurrency) && in_range(state.best.parallelism) && in_range(state.best.pipelining) &&
+            state.throughput >= 0 && state.dimension >= 0 && state.dimension < tuned_dimensions &&
+            (state.direction == 1 || state.direction == -1)) {
+            history.insert_or_assign(std::move(key), state);
+        }
+    }
+    return history;
+}
+
+} // namespace
+
+Tuned_options initial_options(const Dataset_profile& profile)
+{
+    const auto average {profile.file_count == 0 ? 0 : profile.total_bytes / profile.file_count};
+    if (average <= small_file_limit) {
+        // per file overhead dominates, so keep many files and commands in flight over single streams
+        return Tuned_options {32, 1, 16};
+    } else if (average <= medium_file_limit) {
+        return Tuned_options {8, 4, 4};
+    }
+    // each file is long enough for parallel streams to fill the network
+    return Tuned_options {4, 8, 1};
+}
+
+Dataset_profile profile_dataset(Endpoint_type type,
+                                const Resource& directory,
+                                const std::vector<std::string>& identifiers)
+{
+    if (identifiers.empty()) {
+        // a source naming no resources transfers the whole directory
+        Dataset_profile profile {0, 0};
+        if (directory.contained_resources) {
+            for (const auto& resource : *directory.contained_resources) {
+                ++profile.file_count;
+                profile.total_bytes += static_cast<std::uint64_t>(std::max(resource.size, 0L));
+            }
+        }
+        return profile;
+    }
+
+    const auto sizes {resource_sizes(type, directory, identifiers)};
+    return Dataset_profile {static_cast<std::uint64_t>(sizes.size()),
+                            std::accumulate(sizes.begin(), sizes.end(), std::uint64_t {0})};
+}
+
+Transfer_optimizer_impl::Transfer_optimizer_impl(std::string history_path)
+    : history_path_ {std::move(history_path)},
+      mutex_ {},
+      history_ {history_path_.empty() ? std::unordered_map<std::string, Tuning_state> {}
+                                      : load_history(history_path_)}
+{}
+
+Transfer_options Transfer_optimizer_impl::recommend(const Source& source,
+                                                    const Destination& destination,
+                                                    const Dataset_profile& profile)
+{
+    Tuned_options tuned {};
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        const auto state {history_.find(tuning_key(source, destination, profile))};
+        tuned = state == history_.end() ? initial_options(profile) : next_options(state->second);
+    }
+
+    Transfer_options options {};
+    options.concurrency = tuned.concurrency;
+    options.parallelism = tuned.parallelism;
+    options.pipelining = tuned.pipelining;
+    return options;
+}
+
+void Transfer_optimizer_impl::record(const Source& source,
+                                     const Destination& destination,
+                                     const Dataset_profile& profile,
+                                     const Transfer_options& options,
+                                     double throughput)
+{
+    if (!options.concurrency || !options.parallelism || !options.pipelining) {
+        return;
+    }
+    const Tuned_options used {std::clamp(*options.concurrency, 1, max_tuned_option),
+                              std::clamp(*options.parallelism, 1, max_tuned_option),
+                              std::clamp(*options.pipelining, 1, max_tuned_option)};
+    throughput = std::max(throughput, 0.0);
+
+    const std::lock_guard<std::mutex> lock {mutex_};
+    const auto [entry, inserted] {
+        history_.try_emplace(tuning_key(source, destination, profile), Tuning_state {used, throughput, 0, 1})};
+    auto& state {entry->second};
+    // the first measurement of a kind of transfer becomes the starting point of its search
+    if (inserted) {
+        save();
+        return;
+    }
+
+    if (same_options(used, state.best)) {
+        // average repeated measurements of the best options to smooth out noise
+        state.throughput = state.throughput <= 0 ? throughput : (state.throughput + throughput) / 2;
+    } else if (throughput > state.throughput * (1 + min_improvement)) {
+        // keep climbing in the same direction from the better options
+        state.best = used;
+        state.throughput = throughput;
+    } else {
+        advance(state);
+    }
+    save();
+}
+
+void Transfer_optimizer_impl::save() const
+{
+    if (history_path_.empty()) {
+        return;
+    }
+
+    const auto temporary_path {history_path_ + ".tmp"};
+    {
+        std::ofstream out {temporary_path, std::ios::trunc};
+        out << history_magic << '\n';
+        for (const auto& [key, state] : history_) {
+            // keys are the rest of their line, so a credential id containing a newline cannot be saved
+            if (key.find('\n') == std::string::npos) {
+                out << state.best.concurrency << ' ' << state.best.parallelism << ' ' << state.best.pipelining << ' '
+                    << state.throughput << ' ' << state.dimension << ' ' << state.direction << ' ' << key << '\n';
+            }
+        }
+        if (!out.flush()) {
+            std::remove(temporary_path.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporary_path.c_str(), history_path_.c_str()) != 0) {
+        std::remove(temporary_path.c_str());
+    }
+}
+
+} // namespace Internal
+} // namespace Onedatashare
@@ -0,0 +1,124 @@
+/**
+ * @file transfer_optimizer_impl.h
+ * Defines the internal implementation of the service choosing transfer options.
+ */
+
+#ifndef ONEDATASHARE_TRANSFER_OPTIMIZER_IMPL_H
+#define ONEDATASHARE_TRANSFER_OPTIMIZER_IMPL_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/transfer_optimizer.h>
+#include <onedatashare/transfer_service.h>
+
+namespace Onedatashare {
+namespace Internal {
+
+/**
+ * Transfer options tuned by a Transfer_optimizer_impl.
+ */
+struct Tuned_options {
+    /** Number of files transferred at once. */
+    int concurrency;
+
+    /** Number of parallel streams used to transfer each file. */
+    int parallelism;
+
+    /** Number of commands sent ahead on each connection. */
+    int pipelining;
+};
+
+/**
+ * Progress of the hill climbing search for the best options of one kind of transfer.
+ */
+struct Tuning_state {
+    /** Best options found so far. */
+    Tuned_options best;
+
+    /** Average throughput of the best options in bytes per second, or 0 if every transfer with them failed. */
+    double throughput;
+
+    /** Index of the option currently being changed: 0 for concurrency, 1 for parallelism, 2 for pipelining. */
+    int dimension;
+
+    /** Direction the option is currently changed in: 1 to double it, -1 to halve it. */
+    int direction;
+};
+
+/**
+ * Chooses the options of the first transfer of the specified dataset with a heuristic model: many concurrent files
+ * and deep pipelining when the average file is small, and more parallel streams per file as the average file grows.
+ *
+ * @param profile borrowed reference to the summary of the resources transferred
+ *
+ * @return the initial options
+ */
+Tuned_options initial_options(const Dataset_profile& profile);
+
+/**
+ * Summarizes the specified resources from the listing of the directory containing them, or every resource in the
+ * listing if no resources are specified, since a source naming no resources transfers the whole directory. Resources
+ * missing from the listing are counted with an unknown size of 0, and so are directories, since listings do not report
+ * their sizes.
+ *
+ * @param type the type of endpoint the resources are on
+ * @param directory borrowed reference to the listing of the directory containing the resources
+ * @param identifiers borrowed reference to the names or ids, depending on the endpoint type, of the resources, or an
+ * empty list to summarize the whole directory
+ *
+ * @return the summary of the resources
+ *
+ * @see resource_sizes
+ */
+Dataset_profile profile_dataset(Endpoint_type type,
+                                const Resource& directory,
+                                const std::vector<std::string>& identifiers);
+
+/**
+ * Transfer_optimizer keeping the hill climbing state of each kind of transfer in memory and saving all of it to the
+ * history file after each report.
+ */
+class Transfer_optimizer_impl : public Transfer_optimizer {
+public:
+    /**
+     * Creates a new Transfer_optimizer_impl, loading the history file at the specified path if there is one.
+     *
+     * @param history_path the path of the history file, or an empty string to keep the history in memory only
+     */
+    explicit Transfer_optimizer_impl(std::string history_path);
+
+    Transfer_options recommend(const Source& source,
+                               const Destination& destination,
+                               const Dataset_profile& profile) override;
+
+    void record(const Source& source,
+                const Destination& destination,
+                const Dataset_profile& profile,
+                const Transfer_options& options,
+                double throughput) override;
+
+private:
+    /**
+     * Writes every tuning state to a temporary file and renames it over the history file, so that a run interrupted
+     * while saving leaves the previous history intact. Must be called with the mutex held.
+     */
+    void save() const;
+
+    /** Path of the history file, or empty if the history is kept in memory only. */
+    const std::string history_path_;
+
+    /** Guards the tuning states. */
+    std::mutex mutex_;
+
+    /** Tuning state of each kind of transfer, by endpoint pair and file size class. */
+    std::unordered_map<std::string, Tuning_state> history_;
+};
+
+} // namespace Internal
+} // namespace Onedatashare
+
+#endif // ONEDATASHARE_TRANSFER_OPTIMIZER_IMPL_H
@@ -7,7 +7,7 @@
 
 #include <onedatashare/transfer_service.h>
 
-#include "curl_rest.h"
+#include "retry_rest.h"
 #include "transfer_service_impl.h"
 #include "util.h"
 
@@ -22,10 +22,13 @@ std::unique_ptr<Transfer_service> Transfer_service::create(const std::string& od
 {
     return std::make_unique<Internal::Transfer_service_impl>(ods_auth_token,
                                                              url,
-                                                             std::make_unique<Internal::Curl_rest>());
+                                                             Internal::Retry_rest::shared());
 }
 
 Transfer_service::Transfer_service() = default;
 Transfer_service::~Transfer_service() = default;
 
+Transfer_status::Transfer_status() = default;
+Transfer_status::~Transfer_status() = default;
+
 } // namespace Onedatashare
@@ -5,13 +5,25 @@
  * @date 7/23/20
  */
 
-#include <sstream>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
 #include <utility>
 
 #include <onedatashare/ods_error.h>
 
 #include "error_message.h"
+#include "json_parser_pool.h"
+#include "json_writer.h"
 #include "ods_rest_api.h"
+#include "shard_partition.h"
+#include "transfer_optimizer_impl.h"
 #include "transfer_service_impl.h"
 #include "util.h"
 
@@ -20,83 +32,132 @@ namespace Internal {
 
 namespace {
 
+/** Characters reserved for the field names and punctuation surrounding each EntityInfo json object. */
+constexpr std::size_t entity_info_overhead {64};
+
+/** Characters reserved for a TransferOptions json object with every option set. */
+constexpr std::size_t transfer_options_overhead {192};
+
+/** Greatest number of job ids checked by each transfer job status REST API call. */
+constexpr std::size_t status_batch_size {100};
+
+/** Greatest length of the comma separated job ids of each transfer job status REST API call, which keeps its url
+ * within the length servers accept. */
+constexpr std::size_t status_batch_length {2000};
+
+/** Number of times in a row the status of an optimized transfer job must fail to be checked before the job is
+ * reported to its optimizer as failed. */
+constexpr auto max_status_failures {3};
+
 /**
- * Creates an EntityInfo json object with the specified fields
+ * Writes an EntityInfo json object with the specified fields.
  *
+ * @param writer borrowed reference to the writer to write with
  * @param id borrowed reference to the id to use for the EntityInfo
  * @param path borrowed reference to the path to use for the EntityInfo
- *
- * @return json string generated
  */
-std::string create_entity_info(const std::string& id, const std::string& path)
+void write_entity_info(Json_writer& writer, const std::string& id, const std::string& path)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::entity_info_id << "\":\"" << Util::escape_json(id) << "\",\"" << Api::entity_info_path
-           << "\":\"" << Util::escape_json(path) << "\"}";
-
-    return stream.str();
+    writer.begin_object();
+    writer.field<Api::entity_info_id>(id);
+    writer.field<Api::entity_info_path>(path);
+    writer.end_object();
 }
 
 /**
- * Creates a Source json object from the specified Source object.
+ * Writes a Source json object from the specified Source object.
  *
+ * @param writer borrowed reference to the writer to write with
  * @param source the Source object to generate json from
- *
- * @return json string generated
  */
-std::string create_source(const Source& source)
+void write_source(Json_writer& writer, const Source& source)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::source_type << "\":\"" << Util::as_string(source.type) << "\",\"" << Api::source_cred_id
-           << "\":\"" << Util::escape_json(source.cred_id) << "\",\"" << Api::source_info
-           << "\":" << create_entity_info(source.directory_identifier, source.directory_identifier) << ",\""
-           << Api::source_info_list << "\":[";
+    writer.begin_object();
+    writer.field<Api::source_type>(Util::as_string(source.type));
+    writer.field<Api::source_cred_id>(source.cred_id);
+    writer.key<Api::source_info>();
+    write_entity_info(writer, source.directory_identifier, source.directory_identifier);
 
     // create json array of EntityInfo json objects
-    auto first {true};
+    writer.key<Api::source_info_list>();
+    writer.begin_array();
     for (const auto& id : source.resource_identifiers) {
-        // print comma prefix for each element other than the first
-        if (!first) {
-            stream << ",";
-        } else {
-            first = false;
-        }
-        stream << create_entity_info(id, id);
+        write_entity_info(writer, id, id);
     }
-    stream << "]}";
-
-    return stream.str();
+    writer.end_array();
+    writer.end_object();
 }
 
 /**
- * Creates a Destination json object from the specified Destination object.
+ * Writes a Destination json object from the specified Destination object.
  *
+ * @param writer borrowed reference to the writer to write with
  * @param destination the Destination object to generate json from
- *
- * @return json string generated
  */
-std::string create_destination(const Destination& destination)
+void write_destination(Json_writer& writer, const Destination& destination)
 {
-    std::ostringstream stream {};
-    stream << "{\"" << Api::destination_type << "\":\"" << Util::as_string(destination.type) << "\",\""
-           << Api::destination_cred_id << "\":\"" << Util::escape_json(destination.cred_id) << "\",\""
-           << Api::destination_info
-           << "\":" << create_entity_info(destination.directory_identifier, destination.directory_identifier) << "}";
-
-    return stream.str();
+    writer.begin_object();
+    writer.field<Api::destination_type>(Util::as_string(destination.type));
+    writer.field<Api::destination_cred_id>(destination.cred_id);
+    writer.key<Api::destination_info>();
+    write_entity_info(writer, destination.directory_identifier, destination.directory_identifier);
+    writer.end_object();
 }
 
 /**
- * Creates a TransferOptions json object from the specified Transfer_options object.
+ * Checks that each option set in the specified Transfer_options object has a positive value.
  *
- * @param options the Transfer_options object to generate json from
+ * @param options borrowed reference to the options to check
  *
- * @return json string generated
+ * @exception invalid_argument if an option is set to a value that is not positive
  */
-std::string create_transfer_options(const Transfer_options& options)
+void validate_transfer_options(const Transfer_options& options)
 {
-    // TODO: implement
-    return "";
+    for (const auto& count : {options.concurrency, options.parallelism, options.pipelining}) {
+        if (count && *count < 1) {
+            throw std::invalid_argument(Err::invalid_transfer_option_msg);
+        }
+    }
+    if (options.chunk_size && *options.chunk_size == 0) {
+        throw std::invalid_argument(Err::invalid_transfer_option_msg);
+    }
+}
+
+/**
+ * Writes a TransferOptions json object member of the current json object from the specified Transfer_options object,
+ * writing nothing if no option is set so that OneDataShare uses its defaults.
+ *
+ * @param writer borrowed reference to the writer to write with
+ * @param options borrowed reference to the Transfer_options object to generate json from
+ */
+void write_transfer_options(Json_writer& writer, const Transfer_options& options)
+{
+    if (!options.concurrency && !options.parallelism && !options.pipelining && !options.chunk_size &&
+        !options.compress && !options.verify) {
+        return;
+    }
+
+    writer.key<Api::transfer_job_request_options>();
+    writer.begin_object();
+    if (options.concurrency) {
+        writer.number_field<Api::transfer_options_concurrency>(*options.concurrency);
+    }
+    if (options.parallelism) {
+        writer.number_field<Api::transfer_options_parallelism>(*options.parallelism);
+    }
+    if (options.pipelining) {
+        writer.number_field<Api::transfer_options_pipelining>(*options.pipelining);
+    }
+    if (options.chunk_size) {
+        writer.number_field<Api::transfer_options_chunk_size>(*options.chunk_size);
+    }
+    if (options.compress) {
+        writer.bool_field<Api::transfer_options_compress>(*options.compress);
+    }
+    if (options.verify) {
+        writer.bool_field<Api::transfer_options_verify>(*options.verify);
+    }
+    writer.end_object();
 }
 
 /**
@@ -107,26 +168,484 @@ std::string create_transfer_options(const Transfer_options& options)
  * @param options the Transfer_options object to generate json from
  *
  * @return json string generated
+ *
+ * @exception invalid_argument if an option is set to a value that is not positive
  */
 std::string create_transfer_job_request(const Source& source,
                                         const Destination& destination,
                                         const Transfer_options& options)
 {
-    std::ostringstream stream;
-    stream << "{\"" << Api::transfer_job_request_source << "\":" << create_source(source) << ", \""
-           << Api::transfer_job_request_destination << "\":" << create_destination(destination) << "}";
+    validate_transfer_options(options);
+
+    // reserve enough for the whole request up front, since the list of resources can be very long
+    auto size {entity_info_overhead * (source.resource_identifiers.size() + 2) + transfer_options_overhead +
+               source.cred_id.size() + destination.cred_id.size() + 2 * source.directory_identifier.size() +
+               2 * destination.directory_identifier.size()};
+    for (const auto& id : source.resource_identifiers) {
+        size += 2 * id.size();
+    }
+    std::string json {};
+    json.reserve(size);
+
+    Json_writer writer {json};
+    writer.begin_object();
+    writer.key<Api::transfer_job_request_source>();
+    write_source(writer, source);
+    writer.key<Api::transfer_job_request_destination>();
+    write_destination(writer, destination);
+    write_transfer_options(writer, options);
+    writer.end_object();
+
+    return json;
+}
+
+/**
+ * Gets the job id from the response to a transfer job REST API call.
+ *
+ * @param response moved response to parse, whose body is moved into the returned id
+ *
+ * @return the id of the new transfer job
+ *
+ * @exception Unexpected_response_error if the response does not have a 200 status code
+ */
+std::string parse_transfer_response(Response response)
+{
+    if (response.status() != 200) {
+        // expected status 200
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
+    }
+
+    return response.release_body();
+}
+
+/**
+ * Computes the average throughput of a job that transferred the specified number of bytes between the specified
+ * times.
+ *
+ * @param bytes the number of bytes transferred
+ * @param start the time the job started, in milliseconds since the Unix epoch
+ * @param until the time the job ended or was last updated, in milliseconds since the Unix epoch
+ *
+ * @return the throughput in bytes per second, or 0 if either time is unknown or no time has passed
+ */
+double average_throughput(std::uint64_t bytes, std::optional<long> start, std::optional<long> until)
+{
+    if (!start || !until || *until <= *start) {
+        return 0;
+    }
+    return bytes * 1000.0 / (*until - *start);
+}
+
+/**
+ * Gets the Transfer_state named by the specified TransferJobStatus state field value.
+ *
+ * @param value the value of the state field
+ *
+ * @return the named state
+ *
+ * @exception simdjson_error if the value names no state
+ */
+Transfer_state parse_transfer_state(std::string_view value)
+{
+    if (value == Api::transfer_state_queued) {
+        return Transfer_state::queued;
+    } else if (value == Api::transfer_state_running) {
+        return Transfer_state::running;
+    } else if (value == Api::transfer_state_completed) {
+        return Transfer_state::completed;
+    } else if (value == Api::transfer_state_failed) {
+        return Transfer_state::failed;
+    } else if (value == Api::transfer_state_cancelled) {
+        return Transfer_state::cancelled;
+    }
+    throw simdjson::simdjson_error {simdjson::INCORRECT_TYPE};
+}
+
+/**
+ * Creates a Transfer_status_impl from the specified TransferJobStatus json object. Fields that are missing or null
+ * are treated as not yet reported, except for the id and state, which are required.
+ *
+ * @param obj borrowed reference to the json object
+ *
+ * @return the created Transfer_status_impl
+ *
+ * @exception simdjson_error if the object does not meet the specification
+ */
+std::unique_ptr<Transfer_status_impl> create_transfer_status(const simdjson::dom::object& obj)
+{
+    std::optional<std::string_view> id {};
+    std::optional<Transfer_state> state {};
+    std::uint64_t bytes_transferred {0}, files_done {0}, files_total {0};
+    std::optional<double> throughput {};
+    std::optional<long> start_time {}, end_time {}, last_updated {};
+
+    // visit every field once rather than searching the object for each field
+    for (const auto [key, value] : obj) {
+        // if simdjson_error is thrown, the dom must not meet the specification, so propogate the exception
+        if (value.is_null()) {
+            continue;
+        } else if (key == Api::transfer_status_id) {
+            id = value.get_string().value();
+        } else if (key == Api::transfer_status_state) {
+            state = parse_transfer_state(value.get_string().value());
+        } else if (key == Api::transfer_status_bytes_transferred) {
+            bytes_transferred = value.get_uint64().value();
+        } else if (key == Api::transfer_status_files_done) {
+            files_done = value.get_uint64().value();
+        } else if (key == Api::transfer_status_files_total) {
+            files_total = value.get_uint64().value();
+        } else if (key == Api::transfer_status_throughput) {
+            throughput = value.get_double().value();
+        } else if (key == Api::transfer_status_start_time) {
+            start_time = value.get_int64().value();
+        } else if (key == Api::transfer_status_end_time) {
+            end_time = value.get_int64().value();
+        } else if (key == Api::transfer_status_last_updated) {
+            last_updated = value.get_int64().value();
+        }
+    }
+
+    if (!(id && state)) {
+        throw simdjson::simdjson_error {simdjson::NO_SUCH_FIELD};
+    }
+
+    return std::make_unique<Transfer_status_impl>(std::string {*id},
+                                                  *state,
+                                                  bytes_transferred,
+                                                  files_done,
+                                                  files_total,
+                                                  throughput,
+                                                  start_time,
+                                                  end_time,
+                                                  last_updated);
+}
+
+/**
+ * Adds the statuses in the response to a transfer job status REST API call to the specified map.
+ *
+ * @param response borrowed reference to the response to parse
+ * @param statuses mutably borrowed reference to the map the statuses are added to
+ *
+ * @exception Unexpected_response_error if the response is not a successful array of TransferJobStatus objects
+ */
+void parse_status_response(const Response& response, Transfer_status_map& statuses)
+{
+    if (response.status() != 200) {
+        throw Unexpected_response_error {Err::expect_200_msg, response.status()};
+    }
+
+    const auto parser {Json_parser_pool::shared().acquire()};
+    auto [array, err] {parse_body(*parser, response).get_array()};
+    if (err) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status()};
+    }
+
+    try {
+        for (const auto element : array) {
+            auto status {create_transfer_status(element.get_object().value())};
+            auto id {status->id()};
+            statuses.insert_or_assign(std::move(id), std::move(status));
+        }
+    } catch (const simdjson::simdjson_error& e) {
+        throw Unexpected_response_error {Err::invalid_json_body_msg, response.status()};
+    }
+}
+
+/**
+ * Checks if a job in the specified state has ended.
+ *
+ * @param state the state of the job
+ *
+ * @return true if the job completed, failed, or was cancelled
+ */
+bool ended(Transfer_state state)
+{
+    return state == Transfer_state::completed || state == Transfer_state::failed || state == Transfer_state::cancelled;
+}
+
+/**
+ * Combines the statuses of the sub-jobs of a sharded transfer into one status.
+ *
+ * @param statuses borrowed reference to the statuses of the sub-jobs
+ * @param unsubmitted borrowed reference to the sources of the shards that could not be started
+ *
+ * @return the combined status
+ *
+ * @see Transfer_service::status_sharded
+ */
+std::unique_ptr<Transfer_status> combine_statuses(const std::vector<std::unique_ptr<Transfer_status>>& statuses,
+                                                  const std::vector<Source>& unsubmitted)
+{
+    std::string id {};
+    std::uint64_t bytes_transferred {0};
+    std::uint64_t files_done {0};
+    std::uint64_t files_total {0};
+    double throughput {0};
+    std::optional<long> start_time {};
+    std::optional<long> end_time {};
+    std::optional<long> last_updated {};
+    auto started {false};
+    auto all_ended {true};
+    // a shard that was never started can never complete
+    auto any_failed {!unsubmitted.empty()};
+    auto any_cancelled {false};
+    auto all_end_times {true};
+
+    for (const auto& shard : unsubmitted) {
+        files_total += shard.resource_identifiers.size();
+    }
+
+    for (const auto& status : statuses) {
+        id += (id.empty() ? "" : ",") + status->id();
+        bytes_transferred += status->bytes_transferred();
+        files_done += status->files_done();
+        files_total += status->files_total();
+        throughput += status->throughput();
+
+        const auto earliest {[](std::optional<long> a, std::optional<long> b) { return a && (!b || *a < *b) ? a : b; }};
+        const auto latest {[](std::optional<long> a, std::optional<long> b) { return a && (!b || *a > *b) ? a : b; }};
+        start_time = earliest(status->start_time(), start_time);
+        end_time = latest(status->end_time(), end_time);
+        last_updated = latest(status->last_updated(), last_updated);
+        all_end_times = all_end_times && status->end_time();
+
+        started = started || status->state() != Transfer_state::queued;
+        all_ended = all_ended && ended(status->state());
+        any_failed = any_failed || status->state() == Transfer_state::failed;
+        any_cancelled = any_cancelled || status->state() == Transfer_state::cancelled;
+    }
 
-    return stream.str();
+    auto state {Transfer_state::completed};
+    if (!all_ended) {
+        state = started ? Transfer_state::running : Transfer_state::queued;
+        // the combined job has not ended while any sub-job has not
+        end_time = std::nullopt;
+    } else if (any_failed) {
+        state = Transfer_state::failed;
+    } else if (any_cancelled) {
+        state = Transfer_state::cancelled;
+    }
+    if (!all_end_times) {
+        end_time = std::nullopt;
+    }
+
+    // the sub-jobs run side by side, so the bytes of all of them over the time spanned measures the combined job best
+    const auto spanned {start_time && (end_time || last_updated)};
+    return std::make_unique<Transfer_status_impl>(std::move(id),
+                                                  state,
+                                                  bytes_transferred,
+                                                  files_done,
+                                                  files_total,
+                                                  spanned ? std::nullopt : std::optional<double> {throughput},
+                                                  start_time,
+                                                  end_time,
+                                                  last_updated);
 }
 
+/**
+ * Reports the outcome of an optimized transfer job to the optimizer that chose its options, at most once however many
+ * events and errors the tracking of the job reports. Jobs that fail, are cancelled, or whose status repeatedly cannot
+ * be checked are reported with a throughput of 0, so that the optimizer moves its search past the options they used.
+ */
+class Optimizer_report {
+public:
+    /**
+     * Creates a new Optimizer_report for a job using the specified options.
+     *
+     * @param optimizer shared pointer to the optimizer that chose the options
+     * @param source moved source of the transfer
+     * @param destination moved destination of the transfer
+     * @param profile the summary of the resources transferred
+     * @param options moved options the transfer uses
+     * @param monitor borrowed reference to the monitor tracking the job, which must outlive this object
+     */
+    Optimizer_report(std::shared_ptr<Transfer_optimizer> optimizer,
+                     Source source,
+                     Destination destination,
+                     Dataset_profile profile,
+                     Transfer_options options,
+                     Transfer_monitor& monitor)
+        : optimizer_ {std::move(optimizer)},
+          source_ {std::move(source)},
+          destination_ {std::move(destination)},
+          profile_ {profile},
+          options_ {std::move(options)},
+          monitor_ {monitor}
+    {}
+
+    /**
+     * Sets the id the job is tracked under, untracking it right away if the job has already been reported.
+     *
+     * @param id the id returned when the job started being tracked
+     */
+    void set_track_id(Track_id id)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        track_id_ = id;
+        if (recorded_) {
+            monitor_.untrack(id);
+        }
+    }
+
+    /**
+     * Reports the throughput of the job if the specified event ends it.
+     *
+     * @param type the kind of event
+     * @param status borrowed reference to the status of the job when the event occurred
+     */
+    void on_event(Transfer_event_type type, const Transfer_status& status)
+    {
+        switch (type) {
+        case Transfer_event_type::completed:
+            record(status.throughput());
+            break;
+        case Transfer_event_type::failed:
+        case Transfer_event_type::cancelled:
+            record(0);
+            break;
+        default:
+            failures_ = 0;
+            break;
+        }
+    }
+
+    /**
+     * Reports the job as failed once its status has failed to be checked too many times in a row.
+     */
+    void on_error()
+    {
+        if (++failures_ >= max_status_failures) {
+            record(0);
+        }
+    }
+
+private:
+    /**
+     * Reports the specified throughput to the optimizer unless the job has already been reported.
+     *
+     * @param throughput the throughput of the job in bytes per second
+     */
+    void record(double throughput)
+    {
+        if (recorded_.exchange(true)) {
+            return;
+        }
+        optimizer_->record(source_, destination_, profile_, options_, throughput);
+
+        // the job is no longer of interest once reported, even if its status keeps failing to be checked
+        const std::lock_guard<std::mutex> lock {mutex_};
+        if (track_id_) {
+            monitor_.untrack(*track_id_);
+        }
+    }
+
+    /** Optimizer that chose the options. */
+    const std::shared_ptr<Transfer_optimizer> optimizer_;
+
+    /** Source of the transfer. */
+    const Source source_;
+
+    /** Destination of the transfer. */
+    const Destination destination_;
+
+    /** Summary of the resources transferred. */
+    const Dataset_profile profile_;
+
+    /** Options the transfer uses. */
+    const Transfer_options options_;
+
+    /** Monitor tracking the job. */
+    Transfer_monitor& monitor_;
+
+    /** Guards the track id. */
+    std::mutex mutex_ {};
+
+    /** Id the job is tracked under, once tracking has started. */
+    std::optional<Track_id> track_id_ {};
+
+    /** If the job has been reported. */
+    std::atomic<bool> recorded_ {false};
+
+    /** Number of times in a row the status of the job has failed to be checked. */
+    std::atomic<int> failures_ {0};
+};
+
 } // namespace
 
+Transfer_status_impl::Transfer_status_impl(std::string id,
+                                           Transfer_state state,
+                                           std::uint64_t bytes_transferred,
+                                           std::uint64_t files_done,
+                                           std::uint64_t files_total,
+                                           std::optional<double> throughput,
+                                           std::optional<long> start_time,
+                                           std::optional<long> end_time,
+                                           std::optional<long> last_updated)
+    : id_ {std::move(id)},
+      state_ {state},
+      bytes_transferred_ {bytes_transferred},
+      files_done_ {files_done},
+      files_total_ {files_total},
+      throughput_ {throughput ? *throughput
+                              : average_throughput(bytes_transferred, start_time, end_time ? end_time : last_updated)},
+      start_time_ {start_time},
+      end_time_ {end_time},
+      last_updated_ {last_updated}
+{}
+
+const std::string& Transfer_status_impl::id() const
+{
+    return id_;
+}
+
+Transfer_state Transfer_status_impl::state() const
+{
+    return state_;
+}
+
+std::uint64_t Transfer_status_impl::bytes_transferred() const
+{
+    return bytes_transferred_;
+}
+
+std::uint64_t Transfer_status_impl::files_done() const
+{
+    return files_done_;
+}
+
+std::uint64_t Transfer_status_impl::files_total() const
+{
+    return files_total_;
+}
+
+double Transfer_status_impl::throughput() const
+{
+    return throughput_;
+}
+
+std::optional<long> Transfer_status_impl::start_time() const
+{
+    return start_time_;
+}
+
+std::optional<long> Transfer_status_impl::end_time() const
+{
+    return end_time_;
+}
+
+std::optional<long> Transfer_status_impl::last_updated() const
+{
+    return last_updated_;
+}
+
 Transfer_service_impl::Transfer_service_impl(const std::string& ods_auth_token,
                                              const std::string& ods_url,
-                                             std::unique_ptr<Rest> rest_caller)
+                                             std::shared_ptr<Rest> rest_caller)
     : ods_url_(ods_url),
       rest_caller_(std::move(rest_caller)),
-      headers_(Util::create_headers(ods_auth_token))
+      headers_(Util::create_headers(ods_auth_token)),
+      monitor_created_(),
+      monitor_()
 {}
 
 std::string Transfer_service_impl::transfer(const Source& source,
@@ -134,22 +653,170 @@ std::string Transfer_service_impl::transfer(const Source& source,
                                             const Transfer_options& options) const
 {
     // if post throws an exception, propogate it up
-    const auto response {rest_caller_->post(ods_url_ + Api::transfer_job_path,
-                                            headers_,
-                                            create_transfer_job_request(source, destination, options))};
+    return parse_transfer_response(rest_caller_->post(ods_url_ + Api::transfer_job_path,
+                                                      headers_,
+                                                      create_transfer_job_request(source, destination, options)));
+}
 
-    if (response.status != 200) {
-        // expected status 200
-        throw Unexpected_response_error {Err::expect_200_msg, response.status};
+std::future<std::string> Transfer_service_impl::transfer_async(const Source& source,
+                                                               const Destination& destination,
+                                                               const Transfer_options& options) const
+{
+    auto promise {std::make_shared<std::promise<std::string>>()};
+    auto future {promise->get_future()};
+    rest_caller_->post_async(ods_url_ + Api::transfer_job_path,
+                             headers_,
+                             create_transfer_job_request(source, destination, options),
+                             fulfill(std::move(promise), parse_transfer_response));
+
+    return future;
+}
+
+std::string Transfer_service_impl::transfer_optimized(const Source& source,
+                                                      const Destination& destination,
+                                                      const Endpoint& source_endpoint,
+                                                      std::shared_ptr<Transfer_optimizer> optimizer) const
+{
+    const auto profile {profile_dataset(
+        source.type, source_endpoint.list(source.directory_identifier), source.resource_identifiers)};
+    const auto options {optimizer->recommend(source, destination, profile)};
+    auto job_id {transfer(source, destination, options)};
+
+    const auto report {
+        std::make_shared<Optimizer_report>(std::move(optimizer), source, destination, profile, options, monitor())};
+    report->set_track_id(monitor().track(
+        job_id,
+        [report](Transfer_event_type type, const Transfer_status& status) { report->on_event(type, status); },
+        [report](const std::string&, std::exception_ptr) { report->on_error(); }));
+    return job_id;
+}
+
+Sharded_job Transfer_service_impl::transfer_sharded(const Source& source,
+                                                    const Destination& destination,
+                                                    const Transfer_options& options,
+                                                    const Endpoint& source_endpoint,
+                                                    std::size_t shard_count) const
+{
+    const auto& identifiers {source.resource_identifiers};
+    std::vector<Source> shards {};
+    if (identifiers.empty()) {
+        shards.push_back(source);
+    } else {
+        const auto sizes {
+            resource_sizes(source.type, source_endpoint.list(source.directory_identifier), identifiers)};
+        for (const auto& shard : partition_by_size(sizes, shard_count)) {
+            Source sub_source {source.type, source.cred_id, source.directory_identifier, {}};
+            sub_source.resource_identifiers.reserve(shard.size());
+            for (const auto index : shard) {
+                sub_source.resource_identifiers.push_back(identifiers[index]);
+            }
+            shards.push_back(std::move(sub_source));
+        }
+    }
+
+    // start every sub-job before waiting on any of them, so the requests are in flight together
+    std::vector<std::future<std::string>> submissions {};
+    submissions.reserve(shards.size());
+    for (const auto& shard : shards) {
+        submissions.push_back(transfer_async(shard, destination, options));
+    }
+
+    Sharded_job job {};
+    std::exception_ptr error {};
+    for (std::size_t i {0}; i < shards.size(); ++i) {
+        try {
+            job.job_ids.push_back(submissions[i].get());
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+            job.unsubmitted.push_back(std::move(shards[i]));
+        }
+    }
+    if (job.job_ids.empty()) {
+        std::rethrow_exception(error);
     }
 
-    return response.body;
+    return job;
+}
+
+std::unique_ptr<Transfer_status> Transfer_service_impl::status_sharded(const Sharded_job& job) const
+{
+    if (job.job_ids.empty()) {
+        throw std::invalid_argument(Err::empty_sharded_job_msg);
+    }
+    return combine_statuses(status_many(job.job_ids), job.unsubmitted);
 }
 
 std::unique_ptr<Transfer_status> Transfer_service_impl::status(const std::string& id) const
 {
-    // TODO: impl
-    return nullptr;
+    return std::move(status_many({id}).front());
+}
+
+std::vector<std::unique_ptr<Transfer_status>> Transfer_service_impl::status_many(
+    const std::vector<std::string>& ids) const
+{
+    auto statuses {poll_statuses(ids)};
+
+    std::vector<std::unique_ptr<Transfer_status>> result {};
+    result.reserve(ids.size());
+    for (const auto& id : ids) {
+        const auto status {statuses.find(id)};
+        if (status == statuses.end()) {
+            throw Unexpected_response_error {Err::expect_job_status_msg, 200};
+        }
+        // every status in the map was created by parse_status_response
+        result.push_back(
+            std::make_unique<Transfer_status_impl>(static_cast<const Transfer_status_impl&>(*status->second)));
+    }
+
+    return result;
+}
+
+Transfer_monitor& Transfer_service_impl::monitor() const
+{
+    std::call_once(monitor_created_, [this] {
+        monitor_ = std::make_unique<Transfer_monitor_impl>(
+            [this](const std::vector<std::string>& ids) { return poll_statuses(ids); });
+    });
+    return *monitor_;
+}
+
+Transfer_status_map Transfer_service_impl::poll_statuses(const std::vector<std::string>& ids) const
+{
+    const auto url {ods_url_ + Api::transfer_job_status_path + "?" + Api::get_status_ids_param + "="};
+
+    // start every batch before waiting on any of them, so the batches are in flight together
+    std::vector<std::future<Response>> batches {};
+    std::unordered_set<std::string_view> requested {};
+    std::string batch {};
+    std::size_t batch_ids {0};
+    for (const auto& id : ids) {
+        if (!requested.insert(id).second) {
+            continue;
+        }
+        // escaped so that an id containing a comma or reserved characters cannot alter the query
+        const auto escaped_id {Util::escape_url(id)};
+        if (batch_ids == status_batch_size ||
+            (batch_ids > 0 && batch.size() + 1 + escaped_id.size() > status_batch_length)) {
+            batches.push_back(rest_caller_->get_async(url + batch, headers_));
+            batch.clear();
+            batch_ids = 0;
+        }
+        batch += (batch_ids > 0 ? "," : "") + escaped_id;
+        ++batch_ids;
+    }
+    if (batch_ids > 0) {
+        batches.push_back(rest_caller_->get_async(url + batch, headers_));
+    }
+
+    // if get_async raised an exception, propagate it up
+    Transfer_status_map statuses {};
+    for (auto& response : batches) {
+        parse_status_response(response.get(), statuses);
+    }
+
+    return statuses;
 }
 
 } // namespace Internal
@@ -9,15 +9,24 @@
 #ifndef ONEDATASHARE_TRANSFER_SERVICE_IMPL_H
 #define ONEDATASHARE_TRANSFER_SERVICE_IMPL_H
 
+#include <cstddef>
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <onedatashare/endpoint.h>
 #include <onedatashare/endpoint_type.h>
+#include <onedatashare/transfer_monitor.h>
+#include <onedatashare/transfer_optimizer.h>
 #include <onedatashare/transfer_service.h>
 
 #include "rest.h"
+#include "transfer_monitor_impl.h"
 
 namespace Onedatashare {
 namespace Internal {
@@ -26,6 +35,75 @@ namespace Internal {
  * Indicates the status of a transfer.
  */
 class Transfer_status_impl : public Transfer_status {
+public:
+    /**
+     * Creates a new Transfer_status_impl with the specified fields.
+     *
+     * @param id moved id of the job
+     * @param state the state of the job
+     * @param bytes_transferred the number of bytes transferred
+     * @param files_done the number of files transferred
+     * @param files_total the total number of files to transfer
+     * @param throughput the throughput in bytes per second, or no value to compute it from the other fields
+     * @param start_time the time the job started, or no value if it has not started
+     * @param end_time the time the job ended, or no value if it has not ended
+     * @param last_updated the time the status was last updated, or no value if it is not reported
+     */
+    Transfer_status_impl(std::string id,
+                         Transfer_state state,
+                         std::uint64_t bytes_transferred,
+                         std::uint64_t files_done,
+                         std::uint64_t files_total,
+                         std::optional<double> throughput,
+                         std::optional<long> start_time,
+                         std::optional<long> end_time,
+                         std::optional<long> last_updated);
+
+    const std::string& id() const override;
+
+    Transfer_state state() const override;
+
+    std::uint64_t bytes_transferred() const override;
+
+    std::uint64_t files_done() const override;
+
+    std::uint64_t files_total() const override;
+
+    double throughput() const override;
+
+    std::optional<long> start_time() const override;
+
+    std::optional<long> end_time() const override;
+
+    std::optional<long> last_updated() const override;
+
+private:
+    /** Id of the job. */
+    const std::string id_;
+
+    /** State of the job. */
+    const Transfer_state state_;
+
+    /** Number of bytes transferred. */
+    const std::uint64_t bytes_transferred_;
+
+    /** Number of files transferred. */
+    const std::uint64_t files_done_;
+
+    /** Total number of files to transfer. */
+    const std::uint64_t files_total_;
+
+    /** Throughput in bytes per second. */
+    const double throughput_;
+
+    /** Time the job started. */
+    const std::optional<long> start_time_;
+
+    /** Time the job ended. */
+    const std::optional<long> end_time_;
+
+    /** Time the status was last updated. */
+    const std::optional<long> last_updated_;
 };
 
 /**
@@ -38,11 +116,11 @@ public:
      *
      * @param ods_auth_token borrowed reference to the OneDataShare authentication token to use
      * @param ods_url borrowed reference to the url that OneDataShare is running on
-     * @param rest_caller moved pointer to the object to use for making REST API calls
+     * @param rest_caller shared pointer to the object to use for making REST API calls
      */
     Transfer_service_impl(const std::string& ods_auth_token,
                           const std::string& ods_url,
-                          std::unique_ptr<Rest> rest_caller);
+                          std::shared_ptr<Rest> rest_caller);
 
     /**
      * Makes a REST API call to transfer the specified resources to the specified location.
@@ -60,18 +138,133 @@ public:
                          const Destination& destination,
                          const Transfer_options& options) const override;
 
-    // TODO: implement
+    /**
+     * Starts a REST API call to transfer the specified resources to the specified location.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param options borrowed reference to the the options to use for this transfer request
+     *
+     * @return future holding the id of the new transfer job, or the Connection_error or Unexpected_response_error
+     * raised
+     */
+    std::future<std::string> transfer_async(const Source& source,
+                                            const Destination& destination,
+                                            const Transfer_options& options) const override;
+
+    /**
+     * Lists the source directory, makes a REST API call to transfer the specified resources with the options
+     * recommended for them, and tracks the job to report its throughput to the optimizer.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param source_endpoint borrowed reference to the endpoint the source directory is listed with
+     * @param optimizer shared pointer to the optimizer choosing the options
+     *
+     * @return the id of the new transfer job
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    std::string transfer_optimized(const Source& source,
+                                   const Destination& destination,
+                                   const Endpoint& source_endpoint,
+                                   std::shared_ptr<Transfer_optimizer> optimizer) const override;
+
+    /**
+     * Lists the source directory and starts REST API calls, each transferring one shard of the specified resources,
+     * all at once.
+     *
+     * @param source borrowed reference to the source of the transfer
+     * @param destination borrowed reference to the destination of the transfer
+     * @param options borrowed reference to the options to use for every sub-job
+     * @param source_endpoint borrowed reference to the endpoint the source directory is listed with
+     * @param shard_count the greatest number of sub-jobs to start
+     *
+     * @return handle to the started sub-jobs, along with the sources of any that could not be started
+     *
+     * @exception invalid_argument if an option is set to a value that is not positive
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    Sharded_job transfer_sharded(const Source& source,
+                                 const Destination& destination,
+                                 const Transfer_options& options,
+                                 const Endpoint& source_endpoint,
+                                 std::size_t shard_count) const override;
+
+    /**
+     * Makes REST API calls checking the status of every sub-job of the specified sharded transfer.
+     *
+     * @param job borrowed reference to the handle of the sharded transfer
+     *
+     * @return unique pointer to the combined status of the sub-jobs
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    std::unique_ptr<Transfer_status> status_sharded(const Sharded_job& job) const override;
+
+    /**
+     * Makes a REST API call to check the status of the specified transfer job.
+     *
+     * @param id borrowed reference to the id of the transfer job to check
+     *
+     * @return unique pointer to the status of the transfer job
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
     std::unique_ptr<Transfer_status> status(const std::string& id) const override;
 
+    /**
+     * Makes REST API calls, each checking a batch of the specified transfer jobs, all started at once.
+     *
+     * @param ids borrowed reference to the ids of the transfer jobs to check
+     *
+     * @return unique pointers to the statuses of the transfer jobs, in the same order as the ids
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    std::vector<std::unique_ptr<Transfer_status>> status_many(const std::vector<std::string>& ids) const override;
+
+    /**
+     * Gets the monitor tracking jobs with poll_statuses, creating it on first use.
+     *
+     * @return borrowed reference to the monitor
+     */
+    Transfer_monitor& monitor() const override;
+
+    /**
+     * Makes REST API calls, each checking a batch of the specified transfer jobs, all started at once. Unlike
+     * status_many, jobs missing from the responses are left out rather than raising an exception.
+     *
+     * @param ids borrowed reference to the ids of the transfer jobs to check
+     *
+     * @return the statuses received, by job id
+     *
+     * @exception Connection_error if unable to connect to OneDataShare
+     * @exception Unexpected_response_error if an unexpected response is received from OneDataShare
+     */
+    Transfer_status_map poll_statuses(const std::vector<std::string>& ids) const;
+
 private:
     /** Url to the OneDataShare server to make REST API calls to. */
     const std::string ods_url_;
 
     /** Pointer to the object used to make REST API calls. */
-    const std::unique_ptr<Rest> rest_caller_;
+    const std::shared_ptr<Rest> rest_caller_;
 
     /** Headers used in REST API calls. */
     const std::unordered_multimap<std::string, std::string> headers_;
+
+    /** Guards the creation of the monitor. */
+    mutable std::once_flag monitor_created_;
+
+    /** Monitor tracking jobs, created on first use and declared last so that its thread stops before the members
+     * it polls with are destroyed. */
+    mutable std::unique_ptr<Transfer_monitor_impl> monitor_;
 };
 
 } // namespace Internal
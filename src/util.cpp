@@ -6,10 +6,15 @@
  */
 
 #include <fstream>
-#include <iomanip>
-#include <sstream>
+#include <memory>
+#include <new>
 #include <utility>
 
+#include <curl/curl.h>
+
+#include <onedatashare/ods_error.h>
+
+#include "error_message.h"
 #include "util.h"
 
 namespace Onedatashare {
@@ -67,43 +72,41 @@ std::string as_string(Endpoint_type type)
     }
 }
 
-std::string escape_json(const std::string& json)
+std::string escape_url(const std::string& value)
+{
+    // the handle is only used for character set conversion, which is not needed for query parameters
+    const std::unique_ptr<char, decltype(&curl_free)> escaped {
+        curl_easy_escape(nullptr, value.data(), static_cast<int>(value.size())),
+        curl_free};
+    if (!escaped) {
+        throw std::bad_alloc {};
+    }
+    return std::string {escaped.get()};
+}
+
+std::string join_path(const std::string& parent, const std::string& name)
+{
+    if (!parent.empty() && parent.back() == '/') {
+        return parent + name;
+    }
+    return parent + "/" + name;
+}
+
+bool uses_ids(Endpoint_type type)
 {
-    // see also:
-    // https://stackoverflow.com/questions/7724448/simple-json-string-escape-for-c/33799784#33799784
-    std::ostringstream stream {};
-    for (auto c : json) {
-        switch (c) {
-        case '"':
-            stream << "\\\"";
-            break;
-        case '\\':
-            stream << "\\\\";
-            break;
-        case '\b':
-            stream << "\\b";
-            break;
-        case '\f':
-            stream << "\\f";
-            break;
-        case '\n':
-            stream << "\\n";
-            break;
-        case '\r':
-            stream << "\\r";
-            break;
-        case '\t':
-            stream << "\\t";
-            break;
-        default:
-            if ('\x00' <= c && c <= '\x1f') {
-                stream << "\\u" << std::setfill('0') << (int) c;
-            } else {
-                stream << c;
-            }
+    return type == Endpoint_type::box || type == Endpoint_type::google_drive;
+}
+
+std::string child_identifier(Endpoint_type type, const std::string& parent, const Resource& resource, int status)
+{
+    if (uses_ids(type)) {
+        if (!resource.id) {
+            throw Unexpected_response_error {Err::expect_id_msg, status};
         }
+        return *resource.id;
     }
-    return stream.str();
+
+    return join_path(parent, resource.name);
 }
 
 bool load_url_from_config(std::string& url)
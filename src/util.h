@@ -12,6 +12,7 @@
 #include <string>
 #include <unordered_map>
 
+#include <onedatashare/endpoint.h>
 #include <onedatashare/endpoint_type.h>
 
 namespace Onedatashare {
@@ -40,13 +41,49 @@ std::unordered_multimap<std::string, std::string> create_headers(const std::stri
 std::string as_string(Endpoint_type type);
 
 /**
- * Escapes characters in the given json string.
+ * Percent-encodes every character of the given value other than letters, digits, '-', '.', '_', and '~', so that it
+ * can be used as a query parameter value.
  *
- * @param json borrowed reference to the json string to escape
+ * @param value borrowed reference to the value to escape
  *
- * @return a copy of the json string with its characters escaped
+ * @return the escaped value
+ *
+ * @exception std::bad_alloc if the escaped value could not be allocated
+ */
+std::string escape_url(const std::string& value);
+
+/**
+ * Creates the path of the resource with the specified name contained by the directory at the specified path.
+ *
+ * @param parent borrowed reference to the path of the directory
+ * @param name borrowed reference to the name of the contained resource
+ *
+ * @return the path of the contained resource
+ */
+std::string join_path(const std::string& parent, const std::string& name);
+
+/**
+ * Checks if the specified type of endpoint uses ids rather than paths to identify resources.
+ *
+ * @param type the type of endpoint
+ *
+ * @return true if the endpoint uses ids, false otherwise
+ */
+bool uses_ids(Endpoint_type type);
+
+/**
+ * Creates the path or id locating the specified resource contained by the specified directory.
+ *
+ * @param type the type of endpoint the resource is on
+ * @param parent borrowed reference to the path or id of the directory containing the resource
+ * @param resource borrowed reference to the contained resource
+ * @param status the status code of the response the resource was received in
+ *
+ * @return the id of the resource if the endpoint uses ids, the path of the resource otherwise
+ *
+ * @exception Unexpected_response_error if the endpoint uses ids and the resource has no id
  */
-std::string escape_json(const std::string& json);
+std::string child_identifier(Endpoint_type type, const std::string& parent, const Resource& resource, int status);
 
 /**
  * Sets the url in the config file to the specified string.
@@ -0,0 +1,327 @@
+/*
+ * body_sink_tests.cpp
+ */
+
+#include <cstdio>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <body_sink.h>
+#include <curl_multi_rest.h>
+#include <curl_rest.h>
+#include <onedatashare/ods_error.h>
+
+#include "mocks.h"
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+/**
+ * Sink recording every chunk written to it.
+ */
+class Recording_sink : public Ods::Internal::Body_sink {
+public:
+    void expect(std::size_t size) override
+    {
+        expected = size;
+    }
+
+    void write(const char* data, std::size_t size) override
+    {
+        body.append(data, size);
+        writer = std::this_thread::get_id();
+    }
+
+    std::size_t expected {0};
+    std::string body {};
+    std::thread::id writer {};
+};
+
+/**
+ * Sink failing every write.
+ */
+class Failing_sink : public Ods::Internal::Body_sink {
+public:
+    void write(const char*, std::size_t) override
+    {
+        throw Ods::Connection_error {"sink failed"};
+    }
+};
+
+class Body_sink_tests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        char name[] {"/tmp/ods_body_sink_XXXXXX"};
+        const auto fd {mkstemp(name)};
+        ASSERT_NE(fd, -1);
+        close(fd);
+        path_ = name;
+
+        // larger than the chunks libcurl hands to write callbacks
+        body_.reserve(body_size);
+        for (std::size_t i {0}; i < body_size; ++i) {
+            body_.push_back(static_cast<char>('a' + i % 26));
+        }
+        std::ofstream {path_, std::ios::binary} << body_;
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    std::string url() const
+    {
+        return "file://" + path_;
+    }
+
+    static constexpr std::size_t body_size {256 * 1024};
+    std::string path_ {};
+    std::string body_ {};
+};
+
+/**
+ * Tests that chunks written to a String_sink are appended to the string.
+ */
+TEST_F(Body_sink_tests, StringSinkAppendsChunks)
+{
+    std::string body {"a"};
+    Ods::Internal::String_sink sink {body};
+
+    sink.expect(4);
+    sink.write("bc", 2);
+    sink.write("de", 2);
+
+    EXPECT_EQ(body, "abcde");
+    EXPECT_GE(body.capacity(), 5);
+}
+
+/**
+ * Tests that an Fd_sink writes every chunk to its file descriptor.
+ */
+TEST_F(Body_sink_tests, FdSinkWritesChunks)
+{
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    {
+        Ods::Internal::Fd_sink sink {fds[1]};
+        sink.write("abc", 3);
+        sink.write("def", 3);
+    }
+    close(fds[1]);
+
+    char buffer[16] {};
+    EXPECT_EQ(read(fds[0], buffer, sizeof(buffer)), 6);
+    EXPECT_EQ(std::string {buffer}, "abcdef");
+    close(fds[0]);
+}
+
+/**
+ * Tests that an Fd_sink throws when its file descriptor cannot be written to.
+ */
+TEST_F(Body_sink_tests, FdSinkThrowsConnectionErr)
+{
+    Ods::Internal::Fd_sink sink {-1};
+
+    EXPECT_THROW(sink.write("abc", 3), Ods::Connection_error);
+}
+
+/**
+ * Tests that a body received in many chunks is collected entirely instead of only the last chunk being kept.
+ */
+TEST_F(Body_sink_tests, CurlRestGetKeepsEveryChunk)
+{
+    const Ods::Internal::Curl_rest rest {};
+
+    const auto response {rest.get(url(), {})};
+
+    EXPECT_EQ(response.body().size(), body_.size());
+    EXPECT_EQ(response.body(), body_);
+    EXPECT_EQ(response.header("content-length"), std::to_string(body_size));
+    EXPECT_GE(response.body_capacity() - response.body().size(), Ods::Internal::Response::body_padding);
+}
+
+/**
+ * Tests that a streamed body is written entirely to the sink instead of the Response.
+ */
+TEST_F(Body_sink_tests, CurlRestGetStreamsToSink)
+{
+    const Ods::Internal::Curl_rest rest {};
+    Recording_sink sink {};
+
+    const auto response {rest.get(url(), {}, sink)};
+
+    EXPECT_TRUE(response.body().empty());
+    EXPECT_EQ(sink.body, body_);
+}
+
+/**
+ * Tests that an exception thrown by the sink aborts the request and is rethrown.
+ */
+TEST_F(Body_sink_tests, CurlRestGetRethrowsSinkErr)
+{
+    const Ods::Internal::Curl_rest rest {};
+    Failing_sink sink {};
+
+    EXPECT_THROW(rest.get(url(), {}, sink), Ods::Connection_error);
+}
+
+/**
+ * Tests that a body streamed on the event loop thread is written entirely to the sink.
+ */
+TEST_F(Body_sink_tests, CurlMultiRestGetStreamsToSink)
+{
+    const Ods::Internal::Curl_multi_rest rest {};
+    Recording_sink sink {};
+
+    const auto response {rest.get(url(), {}, sink)};
+
+    EXPECT_TRUE(response.body().empty());
+    EXPECT_EQ(sink.body, body_);
+}
+
+/**
+ * Tests that a blocking request made from a callback on the event loop thread throws instead of deadlocking.
+ */
+TEST_F(Body_sink_tests, CurlMultiRestBlockingGetInCallbackThrowsLogicError)
+{
+    const Ods::Internal::Curl_multi_rest rest {};
+    std::promise<bool> threw {};
+
+    rest.get_async(url(), {}, [&](std::future<Ods::Internal::Response>) {
+        try {
+            rest.get(url(), {});
+            threw.set_value(false);
+        } catch (const std::logic_error&) {
+            threw.set_value(true);
+        }
+    });
+
+    EXPECT_TRUE(threw.get_future().get());
+}
+
+/**
+ * Tests that a body handed off by the event loop thread is written entirely to the sink on the draining thread.
+ */
+TEST_F(Body_sink_tests, HandoffSinkDrainsOnCallingThread)
+{
+    const Ods::Internal::Curl_multi_rest rest {};
+    Ods::Internal::Handoff_sink handoff {};
+    std::promise<bool> completed {};
+    rest.get_async(url(), {}, handoff, [&](std::future<Ods::Internal::Response> response) {
+        try {
+            response.get();
+            completed.set_value(true);
+        } catch (...) {
+            completed.set_value(false);
+        }
+        handoff.close();
+    });
+    Recording_sink sink {};
+
+    handoff.drain_into(sink);
+
+    EXPECT_TRUE(completed.get_future().get());
+    EXPECT_EQ(sink.body, body_);
+    EXPECT_EQ(sink.expected, body_size);
+    EXPECT_EQ(sink.writer, std::this_thread::get_id());
+}
+
+/**
+ * Tests that a Handoff_sink pauses a producer that fills its queue and resumes it once the queue is drained.
+ */
+TEST_F(Body_sink_tests, HandoffSinkPausesUntilDrained)
+{
+    Ods::Internal::Handoff_sink handoff {4};
+    std::mutex mutex {};
+    std::condition_variable resumed_cv {};
+    auto resumed {false};
+    auto pauses {0};
+    handoff.set_resume([&] {
+        const std::lock_guard<std::mutex> lock {mutex};
+        resumed = true;
+        resumed_cv.notify_one();
+    });
+
+    std::thread producer {[&] {
+        for (const auto chunk : {"abc", "def", "ghi", "jkl"}) {
+            while (!handoff.ready()) {
+                ++pauses;
+                std::unique_lock<std::mutex> lock {mutex};
+                resumed_cv.wait(lock, [&] { return resumed; });
+                resumed = false;
+            }
+            handoff.write(chunk, 3);
+        }
+        handoff.set_resume(nullptr);
+        handoff.close();
+    }};
+    Recording_sink sink {};
+
+    handoff.drain_into(sink);
+    producer.join();
+
+    EXPECT_EQ(sink.body, "abcdefghijkl");
+    EXPECT_LE(pauses, 3);
+}
+
+/**
+ * Tests that an exception thrown by the draining sink fails the following writes, which aborts the request, and is
+ * rethrown once the sink is closed.
+ */
+TEST_F(Body_sink_tests, HandoffSinkRethrowsDrainErr)
+{
+    Ods::Internal::Handoff_sink handoff {};
+    auto aborted {false};
+    std::thread producer {[&] {
+        while (!aborted) {
+            try {
+                handoff.write("abc", 3);
+                std::this_thread::yield();
+            } catch (const Ods::Connection_error&) {
+                aborted = true;
+            }
+        }
+        handoff.close();
+    }};
+    Failing_sink sink {};
+
+    EXPECT_THROW(handoff.drain_into(sink), Ods::Connection_error);
+    producer.join();
+    EXPECT_TRUE(aborted);
+}
+
+/**
+ * Tests that the default streaming get writes the body returned by get to the sink.
+ */
+TEST_F(Body_sink_tests, DefaultGetWritesBodyToSink)
+{
+    Onedatashare_mocks::Rest_mock rest {};
+    EXPECT_CALL(rest, get("url", Header_map {}))
+        .WillOnce(::testing::Return(Ods::Internal::Response {Header_map {}, "body", 200}));
+    Recording_sink sink {};
+
+    const auto response {static_cast<const Ods::Internal::Rest&>(rest).get("url", {}, sink)};
+
+    EXPECT_EQ(response.status(), 200);
+    EXPECT_TRUE(response.body().empty());
+    EXPECT_EQ(sink.expected, 4);
+    EXPECT_EQ(sink.body, "body");
+}
+
+} // namespace
@@ -0,0 +1,113 @@
+/*
+ * checksum_tests.cpp
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <checksum.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+/**
+ * Creates contents that differ at every offset.
+ */
+std::string contents(std::size_t size)
+{
+    std::string contents(size, '\0');
+    for (std::size_t i {0}; i < size; ++i) {
+        contents[i] = static_cast<char>(i * 131 + i / 5);
+    }
+    return contents;
+}
+
+/**
+ * Computes the xxHash64 of the specified string in one piece.
+ */
+std::uint64_t xxh64(const std::string& str)
+{
+    Ods::Internal::Xxh64 hash {};
+    hash.update(str.data(), str.size());
+    return hash.digest();
+}
+
+class Checksum_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that crc32c_update matches the published CRC32C check values.
+ */
+TEST_F(Checksum_tests, Crc32cMatchesKnownValues)
+{
+    const std::string check {"123456789"};
+    const std::string zeros(32, '\0');
+    const std::string ones(32, '\xff');
+
+    EXPECT_EQ(Ods::Internal::crc32c_update(0, "", 0), 0);
+    EXPECT_EQ(Ods::Internal::crc32c_update(0, check.data(), check.size()), 0xe3069283);
+    EXPECT_EQ(Ods::Internal::crc32c_update(0, zeros.data(), zeros.size()), 0x8a9136aa);
+    EXPECT_EQ(Ods::Internal::crc32c_update(0, ones.data(), ones.size()), 0x62a8ab43);
+}
+
+/**
+ * Tests that checksumming in pieces, or combining the checksums of the pieces, matches checksumming all at once.
+ */
+TEST_F(Checksum_tests, Crc32cUpdateAndCombineMatchWhole)
+{
+    const auto data {contents(1000)};
+    const auto whole {Ods::Internal::crc32c_update(0, data.data(), data.size())};
+
+    for (std::size_t split {0}; split <= data.size(); split += 37) {
+        const auto first {Ods::Internal::crc32c_update(0, data.data(), split)};
+        const auto second {Ods::Internal::crc32c_update(0, data.data() + split, data.size() - split)};
+
+        EXPECT_EQ(Ods::Internal::crc32c_update(first, data.data() + split, data.size() - split), whole);
+        EXPECT_EQ(Ods::Internal::crc32c_combine(first, second, data.size() - split), whole);
+    }
+}
+
+/**
+ * Tests that Xxh64 matches the reference implementation.
+ */
+TEST_F(Checksum_tests, Xxh64MatchesKnownValues)
+{
+    EXPECT_EQ(xxh64(""), 0xef46db3751d8e999);
+    EXPECT_EQ(xxh64("a"), 0xd24ec4f1a98c6e5b);
+    EXPECT_EQ(xxh64("abc"), 0x44bc2cf5ad770999);
+    EXPECT_EQ(xxh64("Nobody inspects the spammish repetition"), 0xfbcea83c8a378bf1);
+}
+
+/**
+ * Tests that hashing in pieces of every size matches hashing all at once, covering partially filled stripes.
+ */
+TEST_F(Checksum_tests, Xxh64UpdateInPiecesMatchesWhole)
+{
+    const auto data {contents(300)};
+    const auto whole {xxh64(data)};
+
+    for (std::size_t piece {1}; piece <= 70; ++piece) {
+        Ods::Internal::Xxh64 hash {};
+        for (std::size_t offset {0}; offset < data.size(); offset += piece) {
+            hash.update(data.data() + offset, std::min(piece, data.size() - offset));
+        }
+        ASSERT_EQ(hash.digest(), whole) << "piece " << piece;
+    }
+}
+
+/**
+ * Tests that to_hex pads with zeros and uses lower case digits.
+ */
+TEST_F(Checksum_tests, ToHex)
+{
+    EXPECT_EQ(Ods::Internal::to_hex(0, 8), "00000000");
+    EXPECT_EQ(Ods::Internal::to_hex(0xe3069283, 8), "e3069283");
+    EXPECT_EQ(Ods::Internal::to_hex(0x44bc2cf5ad770999, 16), "44bc2cf5ad770999");
+    EXPECT_EQ(Ods::Internal::to_hex(0xabc, 8), "00000abc");
+}
+
+} // namespace
@@ -0,0 +1,198 @@
+/*
+ * chunked_upload_tests.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/ods_error.h>
+
+#include <chunked_upload.h>
+#include <rest.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+/**
+ * Rest caller standing in for the upload api, completing each POST on its own thread after a short delay and writing
+ * each part into a file image at the offset named by its Content-Range header.
+ */
+class Part_rest : public Ods::Internal::Rest {
+public:
+    ~Part_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    Ods::Internal::Response get(const std::string&, const Header_map&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map& headers, const std::string& data) const override
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        const auto type {headers.find("Content-Type")};
+        const auto range {headers.find("Content-Range")};
+        if (headers.count("Content-Type") != 1 || type->second != "application/octet-stream" ||
+            range == headers.end()) {
+            return Ods::Internal::Response {Header_map {}, "", 400};
+        }
+        ranges_.push_back(range->second);
+        if (static_cast<int>(ranges_.size()) == fail_part_) {
+            return Ods::Internal::Response {Header_map {}, "", 500};
+        }
+
+        // parse "bytes first-last/total", or "bytes */total" for an empty file
+        const auto& value {range->second};
+        const auto slash {value.find('/')};
+        image_.resize(std::stoull(value.substr(slash + 1)));
+        if (value[6] != '*') {
+            const auto first {std::stoull(value.substr(6, value.find('-') - 6))};
+            image_.replace(first, data.size(), data);
+        }
+        return Ods::Internal::Response {Header_map {}, "", 200};
+    }
+
+    void post_async(const std::string& url,
+                    const Header_map& headers,
+                    std::string data,
+                    Ods::Internal::Response_callback callback) const override
+    {
+        const auto current {++in_flight_};
+        auto max {max_in_flight_.load()};
+        while (current > max && !max_in_flight_.compare_exchange_weak(max, current)) {
+        }
+
+        const std::lock_guard<std::mutex> lock {threads_mutex_};
+        threads_.emplace_back([this, url, headers, data {std::move(data)}, callback {std::move(callback)}] {
+            std::this_thread::sleep_for(std::chrono::milliseconds {2});
+            std::promise<Ods::Internal::Response> promise {};
+            promise.set_value(post(url, headers, data));
+            --in_flight_;
+            callback(promise.get_future());
+        });
+    }
+
+    mutable std::atomic<int> max_in_flight_ {0};
+    mutable std::string image_ {};
+    mutable std::vector<std::string> ranges_ {};
+    int fail_part_ {0};
+
+private:
+    mutable std::atomic<int> in_flight_ {0};
+    mutable std::mutex mutex_ {};
+    mutable std::mutex threads_mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
+class Chunked_upload_tests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + "chunked_upload_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    void write_file(const std::string& contents)
+    {
+        std::ofstream {path_, std::ios::binary} << contents;
+    }
+
+    std::string path_ {};
+};
+
+/**
+ * Tests that every part of a binary file is sent, with no more parts in flight than allowed and progress reported
+ * up to the size of the file.
+ */
+TEST_F(Chunked_upload_tests, SendsEveryPart)
+{
+    std::string contents(10 * 1000 + 7, '\0');
+    for (std::size_t i {0}; i < contents.size(); ++i) {
+        contents[i] = static_cast<char>(i % 251);
+    }
+    write_file(contents);
+
+    const Part_rest rest {};
+    std::vector<std::uint64_t> progress {};
+    Ods::Upload_options options {1000, 3, [&progress](std::uint64_t sent, std::uint64_t total) {
+                                     EXPECT_EQ(total, 10 * 1000 + 7);
+                                     progress.push_back(sent);
+                                 }};
+
+    Ods::Internal::chunked_upload(rest, "url", Header_map {{"Content-Type", "application/json"}}, path_, options);
+
+    EXPECT_EQ(rest.image_, contents);
+    EXPECT_EQ(rest.ranges_.size(), 11);
+    EXPECT_LE(rest.max_in_flight_, 3);
+    EXPECT_GT(rest.max_in_flight_, 1);
+    ASSERT_EQ(progress.size(), 11);
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    EXPECT_EQ(progress.back(), contents.size());
+}
+
+/**
+ * Tests that an empty file is sent as a single empty part.
+ */
+TEST_F(Chunked_upload_tests, SendsEmptyFile)
+{
+    write_file("");
+    const Part_rest rest {};
+
+    Ods::Internal::chunked_upload(rest, "url", Header_map {}, path_, Ods::Upload_options {});
+
+    EXPECT_EQ(rest.ranges_, std::vector<std::string> {"bytes */0"});
+}
+
+/**
+ * Tests that a rejected part stops new parts from being sent and raises an Unexpected_response_error.
+ */
+TEST_F(Chunked_upload_tests, RejectedPartThrowsUnexpectedResponse)
+{
+    write_file(std::string(20 * 100, 'a'));
+    Part_rest rest {};
+    rest.fail_part_ = 2;
+
+    EXPECT_THROW(Ods::Internal::chunked_upload(rest, "url", Header_map {}, path_, Ods::Upload_options {100, 2}),
+                 Ods::Unexpected_response_error);
+    EXPECT_LT(rest.ranges_.size(), 20);
+}
+
+/**
+ * Tests that a missing local file raises a Connection_error without sending anything.
+ */
+TEST_F(Chunked_upload_tests, MissingFileThrowsConnectionErr)
+{
+    const Part_rest rest {};
+
+    EXPECT_THROW(Ods::Internal::chunked_upload(rest, "url", Header_map {}, path_, Ods::Upload_options {}),
+                 Ods::Connection_error);
+    EXPECT_TRUE(rest.ranges_.empty());
+}
+
+} // namespace
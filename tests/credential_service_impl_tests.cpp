@@ -430,4 +430,46 @@ TEST_F(Credential_service_impl_test, CredentialIdListReturnsEmptyList)
     }
 }
 
-} // namespace
\ No newline at end of file
+/**
+ * Tests that credential_id_list_async holds the correct credential identifiers.
+ */
+TEST_F(Credential_service_impl_test, CredentialIdListAsyncReturnsListOfCredentialIds)
+{
+    const std::string json {"{\"credentialList\":[\"first\",\"second\"]}"};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .Times(types.size())
+        .WillRepeatedly(
+            Return(Ods::Internal::Response {std::unordered_multimap<std::string, std::string> {}, json, 200}));
+
+    const Ods::Internal::Credential_service_impl cred {"", "", std::move(caller)};
+
+    for (auto type : types) {
+        const auto list {cred.credential_id_list_async(type).get()};
+        ASSERT_EQ(list.size(), 2);
+        EXPECT_EQ(list[0], "first");
+        EXPECT_EQ(list[1], "second");
+    }
+}
+
+/**
+ * Tests that oauth_url_async holds an Unexpected_response_error when the response has no Location header.
+ */
+TEST_F(Credential_service_impl_test, OauthUrlAsyncHoldsUnexpectedResponse)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .Times(oauth_types.size())
+        .WillRepeatedly(
+            Return(Ods::Internal::Response {std::unordered_multimap<std::string, std::string> {}, "", 303}));
+
+    const Ods::Internal::Credential_service_impl cred {"", "", std::move(caller)};
+
+    for (auto type : oauth_types) {
+        auto future {cred.oauth_url_async(type)};
+        EXPECT_THROW(future.get(), Ods::Unexpected_response_error);
+    }
+}
+
+} // namespace
@@ -0,0 +1,118 @@
+/*
+ * curl_pool_tests.cpp
+ */
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <curl_pool.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+class Curl_pool_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that a returned handle is handed out again by the next acquire instead of creating a new handle.
+ */
+TEST_F(Curl_pool_tests, AcquireReusesReturnedHandle)
+{
+    Ods::Internal::Curl_pool pool {};
+
+    CURL* first {nullptr};
+    {
+        const auto lease {pool.acquire()};
+        first = lease.get();
+        ASSERT_NE(first, nullptr);
+    }
+    EXPECT_EQ(pool.idle_count(), 1);
+
+    const auto lease {pool.acquire()};
+    EXPECT_EQ(lease.get(), first);
+    EXPECT_EQ(pool.idle_count(), 0);
+}
+
+/**
+ * Tests that handles checked out at the same time are distinct.
+ */
+TEST_F(Curl_pool_tests, ConcurrentLeasesAreDistinct)
+{
+    Ods::Internal::Curl_pool pool {};
+
+    const auto a {pool.acquire()};
+    const auto b {pool.acquire()};
+
+    EXPECT_NE(a.get(), b.get());
+}
+
+/**
+ * Tests that no more than the maximum number of idle handles are kept.
+ */
+TEST_F(Curl_pool_tests, IdleHandlesAreCapped)
+{
+    Ods::Internal::Curl_pool pool {{4, 2, std::chrono::seconds {60}}};
+
+    {
+        const auto a {pool.acquire()};
+        const auto b {pool.acquire()};
+        const auto c {pool.acquire()};
+    }
+
+    EXPECT_EQ(pool.idle_count(), 2);
+}
+
+/**
+ * Tests that handles idle for longer than the idle time are evicted.
+ */
+TEST_F(Curl_pool_tests, ExpiredIdleHandlesAreEvicted)
+{
+    Ods::Internal::Curl_pool pool {{4, 4, std::chrono::seconds {0}}};
+
+    {
+        const auto lease {pool.acquire()};
+    }
+
+    EXPECT_EQ(pool.idle_count(), 0);
+}
+
+/**
+ * Tests that acquire blocks while the maximum number of handles are checked out and resumes once one is returned.
+ */
+TEST_F(Curl_pool_tests, AcquireBlocksAtMaxHandles)
+{
+    Ods::Internal::Curl_pool pool {{1, 1, std::chrono::seconds {60}}};
+
+    auto held {std::make_unique<Ods::Internal::Curl_pool::Lease>(pool.acquire())};
+    auto waiter {std::async(std::launch::async, [&pool] { return pool.acquire().get(); })};
+
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds {50}), std::future_status::timeout);
+
+    const auto handle {held->get()};
+    held.reset();
+
+    EXPECT_EQ(waiter.get(), handle);
+}
+
+/**
+ * Tests that moving a lease transfers ownership so the handle is only returned once.
+ */
+TEST_F(Curl_pool_tests, MovedLeaseReturnsHandleOnce)
+{
+    Ods::Internal::Curl_pool pool {};
+
+    {
+        auto a {pool.acquire()};
+        auto b {std::move(a)};
+        EXPECT_EQ(pool.idle_count(), 0);
+    }
+
+    EXPECT_EQ(pool.idle_count(), 1);
+}
+
+} // namespace
@@ -0,0 +1,210 @@
+/*
+ * directory_watcher_impl_tests.cpp
+ */
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/directory_watcher.h>
+#include <onedatashare/endpoint.h>
+#include <onedatashare/ods_error.h>
+
+#include <directory_watcher_impl.h>
+#include <endpoint_impl.h>
+
+#include "mocks.h"
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Onedatashare_mocks::Listing_rest;
+using Onedatashare_mocks::Recorder;
+using Onedatashare_mocks::file_stat;
+using Onedatashare_mocks::resource;
+
+class Directory_watcher_impl_tests : public ::testing::Test {
+};
+
+/**
+ * Fake that completes each listing on its own thread after a delay, like a Rest with an event loop.
+ */
+class Delayed_listing_rest : public Listing_rest {
+    using Header_map = std::unordered_multimap<std::string, std::string>;
+
+public:
+    using Listing_rest::get_async;
+
+    ~Delayed_listing_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void get_async(const std::string& url,
+                   const Header_map& headers,
+                   Ods::Internal::Response_callback callback) const override
+    {
+        const std::lock_guard<std::mutex> lock {threads_mutex_};
+        threads_.emplace_back([this, url, headers, callback {std::move(callback)}] {
+            std::this_thread::sleep_for(std::chrono::milliseconds {20});
+            std::promise<Ods::Internal::Response> response {};
+            response.set_value(get(url, headers));
+            callback(response.get_future());
+        });
+    }
+
+private:
+    mutable std::mutex threads_mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
+/**
+ * Tests that the first listing reports nothing and later listings report added, removed, and modified resources.
+ */
+TEST_F(Directory_watcher_impl_tests, DifferReportsChangesAfterBaseline)
+{
+    Ods::Internal::Listing_differ differ {};
+    std::vector<Ods::Watch_event> events {};
+
+    EXPECT_FALSE(differ.update("/dir", resource("dir", 0, 0, std::nullopt, {{resource("a"), resource("b")}}), events));
+    EXPECT_TRUE(events.empty());
+
+    EXPECT_FALSE(differ.update("/dir", resource("dir", 0, 0, std::nullopt, {{resource("b"), resource("a")}}), events));
+    EXPECT_TRUE(events.empty());
+
+    const auto changed {resource("dir", 0, 0, std::nullopt, {{resource("b", 1), resource("c")}})};
+    EXPECT_TRUE(differ.update("/dir", changed, events));
+    ASSERT_EQ(events.size(), 3);
+
+    std::unordered_map<std::string, Ods::Watch_event_type> types {};
+    for (const auto& event : events) {
+        EXPECT_EQ(event.directory, "/dir");
+        types.emplace(event.resource.name, event.type);
+    }
+    EXPECT_EQ(types.at("a"), Ods::Watch_event_type::removed);
+    EXPECT_EQ(types.at("b"), Ods::Watch_event_type::modified);
+    EXPECT_EQ(types.at("c"), Ods::Watch_event_type::added);
+}
+
+/**
+ * Tests that resources with ids are matched by id, so that a renamed resource is reported as modified.
+ */
+TEST_F(Directory_watcher_impl_tests, DifferMatchesResourcesById)
+{
+    Ods::Internal::Listing_differ differ {};
+    std::vector<Ods::Watch_event> events {};
+
+    differ.update("dir", resource("dir", 0, 0, "dir", {{resource("old", 0, 0, "1")}}), events);
+    EXPECT_TRUE(differ.update("dir", resource("dir", 0, 0, "dir", {{resource("new", 0, 0, "1")}}), events));
+
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].type, Ods::Watch_event_type::modified);
+    EXPECT_EQ(events[0].resource.name, "new");
+}
+
+/**
+ * Tests that a watch reports changes to a directory and stops listing the directory once unwatched.
+ */
+TEST_F(Directory_watcher_impl_tests, WatchReportsChangesUntilUnwatched)
+{
+    const auto rest {std::make_shared<Listing_rest>()};
+    rest->set("/dir", {file_stat("a", 1)});
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred", "token", "url", rest};
+
+    Recorder<Ods::Watch_event> recorder {};
+    Ods::Internal::Directory_watcher_impl watcher {{std::chrono::milliseconds {1}, std::chrono::milliseconds {5}}};
+    const auto id {
+        watcher.watch(endpoint, "/dir", [&](const Ods::Watch_event& event) { recorder.event(event); }, nullptr)};
+
+    // wait for the baseline listing before changing the directory
+    while (rest->gets_ < 2) {
+        std::this_thread::yield();
+    }
+    rest->set("/dir", {file_stat("a", 1), file_stat("b", 2)});
+    ASSERT_TRUE(recorder.wait_for_events(1));
+
+    const auto events {recorder.events()};
+    EXPECT_EQ(events[0].type, Ods::Watch_event_type::added);
+    EXPECT_EQ(events[0].directory, "/dir");
+    EXPECT_EQ(events[0].resource.name, "b");
+    EXPECT_EQ(events[0].resource.size, 2);
+
+    watcher.unwatch(id);
+    std::this_thread::sleep_for(std::chrono::milliseconds {20});
+    const auto gets {rest->gets_.load()};
+    std::this_thread::sleep_for(std::chrono::milliseconds {50});
+    EXPECT_EQ(rest->gets_, gets);
+}
+
+/**
+ * Tests that failed listings are passed to the error callback and that the directory keeps being watched.
+ */
+TEST_F(Directory_watcher_impl_tests, WatchReportsErrorsAndKeepsWatching)
+{
+    const auto rest {std::make_shared<Listing_rest>()};
+    rest->set("/dir", {file_stat("a", 1)});
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred", "token", "url", rest};
+
+    Recorder<Ods::Watch_event> recorder {};
+    Ods::Internal::Directory_watcher_impl watcher {{std::chrono::milliseconds {1}, std::chrono::milliseconds {5}}};
+    watcher.watch(
+        endpoint,
+        "/dir",
+        [&](const Ods::Watch_event& event) { recorder.event(event); },
+        recorder.on_error());
+
+    // wait for the baseline listing before failing
+    while (rest->gets_ < 2) {
+        std::this_thread::yield();
+    }
+    rest->set("/dir", {}, true);
+    ASSERT_TRUE(recorder.wait_for_errors(1));
+
+    rest->set("/dir", {});
+    ASSERT_TRUE(recorder.wait_for_events(1));
+    EXPECT_EQ(recorder.events()[0].type, Ods::Watch_event_type::removed);
+    EXPECT_EQ(recorder.events()[0].resource.name, "a");
+}
+
+/**
+ * Tests that listings completing on another thread wake the watcher and that destroying the watcher waits for the
+ * listings still in flight.
+ */
+TEST_F(Directory_watcher_impl_tests, WatchHandlesListingsCompletingOnAnotherThread)
+{
+    const auto rest {std::make_shared<Delayed_listing_rest>()};
+    rest->set("/dir", {file_stat("a", 1)});
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred", "token", "url", rest};
+
+    Recorder<Ods::Watch_event> recorder {};
+    {
+        Ods::Internal::Directory_watcher_impl watcher {{std::chrono::milliseconds {1}, std::chrono::milliseconds {5}}};
+        watcher.watch(endpoint, "/dir", [&](const Ods::Watch_event& event) { recorder.event(event); }, nullptr);
+
+        // wait for the baseline listing before changing the directory
+        while (rest->gets_ < 2) {
+            std::this_thread::yield();
+        }
+        rest->set("/dir", {});
+        ASSERT_TRUE(recorder.wait_for_events(1));
+        EXPECT_EQ(recorder.events()[0].type, Ods::Watch_event_type::removed);
+    }
+
+    // no listing may complete into the destroyed watcher
+    const auto gets {rest->gets_.load()};
+    std::this_thread::sleep_for(std::chrono::milliseconds {50});
+    EXPECT_EQ(rest->gets_, gets);
+}
+
+} // namespace
@@ -4,22 +4,33 @@
  * 7/20/20
  */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <simdjson/simdjson.h>
 
 #include <onedatashare/endpoint.h>
 #include <onedatashare/endpoint_type.h>
+#include <onedatashare/listing_cache.h>
 #include <onedatashare/ods_error.h>
 
 #include <endpoint_impl.h>
+#include <listing_cache_impl.h>
 #include <ods_rest_api.h>
 
 #include "mocks.h"
@@ -47,6 +58,94 @@ constexpr std::array types {Ods::Endpoint_type::box,
 
 const std::unordered_set id_types {Ods::Endpoint_type::box, Ods::Endpoint_type::google_drive};
 
+/**
+ * Creates a Stat object for a directory with the specified name containing the specified resources.
+ */
+std::string directory_stat(const std::string& name, const std::vector<std::string>& contained = {})
+{
+    std::string stat {R"({"id":")" + name + R"(","name":")" + name +
+                      R"(","size":0,"time":0,"dir":true,"file":false,"files":[)"};
+    for (const auto& resource : contained) {
+        if (stat.back() != '[') {
+            stat += ",";
+        }
+        stat += resource;
+    }
+    return stat + "]}";
+}
+
+/**
+ * Creates a contained Stat object for a directory, or for a file if is_directory is false.
+ */
+std::string child_stat(const std::string& name, bool is_directory = true, const std::string& extra = "")
+{
+    return R"({"id":")" + name + R"(","name":")" + name + R"(","size":0,"time":0,"dir":)" +
+           (is_directory ? "true" : "false") + R"(,"file":)" + (is_directory ? "false" : "true") + extra + "}";
+}
+
+/**
+ * Gets the value of the path parameter of a list url.
+ */
+std::string path_param(const std::string& url)
+{
+    const auto start {url.find(std::string {Ods::Internal::Api::get_ls_path_param} + "=") +
+                      std::string {Ods::Internal::Api::get_ls_path_param}.size() + 1};
+    return Onedatashare_mocks::unescape(url.substr(start, url.find('&', start) - start));
+}
+
+/**
+ * Rest caller completing each GET request on its own thread after a short delay, recording the greatest number of
+ * requests in flight at once.
+ */
+class Threaded_rest : public Ods::Internal::Rest {
+public:
+    explicit Threaded_rest(std::map<std::string, std::string> stats) : stats_ {std::move(stats)} {}
+
+    ~Threaded_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    Ods::Internal::Response get(const std::string& url, const Header_map&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, stats_.at(path_param(url)), 200};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    void get_async(const std::string& url,
+                   const Header_map& headers,
+                   Ods::Internal::Response_callback callback) const override
+    {
+        const auto current {++in_flight_};
+        auto max {max_in_flight_.load()};
+        while (current > max && !max_in_flight_.compare_exchange_weak(max, current)) {
+        }
+
+        const std::lock_guard<std::mutex> lock {mutex_};
+        threads_.emplace_back([this, url, headers, callback {std::move(callback)}] {
+            std::this_thread::sleep_for(std::chrono::milliseconds {2});
+            std::promise<Ods::Internal::Response> promise {};
+            promise.set_value(get(url, headers));
+            --in_flight_;
+            callback(promise.get_future());
+        });
+    }
+
+    mutable std::atomic<int> max_in_flight_ {0};
+
+private:
+    const std::map<std::string, std::string> stats_;
+    mutable std::atomic<int> in_flight_ {0};
+    mutable std::mutex mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
 class Endpoint_impl_tests : public ::testing::Test {
 };
 
@@ -100,6 +199,26 @@ TEST_F(Endpoint_impl_tests, ListWithBadResponseBodyThrowsUnexpectedResponse)
     }
 }
 
+/**
+ * Tests that list escapes the credential id and identifier in the query string so that paths containing reserved
+ * characters are sent intact.
+ */
+TEST_F(Endpoint_impl_tests, ListEscapesQueryParameters)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get(_, _)).WillOnce([](const std::string& url, const Header_map&) {
+        EXPECT_NE(url.find("credId=cred%26id"), std::string::npos);
+        EXPECT_NE(url.find("path=%2Fa%20dir%3F%26x%3Dy"), std::string::npos);
+        EXPECT_NE(url.find("identifier=%2Fa%20dir%3F%26x%3Dy"), std::string::npos);
+        return Ods::Internal::Response {
+            Header_map {}, R"({"name":"a dir?&x=y","size":0,"time":0,"dir":true,"file":false,"files":[]})", 200};
+    });
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred&id", "", "", std::move(caller)};
+
+    EXPECT_EQ(endpoint.list("/a dir?&x=y").name, "a dir?&x=y");
+}
+
 /**
  * Tests that the Resource returned from list has no id when the stat object recieved doesn't have an id.
  */
@@ -816,4 +935,600 @@ TEST_F(Endpoint_impl_tests, DownloadSendsData)
     }
 }
 
-} // namespace
\ No newline at end of file
+/**
+ * Tests that download_file requests the first range of the file from the download path and writes the whole file
+ * when the server does not honor ranges.
+ */
+TEST_F(Endpoint_impl_tests, DownloadFileWritesLocalFile)
+{
+    const auto local_path {::testing::TempDir() + "endpoint_download_file"};
+
+    for (auto type : types) {
+        auto execute_get {[](const std::string& url, const Header_map& headers) {
+            const auto range {headers.find("Range")};
+            if (url.find("/download?") == std::string::npos ||
+                url.find("fileToDownload=file") == std::string::npos || range == headers.end() ||
+                range->second.rfind("bytes=0-", 0) != 0) {
+                return Ods::Internal::Response {Header_map {}, "", 500};
+            }
+            return Ods::Internal::Response {Header_map {}, "contents", 200};
+        }};
+
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get(_, _)).WillOnce(execute_get);
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "cred", "", "", std::move(caller)};
+
+        ASSERT_NO_THROW(endpoint.download_file("/dir", "file", local_path, Ods::Download_options {}));
+        std::ifstream local {local_path};
+        std::string contents {};
+        std::getline(local, contents);
+        EXPECT_EQ(contents, "contents");
+    }
+    std::remove(local_path.c_str());
+}
+
+/**
+ * Tests that download_file escapes the credential id, identifier, and file name in the query string so that names
+ * containing reserved characters are sent intact.
+ */
+TEST_F(Endpoint_impl_tests, DownloadFileEscapesQueryParameters)
+{
+    const auto local_path {::testing::TempDir() + "endpoint_download_file_escaped"};
+
+    auto execute_get {[](const std::string& url, const Header_map&) {
+        if (url.find("credId=cred%26id") == std::string::npos || url.find("path=%2Fa%20dir%3F") == std::string::npos ||
+            url.find("fileToDownload=a%20b%26c%23d%3Fe%25f") == std::string::npos) {
+            return Ods::Internal::Response {Header_map {}, "", 500};
+        }
+        return Ods::Internal::Response {Header_map {}, "contents", 200};
+    }};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get(_, _)).WillOnce(execute_get);
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred&id", "", "", std::move(caller)};
+
+    EXPECT_NO_THROW(endpoint.download_file("/a dir?", "a b&c#d?e%f", local_path, Ods::Download_options {}));
+    std::remove(local_path.c_str());
+}
+
+/**
+ * Tests that upload sends the local file to the upload path, naming it after the last component of the local path.
+ */
+TEST_F(Endpoint_impl_tests, UploadSendsFile)
+{
+    const auto local_path {::testing::TempDir() + "endpoint_upload"};
+    std::ofstream {local_path} << "contents";
+
+    auto execute_post {[](const std::string& url, const Header_map&, const std::string& data) {
+        if (url.find("/upload?") == std::string::npos || url.find("fileName=endpoint_upload") == std::string::npos ||
+            data != "contents") {
+            return Ods::Internal::Response {Header_map {}, "", 500};
+        }
+        return Ods::Internal::Response {Header_map {}, "", 200};
+    }};
+
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, post(_, _, _)).WillOnce(execute_post);
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "cred", "", "", std::move(caller)};
+
+        ASSERT_NO_THROW(endpoint.upload("/dir", local_path, Ods::Upload_options {}));
+    }
+    std::remove(local_path.c_str());
+}
+
+/**
+ * Tests that upload escapes the credential id, identifier, and file name in the query string so that names containing
+ * reserved characters are sent intact.
+ */
+TEST_F(Endpoint_impl_tests, UploadEscapesQueryParameters)
+{
+    const auto local_path {::testing::TempDir() + "a b&c#d?e%f"};
+    std::ofstream {local_path} << "contents";
+
+    auto execute_post {[](const std::string& url, const Header_map&, const std::string&) {
+        if (url.find("credId=cred%26id") == std::string::npos || url.find("path=%2Fa%20dir%3F") == std::string::npos ||
+            url.find("fileName=a%20b%26c%23d%3Fe%25f") == std::string::npos) {
+            return Ods::Internal::Response {Header_map {}, "", 500};
+        }
+        return Ods::Internal::Response {Header_map {}, "", 200};
+    }};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post(_, _, _)).WillOnce(execute_post);
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "cred&id", "", "", std::move(caller)};
+
+    EXPECT_NO_THROW(endpoint.upload("/a dir?", local_path, Ods::Upload_options {}));
+    std::remove(local_path.c_str());
+}
+
+/**
+ * Tests that list_async holds a Connection_error when the request fails to connect.
+ */
+TEST_F(Endpoint_impl_tests, ListAsyncHoldsConnectionErr)
+{
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).WillOnce(Throw(Ods::Connection_error {""}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        auto future {endpoint.list_async("")};
+        EXPECT_THROW(future.get(), Ods::Connection_error);
+    }
+}
+
+/**
+ * Tests that list_async holds the same Resource that list returns.
+ */
+TEST_F(Endpoint_impl_tests, ListAsyncReturnsResource)
+{
+    std::string stat {R"({
+        "id": "parent id",
+        "name": "parent",
+        "size": 0,
+        "time": 0,
+        "dir": true,
+        "file": false,
+        "files": [
+            {"id": "child id", "name": "child", "size": 7, "time": 3, "dir": false, "file": true}
+        ]
+    })"};
+
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).WillOnce(Return(Ods::Internal::Response {Header_map {}, stat, 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        const auto resource {endpoint.list_async("").get()};
+        EXPECT_EQ(resource.name, "parent");
+        ASSERT_TRUE(resource.contained_resources);
+        ASSERT_EQ(resource.contained_resources->size(), 1);
+        EXPECT_EQ(resource.contained_resources->at(0).name, "child");
+        EXPECT_EQ(resource.contained_resources->at(0).size, 7);
+    }
+}
+
+/**
+ * Tests that remove_async holds an Unexpected_response_error when the response has a 500 status code.
+ */
+TEST_F(Endpoint_impl_tests, RemoveAsyncHoldsUnexpectedResponse)
+{
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, post).WillOnce(Return(Ods::Internal::Response {Header_map {}, "", 500}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        auto future {endpoint.remove_async("", "")};
+        EXPECT_THROW(future.get(), Ods::Unexpected_response_error);
+    }
+}
+
+/**
+ * Tests that mkdir_async completes when the response has a 200 status code.
+ */
+TEST_F(Endpoint_impl_tests, MkdirAsyncCompletes)
+{
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, post).WillOnce(Return(Ods::Internal::Response {Header_map {}, "", 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        auto future {endpoint.mkdir_async("", "")};
+        EXPECT_NO_THROW(future.get());
+    }
+}
+
+/**
+ * Tests that list_stream passes each contained resource to the callback and returns the listed resource.
+ */
+TEST_F(Endpoint_impl_tests, ListStreamPassesContainedResources)
+{
+    std::string stat {R"({
+        "files": [
+            {"id": "a id", "name": "a", "size": 7, "time": 3, "dir": false, "file": true},
+            {"id": "b id", "name": "b", "size": 0, "time": 4, "dir": true, "file": false}
+        ],
+        "id": "parent id",
+        "name": "parent",
+        "size": 0,
+        "time": 0,
+        "dir": true,
+        "file": false
+    })"};
+
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).WillOnce(Return(Ods::Internal::Response {Header_map {}, stat, 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        std::vector<Ods::Resource> contained {};
+        const auto resource {endpoint.list_stream("", [&](Ods::Resource r) { contained.push_back(std::move(r)); })};
+
+        EXPECT_EQ(resource.name, "parent");
+        ASSERT_TRUE(resource.contained_resources);
+        EXPECT_TRUE(resource.contained_resources->empty());
+        ASSERT_EQ(contained.size(), 2);
+        EXPECT_EQ(contained[0].name, "a");
+        EXPECT_EQ(contained[0].size, 7);
+        EXPECT_EQ(contained[1].name, "b");
+        EXPECT_TRUE(contained[1].is_directory);
+    }
+}
+
+/**
+ * Tests that list_stream throws an Unexpected_response_error without invoking the callback when the response has a
+ * 500 status code.
+ */
+TEST_F(Endpoint_impl_tests, ListStreamWithBadStatusCodeThrowsUnexpectedResponse)
+{
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get)
+            .WillOnce(Return(Ods::Internal::Response {Header_map {}, R"({"files":[{"name":"a"}]})", 500}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        auto calls {0};
+        EXPECT_THROW(endpoint.list_stream("", [&](Ods::Resource) { ++calls; }), Ods::Unexpected_response_error);
+        EXPECT_EQ(calls, 0);
+    }
+}
+
+/**
+ * Tests that list_stream throws an Unexpected_response_error when the response body is not a complete Stat object.
+ */
+TEST_F(Endpoint_impl_tests, ListStreamWithTruncatedBodyThrowsUnexpectedResponse)
+{
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get)
+            .WillOnce(Return(Ods::Internal::Response {Header_map {}, R"({"name":"parent","files":[)", 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        EXPECT_THROW(endpoint.list_stream("", [](Ods::Resource) {}), Ods::Unexpected_response_error);
+    }
+}
+
+/**
+ * Tests that list_table adds each contained resource to the table.
+ */
+TEST_F(Endpoint_impl_tests, ListTableAddsContainedResources)
+{
+    std::string stat {R"({
+        "name": "parent",
+        "id": "parent id",
+        "size": 0,
+        "time": 0,
+        "dir": true,
+        "file": false,
+        "files": [
+            {"id": "a id", "name": "a", "size": 7, "time": 3, "dir": false, "file": true, "permissions": "rw"},
+            {"name": "b", "size": 0, "time": 4, "dir": true, "file": false, "link": "c"}
+        ]
+    })"};
+
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).WillOnce(Return(Ods::Internal::Response {Header_map {}, stat, 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        Ods::Resource_table contained {};
+        const auto resource {endpoint.list_table("", contained)};
+
+        EXPECT_EQ(resource.name, "parent");
+        ASSERT_EQ(contained.size(), 2);
+        EXPECT_EQ(contained[0].id(), "a id");
+        EXPECT_EQ(contained[0].name(), "a");
+        EXPECT_EQ(contained[0].size(), 7);
+        EXPECT_EQ(contained[0].permissions(), "rw");
+        EXPECT_FALSE(contained[1].id());
+        EXPECT_EQ(contained[1].link(), "c");
+        EXPECT_TRUE(contained[1].is_directory());
+    }
+}
+
+/**
+ * Tests that list_table throws an Unexpected_response_error when a contained Stat object is missing a field.
+ */
+TEST_F(Endpoint_impl_tests, ListTableWithMissingFieldThrowsUnexpectedResponse)
+{
+    const std::string stat {R"({"name":"p","size":0,"time":0,"dir":true,"file":false,"files":[{"name":"a"}]})"};
+
+    for (auto type : types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).WillOnce(Return(Ods::Internal::Response {Header_map {}, stat, 200}));
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        Ods::Resource_table contained {};
+        EXPECT_THROW(endpoint.list_table("", contained), Ods::Unexpected_response_error);
+    }
+}
+
+/**
+ * Tests that list_recursive lists every directory beneath the root by path, skipping files and symbolic links.
+ */
+TEST_F(Endpoint_impl_tests, ListRecursiveVisitsEveryDirectory)
+{
+    const auto link {child_stat("l", true, R"(,"link":"/")")};
+    const std::map<std::string, std::string> stats {
+        {"/root", directory_stat("root", {child_stat("a"), child_stat("b"), child_stat("f", false), link})},
+        {"/root/a", directory_stat("a", {child_stat("c")})},
+        {"/root/b", directory_stat("b")},
+        {"/root/a/c", directory_stat("c")}};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).Times(4).WillRepeatedly([&stats](const std::string& url, const Header_map&) {
+        return Ods::Internal::Response {Header_map {}, stats.at(path_param(url)), 200};
+    });
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller)};
+
+    std::map<std::string, int> depths {};
+    endpoint.list_recursive("/root", {}, [&depths](const std::string& identifier, int depth, const Ods::Resource& r) {
+        EXPECT_TRUE(r.contained_resources);
+        depths[identifier] = depth;
+    });
+
+    EXPECT_EQ(depths, (std::map<std::string, int> {{"/root", 0}, {"/root/a", 1}, {"/root/b", 1}, {"/root/a/c", 2}}));
+}
+
+/**
+ * Tests that list_recursive does not list directories deeper than the maximum depth.
+ */
+TEST_F(Endpoint_impl_tests, ListRecursiveStopsAtMaxDepth)
+{
+    const std::map<std::string, std::string> stats {{"/", directory_stat("root", {child_stat("a")})},
+                                                    {"/a", directory_stat("a", {child_stat("c")})}};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).Times(2).WillRepeatedly([&stats](const std::string& url, const Header_map&) {
+        return Ods::Internal::Response {Header_map {}, stats.at(path_param(url)), 200};
+    });
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::ftp, "", "", "", std::move(caller)};
+
+    std::vector<std::string> listed {};
+    Ods::List_recursive_options options {};
+    options.max_depth = 1;
+    endpoint.list_recursive("/", options, [&listed](const std::string& identifier, int, const Ods::Resource&) {
+        listed.push_back(identifier);
+    });
+
+    EXPECT_EQ(listed, (std::vector<std::string> {"/", "/a"}));
+}
+
+/**
+ * Tests that list_recursive locates contained directories by id on endpoints that use ids.
+ */
+TEST_F(Endpoint_impl_tests, ListRecursiveUsesIdsForIdEndpoints)
+{
+    const std::map<std::string, std::string> stats {{"root", directory_stat("root", {child_stat("a")})},
+                                                    {"a", directory_stat("a")}};
+
+    for (auto type : id_types) {
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, get).Times(2).WillRepeatedly([&stats](const std::string& url, const Header_map&) {
+            return Ods::Internal::Response {Header_map {}, stats.at(path_param(url)), 200};
+        });
+
+        const Ods::Internal::Endpoint_impl endpoint {type, "", "", "", std::move(caller)};
+
+        std::vector<std::string> listed {};
+        endpoint.list_recursive("root", {}, [&listed](const std::string& identifier, int, const Ods::Resource&) {
+            listed.push_back(identifier);
+        });
+
+        EXPECT_EQ(listed, (std::vector<std::string> {"root", "a"}));
+    }
+}
+
+/**
+ * Tests that list_recursive throws an Unexpected_response_error when a listing beneath the root fails.
+ */
+TEST_F(Endpoint_impl_tests, ListRecursiveWithBadStatusCodeThrowsUnexpectedResponse)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).WillRepeatedly([](const std::string& url, const Header_map&) {
+        if (path_param(url) == "/") {
+            return Ods::Internal::Response {Header_map {}, directory_stat("root", {child_stat("a")}), 200};
+        }
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    });
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller)};
+
+    EXPECT_THROW(endpoint.list_recursive("/", {}, [](const std::string&, int, const Ods::Resource&) {}),
+                 Ods::Unexpected_response_error);
+}
+
+/**
+ * Tests that list_recursive lists directories concurrently without exceeding the maximum concurrency.
+ */
+TEST_F(Endpoint_impl_tests, ListRecursiveCapsConcurrency)
+{
+    std::map<std::string, std::string> stats {};
+    std::vector<std::string> children {};
+    for (auto i {0}; i < 20; ++i) {
+        children.push_back(child_stat(std::to_string(i)));
+        stats["/" + std::to_string(i)] = directory_stat(std::to_string(i));
+    }
+    stats["/"] = directory_stat("root", children);
+    const auto caller {std::make_shared<Threaded_rest>(stats)};
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", caller};
+
+    auto listed {0};
+    Ods::List_recursive_options options {};
+    options.max_concurrency = 4;
+    endpoint.list_recursive("/", options, [&listed](const std::string&, int, const Ods::Resource&) { ++listed; });
+
+    EXPECT_EQ(listed, 21);
+    EXPECT_GT(caller->max_in_flight_, 1);
+    EXPECT_LE(caller->max_in_flight_, 4);
+}
+
+/**
+ * Tests that list answers from the cache while the cached listing is fresh.
+ */
+TEST_F(Endpoint_impl_tests, ListWithCacheReusesFreshListing)
+{
+    const auto cache {std::make_shared<Ods::Internal::Listing_cache_impl>(Ods::Listing_cache_options {})};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).WillOnce(Return(Ods::Internal::Response {Header_map {}, directory_stat("d"), 200}));
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller), cache};
+
+    EXPECT_EQ(endpoint.list("/d").name, "d");
+    EXPECT_EQ(endpoint.list("/d").name, "d");
+    EXPECT_EQ(endpoint.list_async("/d").get().name, "d");
+    EXPECT_EQ(cache->stats().hits, 2);
+    EXPECT_EQ(cache->stats().misses, 1);
+}
+
+/**
+ * Tests that an expired listing is revalidated with its ETag and reused when OneDataShare reports it is unchanged.
+ */
+TEST_F(Endpoint_impl_tests, ListWithCacheRevalidatesExpiredListing)
+{
+    const auto cache {std::make_shared<Ods::Internal::Listing_cache_impl>(
+        Ods::Listing_cache_options {std::chrono::seconds {0}, 1024 * 1024})};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .WillOnce(Return(Ods::Internal::Response {Header_map {{"ETag", "\"v1\""}}, directory_stat("d"), 200}))
+        .WillOnce([](const std::string&, const Header_map& headers) {
+            const auto found {headers.find("If-None-Match")};
+            const auto matches {found != headers.end() && found->second == "\"v1\""};
+            return Ods::Internal::Response {Header_map {}, "", matches ? 304 : 500};
+        });
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller), cache};
+
+    EXPECT_EQ(endpoint.list("/d").name, "d");
+    EXPECT_EQ(endpoint.list("/d").name, "d");
+    EXPECT_EQ(cache->stats().revalidations, 1);
+}
+
+/**
+ * Tests that removing a resource discards the cached listing of its directory.
+ */
+TEST_F(Endpoint_impl_tests, RemoveWithCacheInvalidatesListing)
+{
+    const auto cache {std::make_shared<Ods::Internal::Listing_cache_impl>(Ods::Listing_cache_options {})};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .Times(2)
+        .WillRepeatedly(Return(Ods::Internal::Response {Header_map {}, directory_stat("d"), 200}));
+    EXPECT_CALL(*caller, post).WillOnce(Return(Ods::Internal::Response {Header_map {}, "", 200}));
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller), cache};
+
+    endpoint.list("/d");
+    endpoint.remove("/d", "f");
+    endpoint.list("/d");
+
+    EXPECT_EQ(cache->stats().misses, 2);
+    EXPECT_EQ(cache->stats().invalidations, 1);
+}
+
+/**
+ * Tests that a removal that fails after OneDataShare may have applied it still discards listings of its directory
+ * received while it was in flight.
+ */
+TEST_F(Endpoint_impl_tests, FailedRemoveWithCacheInvalidatesListing)
+{
+    const auto cache {std::make_shared<Ods::Internal::Listing_cache_impl>(Ods::Listing_cache_options {})};
+    const Ods::Internal::Endpoint_impl* endpoint_ptr {nullptr};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .Times(4)
+        .WillRepeatedly(Return(Ods::Internal::Response {Header_map {}, directory_stat("d"), 200}));
+    const auto list_then_fail {
+        [&endpoint_ptr](const std::string&, const Header_map&, const std::string&) -> Ods::Internal::Response {
+            // a listing received while the removal is in flight
+            endpoint_ptr->list("/d");
+            throw Ods::Connection_error {"connection lost after the request was sent"};
+        }};
+    EXPECT_CALL(*caller, post).Times(2).WillRepeatedly(list_then_fail);
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller), cache};
+    endpoint_ptr = &endpoint;
+
+    EXPECT_THROW(endpoint.remove("/d", "f"), Ods::Connection_error);
+    endpoint.list("/d");
+    EXPECT_THROW(endpoint.remove_async("/d", "f").get(), Ods::Connection_error);
+    endpoint.list("/d");
+
+    EXPECT_EQ(cache->stats().hits, 0);
+    EXPECT_EQ(cache->stats().misses, 4);
+}
+
+/**
+ * Tests that a failed upload still invalidates a cached listing of the directory received while it was in flight,
+ * since parts sent before the failure may already have created the file.
+ */
+TEST_F(Endpoint_impl_tests, FailedUploadWithCacheInvalidatesListing)
+{
+    const auto local_path {::testing::TempDir() + "endpoint_failed_upload"};
+    std::ofstream {local_path} << "contents";
+    const auto cache {std::make_shared<Ods::Internal::Listing_cache_impl>(Ods::Listing_cache_options {})};
+    const Ods::Internal::Endpoint_impl* endpoint_ptr {nullptr};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .Times(2)
+        .WillRepeatedly(Return(Ods::Internal::Response {Header_map {}, directory_stat("d"), 200}));
+    const auto list_then_fail {
+        [&endpoint_ptr](const std::string&, const Header_map&, const std::string&) -> Ods::Internal::Response {
+            // a listing received while the upload is in flight
+            endpoint_ptr->list("/d");
+            throw Ods::Connection_error {"connection lost after the part was sent"};
+        }};
+    EXPECT_CALL(*caller, post).WillOnce(list_then_fail);
+
+    const Ods::Internal::Endpoint_impl endpoint {Ods::Endpoint_type::sftp, "", "", "", std::move(caller), cache};
+    endpoint_ptr = &endpoint;
+
+    EXPECT_THROW(endpoint.upload("/d", local_path, Ods::Upload_options {}), Ods::Connection_error);
+    endpoint.list("/d");
+
+    EXPECT_EQ(cache->stats().hits, 0);
+    EXPECT_EQ(cache->stats().misses, 2);
+    std::remove(local_path.c_str());
+}
+
+/**
+ * Tests that creating an Endpoint with a cache not created by Listing_cache::create throws invalid_argument.
+ */
+TEST_F(Endpoint_impl_tests, CreateWithUnknownCacheThrowsInvalidArgument)
+{
+    class Other_cache : public Ods::Listing_cache {
+    public:
+        Ods::Listing_cache_stats stats() const override
+        {
+            return {};
+        }
+
+        void clear() override {}
+    };
+
+    EXPECT_THROW(Ods::Endpoint::create(Ods::Endpoint_type::sftp, "", "", "", std::make_shared<Other_cache>()),
+                 std::invalid_argument);
+}
+
+} // namespace
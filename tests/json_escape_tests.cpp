@@ -0,0 +1,66 @@
+/*
+ * json_escape_tests.cpp
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <json_escape.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+class Json_escape_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that every special character is found at every position, covering the vector loops and the scalar tails.
+ */
+TEST_F(Json_escape_tests, FindJsonEscapeFindsEveryPosition)
+{
+    for (const auto special : {'"', '\\', '\0', '\x1f', '\n'}) {
+        for (std::size_t size {1}; size < 100; ++size) {
+            for (std::size_t position {0}; position < size; ++position) {
+                std::string str(size, 'a');
+                str[position] = special;
+                str.back() = special;
+
+                ASSERT_EQ(Ods::Internal::find_json_escape(str), position) << "size " << size;
+            }
+        }
+    }
+}
+
+/**
+ * Tests that strings without special characters, including multibyte and high characters, are scanned to the end.
+ */
+TEST_F(Json_escape_tests, FindJsonEscapeSkipsCleanStrings)
+{
+    std::string str {};
+    for (auto c {0x20}; c < 0x100; ++c) {
+        if (c != '"' && c != '\\') {
+            str.push_back(static_cast<char>(c));
+        }
+    }
+
+    EXPECT_EQ(Ods::Internal::find_json_escape(str), str.size());
+    EXPECT_EQ(Ods::Internal::find_json_escape(""), 0);
+}
+
+/**
+ * Tests that special characters are escaped, including control characters as \u00XX escapes.
+ */
+TEST_F(Json_escape_tests, AppendEscapedJsonEscapesSpecialCharacters)
+{
+    std::string buffer {"{"};
+
+    Ods::Internal::append_escaped_json(buffer, "a long clean prefix \"q\" \\ \x01\x1f\x7f\t");
+
+    EXPECT_EQ(buffer, R"({a long clean prefix \"q\" \\ \u0001\u001f)"
+                      "\x7f"
+                      R"(\t)");
+}
+
+} // namespace
@@ -0,0 +1,91 @@
+/*
+ * json_parser_pool_tests.cpp
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <json_parser_pool.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+class Json_parser_pool_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that a returned parser is handed out again by the next acquire.
+ */
+TEST_F(Json_parser_pool_tests, AcquireReusesReturnedParser)
+{
+    Ods::Internal::Json_parser_pool pool {};
+
+    simdjson::dom::parser* first {nullptr};
+    {
+        const auto lease {pool.acquire()};
+        first = &*lease;
+    }
+    EXPECT_EQ(pool.idle_count(), 1);
+
+    const auto lease {pool.acquire()};
+    EXPECT_EQ(&*lease, first);
+    EXPECT_EQ(pool.idle_count(), 0);
+}
+
+/**
+ * Tests that no more than the maximum number of idle parsers are kept.
+ */
+TEST_F(Json_parser_pool_tests, IdleParsersAreCapped)
+{
+    Ods::Internal::Json_parser_pool pool {{2, 1024 * 1024}};
+    {
+        std::vector<Ods::Internal::Json_parser_pool::Lease> leases {};
+        for (auto i {0}; i < 4; ++i) {
+            leases.push_back(pool.acquire());
+        }
+    }
+
+    EXPECT_EQ(pool.idle_count(), 2);
+}
+
+/**
+ * Tests that a parser that grew beyond the maximum capacity is freed instead of kept.
+ */
+TEST_F(Json_parser_pool_tests, OversizedParserIsFreed)
+{
+    Ods::Internal::Json_parser_pool pool {{2, 16}};
+    {
+        const auto lease {pool.acquire()};
+        ASSERT_FALSE(lease->parse(std::string {R"({"key":"a long enough value"})"}).error());
+    }
+
+    EXPECT_EQ(pool.idle_count(), 0);
+}
+
+/**
+ * Tests that bodies are parsed whether or not their buffer is padded.
+ */
+TEST_F(Json_parser_pool_tests, ParseBodyParsesPaddedAndUnpaddedBodies)
+{
+    Ods::Internal::Json_parser_pool pool {};
+    const auto parser {pool.acquire()};
+
+    const Ods::Internal::Response padded {Header_map {{"Key", "value"}}, R"({"id":"padded"})", 200};
+    ASSERT_GE(padded.body_capacity() - padded.body().size(), simdjson::SIMDJSON_PADDING);
+    EXPECT_EQ(std::string {parse_body(*parser, padded)["id"].get_c_str().value()}, "padded");
+
+    std::string buffer {R"({"id":"unpadded"})"};
+    buffer.shrink_to_fit();
+    const auto size {buffer.size()};
+    const Ods::Internal::Response unpadded {std::move(buffer), {}, 0, 200};
+    ASSERT_EQ(unpadded.body().size(), size);
+    EXPECT_EQ(std::string {parse_body(*parser, unpadded)["id"].get_c_str().value()}, "unpadded");
+}
+
+} // namespace
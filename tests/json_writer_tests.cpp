@@ -0,0 +1,95 @@
+/*
+ * json_writer_tests.cpp
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <simdjson/simdjson.h>
+
+#include <json_writer.h>
+#include <ods_rest_api.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+namespace Api = Ods::Internal::Api;
+
+class Json_writer_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that commas are placed between the members of nested objects and the elements of arrays.
+ */
+TEST_F(Json_writer_tests, NestedValuesAreSeparated)
+{
+    std::string json {};
+    Ods::Internal::Json_writer writer {json};
+
+    writer.begin_object();
+    writer.field<Api::source_type>("box");
+    writer.key<Api::source_info>();
+    writer.begin_object();
+    writer.field<Api::entity_info_id>("id");
+    writer.field<Api::entity_info_path>("path");
+    writer.end_object();
+    writer.key<Api::source_info_list>();
+    writer.begin_array();
+    writer.begin_array();
+    writer.end_array();
+    writer.value("a");
+    writer.value("b");
+    writer.end_array();
+    writer.end_object();
+
+    EXPECT_EQ(json, R"({"type":"box","info":{"id":"id","path":"path"},"infoList":[[],"a","b"]})");
+}
+
+/**
+ * Tests that special characters are escaped while other characters, including multibyte characters, are kept.
+ */
+TEST_F(Json_writer_tests, ValuesAreEscaped)
+{
+    std::string json {};
+    Ods::Internal::Json_writer writer {json};
+
+    writer.value(std::string {"a\"b\\c\b\f\n\r\t\x01\x1f\0d \xc3\xa9", 17});
+
+    EXPECT_EQ(json, R"("a\"b\\c\b\f\n\r\t\u0001\u001f\u0000d é")");
+}
+
+/**
+ * Tests that escaped values are read back unchanged by a json parser.
+ */
+TEST_F(Json_writer_tests, EscapedValuesRoundTrip)
+{
+    std::string value {};
+    for (auto c {0}; c < 128; ++c) {
+        value.push_back(static_cast<char>(c));
+    }
+    std::string json {};
+    Ods::Internal::Json_writer writer {json};
+
+    writer.begin_object();
+    writer.field<Api::entity_info_id>(value);
+    writer.end_object();
+
+    simdjson::dom::parser parser {};
+    EXPECT_EQ(parser.parse(json)[Api::entity_info_id].get_string().value(), value);
+}
+
+/**
+ * Tests that the writer appends to the contents already in the buffer.
+ */
+TEST_F(Json_writer_tests, WriterAppendsToBuffer)
+{
+    std::string json {"prefix "};
+    Ods::Internal::Json_writer writer {json};
+
+    writer.begin_array();
+    writer.end_array();
+
+    EXPECT_EQ(json, "prefix []");
+}
+
+} // namespace
@@ -0,0 +1,161 @@
+/*
+ * listing_cache_impl_tests.cpp
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/listing_cache.h>
+
+#include <listing_cache_impl.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+constexpr auto type {Ods::Endpoint_type::sftp};
+
+/**
+ * Creates a shared Resource with the specified name.
+ */
+std::shared_ptr<const Ods::Resource> resource(const std::string& name)
+{
+    return std::make_shared<const Ods::Resource>(
+        Ods::Resource {std::nullopt, name, 0, 0, true, false, std::nullopt, std::nullopt, std::nullopt});
+}
+
+class Listing_cache_impl_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that a stored listing is a hit until its time to live expires, keeping its validators after expiring.
+ */
+TEST_F(Listing_cache_impl_tests, StoredListingIsFreshUntilExpired)
+{
+    Ods::Internal::Listing_cache_impl fresh_cache {{std::chrono::hours {1}, 1024 * 1024}};
+    Ods::Internal::Listing_cache_impl expired_cache {{std::chrono::seconds {0}, 1024 * 1024}};
+
+    for (auto* cache : {&fresh_cache, &expired_cache}) {
+        EXPECT_FALSE(cache->lookup(type, "cred", "/a").resource);
+        const auto generation {cache->lookup(type, "cred", "/a").generation};
+        cache->store(type, "cred", "/a", resource("a"), "\"tag\"", std::nullopt, generation);
+    }
+
+    const auto fresh {fresh_cache.lookup(type, "cred", "/a")};
+    EXPECT_TRUE(fresh.fresh);
+    EXPECT_EQ(fresh.resource->name, "a");
+    EXPECT_FALSE(fresh_cache.lookup(type, "other cred", "/a").resource);
+
+    const auto expired {expired_cache.lookup(type, "cred", "/a")};
+    EXPECT_FALSE(expired.fresh);
+    EXPECT_EQ(expired.etag, "\"tag\"");
+
+    EXPECT_EQ(fresh_cache.stats().hits, 1);
+    EXPECT_EQ(fresh_cache.stats().misses, 1);
+    EXPECT_EQ(expired_cache.stats().hits, 0);
+}
+
+/**
+ * Tests that the least recently used listings are evicted to stay within the memory bound.
+ */
+TEST_F(Listing_cache_impl_tests, LeastRecentlyUsedListingIsEvicted)
+{
+    Ods::Internal::Listing_cache_impl cache {{std::chrono::hours {1}, 0}};
+    cache.store(type, "cred", "/a", resource("a"), std::nullopt, std::nullopt, 0);
+    const auto one_entry {cache.stats().bytes};
+
+    Ods::Internal::Listing_cache_impl bounded {{std::chrono::hours {1}, one_entry * 2 + one_entry / 2}};
+    bounded.store(type, "cred", "/a", resource("a"), std::nullopt, std::nullopt, 0);
+    bounded.store(type, "cred", "/b", resource("b"), std::nullopt, std::nullopt, 0);
+    EXPECT_TRUE(bounded.lookup(type, "cred", "/a").fresh);
+    bounded.store(type, "cred", "/c", resource("c"), std::nullopt, std::nullopt, 0);
+
+    EXPECT_TRUE(bounded.lookup(type, "cred", "/a").resource);
+    EXPECT_FALSE(bounded.lookup(type, "cred", "/b").resource);
+    EXPECT_TRUE(bounded.lookup(type, "cred", "/c").resource);
+    EXPECT_EQ(bounded.stats().evictions, 1);
+    EXPECT_EQ(bounded.stats().entries, 2);
+}
+
+/**
+ * Tests that a listing requested before an invalidation is not cached.
+ */
+TEST_F(Listing_cache_impl_tests, ListingFromBeforeInvalidationIsDiscarded)
+{
+    Ods::Internal::Listing_cache_impl cache {{}};
+    const auto lookup {cache.lookup(type, "cred", "/a")};
+
+    cache.invalidate(type, "cred", "/b");
+    cache.store(type, "cred", "/a", resource("a"), std::nullopt, std::nullopt, lookup.generation);
+
+    EXPECT_FALSE(cache.lookup(type, "cred", "/a").resource);
+}
+
+/**
+ * Tests that a listing requested before an invalidation on a different endpoint is still cached.
+ */
+TEST_F(Listing_cache_impl_tests, ListingFromBeforeOtherEndpointInvalidationIsKept)
+{
+    Ods::Internal::Listing_cache_impl cache {{}};
+    const auto lookup {cache.lookup(type, "cred", "/a")};
+
+    cache.invalidate(type, "other cred", "/a");
+    cache.invalidate_tree(Ods::Endpoint_type::dropbox, "cred", "/");
+    cache.store(type, "cred", "/a", resource("a"), std::nullopt, std::nullopt, lookup.generation);
+
+    EXPECT_TRUE(cache.lookup(type, "cred", "/a").resource);
+}
+
+/**
+ * Tests that a listing requested before the cache is cleared is not cached.
+ */
+TEST_F(Listing_cache_impl_tests, ListingFromBeforeClearIsDiscarded)
+{
+    Ods::Internal::Listing_cache_impl cache {{}};
+    const auto lookup {cache.lookup(type, "cred", "/a")};
+
+    cache.clear();
+    cache.store(type, "cred", "/a", resource("a"), std::nullopt, std::nullopt, lookup.generation);
+
+    EXPECT_FALSE(cache.lookup(type, "cred", "/a").resource);
+}
+
+/**
+ * Tests that invalidating a tree discards the listings of the path and of every path beneath it only.
+ */
+TEST_F(Listing_cache_impl_tests, InvalidateTreeDiscardsPathsBeneath)
+{
+    Ods::Internal::Listing_cache_impl cache {{}};
+    for (const auto path : {"/a", "/a/b", "/a/b/c", "/ab", "/"}) {
+        cache.store(type, "cred", path, resource(path), std::nullopt, std::nullopt, 0);
+    }
+
+    cache.invalidate_tree(type, "cred", "/a");
+
+    EXPECT_FALSE(cache.lookup(type, "cred", "/a").resource);
+    EXPECT_FALSE(cache.lookup(type, "cred", "/a/b").resource);
+    EXPECT_FALSE(cache.lookup(type, "cred", "/a/b/c").resource);
+    EXPECT_TRUE(cache.lookup(type, "cred", "/ab").resource);
+    EXPECT_TRUE(cache.lookup(type, "cred", "/").resource);
+    EXPECT_EQ(cache.stats().invalidations, 3);
+}
+
+/**
+ * Tests that a revalidated listing becomes fresh again.
+ */
+TEST_F(Listing_cache_impl_tests, RefreshRenewsListing)
+{
+    Ods::Internal::Listing_cache_impl cache {{std::chrono::hours {1}, 1024 * 1024}};
+    const Ods::Internal::Listing_cache_impl::Lookup lookup {resource("a"), false, "\"tag\"", std::nullopt, 0};
+
+    cache.refresh(type, "cred", "/a", lookup);
+
+    EXPECT_TRUE(cache.lookup(type, "cred", "/a").fresh);
+    EXPECT_EQ(cache.stats().revalidations, 1);
+}
+
+} // namespace
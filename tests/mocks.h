@@ -7,8 +7,23 @@
 #ifndef ONEDATASHARE_MOCKS_H
 #define ONEDATASHARE_MOCKS_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <gmock/gmock.h>
 
+#include <onedatashare/endpoint.h>
+
 #include <rest.h>
 
 namespace Onedatashare_mocks {
@@ -26,6 +41,178 @@ public:
                 (const, override));
 };
 
+/**
+ * Creates a Resource with the specified name, size, and time that may contain the specified resources.
+ */
+inline Ods::Resource resource(const std::string& name,
+                              long size = 0,
+                              long time = 0,
+                              std::optional<std::string> id = std::nullopt,
+                              std::optional<std::vector<Ods::Resource>> contained = std::nullopt)
+{
+    return Ods::Resource {std::move(id), name, size, time, contained.has_value(), !contained.has_value(),
+                          std::nullopt,  std::nullopt, std::move(contained)};
+}
+
+/**
+ * Creates a contained Stat object for a file with the specified name, size, and time.
+ */
+inline std::string file_stat(const std::string& name, long size, long time = 0)
+{
+    return R"({"name":")" + name + R"(","size":)" + std::to_string(size) + R"(,"time":)" + std::to_string(time) +
+           R"(,"dir":false,"file":true})";
+}
+
+/**
+ * Creates a contained Stat object for a directory with the specified name.
+ */
+inline std::string dir_stat(const std::string& name)
+{
+    return R"({"name":")" + name + R"(","size":0,"time":0,"dir":true,"file":false})";
+}
+
+/**
+ * Creates a Stat object for a directory containing the specified Stat objects.
+ */
+inline std::string listing(const std::vector<std::string>& stats)
+{
+    std::string body {R"({"name":"dir","size":0,"time":0,"dir":true,"file":false,"files":[)"};
+    for (std::size_t i {0}; i < stats.size(); ++i) {
+        body += (i == 0 ? "" : ",") + stats[i];
+    }
+    return body + "]}";
+}
+
+/**
+ * Decodes the percent-encoded characters of the specified query parameter value.
+ */
+inline std::string unescape(const std::string& value)
+{
+    std::string decoded {};
+    for (std::size_t i {0}; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            decoded.push_back(static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        } else {
+            decoded.push_back(value[i]);
+        }
+    }
+
+    return decoded;
+}
+
+/**
+ * Rest caller answering each listing with the contents of the directory named by its path parameter, or with a 500
+ * if the directory is unknown or while failing is set. POST requests are answered with a 500.
+ */
+class Listing_rest : public Ods::Internal::Rest {
+    using Header_map = std::unordered_multimap<std::string, std::string>;
+
+public:
+    explicit Listing_rest(std::map<std::string, std::vector<std::string>> tree = {}) : tree_ {std::move(tree)} {}
+
+    Ods::Internal::Response get(const std::string& url, const Header_map&) const override
+    {
+        ++gets_;
+        const auto begin {url.find("&path=") + 6};
+        const std::lock_guard<std::mutex> lock {mutex_};
+        const auto directory {tree_.find(unescape(url.substr(begin, url.find('&', begin) - begin)))};
+        if (failing_ || directory == tree_.end()) {
+            return Ods::Internal::Response {Header_map {}, "", 500};
+        }
+        return Ods::Internal::Response {Header_map {}, listing(directory->second), 200};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    /**
+     * Replaces the contents of the directory at the specified path and sets if every listing fails.
+     */
+    void set(const std::string& path, std::vector<std::string> stats, bool failing = false)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        tree_[path] = std::move(stats);
+        failing_ = failing;
+    }
+
+    mutable std::atomic<int> gets_ {0};
+
+private:
+    mutable std::mutex mutex_ {};
+    std::map<std::string, std::vector<std::string>> tree_;
+    bool failing_ {false};
+};
+
+/**
+ * Collects the events and errors reported to callbacks invoked on another thread, letting a test wait for them.
+ */
+template <typename Event>
+class Recorder {
+public:
+    void event(Event event)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        events_.push_back(std::move(event));
+        cv_.notify_all();
+    }
+
+    /**
+     * Creates an error callback counting the errors reported for each id.
+     */
+    std::function<void(const std::string& id, std::exception_ptr error)> on_error()
+    {
+        return [this](const std::string& id, std::exception_ptr) {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            ++errors_[id];
+            ++total_errors_;
+            cv_.notify_all();
+        };
+    }
+
+    /**
+     * Waits up to 5 seconds for the recorded events to satisfy the specified predicate.
+     */
+    bool wait_until(const std::function<bool(const std::vector<Event>& events)>& done)
+    {
+        std::unique_lock<std::mutex> lock {mutex_};
+        return cv_.wait_for(lock, std::chrono::seconds {5}, [&] { return done(events_); });
+    }
+
+    bool wait_for_events(std::size_t count)
+    {
+        return wait_until([count](const std::vector<Event>& events) { return events.size() >= count; });
+    }
+
+    bool wait_for_errors(int count)
+    {
+        std::unique_lock<std::mutex> lock {mutex_};
+        return cv_.wait_for(lock, std::chrono::seconds {5}, [&] { return total_errors_ >= count; });
+    }
+
+    std::vector<Event> events()
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        return events_;
+    }
+
+    int errors(const std::string& id)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        const auto errors {errors_.find(id)};
+        return errors == errors_.end() ? 0 : errors->second;
+    }
+
+private:
+    std::mutex mutex_ {};
+    std::condition_variable cv_ {};
+    std::vector<Event> events_ {};
+    std::map<std::string, int> errors_ {};
+    int total_errors_ {0};
+};
+
 } // namespace Onedatashare_mocks
 
 #endif // ONEDATASHARE_MOCKS_H
\ No newline at end of file
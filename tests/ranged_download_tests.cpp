@@ -0,0 +1,362 @@
+/*
+ * ranged_download_tests.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/ods_error.h>
+
+#include <checksum.h>
+#include <ranged_download.h>
+#include <rest.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+/**
+ * Rest caller serving a file, honoring Range and If-Range headers unless ranges are ignored.
+ */
+class File_rest : public Ods::Internal::Rest {
+public:
+    using Ods::Internal::Rest::get;
+
+    explicit File_rest(std::string contents, std::string etag = "\"v1\"")
+        : contents_ {std::move(contents)}, etag_ {std::move(etag)}
+    {
+    }
+
+    Ods::Internal::Response get(const std::string&, const Header_map& headers) const override
+    {
+        ++gets_;
+        const auto range {headers.find("Range")};
+        const auto if_range {headers.find("If-Range")};
+        if (ignore_ranges_ || range == headers.end() ||
+            (if_range != headers.end() && if_range->second != etag_)) {
+            auto response_headers {digest_headers_};
+            response_headers.emplace("ETag", etag_);
+            return Ods::Internal::Response {response_headers, contents_, 200};
+        }
+
+        // parse "bytes=first-last"
+        const auto& value {range->second};
+        const auto dash {value.find('-')};
+        const auto first {std::stoull(value.substr(6, dash - 6))};
+        const auto last {std::min<unsigned long long>(std::stoull(value.substr(dash + 1)), contents_.size() - 1)};
+        {
+            const std::lock_guard<std::mutex> lock {mutex_};
+            requested_.insert(first);
+            if (fail_offset_ && *fail_offset_ == first) {
+                fail_offset_.reset();
+                throw Ods::Connection_error {"interrupted"};
+            }
+        }
+
+        auto response_headers {digest_headers_};
+        response_headers.emplace("ETag", etag_);
+        response_headers.emplace(
+            "Content-Range",
+            "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(contents_.size()));
+        return Ods::Internal::Response {response_headers, contents_.substr(first, last - first + 1), 206};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    bool ignore_ranges_ {false};
+    mutable std::atomic<int> gets_ {0};
+    mutable std::optional<unsigned long long> fail_offset_ {};
+    mutable std::set<unsigned long long> requested_ {};
+    Header_map digest_headers_ {};
+
+private:
+    const std::string contents_;
+    const std::string etag_;
+    mutable std::mutex mutex_ {};
+};
+
+/**
+ * File_rest completing each request on its own thread, with later ranges delayed less so that chunks in flight
+ * together complete in reverse order.
+ */
+class Reordering_rest : public File_rest {
+public:
+    using File_rest::File_rest;
+
+    ~Reordering_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void get_async(const std::string& url,
+                   const Header_map& headers,
+                   Ods::Internal::Body_sink& sink,
+                   Ods::Internal::Response_callback callback) const override
+    {
+        const auto range {headers.find("Range")};
+        const auto delay {range == headers.end() ? 0 : 8 - std::stoull(range->second.substr(6)) / 1000 % 4 * 2};
+
+        const std::lock_guard<std::mutex> lock {threads_mutex_};
+        threads_.emplace_back([this, url, headers, &sink, callback {std::move(callback)}, delay] {
+            std::this_thread::sleep_for(std::chrono::milliseconds {delay});
+            std::promise<Ods::Internal::Response> promise {};
+            try {
+                promise.set_value(get(url, headers, sink));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+            callback(promise.get_future());
+        });
+    }
+
+private:
+    mutable std::mutex threads_mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
+/**
+ * Creates contents that differ at every offset within a chunk.
+ */
+std::string contents(std::size_t size, char salt = 0)
+{
+    std::string contents(size, '\0');
+    for (std::size_t i {0}; i < size; ++i) {
+        contents[i] = static_cast<char>(i * 31 + i / 7 + salt);
+    }
+    return contents;
+}
+
+/**
+ * Reads the whole file at the specified path.
+ */
+std::string read_file(const std::string& path)
+{
+    std::ifstream in {path, std::ios::binary};
+    return std::string {std::istreambuf_iterator<char> {in}, std::istreambuf_iterator<char> {}};
+}
+
+/**
+ * Computes the hexadecimal CRC32C checksum of the specified contents.
+ */
+std::string crc32c(const std::string& contents)
+{
+    return Ods::Internal::to_hex(Ods::Internal::crc32c_update(0, contents.data(), contents.size()), 8);
+}
+
+/**
+ * Computes the hexadecimal xxHash64 of the specified contents.
+ */
+std::string xxh64(const std::string& contents)
+{
+    Ods::Internal::Xxh64 hash {};
+    hash.update(contents.data(), contents.size());
+    return Ods::Internal::to_hex(hash.digest(), 16);
+}
+
+/**
+ * Tests if a file exists at the specified path.
+ */
+bool exists(const std::string& path)
+{
+    return std::ifstream {path}.good();
+}
+
+class Ranged_download_tests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + "ranged_download_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::remove(path_.c_str());
+        std::remove(state_path().c_str());
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+        std::remove(state_path().c_str());
+    }
+
+    std::string state_path() const
+    {
+        return path_ + Ods::Internal::download_state_suffix;
+    }
+
+    std::string path_ {};
+};
+
+/**
+ * Tests that parse_content_range_total reads the total size and rejects malformed or unknown totals.
+ */
+TEST_F(Ranged_download_tests, ParseContentRangeTotal)
+{
+    EXPECT_EQ(Ods::Internal::parse_content_range_total("bytes 0-1023/4096"), 4096);
+    EXPECT_EQ(Ods::Internal::parse_content_range_total("bytes 5-5/6"), 6);
+    EXPECT_FALSE(Ods::Internal::parse_content_range_total("bytes 0-1023/*"));
+    EXPECT_FALSE(Ods::Internal::parse_content_range_total("0-1023/4096"));
+    EXPECT_FALSE(Ods::Internal::parse_content_range_total("bytes 0-1023"));
+}
+
+/**
+ * Tests that a file spanning many chunks, including a partial last chunk, is downloaded and the state file removed.
+ */
+TEST_F(Ranged_download_tests, DownloadsEveryChunk)
+{
+    const auto expected {contents(10 * 1000 + 123)};
+    const File_rest rest {expected};
+
+    Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, Ods::Download_options {1000, 4});
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_EQ(rest.gets_, 11);
+    EXPECT_FALSE(exists(state_path()));
+}
+
+/**
+ * Tests that the whole file is written when range requests are not honored.
+ */
+TEST_F(Ranged_download_tests, DownloadsWholeFileWithoutRanges)
+{
+    const auto expected {contents(5000)};
+    File_rest rest {expected};
+    rest.ignore_ranges_ = true;
+
+    Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, Ods::Download_options {1000, 4});
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_EQ(rest.gets_, 1);
+}
+
+/**
+ * Tests that an interrupted download keeps its state and that downloading again fetches only the missing chunks.
+ */
+TEST_F(Ranged_download_tests, ResumesInterruptedDownload)
+{
+    const auto expected {contents(8 * 1000)};
+    const File_rest rest {expected};
+    rest.fail_offset_ = 5000;
+
+    EXPECT_THROW(
+        Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, Ods::Download_options {1000, 1}),
+        Ods::Connection_error);
+    EXPECT_TRUE(exists(state_path()));
+
+    rest.requested_.clear();
+    Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, Ods::Download_options {1000, 1});
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_EQ(rest.requested_, (std::set<unsigned long long> {5000, 6000, 7000}));
+    EXPECT_FALSE(exists(state_path()));
+}
+
+/**
+ * Tests that a file changed since its download was interrupted is downloaded again from the start.
+ */
+TEST_F(Ranged_download_tests, RestartsWhenFileChanged)
+{
+    const File_rest old_rest {contents(4000)};
+    old_rest.fail_offset_ = 2000;
+    EXPECT_THROW(
+        Ods::Internal::ranged_download(old_rest, "url", Header_map {}, path_, Ods::Download_options {1000, 1}),
+        Ods::Connection_error);
+
+    const auto expected {contents(4000, 1)};
+    const File_rest new_rest {expected, "\"v2\""};
+    Ods::Internal::ranged_download(new_rest, "url", Header_map {}, path_, Ods::Download_options {1000, 2});
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_FALSE(exists(state_path()));
+}
+
+/**
+ * Tests that a CRC32C checksum computed over chunks received out of order is verified against the server's digest.
+ */
+TEST_F(Ranged_download_tests, VerifiesCrc32cFromServer)
+{
+    const auto expected {contents(10 * 1000 + 123)};
+    Reordering_rest rest {expected};
+    rest.digest_headers_.emplace("X-Checksum-CRC32C", crc32c(expected));
+
+    const auto result {Ods::Internal::ranged_download(
+        rest, "url", Header_map {}, path_, Ods::Download_options {1000, 4, Ods::Checksum_algorithm::crc32c})};
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_EQ(result.size, expected.size());
+    EXPECT_EQ(result.digest, crc32c(expected));
+    EXPECT_TRUE(result.verified);
+}
+
+/**
+ * Tests that an xxHash64 covering chunks received out of order before and after an interruption, and a whole file
+ * received without ranges, is verified against the caller's digest regardless of case.
+ */
+TEST_F(Ranged_download_tests, VerifiesXxh64FromCallerAcrossResume)
+{
+    const auto expected {contents(12 * 1000 + 5)};
+    const Reordering_rest rest {expected};
+    rest.fail_offset_ = 5000;
+    Ods::Download_options options {1000, 2, Ods::Checksum_algorithm::xxh64, xxh64(expected)};
+    std::transform(options.expected_digest.begin(),
+                   options.expected_digest.end(),
+                   options.expected_digest.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+
+    EXPECT_THROW(Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, options), Ods::Connection_error);
+    const auto resumed {Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, options)};
+
+    EXPECT_EQ(read_file(path_), expected);
+    EXPECT_EQ(resumed.digest, xxh64(expected));
+    EXPECT_TRUE(resumed.verified);
+
+    File_rest whole_rest {expected};
+    whole_rest.ignore_ranges_ = true;
+    const auto whole {Ods::Internal::ranged_download(whole_rest, "url", Header_map {}, path_, options)};
+    EXPECT_EQ(whole.digest, xxh64(expected));
+    EXPECT_TRUE(whole.verified);
+}
+
+/**
+ * Tests that a checksum is reported unverified when no digest is supplied, and that a checksum not matching the
+ * server's digest raises an Unexpected_response_error.
+ */
+TEST_F(Ranged_download_tests, ChecksumMismatchThrowsUnexpectedResponse)
+{
+    const auto expected {contents(3000)};
+    File_rest rest {expected};
+
+    const auto result {Ods::Internal::ranged_download(
+        rest, "url", Header_map {}, path_, Ods::Download_options {1000, 2, Ods::Checksum_algorithm::xxh64})};
+    EXPECT_EQ(result.digest, xxh64(expected));
+    EXPECT_FALSE(result.verified);
+
+    rest.digest_headers_.emplace("X-Checksum-XXH64", xxh64(expected + "x"));
+    const Ods::Download_options options {1000, 2, Ods::Checksum_algorithm::xxh64};
+    EXPECT_THROW(Ods::Internal::ranged_download(rest, "url", Header_map {}, path_, options),
+                 Ods::Unexpected_response_error);
+    EXPECT_FALSE(exists(state_path()));
+}
+
+} // namespace
@@ -0,0 +1,212 @@
+/*
+ * rate_limited_rest_tests.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <rate_limited_rest.h>
+#include <rest.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+/**
+ * Rest caller completing each request on its own thread after a delay, 2 milliseconds unless a latency is given for
+ * each call, answering with a 429 whenever more than the specified number of requests are in flight.
+ */
+class Capacity_rest : public Ods::Internal::Rest {
+public:
+    using Rest::get_async;
+
+    explicit Capacity_rest(int capacity,
+                           std::function<std::chrono::milliseconds(int call)> latency =
+                               [](int) { return std::chrono::milliseconds {2}; })
+        : capacity_ {capacity}, latency_ {std::move(latency)}
+    {}
+
+    ~Capacity_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    Ods::Internal::Response get(const std::string&, const Header_map&) const override
+    {
+        ++calls_;
+        return Ods::Internal::Response {Header_map {}, "", 200};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    void get_async(const std::string&, const Header_map&, Ods::Internal::Response_callback callback) const override
+    {
+        const auto delay {latency_(calls_++)};
+        const auto current {++in_flight_};
+        auto max {max_in_flight_.load()};
+        while (current > max && !max_in_flight_.compare_exchange_weak(max, current)) {
+        }
+
+        const std::lock_guard<std::mutex> lock {mutex_};
+        threads_.emplace_back([this, current, delay, callback {std::move(callback)}] {
+            std::this_thread::sleep_for(delay);
+            const auto status {current > capacity_ ? 429 : 200};
+            if (status == 429) {
+                ++rejected_;
+            }
+            --in_flight_;
+            std::promise<Ods::Internal::Response> promise {};
+            promise.set_value(Ods::Internal::Response {Header_map {}, "", status});
+            callback(promise.get_future());
+        });
+    }
+
+    mutable std::atomic<int> calls_ {0};
+    mutable std::atomic<int> max_in_flight_ {0};
+    mutable std::atomic<int> rejected_ {0};
+
+private:
+    const int capacity_;
+    const std::function<std::chrono::milliseconds(int call)> latency_;
+    mutable std::atomic<int> in_flight_ {0};
+    mutable std::mutex mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
+/**
+ * Starts the specified number of GET requests at once and waits for all of them, returning the number answered with
+ * a 200.
+ */
+int get_all(const Ods::Internal::Rest& rest, int requests)
+{
+    std::vector<std::future<Ods::Internal::Response>> responses {};
+    for (auto i {0}; i < requests; ++i) {
+        responses.push_back(rest.get_async("url", Header_map {}));
+    }
+    return static_cast<int>(std::count_if(
+        responses.begin(), responses.end(), [](auto& response) { return response.get().status() == 200; }));
+}
+
+class Rate_limited_rest_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that requests beyond the burst are started no faster than the rate.
+ */
+TEST_F(Rate_limited_rest_tests, TokenBucketPacesRequests)
+{
+    Ods::Internal::Rate_limit_options options {};
+    options.max_rate = 100;
+    options.burst = 1;
+    options.rate_increase = 0;
+    const auto inner {std::make_shared<Capacity_rest>(1000)};
+    const Ods::Internal::Rate_limited_rest rest {inner, options};
+
+    const auto start {std::chrono::steady_clock::now()};
+    EXPECT_EQ(get_all(rest, 21), 21);
+
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds {190});
+    EXPECT_EQ(inner->calls_, 21);
+}
+
+/**
+ * Tests that no more requests are in flight than the concurrency limit allows, and that the limit grows while the
+ * server keeps up.
+ */
+TEST_F(Rate_limited_rest_tests, ConcurrencyLimitGrowsWhileHealthy)
+{
+    Ods::Internal::Rate_limit_options options {};
+    options.initial_concurrency = 2;
+    options.max_concurrency = 2;
+    const auto capped_inner {std::make_shared<Capacity_rest>(1000)};
+    const Ods::Internal::Rate_limited_rest capped {capped_inner, options};
+
+    EXPECT_EQ(get_all(capped, 50), 50);
+    EXPECT_EQ(capped_inner->max_in_flight_, 2);
+
+    options.max_concurrency = 256;
+    const auto inner {std::make_shared<Capacity_rest>(1000)};
+    const Ods::Internal::Rate_limited_rest rest {inner, options};
+
+    EXPECT_EQ(get_all(rest, 200), 200);
+    EXPECT_GT(rest.concurrency_limit(), 4);
+    EXPECT_GT(inner->max_in_flight_, 2);
+}
+
+/**
+ * Tests that 429 responses back off both the concurrency limit and the rate, bringing the number of requests in
+ * flight within the capacity of the server.
+ */
+TEST_F(Rate_limited_rest_tests, BacksOffOnTooManyRequests)
+{
+    Ods::Internal::Rate_limit_options options {};
+    options.max_rate = 100000;
+    options.burst = 1000;
+    options.initial_concurrency = 64;
+    const auto inner {std::make_shared<Capacity_rest>(4)};
+    const Ods::Internal::Rate_limited_rest rest {inner, options};
+
+    get_all(rest, 100);
+    EXPECT_LT(rest.concurrency_limit(), 16);
+    EXPECT_LT(rest.rate(), options.max_rate);
+
+    const auto rejected {inner->rejected_.load()};
+    EXPECT_GT(get_all(rest, 100), 80);
+    EXPECT_LT(inner->rejected_ - rejected, 20);
+}
+
+/**
+ * Tests that with the default options the concurrency limit keeps growing while the server keeps up, however much the
+ * round trip times of its responses vary.
+ */
+TEST_F(Rate_limited_rest_tests, JitterDoesNotBackOffByDefault)
+{
+    // a quarter of the requests are slow, as when listing a few large directories among many small ones
+    const auto mixed_inner {std::make_shared<Capacity_rest>(
+        1000, [](int call) { return std::chrono::milliseconds {call % 4 == 0 ? 40 : 4}; })};
+    const Ods::Internal::Rate_limited_rest mixed {mixed_inner};
+
+    EXPECT_EQ(get_all(mixed, 400), 400);
+    EXPECT_GT(mixed.concurrency_limit(), 16);
+
+    // round trip times spread evenly between 5 and 15 milliseconds
+    const auto jittery_inner {
+        std::make_shared<Capacity_rest>(1000, [](int call) { return std::chrono::milliseconds {5 + call * 7 % 11}; })};
+    const Ods::Internal::Rate_limited_rest jittery {jittery_inner};
+
+    EXPECT_EQ(get_all(jittery, 400), 400);
+    EXPECT_GT(jittery.concurrency_limit(), 16);
+}
+
+/**
+ * Tests that synchronous requests pass through the limits to the inner REST caller.
+ */
+TEST_F(Rate_limited_rest_tests, SynchronousRequestsPassThrough)
+{
+    const auto inner {std::make_shared<Capacity_rest>(1)};
+    const Ods::Internal::Rate_limited_rest rest {inner};
+
+    EXPECT_EQ(rest.get("url", Header_map {}).status(), 200);
+    EXPECT_EQ(rest.post("url", Header_map {}, "{}").status(), 500);
+}
+
+} // namespace
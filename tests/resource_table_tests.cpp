@@ -0,0 +1,136 @@
+/*
+ * resource_table_tests.cpp
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/resource_table.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+class Resource_table_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that every field of an added resource is viewed unchanged.
+ */
+TEST_F(Resource_table_tests, AddedResourceIsViewed)
+{
+    Ods::Resource_table table {};
+
+    table.add("id", "name", 7, 3, false, true, "link", "rw");
+    table.add(std::nullopt, "dir", 0, 4, true, false, std::nullopt, std::nullopt);
+
+    ASSERT_EQ(table.size(), 2);
+    EXPECT_EQ(table[0].id(), "id");
+    EXPECT_EQ(table[0].name(), "name");
+    EXPECT_EQ(table[0].size(), 7);
+    EXPECT_EQ(table[0].time(), 3);
+    EXPECT_FALSE(table[0].is_directory());
+    EXPECT_TRUE(table[0].is_file());
+    EXPECT_EQ(table[0].link(), "link");
+    EXPECT_EQ(table[0].permissions(), "rw");
+    EXPECT_FALSE(table[1].id());
+    EXPECT_EQ(table[1].name(), "dir");
+    EXPECT_TRUE(table[1].is_directory());
+    EXPECT_FALSE(table[1].is_file());
+    EXPECT_FALSE(table[1].link());
+    EXPECT_FALSE(table[1].permissions());
+}
+
+/**
+ * Tests that iterating visits every resource in the order added.
+ */
+TEST_F(Resource_table_tests, IterationVisitsResourcesInOrder)
+{
+    Ods::Resource_table table {};
+    for (const auto name : {"a", "b", "c"}) {
+        table.add(std::nullopt, name, 0, 0, false, true, std::nullopt, std::nullopt);
+    }
+
+    std::vector<std::string> names {};
+    for (const auto resource : table) {
+        names.emplace_back(resource.name());
+    }
+
+    EXPECT_EQ(names, (std::vector<std::string> {"a", "b", "c"}));
+}
+
+/**
+ * Tests that an empty string is distinguished from a missing string.
+ */
+TEST_F(Resource_table_tests, EmptyStringIsNotMissing)
+{
+    Ods::Resource_table table {};
+
+    table.add("", "", 0, 0, false, true, "", std::nullopt);
+
+    ASSERT_TRUE(table[0].id());
+    EXPECT_TRUE(table[0].id()->empty());
+    EXPECT_TRUE(table[0].name().empty());
+    ASSERT_TRUE(table[0].link());
+    EXPECT_FALSE(table[0].permissions());
+}
+
+/**
+ * Tests that interned permissions are viewed from the same memory while uninterned permissions are not.
+ */
+TEST_F(Resource_table_tests, PermissionsAreInterned)
+{
+    Ods::Resource_table interned {};
+    Ods::Resource_table uninterned {false};
+    for (auto* table : {&interned, &uninterned}) {
+        table->add(std::nullopt, "a", 0, 0, false, true, std::nullopt, "rwxr-xr-x");
+        table->add(std::nullopt, "b", 0, 0, false, true, std::nullopt, "rwxr-xr-x");
+    }
+
+    EXPECT_EQ(interned[0].permissions()->data(), interned[1].permissions()->data());
+    EXPECT_NE(uninterned[0].permissions()->data(), uninterned[1].permissions()->data());
+    EXPECT_EQ(uninterned[1].permissions(), "rwxr-xr-x");
+}
+
+/**
+ * Tests that a resource copied into a table converts back to an equal Resource without contained resources.
+ */
+TEST_F(Resource_table_tests, ToResourceRoundTrips)
+{
+    const Ods::Resource resource {"id", "name", 7, 3, false, true, std::nullopt, "rw", std::vector<Ods::Resource> {}};
+    Ods::Resource_table table {};
+
+    table.add(resource);
+    const auto copy {table[0].to_resource()};
+
+    EXPECT_EQ(copy.id, resource.id);
+    EXPECT_EQ(copy.name, resource.name);
+    EXPECT_EQ(copy.size, resource.size);
+    EXPECT_EQ(copy.time, resource.time);
+    EXPECT_EQ(copy.is_directory, resource.is_directory);
+    EXPECT_EQ(copy.is_file, resource.is_file);
+    EXPECT_EQ(copy.link, resource.link);
+    EXPECT_EQ(copy.permissions, resource.permissions);
+    EXPECT_FALSE(copy.contained_resources);
+}
+
+/**
+ * Tests that clearing the table removes every resource, including interned permissions.
+ */
+TEST_F(Resource_table_tests, ClearRemovesResources)
+{
+    Ods::Resource_table table {};
+    table.add(std::nullopt, "a", 0, 0, false, true, std::nullopt, "rw");
+
+    table.clear();
+    table.add(std::nullopt, "b", 0, 0, false, true, std::nullopt, "rw");
+
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ(table[0].name(), "b");
+    EXPECT_EQ(table[0].permissions(), "rw");
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+/*
+ * rest_tests.cpp
+ */
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <rest.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+class Rest_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that headers are found regardless of the case of their keys.
+ */
+TEST_F(Rest_tests, HeaderIgnoresCase)
+{
+    const Ods::Internal::Response response {Header_map {{"Location", "url"}, {"content-type", "json"}}, "body", 303};
+
+    EXPECT_EQ(response.header("location"), "url");
+    EXPECT_EQ(response.header("Content-Type"), "json");
+    EXPECT_FALSE(response.header("Content-Length"));
+    EXPECT_EQ(response.header_count(), 2);
+    EXPECT_EQ(response.body(), "body");
+    EXPECT_EQ(response.status(), 303);
+}
+
+/**
+ * Tests that headers and the body are located within a raw buffer by their offsets.
+ */
+TEST_F(Rest_tests, RawBufferIsViewed)
+{
+    std::string buffer {"Key: value\r\nbody"};
+    const Ods::Internal::Response response {std::move(buffer), {{0, 3, 5, 5}}, 12, 200};
+
+    EXPECT_EQ(response.header("KEY"), "value");
+    EXPECT_EQ(response.body(), "body");
+}
+
+/**
+ * Tests that releasing the body moves out only the body.
+ */
+TEST_F(Rest_tests, ReleaseBodyMovesOutBody)
+{
+    Ods::Internal::Response response {Header_map {{"Key", "value"}}, "body", 200};
+
+    EXPECT_EQ(response.release_body(), "body");
+    EXPECT_EQ(response.header_count(), 0);
+}
+
+/**
+ * Tests that clearing the body keeps the headers.
+ */
+TEST_F(Rest_tests, ClearBodyKeepsHeaders)
+{
+    Ods::Internal::Response response {Header_map {{"Key", "value"}}, "body", 200};
+
+    response.clear_body();
+
+    EXPECT_TRUE(response.body().empty());
+    EXPECT_EQ(response.header("key"), "value");
+}
+
+/**
+ * Tests that a moved Response keeps its headers and body.
+ */
+TEST_F(Rest_tests, MovedResponseKeepsContents)
+{
+    Ods::Internal::Response response {Header_map {{"Key", "value"}}, "body", 200};
+
+    const auto moved {std::move(response)};
+
+    EXPECT_EQ(moved.header("key"), "value");
+    EXPECT_EQ(moved.body(), "body");
+}
+
+} // namespace
@@ -0,0 +1,230 @@
+/*
+ * retry_rest_tests.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/ods_error.h>
+
+#include <rest.h>
+#include <retry_rest.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+/**
+ * Rest caller answering each request with the next scripted response, where a status of 0 raises a Connection_error,
+ * and answering every request with a 200 once the script runs out.
+ */
+class Scripted_rest : public Ods::Internal::Rest {
+public:
+    explicit Scripted_rest(std::deque<Ods::Internal::Response> script) : script_ {std::move(script)} {}
+
+    Ods::Internal::Response get(const std::string&, const Header_map&) const override
+    {
+        return next();
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return next();
+    }
+
+    mutable std::atomic<int> calls_ {0};
+
+private:
+    Ods::Internal::Response next() const
+    {
+        ++calls_;
+        const std::lock_guard<std::mutex> lock {mutex_};
+        if (script_.empty()) {
+            return Ods::Internal::Response {Header_map {}, "ok", 200};
+        }
+        auto response {std::move(script_.front())};
+        script_.pop_front();
+        if (response.status() == 0) {
+            throw Ods::Connection_error {"refused"};
+        }
+        return response;
+    }
+
+    mutable std::mutex mutex_ {};
+    mutable std::deque<Ods::Internal::Response> script_;
+};
+
+/**
+ * Rest caller completing each GET on its own thread, taking a long time to answer the specified request and no time
+ * to answer the rest.
+ */
+class Slow_rest : public Ods::Internal::Rest {
+public:
+    using Rest::get_async;
+
+    explicit Slow_rest(int slow_call) : slow_call_ {slow_call} {}
+
+    ~Slow_rest() override
+    {
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    Ods::Internal::Response get(const std::string& url, const Header_map& headers) const override
+    {
+        return get_async(url, headers).get();
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    void get_async(const std::string&, const Header_map&, Ods::Internal::Response_callback callback) const override
+    {
+        const auto delay {++calls_ == slow_call_ ? std::chrono::seconds {1} : std::chrono::seconds {0}};
+        const std::lock_guard<std::mutex> lock {mutex_};
+        threads_.emplace_back([delay, callback {std::move(callback)}] {
+            std::this_thread::sleep_for(delay);
+            std::promise<Ods::Internal::Response> promise {};
+            promise.set_value(Ods::Internal::Response {Header_map {}, delay.count() ? "slow" : "fast", 200});
+            callback(promise.get_future());
+        });
+    }
+
+    mutable std::atomic<int> calls_ {0};
+
+private:
+    const int slow_call_;
+    mutable std::mutex mutex_ {};
+    mutable std::vector<std::thread> threads_ {};
+};
+
+/**
+ * Creates a Response with the specified status and headers.
+ */
+Ods::Internal::Response response(int status, const Header_map& headers = {})
+{
+    return Ods::Internal::Response {headers, "", status};
+}
+
+/**
+ * Creates a policy retrying quickly up to the specified number of attempts.
+ */
+Ods::Internal::Retry_policy quick_policy(int max_attempts)
+{
+    Ods::Internal::Retry_policy policy {};
+    policy.max_attempts = max_attempts;
+    policy.base_delay = std::chrono::milliseconds {1};
+    policy.max_delay = std::chrono::milliseconds {5};
+    return policy;
+}
+
+class Retry_rest_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that a GET answered with load shedding statuses or failing to connect is retried until it succeeds.
+ */
+TEST_F(Retry_rest_tests, RetriesGetUntilSuccess)
+{
+    const auto inner {std::make_shared<Scripted_rest>(
+        std::deque<Ods::Internal::Response> {response(503), response(0), response(429), response(502)})};
+    const Ods::Internal::Retry_rest rest {inner, quick_policy(5)};
+
+    const auto result {rest.get("url", Header_map {})};
+
+    EXPECT_EQ(result.status(), 200);
+    EXPECT_EQ(result.body(), "ok");
+    EXPECT_EQ(inner->calls_, 5);
+}
+
+/**
+ * Tests that once the attempts are exhausted the last response is returned or the last exception raised.
+ */
+TEST_F(Retry_rest_tests, GivesUpAfterMaxAttempts)
+{
+    const auto shedding {std::make_shared<Scripted_rest>(
+        std::deque<Ods::Internal::Response> {response(503), response(503), response(504), response(200)})};
+    EXPECT_EQ(Ods::Internal::Retry_rest(shedding, quick_policy(3)).get("url", Header_map {}).status(), 504);
+    EXPECT_EQ(shedding->calls_, 3);
+
+    const auto refusing {
+        std::make_shared<Scripted_rest>(std::deque<Ods::Internal::Response> {response(0), response(0), response(0)})};
+    EXPECT_THROW(Ods::Internal::Retry_rest(refusing, quick_policy(2)).get("url", Header_map {}), Ods::Connection_error);
+    EXPECT_EQ(refusing->calls_, 2);
+}
+
+/**
+ * Tests that the delay asked for by a Retry-After header replaces the backoff delay and is capped by the maximum
+ * delay.
+ */
+TEST_F(Retry_rest_tests, HonorsRetryAfter)
+{
+    Ods::Internal::Retry_policy policy {};
+    policy.base_delay = std::chrono::milliseconds {60000};
+    policy.max_delay = std::chrono::milliseconds {50};
+    const auto inner {std::make_shared<Scripted_rest>(std::deque<Ods::Internal::Response> {
+        response(429, Header_map {{"retry-after", "0"}}), response(503, Header_map {{"Retry-After", "3600"}})})};
+    const Ods::Internal::Retry_rest rest {inner, policy};
+
+    const auto start {std::chrono::steady_clock::now()};
+    EXPECT_EQ(rest.get("url", Header_map {}).status(), 200);
+    const auto elapsed {std::chrono::steady_clock::now() - start};
+
+    EXPECT_EQ(inner->calls_, 3);
+    EXPECT_GE(elapsed, std::chrono::milliseconds {50});
+    EXPECT_LT(elapsed, std::chrono::seconds {5});
+}
+
+/**
+ * Tests that POST requests and GET requests answered with other statuses are not retried.
+ */
+TEST_F(Retry_rest_tests, DoesNotRetryPostOrOtherStatuses)
+{
+    const auto inner {
+        std::make_shared<Scripted_rest>(std::deque<Ods::Internal::Response> {response(503), response(404)})};
+    const Ods::Internal::Retry_rest rest {inner, quick_policy(4)};
+
+    EXPECT_EQ(rest.post("url", Header_map {}, "{}").status(), 503);
+    EXPECT_EQ(rest.get("url", Header_map {}).status(), 404);
+    EXPECT_EQ(inner->calls_, 2);
+}
+
+/**
+ * Tests that an attempt taking longer than recent requests is hedged, and that the faster copy is used.
+ */
+TEST_F(Retry_rest_tests, HedgesSlowGet)
+{
+    constexpr auto warm_up {4};
+    const auto inner {std::make_shared<Slow_rest>(warm_up + 1)};
+    Ods::Internal::Retry_policy policy {};
+    policy.hedge = true;
+    policy.hedge_min_samples = warm_up;
+    const Ods::Internal::Retry_rest rest {inner, policy};
+
+    for (auto i {0}; i < warm_up; ++i) {
+        EXPECT_EQ(rest.get("url", Header_map {}).body(), "fast");
+    }
+    const auto start {std::chrono::steady_clock::now()};
+    EXPECT_EQ(rest.get("url", Header_map {}).body(), "fast");
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds {500});
+    EXPECT_EQ(inner->calls_, warm_up + 2);
+}
+
+} // namespace
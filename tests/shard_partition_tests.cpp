@@ -0,0 +1,75 @@
+/*
+ * shard_partition_tests.cpp
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+
+#include <shard_partition.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Partition = std::vector<std::vector<std::size_t>>;
+
+class Shard_partition_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that items are split into shards of balanced total size, each listing its items in increasing order.
+ */
+TEST_F(Shard_partition_tests, BalancesTotalSize)
+{
+    EXPECT_EQ(Ods::Internal::partition_by_size({2, 7, 3, 5, 3, 4}, 2), (Partition {{0, 1, 2}, {3, 4, 5}}));
+    EXPECT_EQ(Ods::Internal::partition_by_size({100, 1, 1, 1, 1}, 2), (Partition {{0}, {1, 2, 3, 4}}));
+}
+
+/**
+ * Tests that items of unknown size are spread evenly, and that there are never more shards than items nor fewer
+ * than one.
+ */
+TEST_F(Shard_partition_tests, HandlesShardCounts)
+{
+    EXPECT_EQ(Ods::Internal::partition_by_size({0, 0, 0, 0}, 2), (Partition {{0, 2}, {1, 3}}));
+    EXPECT_EQ(Ods::Internal::partition_by_size({5, 6, 7}, 10), (Partition {{2}, {1}, {0}}));
+    EXPECT_EQ(Ods::Internal::partition_by_size({5, 6, 7}, 0), (Partition {{0, 1, 2}}));
+    EXPECT_TRUE(Ods::Internal::partition_by_size({}, 4).empty());
+}
+
+/**
+ * Tests that resource_sizes looks up resources by name or by id depending on the endpoint, giving missing resources
+ * and directories a size of 0.
+ */
+TEST_F(Shard_partition_tests, ResourceSizesFollowListing)
+{
+    const auto resource {[](const std::string& name, std::optional<std::string> id, long size, bool directory) {
+        return Ods::Resource {
+            std::move(id), name, size, 0, directory, !directory, std::nullopt, std::nullopt, std::nullopt};
+    }};
+    const Ods::Resource listing {std::nullopt,
+                                 "dir",
+                                 0,
+                                 0,
+                                 true,
+                                 false,
+                                 std::nullopt,
+                                 std::nullopt,
+                                 {{resource("a", "1", 10, false), resource("b", "2", 20, false),
+                                   resource("c", "3", 0, true)}}};
+
+    EXPECT_EQ(Ods::Internal::resource_sizes(Ods::Endpoint_type::sftp, listing, {"b", "c", "missing", "a"}),
+              (std::vector<std::uint64_t> {20, 0, 0, 10}));
+    EXPECT_EQ(Ods::Internal::resource_sizes(Ods::Endpoint_type::box, listing, {"2", "a"}),
+              (std::vector<std::uint64_t> {20, 0}));
+}
+
+} // namespace
@@ -0,0 +1,191 @@
+/*
+ * single_flight_tests.cpp
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+
+#include <endpoint_impl.h>
+#include <rest.h>
+#include <single_flight.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Header_map = std::unordered_multimap<std::string, std::string>;
+
+constexpr auto callers {8};
+
+/**
+ * Gate holding calls until released, letting a test start every caller before the first call completes.
+ */
+class Gate {
+public:
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock {mutex_};
+        cv_.wait(lock, [this] { return open_; });
+    }
+
+    void open()
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_ {};
+    std::condition_variable cv_ {};
+    bool open_ {false};
+};
+
+/**
+ * Rest caller answering every GET request with an empty directory once its gate opens.
+ */
+class Gated_rest : public Ods::Internal::Rest {
+public:
+    Ods::Internal::Response get(const std::string&, const Header_map&) const override
+    {
+        ++gets_;
+        gate_.wait();
+        return Ods::Internal::Response {
+            Header_map {}, R"({"name":"dir","size":0,"time":0,"dir":true,"file":false,"files":[]})", 200};
+    }
+
+    Ods::Internal::Response post(const std::string&, const Header_map&, const std::string&) const override
+    {
+        return Ods::Internal::Response {Header_map {}, "", 500};
+    }
+
+    mutable std::atomic<int> gets_ {0};
+    mutable Gate gate_ {};
+};
+
+class Single_flight_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that concurrent calls with the same key make one call and all receive its result.
+ */
+TEST_F(Single_flight_tests, ConcurrentCallsShareOneCall)
+{
+    Ods::Internal::Single_flight<std::string> flight {};
+    std::atomic<int> calls {0};
+    std::atomic<int> waiting {0};
+    Gate gate {};
+
+    std::vector<std::future<std::string>> results {};
+    for (auto i {0}; i < callers; ++i) {
+        results.push_back(std::async(std::launch::async, [&] {
+            ++waiting;
+            return flight.run("key", [&] {
+                ++calls;
+                gate.wait();
+                return std::string {"result"};
+            });
+        }));
+    }
+    while (waiting < callers) {
+        std::this_thread::yield();
+    }
+    // give the callers that have not yet joined the flight time to do so
+    std::this_thread::sleep_for(std::chrono::milliseconds {20});
+    gate.open();
+
+    for (auto& result : results) {
+        EXPECT_EQ(result.get(), "result");
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+/**
+ * Tests that an exception thrown by the call reaches every caller sharing it, and that calls made after a call
+ * completes start a new call.
+ */
+TEST_F(Single_flight_tests, ExceptionsReachEveryCallerAndKeysAreForgotten)
+{
+    Ods::Internal::Single_flight<int> flight {};
+    Gate gate {};
+
+    auto leader {std::async(std::launch::async, [&] {
+        return flight.run("key", [&]() -> int {
+            gate.wait();
+            throw std::runtime_error {"failed"};
+        });
+    })};
+    std::this_thread::sleep_for(std::chrono::milliseconds {20});
+    auto follower {std::async(std::launch::async, [&] { return flight.run("key", [] { return 1; }); })};
+    std::this_thread::sleep_for(std::chrono::milliseconds {20});
+    gate.open();
+
+    EXPECT_THROW(leader.get(), std::runtime_error);
+    EXPECT_THROW(follower.get(), std::runtime_error);
+    EXPECT_EQ(flight.run("key", [] { return 2; }), 2);
+    EXPECT_EQ(flight.run("other", [] { return 3; }), 3);
+}
+
+/**
+ * Tests that request_key ignores the order of the headers but not their values.
+ */
+TEST_F(Single_flight_tests, RequestKeyIgnoresHeaderOrder)
+{
+    Header_map first {};
+    first.emplace("A", "1");
+    first.emplace("B", "2");
+    Header_map second {};
+    second.emplace("B", "2");
+    second.emplace("A", "1");
+
+    EXPECT_EQ(Ods::Internal::request_key("url", first), Ods::Internal::request_key("url", second));
+    EXPECT_NE(Ods::Internal::request_key("url", first), Ods::Internal::request_key("other", first));
+    EXPECT_NE(Ods::Internal::request_key("url", first), Ods::Internal::request_key("url", Header_map {{"A", "1"}}));
+}
+
+/**
+ * Tests that concurrent listings of the same directory, through different Endpoint_impl objects, make one request.
+ */
+TEST_F(Single_flight_tests, ConcurrentListingsMakeOneRequest)
+{
+    const auto rest {std::make_shared<Gated_rest>()};
+    std::vector<std::unique_ptr<Ods::Internal::Endpoint_impl>> endpoints {};
+    for (auto i {0}; i < callers; ++i) {
+        endpoints.push_back(std::make_unique<Ods::Internal::Endpoint_impl>(
+            Ods::Endpoint_type::sftp, "cred", "token", "single_flight_url", rest));
+    }
+
+    std::atomic<int> waiting {0};
+    std::vector<std::future<Ods::Resource>> results {};
+    for (const auto& endpoint : endpoints) {
+        results.push_back(std::async(std::launch::async, [&waiting, &endpoint] {
+            ++waiting;
+            return endpoint->list("/dir");
+        }));
+    }
+    while (waiting < callers) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds {20});
+    rest->gate_.open();
+
+    for (auto& result : results) {
+        EXPECT_TRUE(result.get().is_directory);
+    }
+    EXPECT_EQ(rest->gets_, 1);
+}
+
+} // namespace
@@ -0,0 +1,130 @@
+/*
+ * stat_parser_tests.cpp
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/ods_error.h>
+#include <onedatashare/resource_table.h>
+
+#include <stat_parser.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+/** Stat object whose strings contain characters that are structural outside of strings. */
+const std::string stat {R"({"name": "dir [1] {x}", "size": 0, "time": 0, "dir": true, "file": false,
+    "permissions": "\"files\": [",
+    "files": [
+        {"name": "a \"}\"", "size": 1, "time": 1, "dir": false, "file": true, "link": "\\"},
+        {"name": "b", "size": 2, "time": 2, "dir": true, "file": false, "files": [
+            {"name": "nested", "size": 3, "time": 3, "dir": false, "file": true}
+        ]}
+    ]
+})"};
+
+class Stat_parser_tests : public ::testing::Test {
+protected:
+    /**
+     * Writes the specified body to a Stat_stream_sink in chunks of the specified size.
+     */
+    Ods::Resource stream(const std::string& body, std::size_t chunk_size)
+    {
+        contained_.clear();
+        Ods::Internal::Stat_stream_sink sink {on_entry_};
+        sink.start(200);
+        for (std::size_t i {0}; i < body.size(); i += chunk_size) {
+            sink.write(body.data() + i, std::min(chunk_size, body.size() - i));
+        }
+        return sink.finish();
+    }
+
+    std::vector<Ods::Resource> contained_ {};
+    const std::function<void(const simdjson::dom::object&)> on_entry_ {
+        [this](const simdjson::dom::object& obj) { contained_.push_back(Ods::Internal::create_resource(obj)); }};
+};
+
+/**
+ * Tests that contained resources are found regardless of how the body is split into chunks.
+ */
+TEST_F(Stat_parser_tests, StreamIgnoresChunkBoundaries)
+{
+    for (std::size_t chunk_size : {1, 2, 3, 7, 64, 4096}) {
+        const auto resource {stream(stat, chunk_size)};
+
+        EXPECT_EQ(resource.name, "dir [1] {x}");
+        EXPECT_EQ(resource.permissions, "\"files\": [");
+        ASSERT_TRUE(resource.contained_resources);
+        EXPECT_TRUE(resource.contained_resources->empty());
+
+        ASSERT_EQ(contained_.size(), 2);
+        EXPECT_EQ(contained_[0].name, "a \"}\"");
+        EXPECT_EQ(contained_[0].link, "\\");
+        EXPECT_EQ(contained_[1].name, "b");
+        ASSERT_TRUE(contained_[1].contained_resources);
+        ASSERT_EQ(contained_[1].contained_resources->size(), 1);
+        EXPECT_EQ(contained_[1].contained_resources->at(0).name, "nested");
+    }
+}
+
+/**
+ * Tests that a Stat object without a files array is returned without contained resources.
+ */
+TEST_F(Stat_parser_tests, StreamFileHasNoContainedResources)
+{
+    const auto resource {stream(R"({"name":"f","size":5,"time":1,"dir":false,"file":true})", 3)};
+
+    EXPECT_EQ(resource.name, "f");
+    EXPECT_FALSE(resource.contained_resources);
+    EXPECT_TRUE(contained_.empty());
+}
+
+/**
+ * Tests that an invalid contained Stat object throws an Unexpected_response_error.
+ */
+TEST_F(Stat_parser_tests, StreamInvalidEntryThrowsUnexpectedResponse)
+{
+    EXPECT_THROW(stream(R"({"name":"d","files":[{"name":1}]})", 5), Ods::Unexpected_response_error);
+    EXPECT_THROW(stream(R"({"name":"d","files":["a"]})", 5), Ods::Unexpected_response_error);
+}
+
+/**
+ * Tests that the body of a response without a 200 status code is not parsed.
+ */
+TEST_F(Stat_parser_tests, StreamIgnoresErrorBody)
+{
+    Ods::Internal::Stat_stream_sink sink {on_entry_};
+    sink.start(404);
+    sink.write(stat.data(), stat.size());
+
+    EXPECT_TRUE(contained_.empty());
+    EXPECT_THROW(sink.finish(), Ods::Unexpected_response_error);
+}
+
+/**
+ * Tests that add_resource adds the fields of a Stat object to a table, ignoring its contained resources.
+ */
+TEST_F(Stat_parser_tests, AddResourceAddsFields)
+{
+    simdjson::dom::parser parser {};
+    Ods::Resource_table table {};
+
+    Ods::Internal::add_resource(parser.parse(stat).get_object().value(), table);
+
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ(table[0].name(), "dir [1] {x}");
+    EXPECT_TRUE(table[0].is_directory());
+    EXPECT_EQ(table[0].permissions(), "\"files\": [");
+    EXPECT_FALSE(table[0].id());
+    EXPECT_THROW(Ods::Internal::add_resource(parser.parse(std::string {R"({"name":"a"})"}).get_object().value(), table),
+                 simdjson::simdjson_error);
+    EXPECT_EQ(table.size(), 1);
+}
+
+} // namespace
@@ -0,0 +1,177 @@
+/*
+ * sync_planner_impl_tests.cpp
+ */
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/ods_error.h>
+#include <onedatashare/sync_planner.h>
+#include <onedatashare/transfer_service.h>
+
+#include <endpoint_impl.h>
+#include <sync_planner_impl.h>
+
+#include "mocks.h"
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Onedatashare_mocks::Listing_rest;
+using Onedatashare_mocks::dir_stat;
+using Onedatashare_mocks::file_stat;
+using Onedatashare_mocks::resource;
+
+/**
+ * Describes each job as a string, in the order the jobs are planned.
+ */
+std::vector<std::string> plan(const Ods::Sync_options& options,
+                              std::map<std::string, std::vector<std::string>> source_tree,
+                              std::map<std::string, std::vector<std::string>> destination_tree)
+{
+    const Ods::Internal::Endpoint_impl source {Ods::Endpoint_type::sftp,
+                                               "source_cred",
+                                               "token",
+                                               "url",
+                                               std::make_shared<Listing_rest>(std::move(source_tree))};
+    const Ods::Internal::Endpoint_impl destination {Ods::Endpoint_type::s3,
+                                                    "destination_cred",
+                                                    "token",
+                                                    "url",
+                                                    std::make_shared<Listing_rest>(std::move(destination_tree))};
+
+    std::vector<std::string> jobs {};
+    const auto join {[](const std::vector<std::string>& identifiers) {
+        std::string joined {};
+        for (const auto& identifier : identifiers) {
+            joined += (joined.empty() ? "" : ",") + identifier;
+        }
+        return joined;
+    }};
+    Ods::Internal::Sync_planner_impl {options}.plan(
+        source,
+        "/src",
+        destination,
+        "/dst",
+        [&](const Ods::Source& from, const Ods::Destination& to) {
+            EXPECT_EQ(from.type, Ods::Endpoint_type::sftp);
+            EXPECT_EQ(from.cred_id, "source_cred");
+            EXPECT_EQ(to.type, Ods::Endpoint_type::s3);
+            EXPECT_EQ(to.cred_id, "destination_cred");
+            jobs.push_back("transfer " + from.directory_identifier + " " + join(from.resource_identifiers) + " to " +
+                           to.directory_identifier);
+        },
+        [&](const Ods::Sync_delete& job) {
+            jobs.push_back("delete " + job.directory_identifier + " " + join(job.resource_identifiers));
+        });
+    return jobs;
+}
+
+class Sync_planner_impl_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that diff_listings transfers missing, resized, and newer files, recurses into matching directories, and
+ * replaces resources of the other kind.
+ */
+TEST_F(Sync_planner_impl_tests, DiffListingsComparesBySizeAndTime)
+{
+    const auto source {resource("src",
+                                0,
+                                0,
+                                std::nullopt,
+                                {{resource("same", 1, 100),
+                                  resource("newer", 1, 110),
+                                  resource("within_tolerance", 1, 102),
+                                  resource("resized", 2, 100),
+                                  resource("missing", 1, 100),
+                                  resource("dir", 0, 0, std::nullopt, {{}}),
+                                  resource("kind", 0, 0, std::nullopt, {{}})}})};
+    const auto destination {resource("dst",
+                                     0,
+                                     0,
+                                     std::nullopt,
+                                     {{resource("kind", 1, 100),
+                                       resource("dir", 0, 0, std::nullopt, {{}}),
+                                       resource("resized", 1, 200),
+                                       resource("within_tolerance", 1, 100),
+                                       resource("newer", 1, 100),
+                                       resource("extra", 1, 100),
+                                       resource("same", 1, 100)}})};
+
+    const auto type {Ods::Endpoint_type::sftp};
+    const auto diff {
+        Ods::Internal::diff_listings(Ods::Sync_options {}, type, "/src", source, type, "/dst/", destination)};
+
+    EXPECT_EQ(diff.transfers, (std::vector<std::string> {"kind", "missing", "newer", "resized"}));
+    EXPECT_EQ(diff.deletes, std::vector<std::string> {"kind"});
+    EXPECT_EQ(diff.directories, (std::vector<std::pair<std::string, std::string>> {{"/src/dir", "/dst/dir"}}));
+
+    const auto deleting {
+        Ods::Internal::diff_listings(Ods::Sync_options {true}, type, "/src", source, type, "/dst", destination)};
+    EXPECT_EQ(deleting.deletes, (std::vector<std::string> {"extra", "kind"}));
+}
+
+/**
+ * Tests that diff_listings names resources by id on endpoints that use ids.
+ */
+TEST_F(Sync_planner_impl_tests, DiffListingsUsesIds)
+{
+    const auto source {
+        resource("src", 0, 0, "0", {{resource("file", 1, 0, "1"), resource("dir", 0, 0, "2", {{}})}})};
+    const auto destination {resource("dst", 0, 0, "9", {{resource("dir", 0, 0, "8", {{}})}})};
+
+    const auto diff {Ods::Internal::diff_listings(Ods::Sync_options {},
+                                                  Ods::Endpoint_type::google_drive,
+                                                  "0",
+                                                  source,
+                                                  Ods::Endpoint_type::box,
+                                                  "9",
+                                                  destination)};
+
+    EXPECT_EQ(diff.transfers, std::vector<std::string> {"1"});
+    EXPECT_EQ(diff.directories, (std::vector<std::pair<std::string, std::string>> {{"2", "8"}}));
+}
+
+/**
+ * Tests that plan walks both trees, passing deletes before transfers for each directory in batches.
+ */
+TEST_F(Sync_planner_impl_tests, PlanEmitsBatchedJobs)
+{
+    const std::map<std::string, std::vector<std::string>> source_tree {
+        {"/src", {file_stat("a", 10), file_stat("b", 20, 100), dir_stat("c"), dir_stat("d"), file_stat("e", 5)}},
+        {"/src/c", {file_stat("x", 1)}},
+        {"/src/d", {file_stat("y", 1)}}};
+    const std::map<std::string, std::vector<std::string>> destination_tree {
+        {"/dst", {file_stat("a", 10), file_stat("b", 20, 50), dir_stat("d"), dir_stat("e"), file_stat("f", 1)}},
+        {"/dst/d", {file_stat("y", 1), file_stat("z", 2)}}};
+
+    EXPECT_EQ(plan(Ods::Sync_options {true, 2, 2}, source_tree, destination_tree),
+              (std::vector<std::string> {"delete /dst e,f",
+                                         "transfer /src b,c to /dst",
+                                         "transfer /src e to /dst",
+                                         "delete /dst/d z"}));
+    EXPECT_EQ(plan(Ods::Sync_options {}, source_tree, destination_tree),
+              (std::vector<std::string> {"delete /dst e", "transfer /src b,c,e to /dst"}));
+}
+
+/**
+ * Tests that a failed listing raises an Unexpected_response_error.
+ */
+TEST_F(Sync_planner_impl_tests, PlanThrowsWhenListingFails)
+{
+    const std::map<std::string, std::vector<std::string>> source_tree {{"/src", {dir_stat("a")}}, {"/src/a", {}}};
+    const std::map<std::string, std::vector<std::string>> destination_tree {{"/dst", {dir_stat("a")}}};
+
+    EXPECT_THROW(plan(Ods::Sync_options {}, source_tree, destination_tree), Ods::Unexpected_response_error);
+}
+
+} // namespace
@@ -0,0 +1,251 @@
+/*
+ * transfer_monitor_impl_tests.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/ods_error.h>
+#include <onedatashare/transfer_monitor.h>
+
+#include <transfer_monitor_impl.h>
+#include <transfer_service_impl.h>
+
+#include "mocks.h"
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+using Onedatashare_mocks::Recorder;
+using std::chrono::milliseconds;
+
+/**
+ * Creates a status of the specified job.
+ */
+std::unique_ptr<Ods::Transfer_status> status(const std::string& id,
+                                             Ods::Transfer_state state,
+                                             std::uint64_t bytes = 0,
+                                             std::uint64_t files_done = 0,
+                                             std::uint64_t files_total = 10)
+{
+    return std::make_unique<Ods::Internal::Transfer_status_impl>(
+        id, state, bytes, files_done, files_total, std::nullopt, std::nullopt, std::nullopt, std::nullopt);
+}
+
+/**
+ * Options polling quickly so that tests complete promptly.
+ */
+Ods::Internal::Transfer_monitor_options quick_options()
+{
+    return Ods::Internal::Transfer_monitor_options {milliseconds {1}, milliseconds {5}};
+}
+
+/**
+ * Poller answering each job with the next of its scripted statuses, repeating the last one once the script runs out.
+ * A job without a script is omitted from the response, and a script entry without a status makes the whole poll
+ * throw.
+ */
+class Scripted_poller {
+public:
+    void script(const std::string& id, std::vector<std::unique_ptr<Ods::Transfer_status>> statuses)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        scripts_[id] = std::deque<std::unique_ptr<Ods::Transfer_status>> {std::make_move_iterator(statuses.begin()),
+                                                                           std::make_move_iterator(statuses.end())};
+    }
+
+    Ods::Internal::Transfer_status_map operator()(const std::vector<std::string>& ids)
+    {
+        const std::lock_guard<std::mutex> lock {mutex_};
+        ++polls_;
+        polled_ids_ += ids.size();
+
+        Ods::Internal::Transfer_status_map statuses {};
+        for (const auto& id : ids) {
+            const auto script {scripts_.find(id)};
+            if (script == scripts_.end()) {
+                continue;
+            }
+            auto& queue {script->second};
+            if (!queue.front()) {
+                queue.pop_front();
+                throw Ods::Connection_error {"unreachable"};
+            }
+            const auto& next {static_cast<const Ods::Internal::Transfer_status_impl&>(*queue.front())};
+            statuses.emplace(id, std::make_unique<Ods::Internal::Transfer_status_impl>(next));
+            if (queue.size() > 1) {
+                queue.pop_front();
+            }
+        }
+        return statuses;
+    }
+
+    std::atomic<int> polls_ {0};
+    std::atomic<std::size_t> polled_ids_ {0};
+
+private:
+    std::mutex mutex_ {};
+    std::map<std::string, std::deque<std::unique_ptr<Ods::Transfer_status>>> scripts_ {};
+};
+
+/** Event reported for a tracked job, along with the id of the job. */
+using Job_event = std::pair<std::string, Ods::Transfer_event_type>;
+
+/**
+ * Creates an event callback passing each event of a tracked job to the specified recorder.
+ */
+std::function<void(Ods::Transfer_event_type, const Ods::Transfer_status&)> on_event(Recorder<Job_event>& recorder)
+{
+    return [&recorder](Ods::Transfer_event_type type, const Ods::Transfer_status& status) {
+        recorder.event({status.id(), type});
+    };
+}
+
+/**
+ * Waits for the specified number of tracked jobs to end.
+ */
+bool wait_for_ended(Recorder<Job_event>& recorder, std::size_t count)
+{
+    return recorder.wait_until([count](const std::vector<Job_event>& events) {
+        return static_cast<std::size_t>(std::count_if(events.begin(), events.end(), [](const Job_event& event) {
+                   return event.second != Ods::Transfer_event_type::progress;
+               })) >= count;
+    });
+}
+
+/**
+ * Gets the kinds of the recorded events of the specified job, in the order they were reported.
+ */
+std::vector<Ods::Transfer_event_type> events_of(Recorder<Job_event>& recorder, const std::string& id)
+{
+    std::vector<Ods::Transfer_event_type> types {};
+    for (const auto& [job_id, type] : recorder.events()) {
+        if (job_id == id) {
+            types.push_back(type);
+        }
+    }
+    return types;
+}
+
+class Transfer_monitor_impl_tests : public ::testing::Test {
+};
+
+/**
+ * Tests that jobs are polled often while queued, starting, or nearly done, and less often in steady progress.
+ */
+TEST_F(Transfer_monitor_impl_tests, NextPollIntervalAdapts)
+{
+    const Ods::Internal::Transfer_monitor_options options {milliseconds {100}, milliseconds {1000}, 2.0, 0.9};
+    const auto next {[&options](const Ods::Transfer_status& status, milliseconds current) {
+        return Ods::Internal::next_poll_interval(options, status, current);
+    }};
+
+    EXPECT_EQ(next(*status("a", Ods::Transfer_state::queued), milliseconds {400}), milliseconds {100});
+    EXPECT_EQ(next(*status("a", Ods::Transfer_state::running, 0), milliseconds {400}), milliseconds {100});
+    EXPECT_EQ(next(*status("a", Ods::Transfer_state::running, 10, 2), milliseconds {400}), milliseconds {800});
+    EXPECT_EQ(next(*status("a", Ods::Transfer_state::running, 10, 2), milliseconds {800}), milliseconds {1000});
+    EXPECT_EQ(next(*status("a", Ods::Transfer_state::running, 10, 9), milliseconds {800}), milliseconds {100});
+}
+
+/**
+ * Tests that each change in progress is reported once, and that a job stops being polled once it ends.
+ */
+TEST_F(Transfer_monitor_impl_tests, ReportsProgressUntilEnded)
+{
+    const auto poller {std::make_shared<Scripted_poller>()};
+    std::vector<std::unique_ptr<Ods::Transfer_status>> running {};
+    running.push_back(status("running", Ods::Transfer_state::queued));
+    running.push_back(status("running", Ods::Transfer_state::running, 10, 1));
+    running.push_back(status("running", Ods::Transfer_state::running, 10, 1));
+    running.push_back(status("running", Ods::Transfer_state::running, 20, 5));
+    running.push_back(status("running", Ods::Transfer_state::completed, 30, 10));
+    poller->script("running", std::move(running));
+    std::vector<std::unique_ptr<Ods::Transfer_status>> failed {};
+    failed.push_back(status("failed", Ods::Transfer_state::failed));
+    poller->script("failed", std::move(failed));
+
+    Recorder<Job_event> recorder {};
+    {
+        Ods::Internal::Transfer_monitor_impl monitor {[poller](const auto& ids) { return (*poller)(ids); },
+                                                      quick_options()};
+        monitor.track("running", on_event(recorder), recorder.on_error());
+        monitor.track("failed", on_event(recorder), recorder.on_error());
+        ASSERT_TRUE(wait_for_ended(recorder, 2));
+
+        // give the monitor time to poll again if it still tracked either job
+        const auto polled {poller->polled_ids_.load()};
+        std::this_thread::sleep_for(milliseconds {20});
+        EXPECT_EQ(poller->polled_ids_, polled);
+    }
+
+    using Type = Ods::Transfer_event_type;
+    EXPECT_EQ(events_of(recorder, "running"),
+              (std::vector<Type> {Type::progress, Type::progress, Type::progress, Type::completed}));
+    EXPECT_EQ(events_of(recorder, "failed"), std::vector<Type> {Type::failed});
+    EXPECT_EQ(recorder.errors("running"), 0);
+    EXPECT_EQ(recorder.errors("failed"), 0);
+}
+
+/**
+ * Tests that failed polls and statuses missing from a poll are reported as errors and the job keeps being tracked.
+ */
+TEST_F(Transfer_monitor_impl_tests, ReportsErrorsAndKeepsTracking)
+{
+    const auto poller {std::make_shared<Scripted_poller>()};
+    std::vector<std::unique_ptr<Ods::Transfer_status>> script {};
+    script.push_back(nullptr);
+    script.push_back(status("job", Ods::Transfer_state::cancelled));
+    poller->script("job", std::move(script));
+
+    Recorder<Job_event> recorder {};
+    Ods::Internal::Transfer_monitor_impl monitor {[poller](const auto& ids) { return (*poller)(ids); },
+                                                  quick_options()};
+    monitor.track("job", on_event(recorder), recorder.on_error());
+    monitor.track("missing", on_event(recorder), recorder.on_error());
+    ASSERT_TRUE(wait_for_ended(recorder, 1));
+
+    EXPECT_EQ(events_of(recorder, "job"), std::vector<Ods::Transfer_event_type> {Ods::Transfer_event_type::cancelled});
+    EXPECT_GE(recorder.errors("job"), 1);
+    EXPECT_GE(recorder.errors("missing"), 1);
+}
+
+/**
+ * Tests that jobs due at the same time are polled together.
+ */
+TEST_F(Transfer_monitor_impl_tests, PollsDueJobsTogether)
+{
+    constexpr auto jobs {2000};
+    const auto poller {std::make_shared<Scripted_poller>()};
+    for (auto i {0}; i < jobs; ++i) {
+        std::vector<std::unique_ptr<Ods::Transfer_status>> script {};
+        script.push_back(status(std::to_string(i), Ods::Transfer_state::completed));
+        poller->script(std::to_string(i), std::move(script));
+    }
+
+    Recorder<Job_event> recorder {};
+    Ods::Internal::Transfer_monitor_impl monitor {[poller](const auto& ids) { return (*poller)(ids); },
+                                                  quick_options()};
+    for (auto i {0}; i < jobs; ++i) {
+        monitor.track(std::to_string(i), on_event(recorder), recorder.on_error());
+    }
+    ASSERT_TRUE(wait_for_ended(recorder, jobs));
+
+    EXPECT_EQ(poller->polled_ids_, jobs);
+    EXPECT_LT(poller->polls_, jobs / 10);
+}
+
+} // namespace
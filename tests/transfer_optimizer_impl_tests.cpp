@@ -0,0 +1,191 @@
+/*
+ * transfer_optimizer_impl_tests.cpp
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <onedatashare/endpoint.h>
+#include <onedatashare/transfer_optimizer.h>
+#include <onedatashare/transfer_service.h>
+
+#include <transfer_optimizer_impl.h>
+
+namespace {
+
+namespace Ods = Onedatashare;
+
+constexpr std::uint64_t mib {1024 * 1024};
+
+const Ods::Source source {Ods::Endpoint_type::sftp, "source_cred", "/src", {}};
+const Ods::Destination destination {Ods::Endpoint_type::s3, "destination_cred", "/dst"};
+
+/** Profile of a dataset of small files. */
+const Ods::Dataset_profile small_files {1000, 1000 * 4096};
+
+/**
+ * Creates a Resource with the specified name, id, and size.
+ */
+Ods::Resource resource(const std::string& name, std::optional<std::string> id, long size)
+{
+    return Ods::Resource {std::move(id), name, size, 0, false, true, std::nullopt, std::nullopt, std::nullopt};
+}
+
+/**
+ * Describes the concurrency, parallelism, and pipelining of the specified options.
+ */
+std::vector<int> describe(const Ods::Transfer_options& options)
+{
+    return {options.concurrency.value_or(0), options.parallelism.value_or(0), options.pipelining.value_or(0)};
+}
+
+class Transfer_optimizer_impl_tests : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + "transfer_optimizer_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    void TearDown() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    std::string path_ {};
+};
+
+/**
+ * Tests that the initial options favour concurrency and pipelining for small files and parallelism for large files.
+ */
+TEST_F(Transfer_optimizer_impl_tests, InitialOptionsFollowFileSize)
+{
+    const auto small {Ods::Internal::initial_options(small_files)};
+    const auto medium {Ods::Internal::initial_options(Ods::Dataset_profile {10, 10 * 50 * mib})};
+    const auto large {Ods::Internal::initial_options(Ods::Dataset_profile {2, 2 * 1024 * mib})};
+    const auto empty {Ods::Internal::initial_options(Ods::Dataset_profile {})};
+
+    EXPECT_GT(small.concurrency, medium.concurrency);
+    EXPECT_GT(medium.concurrency, large.concurrency);
+    EXPECT_GT(small.pipelining, large.pipelining);
+    EXPECT_LT(small.parallelism, medium.parallelism);
+    EXPECT_LT(medium.parallelism, large.parallelism);
+    EXPECT_EQ(empty.concurrency, small.concurrency);
+}
+
+/**
+ * Tests that profile_dataset sums the sizes of the named resources only, by name or by id depending on the endpoint,
+ * or of the whole directory when no resources are named.
+ */
+TEST_F(Transfer_optimizer_impl_tests, ProfileDatasetSumsNamedResources)
+{
+    const Ods::Resource directory {std::nullopt,
+                                   "dir",
+                                   0,
+                                   0,
+                                   true,
+                                   false,
+                                   std::nullopt,
+                                   std::nullopt,
+                                   {{resource("a", "1", 100), resource("b", "2", 20), resource("c", "3", 3)}}};
+
+    const auto by_name {Ods::Internal::profile_dataset(Ods::Endpoint_type::sftp, directory, {"a", "c", "missing"})};
+    EXPECT_EQ(by_name.file_count, 3);
+    EXPECT_EQ(by_name.total_bytes, 103);
+
+    const auto by_id {Ods::Internal::profile_dataset(Ods::Endpoint_type::google_drive, directory, {"2", "a"})};
+    EXPECT_EQ(by_id.file_count, 2);
+    EXPECT_EQ(by_id.total_bytes, 20);
+
+    const auto whole {Ods::Internal::profile_dataset(Ods::Endpoint_type::sftp, directory, {})};
+    EXPECT_EQ(whole.file_count, 3);
+    EXPECT_EQ(whole.total_bytes, 123);
+}
+
+/**
+ * Tests that each option is doubled and halved in turn, keeping changes that improve the throughput, and that each
+ * kind of transfer is tuned separately.
+ */
+TEST_F(Transfer_optimizer_impl_tests, HillClimbsOnThroughput)
+{
+    Ods::Internal::Transfer_optimizer_impl optimizer {""};
+    const auto step {[&optimizer](double throughput) {
+        const auto options {optimizer.recommend(source, destination, small_files)};
+        optimizer.record(source, destination, small_files, options, throughput);
+        return describe(options);
+    }};
+
+    EXPECT_EQ(step(100), (std::vector<int> {32, 1, 16}));
+    // doubling the concurrency improves the throughput, so it is kept
+    EXPECT_EQ(step(150), (std::vector<int> {64, 1, 16}));
+    // the concurrency cannot be doubled again, so it is halved, which is worse
+    EXPECT_EQ(step(100), (std::vector<int> {32, 1, 16}));
+    // a change within the noise of the measurement is not kept
+    EXPECT_EQ(step(151), (std::vector<int> {64, 2, 16}));
+    EXPECT_EQ(step(100), (std::vector<int> {64, 1, 32}));
+    EXPECT_EQ(step(100), (std::vector<int> {64, 1, 8}));
+    // every option has been tried in both directions, so the search starts again from the first
+    EXPECT_EQ(describe(optimizer.recommend(source, destination, small_files)), (std::vector<int> {32, 1, 16}));
+
+    const Ods::Dataset_profile large_files {2, 2 * 1024 * mib};
+    EXPECT_EQ(describe(optimizer.recommend(source, destination, large_files)), (std::vector<int> {4, 8, 1}));
+
+    // reports of options left unset are ignored
+    optimizer.record(source, destination, large_files, Ods::Transfer_options {}, 100);
+    EXPECT_EQ(describe(optimizer.recommend(source, destination, large_files)), (std::vector<int> {4, 8, 1}));
+}
+
+/**
+ * Tests that failed transfers, reported with a throughput of 0, move the search on rather than recommending the same
+ * options again, even when the first transfer of a kind fails.
+ */
+TEST_F(Transfer_optimizer_impl_tests, FailuresMoveSearchOn)
+{
+    Ods::Internal::Transfer_optimizer_impl optimizer {""};
+    const auto step {[&optimizer](double throughput) {
+        const auto options {optimizer.recommend(source, destination, small_files)};
+        optimizer.record(source, destination, small_files, options, throughput);
+        return describe(options);
+    }};
+
+    EXPECT_EQ(step(0), (std::vector<int> {32, 1, 16}));
+    EXPECT_EQ(step(0), (std::vector<int> {64, 1, 16}));
+    EXPECT_EQ(step(0), (std::vector<int> {16, 1, 16}));
+    // the first options that succeed beat the failed ones and become the best
+    EXPECT_EQ(step(100), (std::vector<int> {32, 2, 16}));
+    EXPECT_EQ(step(0), (std::vector<int> {32, 4, 16}));
+    EXPECT_EQ(describe(optimizer.recommend(source, destination, small_files)), (std::vector<int> {32, 1, 16}));
+}
+
+/**
+ * Tests that tuning carries over to a new optimizer loading the same history file, and that a malformed history file
+ * starts tuning afresh.
+ */
+TEST_F(Transfer_optimizer_impl_tests, HistoryCarriesOverBetweenRuns)
+{
+    std::vector<int> expected {};
+    {
+        const auto optimizer {Ods::Transfer_optimizer::create(path_)};
+        for (auto throughput : {100, 200, 150, 300}) {
+            const auto options {optimizer->recommend(source, destination, small_files)};
+            optimizer->record(source, destination, small_files, options, throughput);
+        }
+        expected = describe(optimizer->recommend(source, destination, small_files));
+    }
+    EXPECT_EQ(expected, (std::vector<int> {64, 4, 16}));
+
+    const auto reloaded {Ods::Transfer_optimizer::create(path_)};
+    EXPECT_EQ(describe(reloaded->recommend(source, destination, small_files)), expected);
+
+    std::ofstream {path_, std::ios::trunc} << "not a history file\n";
+    const auto afresh {Ods::Transfer_optimizer::create(path_)};
+    EXPECT_EQ(describe(afresh->recommend(source, destination, small_files)), (std::vector<int> {32, 1, 16}));
+}
+
+} // namespace
@@ -4,8 +4,15 @@
  * 7/23/20
  */
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -13,7 +20,9 @@
 #include <simdjson/simdjson.h>
 
 #include <onedatashare/ods_error.h>
+#include <onedatashare/transfer_optimizer.h>
 
+#include <endpoint_impl.h>
 #include <ods_rest_api.h>
 #include <transfer_service_impl.h>
 #include <util.h>
@@ -211,4 +220,442 @@ TEST_F(Transfer_service_impl_tests, TransferSendsData)
     }
 }
 
-} // namespace
\ No newline at end of file
+/**
+ * Tests that transfer_async holds the correct job id.
+ */
+TEST_F(Transfer_service_impl_tests, TransferAsyncReturnsJobId)
+{
+    std::string job_id {"this is the job id"};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post).WillOnce(Return(Ods::Internal::Response {Header_map {}, job_id, 200}));
+
+    Ods::Internal::Transfer_service_impl transfer {"", "", std::move(caller)};
+
+    Ods::Source src {Ods::Endpoint_type::sftp, "", "", Str_vec {}};
+    Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+
+    EXPECT_EQ(transfer.transfer_async(src, dest, Ods::Transfer_options {}).get(), job_id);
+}
+
+/**
+ * Tests that transfer sends only the options that are set, and sends no options object when none are.
+ */
+TEST_F(Transfer_service_impl_tests, TransferSendsOptions)
+{
+    namespace Api = Ods::Internal::Api;
+
+    std::vector<std::string> requests {};
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post)
+        .Times(2)
+        .WillRepeatedly([&requests](const std::string&, const Header_map&, const std::string& data) {
+            requests.push_back(data);
+            return Ods::Internal::Response {Header_map {}, "job", 200};
+        });
+
+    Ods::Internal::Transfer_service_impl transfer {"", "", std::move(caller)};
+    const Ods::Source src {Ods::Endpoint_type::sftp, "", "", Str_vec {}};
+    const Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+
+    Ods::Transfer_options opt {};
+    opt.concurrency = 8;
+    opt.parallelism = 4;
+    opt.pipelining = 16;
+    opt.chunk_size = 64ULL * 1024 * 1024 * 1024;
+    opt.compress = false;
+    opt.verify = true;
+    transfer.transfer(src, dest, opt);
+    transfer.transfer(src, dest, Ods::Transfer_options {});
+
+    simdjson::dom::parser parser {};
+    const auto options {parser.parse(requests[0])[Api::transfer_job_request_options]};
+    EXPECT_EQ(options[Api::transfer_options_concurrency].get_uint64().value(), 8);
+    EXPECT_EQ(options[Api::transfer_options_parallelism].get_uint64().value(), 4);
+    EXPECT_EQ(options[Api::transfer_options_pipelining].get_uint64().value(), 16);
+    EXPECT_EQ(options[Api::transfer_options_chunk_size].get_uint64().value(), 64ULL * 1024 * 1024 * 1024);
+    EXPECT_FALSE(options[Api::transfer_options_compress].get_bool().value());
+    EXPECT_TRUE(options[Api::transfer_options_verify].get_bool().value());
+
+    EXPECT_EQ(parser.parse(requests[1])[Api::transfer_job_request_options].error(), simdjson::NO_SUCH_FIELD);
+}
+
+/**
+ * Tests that transfer and transfer_async reject options that are not positive without sending a request.
+ */
+TEST_F(Transfer_service_impl_tests, TransferRejectsInvalidOptions)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post).Times(0);
+
+    Ods::Internal::Transfer_service_impl transfer {"", "", std::move(caller)};
+    const Ods::Source src {Ods::Endpoint_type::sftp, "", "", Str_vec {}};
+    const Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+
+    Ods::Transfer_options zero_streams {};
+    zero_streams.parallelism = 0;
+    Ods::Transfer_options negative_files {};
+    negative_files.concurrency = -1;
+    Ods::Transfer_options zero_chunk {};
+    zero_chunk.chunk_size = 0;
+
+    EXPECT_THROW(transfer.transfer(src, dest, zero_streams), std::invalid_argument);
+    EXPECT_THROW(transfer.transfer(src, dest, zero_chunk), std::invalid_argument);
+    EXPECT_THROW(transfer.transfer_async(src, dest, negative_files), std::invalid_argument);
+}
+
+/**
+ * Optimizer recommending fixed options and passing each report to a promise.
+ */
+class Recording_optimizer : public Ods::Transfer_optimizer {
+public:
+    Ods::Transfer_options recommend(const Ods::Source&,
+                                    const Ods::Destination&,
+                                    const Ods::Dataset_profile& profile) override
+    {
+        profile_ = profile;
+        Ods::Transfer_options options {};
+        options.concurrency = 3;
+        return options;
+    }
+
+    void record(const Ods::Source&,
+                const Ods::Destination&,
+                const Ods::Dataset_profile&,
+                const Ods::Transfer_options& options,
+                double throughput) override
+    {
+        recorded_.set_value({options.concurrency.value_or(0), throughput});
+    }
+
+    Ods::Dataset_profile profile_ {};
+    std::promise<std::pair<int, double>> recorded_ {};
+};
+
+/**
+ * Tests that transfer_optimized sends the options recommended for the listed resources and reports the throughput of
+ * the completed job.
+ */
+TEST_F(Transfer_service_impl_tests, TransferOptimizedReportsThroughput)
+{
+    namespace Api = Ods::Internal::Api;
+
+    auto list_caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*list_caller, get)
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {},
+            R"({"name":"src","size":0,"time":0,"dir":true,"file":false,"files":[)"
+            R"({"name":"a","size":100,"time":0,"dir":false,"file":true},)"
+            R"({"name":"b","size":50,"time":0,"dir":false,"file":true}]})",
+            200}));
+    const Ods::Internal::Endpoint_impl endpoint {
+        Ods::Endpoint_type::sftp, "cred", "", "ods", std::move(list_caller)};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post).WillOnce([](const std::string&, const Header_map&, const std::string& data) {
+        simdjson::dom::parser parser {};
+        const auto options {parser.parse(data)[Api::transfer_job_request_options]};
+        EXPECT_EQ(options[Api::transfer_options_concurrency].get_uint64().value(), 3);
+        return Ods::Internal::Response {Header_map {}, "job", 200};
+    });
+    EXPECT_CALL(*caller, get)
+        .WillRepeatedly(Return(Ods::Internal::Response {
+            Header_map {}, R"([{"id":"job","status":"COMPLETED","filesTotal":1,"throughput":42.5}])", 200}));
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+
+    const auto optimizer {std::make_shared<Recording_optimizer>()};
+    auto recorded {optimizer->recorded_.get_future()};
+    const Ods::Source src {Ods::Endpoint_type::sftp, "cred", "/src", Str_vec {"a"}};
+    const Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+
+    EXPECT_EQ(transfer.transfer_optimized(src, dest, endpoint, optimizer), "job");
+    EXPECT_EQ(optimizer->profile_.file_count, 1);
+    EXPECT_EQ(optimizer->profile_.total_bytes, 100);
+    ASSERT_EQ(recorded.wait_for(std::chrono::seconds {5}), std::future_status::ready);
+    EXPECT_EQ(recorded.get(), (std::pair<int, double> {3, 42.5}));
+}
+
+/**
+ * Tests that transfer_optimized reports a throughput of 0 for a job that fails, and for a job whose status repeatedly
+ * cannot be checked, so that the optimizer moves past the options it used, and stops checking the job once reported.
+ * A source naming no resources is profiled as the whole directory.
+ */
+TEST_F(Transfer_service_impl_tests, TransferOptimizedReportsFailuresAsZero)
+{
+    const auto listing {Ods::Internal::Response {
+        Header_map {},
+        R"({"name":"src","size":0,"time":0,"dir":true,"file":false,"files":[)"
+        R"({"name":"a","size":100,"time":0,"dir":false,"file":true},)"
+        R"({"name":"b","size":50,"time":0,"dir":false,"file":true}]})",
+        200}};
+    const Ods::Source src {Ods::Endpoint_type::sftp, "cred", "/src", Str_vec {}};
+    const Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+
+    for (const auto& status_response :
+         {Ods::Internal::Response {Header_map {}, R"([{"id":"job","status":"FAILED","filesTotal":1}])", 200},
+          Ods::Internal::Response {Header_map {}, "", 500}}) {
+        auto list_caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*list_caller, get).WillOnce(Return(listing));
+        const Ods::Internal::Endpoint_impl endpoint {
+            Ods::Endpoint_type::sftp, "cred", "", "ods", std::move(list_caller)};
+
+        auto caller {std::make_unique<Rest_mock>()};
+        EXPECT_CALL(*caller, post).WillOnce(Return(Ods::Internal::Response {Header_map {}, "job", 200}));
+        std::atomic<int> polls {0};
+        EXPECT_CALL(*caller, get).WillRepeatedly([&polls, &status_response](const std::string&, const Header_map&) {
+            ++polls;
+            return status_response;
+        });
+        const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+
+        const auto optimizer {std::make_shared<Recording_optimizer>()};
+        auto recorded {optimizer->recorded_.get_future()};
+
+        EXPECT_EQ(transfer.transfer_optimized(src, dest, endpoint, optimizer), "job");
+        EXPECT_EQ(optimizer->profile_.file_count, 2);
+        EXPECT_EQ(optimizer->profile_.total_bytes, 150);
+        ASSERT_EQ(recorded.wait_for(std::chrono::seconds {10}), std::future_status::ready);
+        EXPECT_EQ(recorded.get(), (std::pair<int, double> {3, 0}));
+
+        // the next poll would have been due well within the wait had the job still been tracked
+        const auto reported_polls {polls.load()};
+        std::this_thread::sleep_for(std::chrono::seconds {3});
+        EXPECT_EQ(polls.load(), reported_polls);
+    }
+}
+
+/**
+ * Tests that transfer_sharded starts one job per shard, balanced by the listed sizes, and hands back the sources of
+ * shards that could not be started.
+ */
+TEST_F(Transfer_service_impl_tests, TransferShardedSubmitsBalancedShards)
+{
+    namespace Api = Ods::Internal::Api;
+
+    auto list_caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*list_caller, get)
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {},
+            R"({"name":"src","size":0,"time":0,"dir":true,"file":false,"files":[)"
+            R"({"name":"a","size":100,"time":0,"dir":false,"file":true},)"
+            R"({"name":"b","size":60,"time":0,"dir":false,"file":true},)"
+            R"({"name":"c","size":50,"time":0,"dir":false,"file":true},)"
+            R"({"name":"d","size":40,"time":0,"dir":false,"file":true}]})",
+            200}));
+    const Ods::Internal::Endpoint_impl endpoint {
+        Ods::Endpoint_type::sftp, "cred", "", "ods", std::move(list_caller)};
+
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, post)
+        .Times(3)
+        .WillRepeatedly([](const std::string&, const Header_map&, const std::string& data) {
+            simdjson::dom::parser parser {};
+            std::string names {};
+            for (const auto info : parser.parse(data)[Api::transfer_job_request_source][Api::source_info_list]) {
+                names += info[Api::entity_info_id].get_c_str().value();
+            }
+            if (names == "cd") {
+                return Ods::Internal::Response {Header_map {}, "", 500};
+            }
+            return Ods::Internal::Response {Header_map {}, "job " + names, 200};
+        });
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+
+    const Ods::Source src {Ods::Endpoint_type::sftp, "cred", "/src", Str_vec {"a", "b", "c", "d"}};
+    const Ods::Destination dest {Ods::Endpoint_type::s3, "", ""};
+    const auto job {transfer.transfer_sharded(src, dest, Ods::Transfer_options {}, endpoint, 3)};
+
+    EXPECT_EQ(job.job_ids, (Str_vec {"job a", "job b"}));
+    ASSERT_EQ(job.unsubmitted.size(), 1);
+    EXPECT_EQ(job.unsubmitted[0].cred_id, "cred");
+    EXPECT_EQ(job.unsubmitted[0].directory_identifier, "/src");
+    EXPECT_EQ(job.unsubmitted[0].resource_identifiers, (Str_vec {"c", "d"}));
+}
+
+/**
+ * Tests that status_sharded sums the progress of the sub-jobs and reports the combined job running until every
+ * sub-job ends, then failed if any sub-job failed.
+ */
+TEST_F(Transfer_service_impl_tests, StatusShardedCombinesStatuses)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {},
+            R"([{"id":"a","status":"COMPLETED","bytesTransferred":3000,"filesDone":2,"filesTotal":2,)"
+            R"("startTime":2000,"endTime":4000,"lastUpdated":4000},)"
+            R"({"id":"b","status":"RUNNING","bytesTransferred":1000,"filesDone":1,"filesTotal":3,)"
+            R"("startTime":1000,"lastUpdated":3000}])",
+            200}))
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {},
+            R"([{"id":"a","status":"COMPLETED","filesTotal":2,"throughput":10},)"
+            R"({"id":"b","status":"FAILED","filesTotal":3,"throughput":5}])",
+            200}));
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+    const Ods::Sharded_job job {Str_vec {"a", "b"}, {}};
+
+    const auto running {transfer.status_sharded(job)};
+    EXPECT_EQ(running->id(), "a,b");
+    EXPECT_EQ(running->state(), Ods::Transfer_state::running);
+    EXPECT_EQ(running->bytes_transferred(), 4000);
+    EXPECT_EQ(running->files_done(), 3);
+    EXPECT_EQ(running->files_total(), 5);
+    EXPECT_EQ(running->start_time(), 1000);
+    EXPECT_EQ(running->end_time(), std::nullopt);
+    EXPECT_EQ(running->last_updated(), 4000);
+    EXPECT_DOUBLE_EQ(running->throughput(), 4000 * 1000.0 / 3000);
+
+    const auto failed {transfer.status_sharded(job)};
+    EXPECT_EQ(failed->state(), Ods::Transfer_state::failed);
+    EXPECT_DOUBLE_EQ(failed->throughput(), 15);
+}
+
+/**
+ * Tests that status_sharded counts the files of unsubmitted shards and reports the combined job failed once its
+ * started sub-jobs end, and that it rejects a job with no started sub-jobs without sending a request.
+ */
+TEST_F(Transfer_service_impl_tests, StatusShardedAccountsForUnsubmittedShards)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {}, R"([{"id":"a","status":"RUNNING","filesDone":1,"filesTotal":2}])", 200}))
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {}, R"([{"id":"a","status":"COMPLETED","filesDone":2,"filesTotal":2}])", 200}));
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+    const Ods::Sharded_job job {Str_vec {"a"}, {Ods::Source {Ods::Endpoint_type::sftp, "", "", Str_vec {"c", "d"}}}};
+
+    const auto running {transfer.status_sharded(job)};
+    EXPECT_EQ(running->state(), Ods::Transfer_state::running);
+    EXPECT_EQ(running->files_total(), 4);
+
+    const auto ended {transfer.status_sharded(job)};
+    EXPECT_EQ(ended->state(), Ods::Transfer_state::failed);
+    EXPECT_EQ(ended->files_done(), 2);
+    EXPECT_EQ(ended->files_total(), 4);
+
+    const Ods::Sharded_job unstarted {Str_vec {}, {Ods::Source {Ods::Endpoint_type::sftp, "", "", Str_vec {"c"}}}};
+    EXPECT_THROW(transfer.status_sharded(unstarted), std::invalid_argument);
+}
+
+/**
+ * Tests that status parses every field of the job status, computing the throughput when it is not reported.
+ */
+TEST_F(Transfer_service_impl_tests, StatusParsesFields)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .WillOnce([](const std::string& url, const Header_map&) {
+            EXPECT_EQ(url, "ods/api/transfer-job/status?ids=running");
+            return Ods::Internal::Response {
+                Header_map {},
+                R"([{"id":"running","status":"RUNNING","bytesTransferred":4000,"filesDone":1,"filesTotal":3,)"
+                R"("throughput":null,"startTime":1000,"endTime":null,"lastUpdated":3000}])",
+                200};
+        })
+        .WillOnce(Return(Ods::Internal::Response {
+            Header_map {},
+            R"([{"id":"queued","status":"QUEUED","filesTotal":2,"throughput":12.5}])",
+            200}));
+
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+
+    const auto running {transfer.status("running")};
+    EXPECT_EQ(running->id(), "running");
+    EXPECT_EQ(running->state(), Ods::Transfer_state::running);
+    EXPECT_EQ(running->bytes_transferred(), 4000);
+    EXPECT_EQ(running->files_done(), 1);
+    EXPECT_EQ(running->files_total(), 3);
+    EXPECT_DOUBLE_EQ(running->throughput(), 2000);
+    EXPECT_EQ(running->start_time(), 1000);
+    EXPECT_EQ(running->end_time(), std::nullopt);
+    EXPECT_EQ(running->last_updated(), 3000);
+
+    const auto queued {transfer.status("queued")};
+    EXPECT_EQ(queued->state(), Ods::Transfer_state::queued);
+    EXPECT_EQ(queued->bytes_transferred(), 0);
+    EXPECT_DOUBLE_EQ(queued->throughput(), 12.5);
+    EXPECT_EQ(queued->start_time(), std::nullopt);
+}
+
+/**
+ * Tests that status_many checks each distinct id once, in batches, and returns the statuses in the order of the ids.
+ */
+TEST_F(Transfer_service_impl_tests, StatusManyBatchesIds)
+{
+    Str_vec ids {};
+    for (auto i {0}; i < 250; ++i) {
+        ids.push_back("job" + std::to_string(i));
+    }
+    ids.push_back("job7");
+
+    std::vector<std::string> urls {};
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).Times(3).WillRepeatedly([&urls](const std::string& url, const Header_map&) {
+        urls.push_back(url);
+
+        // answer with the requested ids in reverse order
+        std::vector<std::string> requested {};
+        for (auto begin {url.find('=') + 1}; begin <= url.size();) {
+            const auto end {std::min(url.find(',', begin), url.size())};
+            requested.push_back(url.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        std::string body {"["};
+        for (auto id {requested.rbegin()}; id != requested.rend(); ++id) {
+            body += (body.size() > 1 ? "," : "") + (R"({"id":")" + *id + R"(","status":"COMPLETED"})");
+        }
+        return Ods::Internal::Response {Header_map {}, body + "]", 200};
+    });
+
+    const Ods::Internal::Transfer_service_impl transfer {"", "", std::move(caller)};
+    const auto statuses {transfer.status_many(ids)};
+
+    ASSERT_EQ(statuses.size(), ids.size());
+    for (std::size_t i {0}; i < ids.size(); ++i) {
+        EXPECT_EQ(statuses[i]->id(), ids[i]);
+        EXPECT_EQ(statuses[i]->state(), Ods::Transfer_state::completed);
+    }
+    std::unordered_set<std::string> distinct_urls {urls.begin(), urls.end()};
+    EXPECT_EQ(distinct_urls.size(), 3);
+    EXPECT_TRUE(transfer.status_many(Str_vec {}).empty());
+}
+
+/**
+ * Tests that status escapes job ids in the query string so that an id cannot be split into several ids.
+ */
+TEST_F(Transfer_service_impl_tests, StatusEscapesIds)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get).WillOnce([](const std::string& url, const Header_map&) {
+        EXPECT_EQ(url, "ods/api/transfer-job/status?ids=a%2Cb%26c");
+        return Ods::Internal::Response {Header_map {}, R"([{"id":"a,b&c","status":"COMPLETED"}])", 200};
+    });
+
+    const Ods::Internal::Transfer_service_impl transfer {"", "ods", std::move(caller)};
+
+    EXPECT_EQ(transfer.status("a,b&c")->state(), Ods::Transfer_state::completed);
+}
+
+/**
+ * Tests that status throws an Unexpected_response_error when the response is not a 200, is not a list of job
+ * statuses, or omits the requested job.
+ */
+TEST_F(Transfer_service_impl_tests, StatusThrowsUnexpectedResponse)
+{
+    auto caller {std::make_unique<Rest_mock>()};
+    EXPECT_CALL(*caller, get)
+        .WillOnce(Return(Ods::Internal::Response {Header_map {}, "", 500}))
+        .WillOnce(Return(Ods::Internal::Response {Header_map {}, R"([{"id":"job","status":"UNKNOWN"}])", 200}))
+        .WillOnce(Return(Ods::Internal::Response {Header_map {}, R"({"id":"job","status":"FAILED"})", 200}))
+        .WillOnce(Return(Ods::Internal::Response {Header_map {}, R"([{"id":"other","status":"FAILED"}])", 200}));
+
+    const Ods::Internal::Transfer_service_impl transfer {"", "", std::move(caller)};
+
+    for (auto i {0}; i < 4; ++i) {
+        EXPECT_THROW(transfer.status("job"), Ods::Unexpected_response_error);
+    }
+}
+
+} // namespace